@@ -3,7 +3,8 @@
 
 	"Animations": {
 		"Vine": {
-			"Path": "Object/vine.aura"
+			"Path": "Object/vine.aura",
+			"Flags": 4
 		}
 	}
 }
\ No newline at end of file
@@ -158,6 +158,7 @@
 		
 		"WeaponWheel": {
 			"Path": "UI/weapon_wheel.aura",
+			"Flags": 4,
 			"States": [ 80 ]
 		},
 		"WeaponWheelInner": {
@@ -171,26 +172,32 @@
 		
 		"TouchDpad": {
 			"Path": "UI/touch_dpad.aura",
+			"Flags": 4,
 			"States": [ 100 ]
 		},
 		"TouchFire": {
 			"Path": "UI/touch_fire.aura",
+			"Flags": 4,
 			"States": [ 101 ]
 		},
 		"TouchJump": {
 			"Path": "UI/touch_jump.aura",
+			"Flags": 4,
 			"States": [ 102 ]
 		},
 		"TouchRun": {
 			"Path": "UI/touch_run.aura",
+			"Flags": 4,
 			"States": [ 103 ]
 		},
 		"TouchChange": {
 			"Path": "UI/touch_change.aura",
+			"Flags": 4,
 			"States": [ 104 ]
 		},
 		"TouchPause": {
 			"Path": "UI/touch_pause.aura",
+			"Flags": 4,
 			"States": [ 105 ]
 		}
 	}
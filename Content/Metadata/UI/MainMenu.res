@@ -181,14 +181,17 @@
 		
 		"Menu16": {
 			"Path": "UI/menu16.aura",
+			"Flags": 4,
 			"States": [ 80 ]
 		},
 		"Menu32": {
 			"Path": "UI/menu32.aura",
+			"Flags": 4,
 			"States": [ 81 ]
 		},
 		"Menu128": {
 			"Path": "UI/menu128.aura",
+			"Flags": 4,
 			"States": [ 82 ]
 		},
 		
@@ -21,16 +21,168 @@
 #include "../../nCine/Base/Random.h"
 #include "../../nCine/Base/FrameTimer.h"
 
+#if defined(DEATH_TARGET_SSE2)
+#	include <IntrinsicsSse2.h>
+#elif defined(DEATH_TARGET_NEON)
+#	include <arm_neon.h>
+#endif
+
 using namespace Jazz2::Tiles;
 using namespace nCine;
 
 namespace Jazz2::Actors
 {
+	namespace
+	{
+		// Frame of a collision mask placed in the world, frames without collision mask are considered solid
+		struct PlacedMask
+		{
+			const GenericGraphicResource* Base;
+			std::int32_t Frame;
+			std::int32_t Left;
+			std::int32_t Top;
+			bool IsFacingLeft;
+		};
+
+		PlacedMask PlaceMask(const GraphicResource* res, std::int32_t currentFrame, bool isFacingLeft, const AABBf& frameAABB)
+		{
+			PlacedMask mask;
+			mask.Frame = std::min(currentFrame, res->FrameCount - 1);
+			mask.Base = (res->Base->Mask != nullptr && mask.Frame >= 0 &&
+				mask.Frame < res->Base->FrameConfiguration.X * res->Base->FrameConfiguration.Y ? res->Base : nullptr);
+			mask.Left = (std::int32_t)frameAABB.L;
+			mask.Top = (std::int32_t)frameAABB.T;
+			mask.IsFacingLeft = isFacingLeft;
+			return mask;
+		}
+
+		// Shrinks the region to solid pixels of the frame, so fully transparent borders don't have to be tested
+		void ClipToMaskBounds(const PlacedMask& mask, std::int32_t& x1, std::int32_t& y1, std::int32_t& x2, std::int32_t& y2)
+		{
+			if (mask.Base == nullptr) {
+				return;
+			}
+
+			const Recti& bounds = mask.Base->MaskBounds[mask.Frame];
+			std::int32_t left = mask.Left + (mask.IsFacingLeft ? mask.Base->FrameDimensions.X - bounds.X - bounds.W : bounds.X);
+			std::int32_t top = mask.Top + bounds.Y;
+			x1 = std::max(x1, left);
+			y1 = std::max(y1, top);
+			x2 = std::min(x2, left + bounds.W);
+			y2 = std::min(y2, top + bounds.H);
+		}
+
+		// 32 columns of a placed mask starting at the specified column, the bits are split into two words in general
+		struct MaskColumns
+		{
+			const std::uint32_t* Column;
+			const std::uint32_t* NextColumn;
+			std::int32_t Shift;
+		};
+
+		MaskColumns GetMaskColumns(const PlacedMask* mask, std::int32_t x)
+		{
+			MaskColumns columns = { nullptr, nullptr, 0 };
+			if (mask != nullptr && mask->Base != nullptr) {
+				std::int32_t word = (x - mask->Left) >> 5;
+				columns.Shift = (x - mask->Left) & 31;
+				columns.Column = mask->Base->GetMaskColumn(mask->Frame, mask->IsFacingLeft, word);
+				if (columns.Shift != 0 && word + 1 < mask->Base->MaskStride) {
+					columns.NextColumn = mask->Base->GetMaskColumn(mask->Frame, mask->IsFacingLeft, word + 1);
+				}
+			}
+			return columns;
+		}
+
+		inline std::uint32_t LoadMaskBits(const MaskColumns& columns, std::int32_t y)
+		{
+			if (columns.Column == nullptr) {
+				return 0xFFFFFFFFu;
+			}
+			std::uint32_t bits = (columns.Column[y] >> columns.Shift);
+			if (columns.NextColumn != nullptr) {
+				bits |= (columns.NextColumn[y] << (32 - columns.Shift));
+			}
+			return bits;
+		}
+
+#if defined(DEATH_TARGET_SSE2)
+		inline __m128i LoadMaskBits4(const MaskColumns& columns, std::int32_t y)
+		{
+			if (columns.Column == nullptr) {
+				return _mm_set1_epi32(-1);
+			}
+			__m128i bits = _mm_srl_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&columns.Column[y])), _mm_cvtsi32_si128(columns.Shift));
+			if (columns.NextColumn != nullptr) {
+				__m128i nextBits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&columns.NextColumn[y]));
+				bits = _mm_or_si128(bits, _mm_sll_epi32(nextBits, _mm_cvtsi32_si128(32 - columns.Shift)));
+			}
+			return bits;
+		}
+#elif defined(DEATH_TARGET_NEON)
+		inline uint32x4_t LoadMaskBits4(const MaskColumns& columns, std::int32_t y)
+		{
+			if (columns.Column == nullptr) {
+				return vdupq_n_u32(0xFFFFFFFFu);
+			}
+			// Negative shift count shifts to the right
+			uint32x4_t bits = vshlq_u32(vld1q_u32(&columns.Column[y]), vdupq_n_s32(-columns.Shift));
+			if (columns.NextColumn != nullptr) {
+				bits = vorrq_u32(bits, vshlq_u32(vld1q_u32(&columns.NextColumn[y]), vdupq_n_s32(32 - columns.Shift)));
+			}
+			return bits;
+		}
+#endif
+
+		// Returns true if both masks have a solid pixel at the same position in the region, the second mask is optional
+		bool AreMasksOverlapping(const PlacedMask& mask1, const PlacedMask* mask2, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2)
+		{
+			std::int32_t row1 = y1 - mask1.Top;
+			std::int32_t row2 = (mask2 != nullptr ? y1 - mask2->Top : 0);
+			std::int32_t height = y2 - y1;
+
+			// Rows are tested by 32 columns at once
+			for (std::int32_t x = x1; x < x2; x += 32) {
+				std::uint32_t columnMask = (x2 - x >= 32 ? 0xFFFFFFFFu : (1u << (x2 - x)) - 1);
+				MaskColumns columns1 = GetMaskColumns(&mask1, x);
+				MaskColumns columns2 = GetMaskColumns(mask2, x);
+				std::int32_t y = 0;
+
+#if defined(DEATH_TARGET_SSE2)
+				// Test 4 rows at once, rows of the same columns are stored together
+				__m128i columnMask4 = _mm_set1_epi32((std::int32_t)columnMask);
+				for (; y + 4 <= height; y += 4) {
+					__m128i bits = _mm_and_si128(LoadMaskBits4(columns1, row1 + y), LoadMaskBits4(columns2, row2 + y));
+					if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(bits, columnMask4), _mm_setzero_si128())) != 0xFFFF) {
+						return true;
+					}
+				}
+#elif defined(DEATH_TARGET_NEON)
+				uint32x4_t columnMask4 = vdupq_n_u32(columnMask);
+				for (; y + 4 <= height; y += 4) {
+					uint32x4_t bits = vandq_u32(vandq_u32(LoadMaskBits4(columns1, row1 + y), LoadMaskBits4(columns2, row2 + y)), columnMask4);
+					uint32x2_t bits2 = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+					if ((vget_lane_u32(bits2, 0) | vget_lane_u32(bits2, 1)) != 0) {
+						return true;
+					}
+				}
+#endif
+				for (; y < height; y++) {
+					if ((LoadMaskBits(columns1, row1 + y) & LoadMaskBits(columns2, row2 + y) & columnMask) != 0) {
+						return true;
+					}
+				}
+			}
+
+			return false;
+		}
+	}
+
 	ActorBase::ActorBase()
 		: _state(ActorState::None), _levelHandler(nullptr), _internalForceY(0.0f), _elasticity(0.0f), _friction(1.5f),
 			_unstuckCooldown(0.0f), _frozenTimeLeft(0.0f), _maxHealth(1), _health(1), _spawnFrames(0.0f), _metadata(nullptr),
 			_renderer(this), _currentAnimation(nullptr), _currentTransition(nullptr), _currentTransitionCancellable(false),
-			CollisionProxyID(Collisions::NullNode)
+			CollisionProxyID(Collisions::NullNode), _updatedInParallel(false)
 	{
 	}
 
@@ -128,7 +280,7 @@ namespace Jazz2::Actors
 		if (GetState(ActorState::IsCreatedFromEventMap)) {
 			auto events = _levelHandler->EventMap();
 			if (events != nullptr) {
-				events->Deactivate(_originTile.X, _originTile.Y);
+				// Removed event is also deactivated, so activation zones don't have to check the tile again
 				events->StoreTileEvent(_originTile.X, _originTile.Y, EventType::Empty);
 			}
 		}
@@ -156,10 +308,10 @@ namespace Jazz2::Actors
 		// Objects should override this if they need to.
 	}
 
-	bool ActorBase::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool ActorBase::OnHandleCollision(ActorBase* other)
 	{
 		if (GetState(ActorState::CanBeFrozen)) {
-			HandleFrozenStateChange(other.get());
+			HandleFrozenStateChange(other);
 		}
 		return false;
 	}
@@ -221,25 +373,26 @@ namespace Jazz2::Actors
 				// Not doing this will cause hiccups with uphill slopes in particular.
 				// Beach tileset also has some spots where two properly set up adjacent
 				// tiles have a 2px jump, so adapt to that.
-				bool success = false;
+				SmallVector<Vector2f, 64> diffs;
 				float maxYDiff = std::max(3.0f, std::abs(effectiveSpeedX) + 2.5f);
 				for (float yDiff = maxYDiff + effectiveSpeedY; yDiff >= -maxYDiff + effectiveSpeedY; yDiff -= CollisionCheckStep) {
-					if (MoveInstantly(Vector2f(effectiveSpeedX, yDiff), MoveType::Relative, params)) {
-						success = true;
-						break;
-					}
+					diffs.push_back(Vector2f(effectiveSpeedX, yDiff));
 				}
+				bool success = (TryMoveInstantly(diffs, params) >= 0);
 
 				// Also try to move horizontally as far as possible
 				float xDiff = std::abs(effectiveSpeedX);
 				float maxXDiff = -xDiff;
 				if (!success) {
 					std::int32_t sign = (effectiveSpeedX > 0.0f ? 1 : -1);
+					diffs.clear();
 					for (; xDiff >= maxXDiff; xDiff -= CollisionCheckStep) {
-						if (MoveInstantly(Vector2f(xDiff * sign, 0.0f), MoveType::Relative, params)) {
-							success = true;
-							break;
-						}
+						diffs.push_back(Vector2f(xDiff * sign, 0.0f));
+					}
+					std::int32_t index = TryMoveInstantly(diffs, params);
+					if (index >= 0) {
+						xDiff = diffs[index].X * sign;
+						success = true;
 					}
 
 					bool moved = false;
@@ -288,27 +441,33 @@ namespace Jazz2::Actors
 				// First, attempt to move directly based on the current speed values
 				if (!MoveInstantly(Vector2f(effectiveSpeedX, effectiveSpeedY), MoveType::Relative, params)) {
 					// First, attempt to move horizontally as much as possible
+					SmallVector<Vector2f, 64> diffs;
 					float maxDiff = std::abs(effectiveSpeedX);
 					std::int32_t sign = (effectiveSpeedX > 0.0f ? 1 : -1);
 					float xDiff = maxDiff;
 					for (; xDiff > std::numeric_limits<float>::epsilon(); xDiff -= CollisionCheckStep) {
-						if (MoveInstantly(Vector2f(xDiff * sign, 0.0f), MoveType::Relative, params)) {
-							break;
-						}
+						diffs.push_back(Vector2f(xDiff * sign, 0.0f));
+					}
+					std::int32_t index = TryMoveInstantly(diffs, params);
+					if (index >= 0) {
+						xDiff = diffs[index].X * sign;
 					}
 
 					// Then, try the same vertically
 					maxDiff = std::abs(effectiveSpeedY);
 					sign = (effectiveSpeedY > 0.0f ? 1 : -1);
 					float yDiff = maxDiff;
+					diffs.clear();
 					for (; yDiff > std::numeric_limits<float>::epsilon(); yDiff -= CollisionCheckStep) {
 						float yDiffSigned = (yDiff * sign);
-						if (MoveInstantly(Vector2f(0.0f, yDiffSigned), MoveType::Relative, params) ||
-							// Add horizontal tolerance
-							MoveInstantly(Vector2f(yDiff * 0.2f, yDiffSigned), MoveType::Relative, params) ||
-							MoveInstantly(Vector2f(yDiff * -0.2f, yDiffSigned), MoveType::Relative, params)) {
-							break;
-						}
+						diffs.push_back(Vector2f(0.0f, yDiffSigned));
+						// Add horizontal tolerance
+						diffs.push_back(Vector2f(yDiff * 0.2f, yDiffSigned));
+						diffs.push_back(Vector2f(yDiff * -0.2f, yDiffSigned));
+					}
+					index = TryMoveInstantly(diffs, params);
+					if (index >= 0) {
+						yDiff = diffs[index].Y * sign;
 					}
 
 					// Place us to the ground only if no horizontal movement was
@@ -371,6 +530,41 @@ namespace Jazz2::Actors
 		}
 	}
 
+	std::int32_t ActorBase::TryMoveInstantly(ArrayView<const Vector2f> diffs, TileCollisionParams& params)
+	{
+		// Tries all relative moves in order until one succeeds, solid objects for all of them are found by one query
+		SmallVector<AABBf, 64> aabbs;
+		aabbs.reserve(diffs.size());
+		for (const Vector2f& diff : diffs) {
+			aabbs.push_back(AABBInner + diff);
+		}
+
+		SmallVector<ActorBase*, 16> candidates;
+		SmallVector<std::uint32_t, 65> offsets;
+		offsets.resize(diffs.size() + 1);
+		if (GetState(ActorState::CollideWithSolidObjects)) {
+			_levelHandler->FindCollisionActorsByAABBs(this, aabbs, candidates, offsets);
+		}
+
+		for (std::size_t i = 0; i < diffs.size(); i++) {
+			if (diffs[i] == Vector2f::Zero) {
+				return (std::int32_t)i;
+			}
+
+			ArrayView<ActorBase* const> colliders(candidates.data() + offsets[i], offsets[i + 1] - offsets[i]);
+			if (_levelHandler->IsPositionEmpty(this, aabbs[i], params, colliders)) {
+				AABBInner = aabbs[i];
+				_pos += diffs[i];
+				if ((_state & ActorState::ForceDisableCollisions) != ActorState::ForceDisableCollisions) {
+					_state |= ActorState::IsDirty;
+				}
+				return (std::int32_t)i;
+			}
+		}
+
+		return -1;
+	}
+
 	void ActorBase::UpdateHitbox(std::int32_t w, std::int32_t h)
 	{
 		if (_currentAnimation == nullptr) {
@@ -427,6 +621,12 @@ namespace Jazz2::Actors
 #if defined(WITH_AUDIO)
 		auto it = _metadata->Sounds.find(String::nullTerminatedView(identifier));
 		if (it != _metadata->Sounds.end()) {
+			if (_levelHandler->IsUpdatingInParallel()) {
+				// Key stored in metadata is used, so the identifier doesn't have to be copied
+				_levelHandler->InvokeDeferred({ DeferredCommandType::PlaySfx, this, it->first, {}, 0, gain, pitch });
+				return nullptr;
+			}
+
 			std::int32_t idx = (it->second.Buffers.size() > 1 ? Random().Next(0, (std::int32_t)it->second.Buffers.size()) : 0);
 			return _levelHandler->PlaySfx(this, identifier, &it->second.Buffers[idx]->Buffer, Vector3f(_pos.X, _pos.Y, 0.0f), false, gain, pitch);
 		} else {
@@ -634,103 +834,39 @@ namespace Jazz2::Actors
 				return true;
 			}
 
-			//PixelData p;
-			uint8_t* p;
-			GraphicResource* res;
-			bool isFacingLeftCurrent;
-			std::int32_t x1, y1, x2, y2, xs, dx, dy, stride;
+			std::int32_t x1, y1, x2, y2;
+			PlacedMask mask;
 			if (perPixel1) {
-				res = res1;
-				p = res->Base->Mask.get();
-
-				isFacingLeftCurrent = GetState(ActorState::IsFacingLeft);
-
 				x1 = (std::int32_t)std::max(inter.L, other->AABBInner.L);
 				y1 = (std::int32_t)std::max(inter.T, other->AABBInner.T);
 				x2 = (std::int32_t)std::min(inter.R, other->AABBInner.R);
 				y2 = (std::int32_t)std::min(inter.B, other->AABBInner.B);
-
-				xs = (std::int32_t)aabb1.L;
-
-				std::int32_t frame1 = std::min(_renderer.CurrentFrame, res->FrameCount - 1);
-				dx = (frame1 % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X;
-				dy = (frame1 / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y - (std::int32_t)aabb1.T;
-
+				mask = PlaceMask(res1, _renderer.CurrentFrame, GetState(ActorState::IsFacingLeft), aabb1);
 			} else {
-				res = res2;
-				p = res->Base->Mask.get();
-
-				isFacingLeftCurrent = other->GetState(ActorState::IsFacingLeft);
-
 				x1 = (std::int32_t)std::max(inter.L, AABBInner.L);
 				y1 = (std::int32_t)std::max(inter.T, AABBInner.T);
 				x2 = (std::int32_t)std::min(inter.R, AABBInner.R);
 				y2 = (std::int32_t)std::min(inter.B, AABBInner.B);
-
-				xs = (std::int32_t)aabb2.L;
-
-				std::int32_t frame2 = std::min(other->_renderer.CurrentFrame, res->FrameCount - 1);
-				dx = (frame2 % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X;
-				dy = (frame2 / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y - (std::int32_t)aabb2.T;
+				mask = PlaceMask(res2, other->_renderer.CurrentFrame, other->GetState(ActorState::IsFacingLeft), aabb2);
 			}
 
-			stride = res->Base->FrameConfiguration.X * res->Base->FrameDimensions.X;
-
 			// Per-pixel collision check
-			for (std::int32_t i = x1; i < x2; i += PerPixelCollisionStep) {
-				for (std::int32_t j = y1; j < y2; j += PerPixelCollisionStep) {
-					std::int32_t i1 = i - xs;
-					if (isFacingLeftCurrent) {
-						i1 = res->Base->FrameDimensions.X - i1 - 1;
-					}
-
-					if (p[((j + dy) * stride) + i1 + dx] > AlphaThreshold) {
-						return true;
-					}
-				}
-			}
-		} else {
-			std::int32_t x1 = (std::int32_t)inter.L;
-			std::int32_t y1 = (std::int32_t)inter.T;
-			std::int32_t x2 = (std::int32_t)inter.R;
-			std::int32_t y2 = (std::int32_t)inter.B;
-
-			std::int32_t x1s = (std::int32_t)aabb1.L;
-			std::int32_t x2s = (std::int32_t)aabb2.L;
-
-			std::int32_t frame1 = std::min(_renderer.CurrentFrame, res1->FrameCount - 1);
-			std::int32_t dx1 = (frame1 % res1->Base->FrameConfiguration.X) * res1->Base->FrameDimensions.X;
-			std::int32_t dy1 = (frame1 / res1->Base->FrameConfiguration.X) * res1->Base->FrameDimensions.Y - (std::int32_t)aabb1.T;
-			std::int32_t stride1 = res1->Base->FrameConfiguration.X * res1->Base->FrameDimensions.X;
+			ClipToMaskBounds(mask, x1, y1, x2, y2);
+			return (x1 < x2 && y1 < y2 && AreMasksOverlapping(mask, nullptr, x1, y1, x2, y2));
+		}
 
-			std::int32_t frame2 = std::min(other->_renderer.CurrentFrame, res2->FrameCount - 1);
-			std::int32_t dx2 = (frame2 % res2->Base->FrameConfiguration.X) * res2->Base->FrameDimensions.X;
-			std::int32_t dy2 = (frame2 / res2->Base->FrameConfiguration.X) * res2->Base->FrameDimensions.Y - (std::int32_t)aabb2.T;
-			std::int32_t stride2 = res2->Base->FrameConfiguration.X * res2->Base->FrameDimensions.X;
+		std::int32_t x1 = (std::int32_t)inter.L;
+		std::int32_t y1 = (std::int32_t)inter.T;
+		std::int32_t x2 = (std::int32_t)inter.R;
+		std::int32_t y2 = (std::int32_t)inter.B;
 
-			// Per-pixel collision check
-			auto p1 = res1->Base->Mask.get();
-			auto p2 = res2->Base->Mask.get();
-
-			for (std::int32_t i = x1; i < x2; i += PerPixelCollisionStep) {
-				for (std::int32_t j = y1; j < y2; j += PerPixelCollisionStep) {
-					std::int32_t i1 = i - x1s;
-					if (GetState(ActorState::IsFacingLeft)) {
-						i1 = res1->Base->FrameDimensions.X - i1 - 1;
-					}
-					std::int32_t i2 = i - x2s;
-					if (other->GetState(ActorState::IsFacingLeft)) {
-						i2 = res2->Base->FrameDimensions.X - i2 - 1;
-					}
-
-					if (p1[((j + dy1) * stride1) + i1 + dx1] > AlphaThreshold && p2[((j + dy2) * stride2) + i2 + dx2] > AlphaThreshold) {
-						return true;
-					}
-				}
-			}
-		}
+		PlacedMask mask1 = PlaceMask(res1, _renderer.CurrentFrame, GetState(ActorState::IsFacingLeft), aabb1);
+		PlacedMask mask2 = PlaceMask(res2, other->_renderer.CurrentFrame, other->GetState(ActorState::IsFacingLeft), aabb2);
 
-		return false;
+		// Per-pixel collision check
+		ClipToMaskBounds(mask1, x1, y1, x2, y2);
+		ClipToMaskBounds(mask2, x1, y1, x2, y2);
+		return (x1 < x2 && y1 < y2 && AreMasksOverlapping(mask1, &mask2, x1, y1, x2, y2));
 	}
 
 	bool ActorBase::IsCollidingWith(const AABBf& aabb)
@@ -772,30 +908,11 @@ namespace Jazz2::Actors
 		std::int32_t x2 = (std::int32_t)std::min(inter.R, aabb.R);
 		std::int32_t y2 = (std::int32_t)std::min(inter.B, aabb.B);
 
-		std::int32_t xs = (std::int32_t)aabbSelf.L;
-
-		std::int32_t frame1 = std::min(_renderer.CurrentFrame, res->FrameCount - 1);
-		std::int32_t dx = (frame1 % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X;
-		std::int32_t dy = (frame1 / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y - (int)aabbSelf.T;
-		std::int32_t stride = res->Base->FrameConfiguration.X * res->Base->FrameDimensions.X;
+		PlacedMask mask = PlaceMask(res, _renderer.CurrentFrame, GetState(ActorState::IsFacingLeft), aabbSelf);
 
 		// Per-pixel collision check
-		auto p = res->Base->Mask.get();
-
-		for (std::int32_t i = x1; i < x2; i += PerPixelCollisionStep) {
-			for (std::int32_t j = y1; j < y2; j += PerPixelCollisionStep) {
-				std::int32_t i1 = i - xs;
-				if (GetState(ActorState::IsFacingLeft)) {
-					i1 = res->Base->FrameDimensions.X - i1 - 1;
-				}
-
-				if (p[((j + dy) * stride) + i1 + dx] > AlphaThreshold) {
-					return true;
-				}
-			}
-		}
-
-		return false;
+		ClipToMaskBounds(mask, x1, y1, x2, y2);
+		return (x1 < x2 && y1 < y2 && AreMasksOverlapping(mask, nullptr, x1, y1, x2, y2));
 	}
 
 	bool ActorBase::IsCollidingWithAngled(ActorBase* other)
@@ -866,17 +983,7 @@ namespace Jazz2::Actors
 		Vector3f yPosIn2 = Vector3f::Zero * transformAToB;
 
 		std::int32_t frame1 = std::min(_renderer.CurrentFrame, res1->FrameCount - 1);
-		std::int32_t dx1 = (frame1 % res1->Base->FrameConfiguration.X) * res1->Base->FrameDimensions.X;
-		std::int32_t dy1 = (frame1 / res1->Base->FrameConfiguration.X) * res1->Base->FrameDimensions.Y;
-		std::int32_t stride1 = res1->Base->FrameConfiguration.X * res1->Base->FrameDimensions.X;
-
 		std::int32_t frame2 = std::min(other->_renderer.CurrentFrame, res2->FrameCount - 1);
-		std::int32_t dx2 = (frame2 % res2->Base->FrameConfiguration.X) * res2->Base->FrameDimensions.X;
-		std::int32_t dy2 = (frame2 / res2->Base->FrameConfiguration.X) * res2->Base->FrameDimensions.Y;
-		std::int32_t stride2 = res2->Base->FrameConfiguration.X * res2->Base->FrameDimensions.X;
-
-		auto p1 = res1->Base->Mask.get();
-		auto p2 = res2->Base->Mask.get();
 
 		for (std::int32_t y1 = 0; y1 < height1; y1 += PerPixelCollisionStep) {
 			Vector3f posIn2 = yPosIn2;
@@ -886,7 +993,7 @@ namespace Jazz2::Actors
 				std::int32_t y2 = (std::int32_t)std::round(posIn2.Y);
 
 				if (x2 >= 0 && x2 < width2 && y2 >= 0 && y2 < height2) {
-					if (p1[((y1 + dy1) * stride1) + x1 + dx1] > AlphaThreshold && p2[((y2 + dy2) * stride2) + x2 + dx2] > AlphaThreshold) {
+					if (res1->Base->IsMaskPixelSet(frame1, x1, y1) && res2->Base->IsMaskPixelSet(frame2, x2, y2)) {
 						return true;
 					}
 				}
@@ -941,11 +1048,6 @@ namespace Jazz2::Actors
 		Vector3f yPosInAABB = Vector3f::Zero * transform;
 
 		std::int32_t frame = std::min(_renderer.CurrentFrame, res->FrameCount - 1);
-		std::int32_t dx = (frame % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X;
-		std::int32_t dy = (frame / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y;
-		std::int32_t stride = res->Base->FrameConfiguration.X * res->Base->FrameDimensions.X;
-
-		auto p = res->Base->Mask.get();
 
 		for (std::int32_t y1 = 0; y1 < height; y1 += PerPixelCollisionStep) {
 			Vector3f posInAABB = yPosInAABB;
@@ -954,7 +1056,7 @@ namespace Jazz2::Actors
 				std::int32_t x2 = (std::int32_t)std::round(posInAABB.X);
 				std::int32_t y2 = (std::int32_t)std::round(posInAABB.Y);
 
-				if (p[((y1 + dy) * stride) + x1 + dx] > AlphaThreshold &&
+				if (res->Base->IsMaskPixelSet(frame, x1, y1) &&
 					x2 >= aabb.L && x2 < aabb.R && y2 >= aabb.T && y2 < aabb.B) {
 					return true;
 				}
@@ -1025,6 +1127,7 @@ namespace Jazz2::Actors
 
 		_renderer.FrameConfiguration = res->Base->FrameConfiguration;
 		_renderer.FrameDimensions = res->Base->FrameDimensions;
+		_renderer.TextureOffset = res->Base->TextureOffset;
 		if (res->AnimDuration < 0.0f) {
 			if (res->FrameCount > 1) {
 				_renderer.FirstFrame = res->FrameOffset + nCine::Random().Next(0, res->FrameCount);
@@ -1045,6 +1148,7 @@ namespace Jazz2::Actors
 		_renderer.Hotspot.X = static_cast<float>(IsFacingLeft() ? (res->Base->FrameDimensions.X - res->Base->Hotspot.X) : res->Base->Hotspot.X);
 		_renderer.Hotspot.Y = static_cast<float>(res->Base->Hotspot.Y);
 
+		_renderer.SetPaletteOffset(res->Base->IsIndexed() ? res->Base->PaletteOffset : -1);
 		_renderer.setTexture(res->Base->TextureDiffuse.get());
 		_renderer.UpdateVisibleFrames();
 
@@ -1183,7 +1287,7 @@ namespace Jazz2::Actors
 	ActorBase::ActorRenderer::ActorRenderer(ActorBase* owner)
 		: BaseSprite(nullptr, nullptr, 0.0f, 0.0f), AnimPaused(false), LoopMode(AnimationLoopMode::Loop), FirstFrame(0),
 			FrameCount(0), AnimDuration(0.0f), AnimTime(0.0f), CurrentFrame(0), _owner(owner),
-			_rendererType((ActorRendererType)-1), _rendererTransition(0.0f)
+			_rendererType((ActorRendererType)-1), _rendererTransition(0.0f), _paletteOffset(-1)
 	{
 		_type = ObjectType::Sprite;
 		renderCommand_.setType(RenderCommand::Type::Sprite);
@@ -1204,7 +1308,13 @@ namespace Jazz2::Actors
 			case ActorRendererType::WhiteMask: shaderChanged = renderCommand_.material().setShader(ContentResolver::Get().GetShader(PrecompiledShader::WhiteMask)); break;
 			case ActorRendererType::PartialWhiteMask: shaderChanged = renderCommand_.material().setShader(ContentResolver::Get().GetShader(PrecompiledShader::PartialWhiteMask)); break;
 			case ActorRendererType::FrozenMask: shaderChanged = renderCommand_.material().setShader(ContentResolver::Get().GetShader(PrecompiledShader::FrozenMask)); break;
-			default: shaderChanged = renderCommand_.material().setShaderProgramType(Material::ShaderProgramType::Sprite); break;
+			default:
+				if (_paletteOffset >= 0) {
+					shaderChanged = renderCommand_.material().setShader(ContentResolver::Get().GetShader(PrecompiledShader::Palette));
+				} else {
+					shaderChanged = renderCommand_.material().setShaderProgramType(Material::ShaderProgramType::Sprite);
+				}
+				break;
 		}
 		if (shaderChanged) {
 			shaderHasChanged();
@@ -1216,15 +1326,55 @@ namespace Jazz2::Actors
 					Vector2i texSize = texture_->size();
 					setColor(Colorf(1.0f / texSize.X, 1.0f / texSize.Y, 1.0f, _rendererTransition));
 				}
+			} else if (type == ActorRendererType::Default && _paletteOffset >= 0) {
+				// Palette offset is passed in red channel of the color, so sprites with different palettes can be batched together
+				GLUniformCache* paletteUniform = renderCommand_.material().uniform(Material::PaletteUniformName);
+				if (paletteUniform && paletteUniform->intValue(0) != 1) {
+					paletteUniform->setIntValue(1); // GL_TEXTURE1
+				}
+				Texture* paletteTexture = ContentResolver::Get().GetPaletteTexture();
+				if (paletteTexture != nullptr) {
+					renderCommand_.material().setTexture(1, *paletteTexture);
+				}
+				setColor(Colorf((float)_paletteOffset, 1.0f, 1.0f, 1.0f));
 			} else {
+				renderCommand_.material().setTexture(1, nullptr);
 				setColor(Colorf::White);
 			}
 		}
 	}
 
+	void ActorBase::ActorRenderer::SetPaletteOffset(std::int32_t paletteOffset)
+	{
+		if (_paletteOffset == paletteOffset) {
+			return;
+		}
+
+		bool indexedChanged = ((_paletteOffset >= 0) != (paletteOffset >= 0));
+		_paletteOffset = paletteOffset;
+
+		if (_rendererType == ActorRendererType::Default) {
+			if (indexedChanged) {
+				// Indexed textures need different shader
+				_rendererType = (ActorRendererType)-1;
+				Initialize(ActorRendererType::Default);
+			} else {
+				setColor(Colorf((float)_paletteOffset, 1.0f, 1.0f, color().A));
+			}
+		}
+	}
+
 	void ActorBase::ActorRenderer::OnUpdate(float timeMult)
 	{
-		_owner->OnUpdate(timeMult);
+		if (_owner->_updatedInParallel) {
+			// Already updated by LevelHandler in this frame
+			_owner->_updatedInParallel = false;
+		} else {
+			_owner->OnUpdate(timeMult);
+#if defined(WITH_PROFILER)
+			Profiler::AddCounter(ProfilerCounter::ActorsUpdated);
+#endif
+		}
 
 		Vector2f pos = _owner->_pos;
 		if (!PreferencesCache::UnalignedViewport || (_owner->_state & ActorState::IsDirty) != ActorState::IsDirty) {
@@ -1342,7 +1492,7 @@ namespace Jazz2::Actors
 		// Set current animation frame rectangle
 		std::int32_t col = CurrentFrame % FrameConfiguration.X;
 		std::int32_t row = CurrentFrame / FrameConfiguration.X;
-		setTexRect(Recti(FrameDimensions.X * col, FrameDimensions.Y * row, FrameDimensions.X, FrameDimensions.Y));
+		setTexRect(Recti(TextureOffset.X + FrameDimensions.X * col, TextureOffset.Y + FrameDimensions.Y * row, FrameDimensions.X, FrameDimensions.Y));
 		setAbsAnchorPoint(Hotspot.X, Hotspot.Y);
 	}
 
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "ActorPool.h"
 #include "../EventType.h"
 #include "../LightEmitter.h"
 #include "../Resources.h"
@@ -105,6 +106,14 @@ namespace Jazz2::Actors
 		CollideWithSolidObjectsBelow = 0x4000000,
 		/** @brief Ignore solid collisions agains similar objects that have this flag */
 		ExcludeSimilar = 0x8000000,
+
+		/**
+		 * @brief Allow @ref ActorBase::OnUpdate() to be called in parallel with other actors
+		 *
+		 * The actor can modify only itself and read the level, any other side effects must be deferred using
+		 * @ref ILevelHandler::InvokeDeferred(). It's ignored for actors that collide with solid objects or are frozen.
+		 */
+		AllowParallelUpdate = 0x10000000,
 	};
 
 	DEFINE_ENUM_OPERATORS(ActorState);
@@ -155,12 +164,14 @@ namespace Jazz2::Actors
 		AABBf AABB;
 		AABBf AABBInner;
 		std::int32_t CollisionProxyID;
+		// Assigned by the level when the actor is added, it should be used for references that can outlive the actor
+		ActorHandle Handle;
 
 		bool IsFacingLeft();
 
 		void SetParent(SceneNode* parent);
 		Task<bool> OnActivated(const ActorActivationDetails& details);
-		virtual bool OnHandleCollision(std::shared_ptr<ActorBase> other);
+		virtual bool OnHandleCollision(ActorBase* other);
 
 		bool IsInvulnerable();
 		std::int32_t GetHealth();
@@ -210,6 +221,7 @@ namespace Jazz2::Actors
 			bool AnimPaused;
 			Vector2i FrameConfiguration;
 			Vector2i FrameDimensions;
+			Vector2i TextureOffset;
 			AnimationLoopMode LoopMode;
 			std::int32_t FirstFrame;
 			std::int32_t FrameCount;
@@ -219,6 +231,7 @@ namespace Jazz2::Actors
 			Vector2f Hotspot;
 
 			void Initialize(ActorRendererType type);
+			void SetPaletteOffset(std::int32_t paletteOffset);
 
 			void OnUpdate(float timeMult) override;
 			bool OnDraw(RenderQueue& renderQueue) override;
@@ -233,12 +246,13 @@ namespace Jazz2::Actors
 			ActorBase* _owner;
 			ActorRendererType _rendererType;
 			float _rendererTransition;
+			// Negative if the texture is not indexed
+			std::int32_t _paletteOffset;
 
 			void UpdateVisibleFrames();
 			static std::int32_t NormalizeFrame(std::int32_t frame, std::int32_t min, std::int32_t max);
 		};
 
-		static constexpr std::uint8_t AlphaThreshold = 40;
 		static constexpr float CollisionCheckStep = 0.5f;
 		static constexpr std::int32_t PerPixelCollisionStep = 3;
 		static constexpr std::int32_t AnimationCandidatesCount = 5;
@@ -283,6 +297,7 @@ namespace Jazz2::Actors
 		virtual void OnTriggeredEvent(EventType eventType, uint8_t* eventParams);
 
 		void TryStandardMovement(float timeMult, Tiles::TileCollisionParams& params);
+		std::int32_t TryMoveInstantly(ArrayView<const Vector2f> diffs, Tiles::TileCollisionParams& params);
 		void UpdateHitbox(std::int32_t w, std::int32_t h);
 		void UpdateFrozenState(float timeMult);
 		void HandleFrozenStateChange(ActorBase* shot);
@@ -347,6 +362,7 @@ namespace Jazz2::Actors
 
 		ActorState _state;
 		std::function<void()> _currentTransitionCallback;
+		bool _updatedInParallel;
 
 		bool IsCollidingWithAngled(ActorBase* other);
 		bool IsCollidingWithAngled(const AABBf& aabb);
@@ -0,0 +1,43 @@
+﻿#include "ActorPool.h"
+
+#include "../../nCine/Base/ConcurentQueue/concurrentqueue.h"
+
+namespace Jazz2::Actors
+{
+	class ActorPool::Bin
+	{
+	public:
+		// Max. number of free blocks kept in one bin, the rest is returned to the system
+		static constexpr std::size_t MaxFreeBlocks = 512;
+
+		Bin(std::size_t blockSize)
+			: BlockSize(blockSize)
+		{
+		}
+
+		std::size_t BlockSize;
+		moodycamel::ConcurrentQueue<void*> FreeBlocks;
+	};
+
+	ActorPool::Bin* ActorPool::CreateBin(std::size_t blockSize)
+	{
+		return new Bin(blockSize);
+	}
+
+	void* ActorPool::Allocate(Bin* bin)
+	{
+		void* ptr;
+		if (bin->FreeBlocks.try_dequeue(ptr)) {
+			return ptr;
+		}
+		return ::operator new(bin->BlockSize);
+	}
+
+	void ActorPool::Deallocate(Bin* bin, void* ptr)
+	{
+		// The count is only approximate, but it's good enough to limit the memory usage
+		if (bin->FreeBlocks.size_approx() >= Bin::MaxFreeBlocks || !bin->FreeBlocks.enqueue(ptr)) {
+			::operator delete(ptr);
+		}
+	}
+}
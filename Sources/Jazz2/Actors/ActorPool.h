@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <Common.h>
+
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace Jazz2::Actors
+{
+	/** @brief Weak reference to an actor that stays valid even if the actor is destroyed */
+	struct ActorHandle
+	{
+		/** @brief Index of the slot in the level */
+		std::uint32_t Index;
+		/** @brief Generation of the slot, it's incremented every time the slot is released, `0` is never used */
+		std::uint32_t Generation;
+
+		constexpr ActorHandle() noexcept
+			: Index(0), Generation(0) {}
+
+		constexpr ActorHandle(std::uint32_t index, std::uint32_t generation) noexcept
+			: Index(index), Generation(generation) {}
+
+		constexpr bool IsValid() const noexcept {
+			return (Generation != 0);
+		}
+
+		constexpr bool operator==(const ActorHandle& other) const noexcept {
+			return (Index == other.Index && Generation == other.Generation);
+		}
+		constexpr bool operator!=(const ActorHandle& other) const noexcept {
+			return !operator==(other);
+		}
+	};
+
+	/** @brief Thread-safe pools of fixed-size memory blocks for actors */
+	class ActorPool
+	{
+	public:
+		class Bin;
+
+		/** @brief Creates a new bin for blocks of the specified size, bins are never destroyed */
+		static Bin* CreateBin(std::size_t blockSize);
+		/** @brief Returns a block from the bin, or allocates a new one if the bin is empty */
+		static void* Allocate(Bin* bin);
+		/** @brief Returns a block back to the bin */
+		static void Deallocate(Bin* bin, void* ptr);
+
+	private:
+		ActorPool() = delete;
+		~ActorPool() = delete;
+	};
+
+	/** @brief Allocator that reuses memory of destroyed actors of the same type, it's intended to be used with @ref std::allocate_shared() */
+	template<class T>
+	class ActorPoolAllocator
+	{
+	public:
+		using value_type = T;
+
+		ActorPoolAllocator() noexcept {}
+
+		template<class U>
+		ActorPoolAllocator(const ActorPoolAllocator<U>&) noexcept {}
+
+		T* allocate(std::size_t n) {
+			if (n != 1) {
+				return static_cast<T*>(::operator new(n * sizeof(T)));
+			}
+			return static_cast<T*>(ActorPool::Allocate(GetBin()));
+		}
+
+		void deallocate(T* ptr, std::size_t n) noexcept {
+			if (n != 1) {
+				::operator delete(ptr);
+				return;
+			}
+			ActorPool::Deallocate(GetBin(), ptr);
+		}
+
+		template<class U>
+		bool operator==(const ActorPoolAllocator<U>&) const noexcept {
+			return true;
+		}
+		template<class U>
+		bool operator!=(const ActorPoolAllocator<U>&) const noexcept {
+			return false;
+		}
+
+	private:
+		// The allocator is rebound to the control block type by std::allocate_shared(), so every actor type has its own bin
+		static ActorPool::Bin* GetBin() {
+			static ActorPool::Bin* bin = ActorPool::CreateBin(sizeof(T));
+			return bin;
+		}
+	};
+
+	/** @brief Creates a new actor of the specified type, memory of destroyed actors of the same type is reused */
+	template<class T, class ...Args>
+	inline std::shared_ptr<T> CreateActor(Args&&... args)
+	{
+		return std::allocate_shared<T>(ActorPoolAllocator<T>(), std::forward<Args>(args)...);
+	}
+}
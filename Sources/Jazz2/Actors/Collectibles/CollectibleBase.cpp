@@ -1,4 +1,5 @@
 ﻿#include "CollectibleBase.h"
+#include "../../ILevelHandler.h"
 #include "../Player.h"
 #include "../Explosion.h"
 #include "../Weapons/ShotBase.h"
@@ -25,7 +26,7 @@ namespace Jazz2::Actors::Collectibles
 	{
 		_elasticity = 0.6f;
 
-		SetState(ActorState::SkipPerPixelCollisions, true);
+		SetState(ActorState::SkipPerPixelCollisions | ActorState::AllowParallelUpdate, true);
 
 		Vector2f pos = _pos;
 		_phase = ((pos.X / 32) + (pos.Y / 32)) * 2.0f;
@@ -68,8 +69,8 @@ namespace Jazz2::Actors::Collectibles
 		} else if (_timeLeft > 0.0f) {
 			_timeLeft -= timeMult;
 			if (_timeLeft <= 0.0f) {
-				Explosion::Create(_levelHandler, Vector3i((int)_pos.X, (int)_pos.Y, _renderer.layer()), Explosion::Type::Generator);
-				DecreaseHealth(INT32_MAX);
+				_levelHandler->InvokeDeferred({ DeferredCommandType::CreateExplosion, nullptr, {}, Vector3i((int)_pos.X, (int)_pos.Y, _renderer.layer()), (std::int32_t)Explosion::Type::Generator });
+				_levelHandler->InvokeDeferred({ DeferredCommandType::DecreaseHealth, this, {}, {}, INT32_MAX });
 			}
 		}
 
@@ -91,7 +92,7 @@ namespace Jazz2::Actors::Collectibles
 		}
 	}
 
-	bool CollectibleBase::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool CollectibleBase::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			OnCollect(player);
@@ -16,7 +16,7 @@ namespace Jazz2::Actors::Collectibles
 	public:
 		CollectibleBase();
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 	protected:
 		static constexpr int IlluminateLightCount = 20;
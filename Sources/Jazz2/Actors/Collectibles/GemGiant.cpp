@@ -32,7 +32,7 @@ namespace Jazz2::Actors::Collectibles
 		async_return true;
 	}
 
-	bool GemGiant::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool GemGiant::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* shotBase = runtime_cast<Weapons::ShotBase*>(other)) {
 			if (shotBase->GetStrength() > 0) {
@@ -1,4 +1,5 @@
 ﻿#include "GemRing.h"
+#include "../../ContentResolver.h"
 #include "../../ILevelHandler.h"
 #include "../../Tiles/TileMap.h"
 #include "../Player.h"
@@ -32,11 +33,18 @@ namespace Jazz2::Actors::Collectibles
 
 		async_await RequestMetadataAsync("Collectible/Gems"_s);
 
+		auto* res = _metadata->FindAnimation(AnimState::Default); // GemRed
+		Texture* paletteTexture = (res != nullptr && res->Base->IsIndexed() ? ContentResolver::Get().GetPaletteTexture() : nullptr);
+
 		for (int i = 0; i < length; i++) {
 			ChainPiece& piece = _pieces.emplace_back();
 			piece.Scale = 0.8f;
 			piece.Command = std::make_unique<RenderCommand>(RenderCommand::Type::Sprite);
-			piece.Command->material().setShaderProgramType(Material::ShaderProgramType::Sprite);
+			if (paletteTexture != nullptr) {
+				piece.Command->material().setShader(ContentResolver::Get().GetShader(PrecompiledShader::Palette));
+			} else {
+				piece.Command->material().setShaderProgramType(Material::ShaderProgramType::Sprite);
+			}
 			piece.Command->material().setBlendingEnabled(true);
 			piece.Command->material().reserveUniformsDataMemory();
 			piece.Command->geometry().setDrawParameters(GL_TRIANGLE_STRIP, 0, 4);
@@ -45,6 +53,14 @@ namespace Jazz2::Actors::Collectibles
 			if (textureUniform && textureUniform->intValue(0) != 0) {
 				textureUniform->setIntValue(0); // GL_TEXTURE0
 			}
+
+			if (paletteTexture != nullptr) {
+				GLUniformCache* paletteUniform = piece.Command->material().uniform(Material::PaletteUniformName);
+				if (paletteUniform && paletteUniform->intValue(0) != 1) {
+					paletteUniform->setIntValue(1); // GL_TEXTURE1
+				}
+				piece.Command->material().setTexture(1, *paletteTexture);
+			}
 		}
 
 		async_return true;
@@ -54,7 +70,7 @@ namespace Jazz2::Actors::Collectibles
 	{
 		if (_collected) {
 			if (_collectedPhase > 100.0f) {
-				DecreaseHealth(INT32_MAX);
+				_levelHandler->InvokeDeferred({ DeferredCommandType::DecreaseHealth, this, {}, {}, INT32_MAX });
 				return;
 			}
 
@@ -104,14 +120,16 @@ namespace Jazz2::Actors::Collectibles
 					int col = curAnimFrame % res->Base->FrameConfiguration.X;
 					int row = curAnimFrame / res->Base->FrameConfiguration.X;
 					float texScaleX = (float(res->Base->FrameDimensions.X) / float(texSize.X));
-					float texBiasX = (float(res->Base->FrameDimensions.X * col) / float(texSize.X));
+					float texBiasX = (float(res->Base->TextureOffset.X + res->Base->FrameDimensions.X * col) / float(texSize.X));
 					float texScaleY = (float(res->Base->FrameDimensions.Y) / float(texSize.Y));
-					float texBiasY = (float(res->Base->FrameDimensions.Y * row) / float(texSize.Y));
+					float texBiasY = (float(res->Base->TextureOffset.Y + res->Base->FrameDimensions.Y * row) / float(texSize.Y));
 
 					auto instanceBlock = command->material().uniformBlock(Material::InstanceBlockName);
 					instanceBlock->uniform(Material::TexRectUniformName)->setFloatValue(texScaleX, texBiasX, texScaleY, texBiasY);
 					instanceBlock->uniform(Material::SpriteSizeUniformName)->setFloatValue(res->Base->FrameDimensions.X * _pieces[i].Scale, res->Base->FrameDimensions.Y * _pieces[i].Scale);
-					instanceBlock->uniform(Material::ColorUniformName)->setFloatVector(Colorf(1.0f, 1.0f, 1.0f, 0.7f).Data());
+					// Palette offset is passed in red channel of the color if the texture is indexed
+					float red = (res->Base->IsIndexed() ? (float)res->Base->PaletteOffset : 1.0f);
+					instanceBlock->uniform(Material::ColorUniformName)->setFloatVector(Colorf(red, 1.0f, 1.0f, 0.7f).Data());
 
 					auto& pos = _pieces[i].Pos;
 					command->setTransformation(Matrix4x4f::Translation(pos.X, pos.Y, 0.0f).RotateZ(_pieces[i].Angle));
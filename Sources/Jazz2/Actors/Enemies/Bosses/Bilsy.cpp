@@ -99,7 +99,7 @@ namespace Jazz2::Actors::Bosses
 						SetTransition((AnimState)1073741826, false, [this]() {
 							PlaySfx("ThrowFireball"_s);
 
-							std::shared_ptr<Fireball> fireball = std::make_shared<Fireball>();
+							std::shared_ptr<Fireball> fireball = CreateActor<Fireball>();
 							uint8_t fireballParams[2] = { _theme, (uint8_t)(IsFacingLeft() ? 1 : 0) };
 							fireball->OnActivated(ActorActivationDetails(
 								_levelHandler,
@@ -271,7 +271,7 @@ namespace Jazz2::Actors::Bosses
 		light.RadiusFar = 30.0f;
 	}
 
-	bool Bilsy::Fireball::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Bilsy::Fireball::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			DecreaseHealth(INT32_MAX);
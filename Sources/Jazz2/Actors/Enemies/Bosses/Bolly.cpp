@@ -54,7 +54,7 @@ namespace Jazz2::Actors::Bosses
 		async_await RequestMetadataAsync("Boss/Bolly"_s);
 		SetAnimation(AnimState::Idle);
 
-		_bottom = std::make_shared<BollyPart>();
+		_bottom = CreateActor<BollyPart>();
 		uint8_t bottomParams[1] = { 1 };
 		_bottom->OnActivated(ActorActivationDetails(
 			_levelHandler,
@@ -63,7 +63,7 @@ namespace Jazz2::Actors::Bosses
 		));
 		_levelHandler->AddActor(_bottom);
 
-		/*_turret = std::make_shared<BollyPart>();
+		/*_turret = CreateActor<BollyPart>();
 		uint8_t turretParams[1] = { 2 };
 		_turret->OnActivated({
 			.LevelHandler = _levelHandler,
@@ -74,7 +74,7 @@ namespace Jazz2::Actors::Bosses
 
 		int32_t chainLength = (_levelHandler->Difficulty() < GameDifficulty::Hard ? NormalChainLength : HardChainLength);
 		for (int32_t i = 0; i < chainLength; i++) {
-			_chain[i] = std::make_shared<BollyPart>();
+			_chain[i] = CreateActor<BollyPart>();
 			uint8_t chainParams[1] = { (uint8_t)((i % 3) == 2 ? 3 : 4) };
 			_chain[i]->OnActivated(ActorActivationDetails(
 				_levelHandler,
@@ -273,7 +273,7 @@ namespace Jazz2::Actors::Bosses
 		if (found) {
 			Vector2f diff = (targetPos - _pos).Normalized();
 
-			std::shared_ptr<Rocket> rocket = std::make_shared<Rocket>();
+			std::shared_ptr<Rocket> rocket = CreateActor<Rocket>();
 			rocket->OnActivated(ActorActivationDetails(
 				_levelHandler,
 				Vector3i((std::int32_t)_pos.X + (IsFacingLeft() ? 10 : -10), (std::int32_t)_pos.Y + 10, _renderer.layer() - 4)
@@ -369,7 +369,7 @@ namespace Jazz2::Actors::Bosses
 		light.RadiusFar = 12.0f;
 	}
 
-	bool Bolly::Rocket::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Bolly::Rocket::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			DecreaseHealth(INT32_MAX);
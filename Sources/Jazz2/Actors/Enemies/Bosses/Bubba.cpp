@@ -81,7 +81,7 @@ namespace Jazz2::Actors::Bosses
 								float x = (IsFacingLeft() ? -16.0f : 16.0f);
 								float y = -5.0f;
 
-								std::shared_ptr<Fireball> fireball = std::make_shared<Fireball>();
+								std::shared_ptr<Fireball> fireball = CreateActor<Fireball>();
 								uint8_t fireballParams[1] = { (uint8_t)(IsFacingLeft() ? 1 : 0) };
 								fireball->OnActivated(ActorActivationDetails(
 									_levelHandler,
@@ -277,7 +277,7 @@ namespace Jazz2::Actors::Bosses
 		light.RadiusFar = 30.0f;
 	}
 
-	bool Bubba::Fireball::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Bubba::Fireball::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			DecreaseHealth(INT32_MAX);
@@ -31,7 +31,7 @@ namespace Jazz2::Actors::Bosses
 		class Fireball : public EnemyBase
 		{
 		public:
-			bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+			bool OnHandleCollision(ActorBase* other) override;
 
 		protected:
 			Task<bool> OnActivatedAsync(const ActorActivationDetails& details) override;
@@ -183,7 +183,7 @@ namespace Jazz2::Actors::Bosses
 				SetTransition((AnimState)673, false, [this]() {
 					PlaySfx("SpitFireball"_s);
 
-					std::shared_ptr<Fireball> fireball = std::make_shared<Fireball>();
+					std::shared_ptr<Fireball> fireball = CreateActor<Fireball>();
 					uint8_t fireballParams[1] = { (uint8_t)(IsFacingLeft() ? 1 : 0) };
 					fireball->OnActivated(ActorActivationDetails(
 						_levelHandler,
@@ -321,7 +321,7 @@ namespace Jazz2::Actors::Bosses
 		PlaySfx("Shoot"_s);
 
 		SetTransition((AnimState)16, false, [this]() {
-			std::shared_ptr<Bullet> bullet = std::make_shared<Bullet>();
+			std::shared_ptr<Bullet> bullet = CreateActor<Bullet>();
 			uint8_t fireballParams[1] = { (uint8_t)(IsFacingLeft() ? 1 : 0) };
 			bullet->OnActivated(ActorActivationDetails(
 				_levelHandler,
@@ -58,7 +58,7 @@ namespace Jazz2::Actors::Bosses
 		SetAnimation(AnimState::Idle);
 
 		// Invisible block above the queen
-		_block = std::make_shared<InvisibleBlock>();
+		_block = CreateActor<InvisibleBlock>();
 		_block->OnActivated(ActorActivationDetails(
 			_levelHandler,
 			Vector3i((std::int32_t)_pos.X, (std::int32_t)_pos.Y, _renderer.layer() + 1)
@@ -139,7 +139,7 @@ namespace Jazz2::Actors::Bosses
 							auto players = _levelHandler->GetPlayers();
 							auto* player = players[Random().Next(0, (std::uint32_t)players.size())];
 
-							std::shared_ptr<Brick> brick = std::make_shared<Brick>();
+							std::shared_ptr<Brick> brick = CreateActor<Brick>();
 							brick->OnActivated(ActorActivationDetails(
 								_levelHandler,
 								Vector3i((std::int32_t)(player->GetPos().X + Random().NextFloat(-50.0f, 50.0f)), (std::int32_t)(_pos.Y - 200.0f), _renderer.layer() - 20)
@@ -232,7 +232,7 @@ namespace Jazz2::Actors::Bosses
 		_stateTime -= timeMult;
 	}
 
-	bool Queen::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Queen::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* spring = runtime_cast<Environment::Spring*>(other)) {
 			// Collide only with hitbox
@@ -172,7 +172,7 @@ namespace Jazz2::Actors::Bosses
 			return;
 		}
 
-		std::shared_ptr<SpikeBall> spikeBall = std::make_shared<SpikeBall>();
+		std::shared_ptr<SpikeBall> spikeBall = CreateActor<SpikeBall>();
 		uint8_t spikeBallParams[1] = { (uint8_t)(IsFacingLeft() ? 1 : 0) };
 		spikeBall->OnActivated(ActorActivationDetails(
 			_levelHandler,
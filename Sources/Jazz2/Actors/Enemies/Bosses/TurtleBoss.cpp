@@ -83,7 +83,7 @@ namespace Jazz2::Actors::Bosses
 					_state = StateTransition;
 					SetAnimation(AnimState::Idle);
 					SetTransition((AnimState)1073741824, false, [this]() {
-						_mace = std::make_shared<Mace>();
+						_mace = CreateActor<Mace>();
 						_mace->OnActivated(ActorActivationDetails(
 							_levelHandler,
 							Vector3i((std::int32_t)_pos.X, (std::int32_t)_pos.Y, _renderer.layer() + 2)
@@ -121,7 +121,7 @@ namespace Jazz2::Actors::Bosses
 		_stateTime -= timeMult;
 	}
 
-	bool TurtleBoss::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool TurtleBoss::OnHandleCollision(ActorBase* other)
 	{
 		if (_state == StateAttacking && _stateTime <= 0.0f) {
 			if (auto* mace = runtime_cast<Mace*>(other)) {
@@ -153,7 +153,7 @@ namespace Jazz2::Actors::Bosses
 			shellSpeedY = -0.98f;
 		}
 
-		std::shared_ptr<Enemies::TurtleShell> shell = std::make_shared<Enemies::TurtleShell>();
+		std::shared_ptr<Enemies::TurtleShell> shell = CreateActor<Enemies::TurtleShell>();
 		uint8_t shellParams[9];
 		*(float*)&shellParams[0] = _speed.X * 1.1f;
 		*(float*)&shellParams[4] = shellSpeedY;
@@ -69,7 +69,7 @@ namespace Jazz2::Actors::Bosses
 		_hasShield = true;
 
 		for (int i = 0; i < static_cast<int>(arraySize(_shields)); i++) {
-			_shields[i] = std::make_shared<ShieldPart>();
+			_shields[i] = CreateActor<ShieldPart>();
 			_shields[i]->Phase = (fTwoPi * i / static_cast<int>(arraySize(_shields)));
 			_shields[i]->OnActivated(ActorActivationDetails(
 				_levelHandler,
@@ -104,7 +104,7 @@ namespace Jazz2::Actors::Bosses
 					float force = Random().NextFloat(-15.0f, 15.0f);
 
 					// TODO: Implement Crab spawn animation
-					std::shared_ptr<Enemies::Crab> crab = std::make_shared<Enemies::Crab>();
+					std::shared_ptr<Enemies::Crab> crab = CreateActor<Enemies::Crab>();
 					crab->OnActivated(ActorActivationDetails(
 						_levelHandler,
 						Vector3i((std::int32_t)_pos.X, (std::int32_t)_pos.Y, _renderer.layer() - 4)
@@ -255,7 +255,7 @@ namespace Jazz2::Actors::Bosses
 		UpdateHitbox(6, 6);
 	}
 
-	bool Uterus::ShieldPart::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Uterus::ShieldPart::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* shotBase = runtime_cast<Weapons::ShotBase*>(other)) {
 			DecreaseHealth(shotBase->GetStrength(), shotBase);
@@ -265,7 +265,7 @@ namespace Jazz2::Actors::Bosses
 			SetState(ActorState::CollideWithTileset | ActorState::CollideWithSolidObjects | ActorState::ApplyGravitation, true);
 
 			if (GetState(ActorState::CanBeFrozen)) {
-				HandleFrozenStateChange(other.get());
+				HandleFrozenStateChange(other);
 			}
 			return true;
 		}
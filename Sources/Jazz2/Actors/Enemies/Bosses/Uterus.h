@@ -38,7 +38,7 @@ namespace Jazz2::Actors::Bosses
 			float Phase;
 			float FallTime;
 
-			bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+			bool OnHandleCollision(ActorBase* other) override;
 
 			void Recover(float phase);
 
@@ -68,7 +68,7 @@ namespace Jazz2::Actors::Enemies
 
 					SetAnimation((AnimState)5);
 					SetTransition((AnimState)4, true, [this]() {
-						std::shared_ptr<Smoke> smoke = std::make_shared<Smoke>();
+						std::shared_ptr<Smoke> smoke = CreateActor<Smoke>();
 						smoke->OnActivated(ActorActivationDetails(
 							_levelHandler,
 							Vector3i((std::int32_t)_pos.X - 26, (std::int32_t)_pos.Y - 18, _renderer.layer() + 20)
@@ -89,7 +89,7 @@ namespace Jazz2::Actors::Enemies
 		}
 	}
 
-	bool Caterpillar::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Caterpillar::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* shotBase = runtime_cast<Weapons::ShotBase*>(other)) {
 			if (_state != StateDisoriented) {
@@ -149,7 +149,7 @@ namespace Jazz2::Actors::Enemies
 		}
 	}
 
-	bool Caterpillar::Smoke::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Caterpillar::Smoke::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			if (player->SetDizzyTime(180.0f)) {
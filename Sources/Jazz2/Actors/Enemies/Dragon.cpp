@@ -86,7 +86,7 @@ namespace Jazz2::Actors::Enemies
 						});
 					} else {
 						if (_attackTime <= 0.0f) {
-							std::shared_ptr<Fire> fire = std::make_shared<Fire>();
+							std::shared_ptr<Fire> fire = CreateActor<Fire>();
 							uint8_t fireParams[1];
 							fireParams[0] = (IsFacingLeft() ? 1 : 0);
 							fire->OnActivated(ActorActivationDetails(
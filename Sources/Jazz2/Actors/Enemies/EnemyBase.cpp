@@ -150,7 +150,7 @@ namespace Jazz2::Actors::Enemies
 		}
 	}
 
-	bool EnemyBase::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool EnemyBase::OnHandleCollision(ActorBase* other)
 	{
 		if (!GetState(ActorState::IsInvulnerable)) {
 			if (auto* shotBase = runtime_cast<Weapons::ShotBase*>(other)) {
@@ -248,9 +248,9 @@ namespace Jazz2::Actors::Enemies
 					debris.Time = 320.0f;
 
 					debris.TexScaleX = (currentSize / float(texSize.X));
-					debris.TexBiasX = (((float)(_renderer.CurrentFrame % res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.X) + ((float)fx / float(texSize.X)));
+					debris.TexBiasX = (float(res->Base->TextureOffset.X + (_renderer.CurrentFrame % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X + fx) / float(texSize.X));
 					debris.TexScaleY = (currentSize / float(texSize.Y));
-					debris.TexBiasY = (((float)(_renderer.CurrentFrame / res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.Y) + ((float)fy / float(texSize.Y)));
+					debris.TexBiasY = (float(res->Base->TextureOffset.Y + (_renderer.CurrentFrame / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y + fy) / float(texSize.Y));
 
 					debris.DiffuseTexture = texture;
 					debris.Flags = Tiles::TileMap::DebrisFlags::Bounce;
@@ -286,9 +286,9 @@ namespace Jazz2::Actors::Enemies
 					debris.Time = Random().FastFloat(10.0f, 50.0f);
 
 					debris.TexScaleX = (currentSize / float(texSize.X));
-					debris.TexBiasX = (((float)(_renderer.CurrentFrame % res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.X) + ((float)fx / float(texSize.X)));
+					debris.TexBiasX = (float(res->Base->TextureOffset.X + (_renderer.CurrentFrame % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X + fx) / float(texSize.X));
 					debris.TexScaleY = (currentSize / float(texSize.Y));
-					debris.TexBiasY = (((float)(_renderer.CurrentFrame / res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.Y) + ((float)fy / float(texSize.Y)));
+					debris.TexBiasY = (float(res->Base->TextureOffset.Y + (_renderer.CurrentFrame / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y + fy) / float(texSize.Y));
 
 					debris.DiffuseTexture = texture;
 					debris.Flags = Tiles::TileMap::DebrisFlags::Disappear;
@@ -323,9 +323,9 @@ namespace Jazz2::Actors::Enemies
 					debris.Time = Random().FastFloat(300.0f, 340.0f);;
 
 					debris.TexScaleX = (currentSize / float(texSize.X));
-					debris.TexBiasX = (((float)(_renderer.CurrentFrame % res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.X) + ((float)fx / float(texSize.X)));
+					debris.TexBiasX = (float(res->Base->TextureOffset.X + (_renderer.CurrentFrame % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X + fx) / float(texSize.X));
 					debris.TexScaleY = (currentSize / float(texSize.Y));
-					debris.TexBiasY = (((float)(_renderer.CurrentFrame / res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.Y) + ((float)fy / float(texSize.Y)));
+					debris.TexBiasY = (float(res->Base->TextureOffset.Y + (_renderer.CurrentFrame / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y + fy) / float(texSize.Y));
 
 					debris.DiffuseTexture = texture;
 					debris.Flags = Tiles::TileMap::DebrisFlags::Disappear;
@@ -13,7 +13,7 @@ namespace Jazz2::Actors::Enemies
 
 		bool CanCollideWithAmmo;
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		bool CanHurtPlayer()
 		{
@@ -58,7 +58,7 @@ namespace Jazz2::Actors::Enemies
 						SetTransition((AnimState)1073741824, false, [this]() {
 							PlaySfx("Spit"_s);
 
-							std::shared_ptr<BulletSpit> bulletSpit = std::make_shared<BulletSpit>();
+							std::shared_ptr<BulletSpit> bulletSpit = CreateActor<BulletSpit>();
 							uint8_t bulletSpitParams[1];
 							bulletSpitParams[0] = (IsFacingLeft() ? 1 : 0);
 							bulletSpit->OnActivated(ActorActivationDetails(
@@ -152,7 +152,7 @@ namespace Jazz2::Actors::Enemies
 		UpdateHitbox(8, 8);
 	}
 
-	bool MadderHatter::BulletSpit::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool MadderHatter::BulletSpit::OnHandleCollision(ActorBase* other)
 	{
 		return false;
 	}
@@ -27,7 +27,7 @@ namespace Jazz2::Actors::Enemies
 			DEATH_RUNTIME_OBJECT(EnemyBase);
 
 		public:
-			bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+			bool OnHandleCollision(ActorBase* other) override;
 
 		protected:
 			Task<bool> OnActivatedAsync(const ActorActivationDetails& details) override;
@@ -100,7 +100,7 @@ namespace Jazz2::Actors::Enemies
 							SetFacingLeft(targetPos.X < _pos.X);
 
 							SetTransition((AnimState)1073741826, false, [this]() {
-								std::shared_ptr<Banana> banana = std::make_shared<Banana>();
+								std::shared_ptr<Banana> banana = CreateActor<Banana>();
 								uint8_t bananaParams[1];
 								bananaParams[0] = (IsFacingLeft() ? 1 : 0);
 								banana->OnActivated(ActorActivationDetails(
@@ -124,7 +124,7 @@ namespace Jazz2::Actors::Enemies
 						SetFacingLeft(targetPos.X < _pos.X);
 
 						SetTransition((AnimState)1073741826, false, [this]() {
-							std::shared_ptr<Banana> banana = std::make_shared<Banana>();
+							std::shared_ptr<Banana> banana = CreateActor<Banana>();
 							uint8_t bananaParams[1];
 							bananaParams[0] = (IsFacingLeft() ? 1 : 0);
 							banana->OnActivated(ActorActivationDetails(
@@ -127,9 +127,9 @@ namespace Jazz2::Actors::Enemies
 					debris.Time = 280.0f;
 
 					debris.TexScaleX = (currentSize / float(texSize.X));
-					debris.TexBiasX = (((float)(_renderer.CurrentFrame % res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.X) + ((float)fx / float(texSize.X)));
+					debris.TexBiasX = (float(res->Base->TextureOffset.X + (_renderer.CurrentFrame % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X + fx) / float(texSize.X));
 					debris.TexScaleY = (currentSize / float(texSize.Y));
-					debris.TexBiasY = (((float)(_renderer.CurrentFrame / res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.Y) + ((float)fy / float(texSize.Y)));
+					debris.TexBiasY = (float(res->Base->TextureOffset.Y + (_renderer.CurrentFrame / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y + fy) / float(texSize.Y));
 
 					debris.DiffuseTexture = res->Base->TextureDiffuse.get();
 					debris.Flags = Tiles::TileMap::DebrisFlags::Disappear;
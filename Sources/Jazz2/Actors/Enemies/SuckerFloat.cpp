@@ -66,7 +66,7 @@ namespace Jazz2::Actors::Enemies
 
 			TryGenerateRandomDrop();
 		} else {
-			std::shared_ptr<Sucker> sucker = std::make_shared<Sucker>();
+			std::shared_ptr<Sucker> sucker = CreateActor<Sucker>();
 			uint8_t suckerParams[1] = { (uint8_t)_lastHitDir };
 			sucker->OnActivated(ActorActivationDetails(
 				_levelHandler,
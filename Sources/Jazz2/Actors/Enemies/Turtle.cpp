@@ -137,7 +137,7 @@ namespace Jazz2::Actors::Enemies
 				shellSpeedY = -0.98f;
 			}
 
-			std::shared_ptr<TurtleShell> shell = std::make_shared<TurtleShell>();
+			std::shared_ptr<TurtleShell> shell = CreateActor<TurtleShell>();
 			uint8_t shellParams[9];
 			*(float*)&shellParams[0] = _speed.X * 1.1f;
 			*(float*)&shellParams[4] = shellSpeedY;
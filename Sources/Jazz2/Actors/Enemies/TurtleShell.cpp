@@ -118,7 +118,7 @@ namespace Jazz2::Actors::Enemies
 		return EnemyBase::OnPerish(collider);
 	}
 
-	bool TurtleShell::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool TurtleShell::OnHandleCollision(ActorBase* other)
 	{
 		EnemyBase::OnHandleCollision(other);
 
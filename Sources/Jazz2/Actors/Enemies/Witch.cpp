@@ -78,7 +78,7 @@ namespace Jazz2::Actors::Enemies
 				SetTransition(AnimState::TransitionAttack, true, [this]() {
 					Vector2f bulletPos = Vector2f(_pos.X + (IsFacingLeft() ? -24.0f : 24.0f), _pos.Y);
 
-					std::shared_ptr<MagicBullet> magicBullet = std::make_shared<MagicBullet>(this);
+					std::shared_ptr<MagicBullet> magicBullet = CreateActor<MagicBullet>(this);
 					magicBullet->OnActivated(ActorActivationDetails(
 						_levelHandler,
 						Vector3i((std::int32_t)bulletPos.X, (std::int32_t)bulletPos.Y, _renderer.layer() + 1)
@@ -170,7 +170,7 @@ namespace Jazz2::Actors::Enemies
 		UpdateHitbox(10, 10);
 	}
 
-	bool Witch::MagicBullet::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Witch::MagicBullet::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			DecreaseHealth(INT32_MAX);
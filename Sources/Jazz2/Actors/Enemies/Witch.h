@@ -30,7 +30,7 @@ namespace Jazz2::Actors::Enemies
 		public:
 			MagicBullet(Witch* owner) : _owner(owner), _time(380.0f) { }
 
-			bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+			bool OnHandleCollision(ActorBase* other) override;
 
 		protected:
 			Task<bool> OnActivatedAsync(const ActorActivationDetails& details) override;
@@ -38,7 +38,7 @@ namespace Jazz2::Actors::Environment
 		}
 	}
 
-	bool AirboardGenerator::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool AirboardGenerator::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			if (_active && player->SetModifier(Player::Modifier::Airboard)) {
@@ -83,9 +83,9 @@ namespace Jazz2::Actors::Environment
 					debris.Time = 110.0f;
 
 					debris.TexScaleX = (size.X / float(texSize.X));
-					debris.TexBiasX = ((float)(frame % frameConf.X) / frameConf.X);
+					debris.TexBiasX = (float(res->Base->TextureOffset.X + (frame % frameConf.X) * size.X) / float(texSize.X));
 					debris.TexScaleY = (size.Y / float(texSize.Y));
-					debris.TexBiasY = ((float)(frame / frameConf.X) / frameConf.Y);
+					debris.TexBiasY = (float(res->Base->TextureOffset.Y + (frame / frameConf.X) * size.Y) / float(texSize.Y));
 
 					debris.DiffuseTexture = res->Base->TextureDiffuse.get();
 
@@ -53,7 +53,7 @@ namespace Jazz2::Actors::Environment
 		async_return true;
 	}
 
-	bool BirdCage::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool BirdCage::OnHandleCollision(ActorBase* other)
 	{
 		if (!_activated) {
 			if (auto* shotBase = runtime_cast<Weapons::ShotBase*>(other)) {
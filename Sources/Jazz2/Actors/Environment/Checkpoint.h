@@ -11,7 +11,7 @@ namespace Jazz2::Actors::Environment
 	public:
 		Checkpoint();
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		static void Preload(const ActorActivationDetails& details);
 
@@ -72,7 +72,7 @@ namespace Jazz2::Actors::Environment
 #endif
 	}
 
-	bool Copter::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Copter::OnHandleCollision(ActorBase* other)
 	{
 		if (_state == State::Free || _state == State::Unmounted) {
 			if (auto* player = runtime_cast<Player*>(other)) {
@@ -37,7 +37,7 @@ namespace Jazz2::Actors::Environment
 		}
 	}
 
-	bool Eva::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Eva::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			if (player->GetPlayerType() == PlayerType::Frog && player->DisableControllable(160.0f)) {
@@ -54,7 +54,7 @@ namespace Jazz2::Actors::Environment
 		}
 	}
 
-	bool Moth::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Moth::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			if (_timer <= 50.0f) {
@@ -127,7 +127,7 @@ namespace Jazz2::Actors::Environment
 		UpdateHitbox(50, 50);
 	}
 
-	bool RollingRock::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool RollingRock::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* rollingRock = runtime_cast<RollingRock*>(other)) {
 			float dx = (rollingRock->_pos.X - _pos.X);
@@ -20,7 +20,7 @@ namespace Jazz2::Actors::Environment
 		Task<bool> OnActivatedAsync(const ActorActivationDetails& details) override;
 		void OnUpdate(float timeMult) override;
 		void OnUpdateHitbox() override;
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 		void OnTriggeredEvent(EventType eventType, uint8_t* eventParams) override;
 
 	private:
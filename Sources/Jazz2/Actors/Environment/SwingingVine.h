@@ -12,7 +12,7 @@ namespace Jazz2::Actors::Environment
 		SwingingVine();
 		~SwingingVine();
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		static void Preload(const ActorActivationDetails& details)
 		{
@@ -12,7 +12,7 @@ namespace Jazz2::Actors
 
 	void Explosion::Create(ILevelHandler* levelHandler, const Vector3i& pos, Type type, float scale)
 	{
-		std::shared_ptr<Explosion> explosion = std::make_shared<Explosion>();
+		std::shared_ptr<Explosion> explosion = CreateActor<Explosion>();
 		std::uint8_t explosionParams[8];
 		*(std::uint16_t*)&explosionParams[0] = (uint16_t)type;
 		// 2-3: unused
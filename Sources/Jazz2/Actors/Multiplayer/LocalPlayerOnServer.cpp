@@ -70,7 +70,7 @@ namespace Jazz2::Actors::Multiplayer
 		_renderer.setPosition(_displayPos);
 	}
 
-	bool LocalPlayerOnServer::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool LocalPlayerOnServer::OnHandleCollision(ActorBase* other)
 	{
 		return PlayerOnServer::OnHandleCollision(other);
 	}
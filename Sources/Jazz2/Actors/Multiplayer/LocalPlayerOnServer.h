@@ -13,7 +13,7 @@ namespace Jazz2::Actors::Multiplayer
 	public:
 		LocalPlayerOnServer();
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		void SyncWithServer(const Vector2f& pos, const Vector2f& speed, bool isVisible, bool isFacingLeft, bool isActivelyPushing);
 
@@ -12,7 +12,7 @@ namespace Jazz2::Actors::Multiplayer
 	{
 	}
 
-	bool PlayerOnServer::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool PlayerOnServer::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* shotBase = runtime_cast<Weapons::ShotBase*>(other)) {
 			std::int32_t strength = shotBase->GetStrength();
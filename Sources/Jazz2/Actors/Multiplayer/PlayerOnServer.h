@@ -13,7 +13,7 @@ namespace Jazz2::Actors::Multiplayer
 	public:
 		PlayerOnServer();
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		std::uint8_t GetTeamId() const;
 		void SetTeamId(std::uint8_t value);
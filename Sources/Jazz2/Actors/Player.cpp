@@ -396,9 +396,9 @@ namespace Jazz2::Actors
 							debris.Time = 160.0f;
 
 							debris.TexScaleX = (size.X / float(texSize.X));
-							debris.TexBiasX = 0.0f;
+							debris.TexBiasX = (res->Base->TextureOffset.X / float(texSize.X));
 							debris.TexScaleY = (size.Y / float(texSize.Y));
-							debris.TexBiasY = 0.0f;
+							debris.TexBiasY = (res->Base->TextureOffset.Y / float(texSize.Y));
 
 							debris.DiffuseTexture = res->Base->TextureDiffuse.get();
 							debris.Flags = Tiles::TileMap::DebrisFlags::AdditiveBlending;
@@ -555,9 +555,9 @@ namespace Jazz2::Actors
 							debris.Time = 160.0f;
 
 							debris.TexScaleX = (size.X / float(texSize.X));
-							debris.TexBiasX = ((float)(frame % frameConf.X) / frameConf.X);
+							debris.TexBiasX = (float(res->Base->TextureOffset.X + (frame % frameConf.X) * size.X) / float(texSize.X));
 							debris.TexScaleY = (size.Y / float(texSize.Y));
-							debris.TexBiasY = ((float)(frame / frameConf.X) / frameConf.Y);
+							debris.TexBiasY = (float(res->Base->TextureOffset.Y + (frame / frameConf.X) * size.Y) / float(texSize.Y));
 
 							debris.DiffuseTexture = res->Base->TextureDiffuse.get();
 
@@ -1100,9 +1100,9 @@ namespace Jazz2::Actors
 				std::int32_t col = curAnimFrame % res->Base->FrameConfiguration.X;
 				std::int32_t row = curAnimFrame / res->Base->FrameConfiguration.X;
 				float texScaleX = (float(res->Base->FrameDimensions.X) / float(texSize.X));
-				float texBiasX = (float(res->Base->FrameDimensions.X * col) / float(texSize.X));
+				float texBiasX = (float(res->Base->TextureOffset.X + res->Base->FrameDimensions.X * col) / float(texSize.X));
 				float texScaleY = (float(res->Base->FrameDimensions.Y) / float(texSize.Y));
-				float texBiasY = (float(res->Base->FrameDimensions.Y * row) / float(texSize.Y));
+				float texBiasY = (float(res->Base->TextureOffset.Y + res->Base->FrameDimensions.Y * row) / float(texSize.Y));
 
 				float scaleY = std::max(_weaponFlareTime / 8.0f, 0.4f);
 				switch (_playerType) {
@@ -1259,9 +1259,9 @@ namespace Jazz2::Actors
 					std::int32_t col = curAnimFrame % res->Base->FrameConfiguration.X;
 					std::int32_t row = curAnimFrame / res->Base->FrameConfiguration.X;
 					float texScaleX = (float(res->Base->FrameDimensions.X) / float(texSize.X));
-					float texBiasX = (float(res->Base->FrameDimensions.X * col) / float(texSize.X));
+					float texBiasX = (float(res->Base->TextureOffset.X + res->Base->FrameDimensions.X * col) / float(texSize.X));
 					float texScaleY = (float(res->Base->FrameDimensions.Y) / float(texSize.Y));
-					float texBiasY = (float(res->Base->FrameDimensions.Y * row) / float(texSize.Y));
+					float texBiasY = (float(res->Base->TextureOffset.Y + res->Base->FrameDimensions.Y * row) / float(texSize.Y));
 
 					float shieldPosX = _pos.X - res->Base->FrameDimensions.X * shieldScale * 0.5f;
 					float shieldPosY = _pos.Y - res->Base->FrameDimensions.Y * shieldScale * 0.5f;
@@ -1437,7 +1437,7 @@ namespace Jazz2::Actors
 		}
 	}
 
-	bool Player::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Player::OnHandleCollision(ActorBase* other)
 	{
 		ZoneScoped;
 
@@ -2600,7 +2600,7 @@ namespace Jazz2::Actors
 				}
 
 				// Spawn corpse
-				std::shared_ptr<PlayerCorpse> corpse = std::make_shared<PlayerCorpse>();
+				std::shared_ptr<PlayerCorpse> corpse = CreateActor<PlayerCorpse>();
 				std::uint8_t playerParams[2] = { (std::uint8_t)_playerType, (std::uint8_t)(IsFacingLeft() ? 1 : 0) };
 				corpse->OnActivated(ActorActivationDetails(
 					_levelHandler,
@@ -2686,7 +2686,7 @@ namespace Jazz2::Actors
 		float angle;
 		GetFirePointAndAngle(initialPos, gunspotPos, angle);
 
-		std::shared_ptr<T> shot = std::make_shared<T>();
+		std::shared_ptr<T> shot = CreateActor<T>();
 		std::uint8_t shotParams[1] = { _weaponUpgrades[(std::int32_t)weaponType] };
 		shot->OnActivated(ActorActivationDetails(
 			_levelHandler,
@@ -2715,7 +2715,7 @@ namespace Jazz2::Actors
 		uint8_t shotParams[1] = { _weaponUpgrades[(std::int32_t)WeaponType::RF] };
 
 		if ((_weaponUpgrades[(std::int32_t)WeaponType::RF] & 0x1) != 0) {
-			std::shared_ptr<Weapons::RFShot> shot1 = std::make_shared<Weapons::RFShot>();
+			std::shared_ptr<Weapons::RFShot> shot1 = CreateActor<Weapons::RFShot>();
 			shot1->OnActivated(ActorActivationDetails(
 				_levelHandler,
 				initialPos,
@@ -2724,7 +2724,7 @@ namespace Jazz2::Actors
 			shot1->OnFire(shared_from_this(), gunspotPos, _speed, angle - 0.3f, IsFacingLeft());
 			_levelHandler->AddActor(shot1);
 
-			std::shared_ptr<Weapons::RFShot> shot2 = std::make_shared<Weapons::RFShot>();
+			std::shared_ptr<Weapons::RFShot> shot2 = CreateActor<Weapons::RFShot>();
 			shot2->OnActivated(ActorActivationDetails(
 				_levelHandler,
 				initialPos,
@@ -2733,7 +2733,7 @@ namespace Jazz2::Actors
 			shot2->OnFire(shared_from_this(), gunspotPos, _speed, angle, IsFacingLeft());
 			_levelHandler->AddActor(shot2);
 
-			std::shared_ptr<Weapons::RFShot> shot3 = std::make_shared<Weapons::RFShot>();
+			std::shared_ptr<Weapons::RFShot> shot3 = CreateActor<Weapons::RFShot>();
 			shot3->OnActivated(ActorActivationDetails(
 				_levelHandler,
 				initialPos,
@@ -2742,7 +2742,7 @@ namespace Jazz2::Actors
 			shot3->OnFire(shared_from_this(), gunspotPos, _speed, angle + 0.3f, IsFacingLeft());
 			_levelHandler->AddActor(shot3);
 		} else {
-			std::shared_ptr<Weapons::RFShot> shot1 = std::make_shared<Weapons::RFShot>();
+			std::shared_ptr<Weapons::RFShot> shot1 = CreateActor<Weapons::RFShot>();
 			shot1->OnActivated(ActorActivationDetails(
 				_levelHandler,
 				initialPos,
@@ -2751,7 +2751,7 @@ namespace Jazz2::Actors
 			shot1->OnFire(shared_from_this(), gunspotPos, _speed, angle - 0.22f, IsFacingLeft());
 			_levelHandler->AddActor(shot1);
 
-			std::shared_ptr<Weapons::RFShot> shot2 = std::make_shared<Weapons::RFShot>();
+			std::shared_ptr<Weapons::RFShot> shot2 = CreateActor<Weapons::RFShot>();
 			shot2->OnActivated(ActorActivationDetails(
 				_levelHandler,
 				initialPos,
@@ -2775,7 +2775,7 @@ namespace Jazz2::Actors
 
 		uint8_t shotParams[1] = { _weaponUpgrades[(std::int32_t)WeaponType::Pepper] };
 
-		std::shared_ptr<Weapons::PepperShot> shot1 = std::make_shared<Weapons::PepperShot>();
+		std::shared_ptr<Weapons::PepperShot> shot1 = CreateActor<Weapons::PepperShot>();
 		shot1->OnActivated(ActorActivationDetails(
 			_levelHandler,
 			initialPos,
@@ -2784,7 +2784,7 @@ namespace Jazz2::Actors
 		shot1->OnFire(shared_from_this(), gunspotPos, _speed, angle - Random().NextFloat(-0.2f, 0.2f), IsFacingLeft());
 		_levelHandler->AddActor(shot1);
 
-		std::shared_ptr<Weapons::PepperShot> shot2 = std::make_shared<Weapons::PepperShot>();
+		std::shared_ptr<Weapons::PepperShot> shot2 = CreateActor<Weapons::PepperShot>();
 		shot2->OnActivated(ActorActivationDetails(
 			_levelHandler,
 			initialPos,
@@ -2801,7 +2801,7 @@ namespace Jazz2::Actors
 
 	void Player::FireWeaponTNT()
 	{
-		std::shared_ptr<Weapons::TNT> tnt = std::make_shared<Weapons::TNT>();
+		std::shared_ptr<Weapons::TNT> tnt = CreateActor<Weapons::TNT>();
 		tnt->OnActivated(ActorActivationDetails(
 			_levelHandler,
 			Vector3i((std::int32_t)_pos.X, (std::int32_t)_pos.Y, _renderer.layer() - 2)
@@ -2823,7 +2823,7 @@ namespace Jazz2::Actors
 		float angle;
 		GetFirePointAndAngle(initialPos, gunspotPos, angle);
 
-		std::shared_ptr<Weapons::Thunderbolt> shot = std::make_shared<Weapons::Thunderbolt>();
+		std::shared_ptr<Weapons::Thunderbolt> shot = CreateActor<Weapons::Thunderbolt>();
 		uint8_t shotParams[1] = { _weaponUpgrades[(std::int32_t)WeaponType::Thunderbolt] };
 		shot->OnActivated(ActorActivationDetails(
 			_levelHandler,
@@ -3944,7 +3944,7 @@ namespace Jazz2::Actors
 			return false;
 		}
 
-		_spawnedBird = std::make_shared<Environment::Bird>();
+		_spawnedBird = CreateActor<Environment::Bird>();
 		std::uint8_t birdParams[2] = { type, (std::uint8_t)_playerIndex };
 		_spawnedBird->OnActivated(ActorActivationDetails(
 			_levelHandler,
@@ -34,7 +34,7 @@ namespace Jazz2::Actors::Solid
 		async_return true;
 	}
 
-	bool AmmoBarrel::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool AmmoBarrel::OnHandleCollision(ActorBase* other)
 	{
 		if (_health == 0) {
 			return GenericContainer::OnHandleCollision(other);
@@ -57,7 +57,7 @@ namespace Jazz2::Actors::Solid
 		async_return true;
 	}
 
-	bool AmmoCrate::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool AmmoCrate::OnHandleCollision(ActorBase* other)
 	{
 		if (_health == 0) {
 			return GenericContainer::OnHandleCollision(other);
@@ -196,9 +196,9 @@ namespace Jazz2::Actors::Solid
 				std::int32_t col = curAnimFrame % _currentAnimation->Base->FrameConfiguration.X;
 				std::int32_t row = curAnimFrame / _currentAnimation->Base->FrameConfiguration.X;
 				float texScaleX = (float(_currentAnimation->Base->FrameDimensions.X) / float(texSize.X));
-				float texBiasX = (float(_currentAnimation->Base->FrameDimensions.X * col) / float(texSize.X));
+				float texBiasX = (float(_currentAnimation->Base->TextureOffset.X + _currentAnimation->Base->FrameDimensions.X * col) / float(texSize.X));
 				float texScaleY = (float(_currentAnimation->Base->FrameDimensions.Y) / float(texSize.Y));
-				float texBiasY = (float(_currentAnimation->Base->FrameDimensions.Y * row) / float(texSize.Y));
+				float texBiasY = (float(_currentAnimation->Base->TextureOffset.Y + _currentAnimation->Base->FrameDimensions.Y * row) / float(texSize.Y));
 
 				auto* instanceBlock = command->material().uniformBlock(Material::InstanceBlockName);
 				instanceBlock->uniform(Material::TexRectUniformName)->setFloatValue(texScaleX, texBiasX, texScaleY, texBiasY);
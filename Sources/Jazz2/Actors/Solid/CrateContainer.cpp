@@ -33,7 +33,7 @@ namespace Jazz2::Actors::Solid
 		async_return true;
 	}
 
-	bool CrateContainer::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool CrateContainer::OnHandleCollision(ActorBase* other)
 	{
 		if (_health == 0) {
 			return GenericContainer::OnHandleCollision(other);
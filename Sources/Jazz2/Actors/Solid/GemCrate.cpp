@@ -37,7 +37,7 @@ namespace Jazz2::Actors::Solid
 		async_return true;
 	}
 
-	bool GemCrate::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool GemCrate::OnHandleCollision(ActorBase* other)
 	{
 		if (_health == 0) {
 			return GenericContainer::OnHandleCollision(other);
@@ -122,7 +122,7 @@ namespace Jazz2::Actors::Solid
 		}
 	}
 
-	bool Pole::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Pole::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* shotBase = runtime_cast<Weapons::ShotBase*>(other)) {
 			if (shotBase->GetStrength() > 0) {
@@ -18,7 +18,7 @@ namespace Jazz2::Actors::Solid
 
 		Pole();
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		FallDirection GetFallDirection() const {
 			return _fall;
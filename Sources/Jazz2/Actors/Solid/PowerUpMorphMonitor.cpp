@@ -64,7 +64,7 @@ namespace Jazz2::Actors::Solid
 		AABBInner.R -= 2.0f;
 	}
 
-	bool PowerUpMorphMonitor::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool PowerUpMorphMonitor::OnHandleCollision(ActorBase* other)
 	{
 		if (_health == 0) {
 			return SolidObjectBase::OnHandleCollision(other);
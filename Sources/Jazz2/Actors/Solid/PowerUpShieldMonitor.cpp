@@ -65,7 +65,7 @@ namespace Jazz2::Actors::Solid
 		AABBInner.R -= 2.0f;
 	}
 
-	bool PowerUpShieldMonitor::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool PowerUpShieldMonitor::OnHandleCollision(ActorBase* other)
 	{
 		if (_health == 0) {
 			return SolidObjectBase::OnHandleCollision(other);
@@ -77,7 +77,7 @@ namespace Jazz2::Actors::Solid
 		AABBInner.R -= 2.0f;
 	}
 
-	bool PowerUpWeaponMonitor::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool PowerUpWeaponMonitor::OnHandleCollision(ActorBase* other)
 	{
 		if (_health == 0) {
 			return SolidObjectBase::OnHandleCollision(other);
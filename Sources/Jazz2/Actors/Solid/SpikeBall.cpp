@@ -104,9 +104,9 @@ namespace Jazz2::Actors::Solid
 					int col = curAnimFrame % chainAnim->Base->FrameConfiguration.X;
 					int row = curAnimFrame / chainAnim->Base->FrameConfiguration.X;
 					float texScaleX = (float(chainAnim->Base->FrameDimensions.X) / float(texSize.X));
-					float texBiasX = (float(chainAnim->Base->FrameDimensions.X * col) / float(texSize.X));
+					float texBiasX = (float(chainAnim->Base->TextureOffset.X + chainAnim->Base->FrameDimensions.X * col) / float(texSize.X));
 					float texScaleY = (float(chainAnim->Base->FrameDimensions.Y) / float(texSize.Y));
-					float texBiasY = (float(chainAnim->Base->FrameDimensions.Y * row) / float(texSize.Y));
+					float texBiasY = (float(chainAnim->Base->TextureOffset.Y + chainAnim->Base->FrameDimensions.Y * row) / float(texSize.Y));
 
 					auto instanceBlock = command->material().uniformBlock(Material::InstanceBlockName);
 					instanceBlock->uniform(Material::TexRectUniformName)->setFloatValue(texScaleX, texBiasX, texScaleY, texBiasY);
@@ -111,9 +111,9 @@ namespace Jazz2::Actors::Weapons
 							int col = curAnimFrame % resBase->FrameConfiguration.X;
 							int row = curAnimFrame / resBase->FrameConfiguration.X;
 							debris.TexScaleX = (float(resBase->FrameDimensions.X) / float(texSize.X));
-							debris.TexBiasX = (float(resBase->FrameDimensions.X * col) / float(texSize.X));
+							debris.TexBiasX = (float(resBase->TextureOffset.X + resBase->FrameDimensions.X * col) / float(texSize.X));
 							debris.TexScaleY = (float(resBase->FrameDimensions.Y) / float(texSize.Y));
-							debris.TexBiasY = (float(resBase->FrameDimensions.Y * row) / float(texSize.Y));
+							debris.TexBiasY = (float(resBase->TextureOffset.Y + resBase->FrameDimensions.Y * row) / float(texSize.Y));
 
 							debris.DiffuseTexture = resBase->TextureDiffuse.get();
 
@@ -144,7 +144,7 @@ namespace Jazz2::Actors::Weapons
 		}
 	}
 
-	bool ElectroShot::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool ElectroShot::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* enemyBase = runtime_cast<Enemies::EnemyBase*>(other)) {
 			if (enemyBase->IsInvulnerable() || !enemyBase->CanCollideWithAmmo) {
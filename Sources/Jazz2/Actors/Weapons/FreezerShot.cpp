@@ -116,9 +116,9 @@ namespace Jazz2::Actors::Weapons
 				debris.Time = 300.0f;
 
 				debris.TexScaleX = (currentSize / float(texSize.X));
-				debris.TexBiasX = (((float)(_renderer.CurrentFrame % resBase->FrameConfiguration.X) / resBase->FrameConfiguration.X) + (((resBase->FrameDimensions.X * 0.5f) + dx) / float(texSize.X)));
+				debris.TexBiasX = ((resBase->TextureOffset.X + (_renderer.CurrentFrame % resBase->FrameConfiguration.X) * resBase->FrameDimensions.X + (resBase->FrameDimensions.X * 0.5f) + dx) / float(texSize.X));
 				debris.TexScaleY = (currentSize / float(texSize.Y));
-				debris.TexBiasY = (((float)(_renderer.CurrentFrame / resBase->FrameConfiguration.X) / resBase->FrameConfiguration.Y) + (((resBase->FrameDimensions.Y * 0.5f) + dy) / float(texSize.Y)));
+				debris.TexBiasY = ((resBase->TextureOffset.Y + (_renderer.CurrentFrame / resBase->FrameConfiguration.X) * resBase->FrameDimensions.Y + (resBase->FrameDimensions.Y * 0.5f) + dy) / float(texSize.Y));
 
 				debris.DiffuseTexture = resBase->TextureDiffuse.get();
 				debris.Flags = Tiles::TileMap::DebrisFlags::Disappear;
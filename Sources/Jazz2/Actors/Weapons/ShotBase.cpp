@@ -64,7 +64,7 @@ namespace Jazz2::Actors::Weapons
 		}
 	}
 
-	bool ShotBase::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool ShotBase::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* enemyBase = runtime_cast<Enemies::EnemyBase*>(other)) {
 			if (enemyBase->CanCollideWithAmmo) {
@@ -19,7 +19,7 @@ namespace Jazz2::Actors::Weapons
 	public:
 		ShotBase();
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		inline int GetStrength() {
 			return _strength;
@@ -99,7 +99,7 @@ namespace Jazz2::Actors::Weapons
 			PlaySfx("Explosion"_s);
 
 			_levelHandler->FindCollisionActorsByRadius(_pos.X, _pos.Y, 50.0f, [this](ActorBase* actor) {
-				actor->OnHandleCollision(shared_from_this());
+				actor->OnHandleCollision(this);
 				return true;
 			});
 
@@ -132,7 +132,7 @@ namespace Jazz2::Actors::Weapons
 		}
 	}
 
-	bool TNT::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool TNT::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* tnt = runtime_cast<TNT*>(other)) {
 			if (tnt->_isExploded && _timeLeft > 35.0f) {
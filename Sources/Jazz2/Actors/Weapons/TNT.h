@@ -11,7 +11,7 @@ namespace Jazz2::Actors::Weapons
 	public:
 		TNT();
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		Player* GetOwner();
 
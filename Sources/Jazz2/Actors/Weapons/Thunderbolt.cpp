@@ -143,7 +143,7 @@ namespace Jazz2::Actors::Weapons
 		DecreaseHealth(INT32_MAX);
 	}
 
-	bool Thunderbolt::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool Thunderbolt::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* enemyBase = runtime_cast<Enemies::EnemyBase*>(other)) {
 			if (enemyBase->CanCollideWithAmmo) {
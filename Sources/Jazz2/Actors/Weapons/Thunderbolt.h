@@ -13,7 +13,7 @@ namespace Jazz2::Actors::Weapons
 
 		void OnFire(const std::shared_ptr<ActorBase>& owner, Vector2f gunspotPos, Vector2f speed, float angle, bool isFacingLeft);
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 		WeaponType GetWeaponType() override {
 			return WeaponType::Thunderbolt;
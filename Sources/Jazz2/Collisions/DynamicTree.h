@@ -67,6 +67,14 @@ namespace Jazz2::Collisions
 		}
 	};
 
+	/// Ray-cast input data. The ray extends from P1 to P1 + MaxFraction * (P2 - P1).
+	struct RayCastInput
+	{
+		Vector2f P1;
+		Vector2f P2;
+		float MaxFraction;
+	};
+
 	/// A dynamic AABB tree broad-phase, inspired by Nathanael Presson's btDbvt.
 	/// A dynamic tree arranges data in a binary tree to accelerate
 	/// queries such as volume queries and ray casts. Leafs are proxies
@@ -118,8 +126,9 @@ namespace Jazz2::Collisions
 		/// number of proxies in the tree.
 		/// @param input the ray-cast input data. The ray extends from p1 to p1 + maxFraction * (p2 - p1).
 		/// @param callback a callback class that is called for each proxy that is hit by the ray.
-		//template <typename T>
-		//void RayCast(T* callback, const b2RayCastInput& input) const;
+		/// The callback returns the new max. fraction of the ray, 0 to terminate the ray-cast or -1 to ignore the proxy.
+		template<typename T>
+		void RayCast(T* callback, const RayCastInput& input) const;
 
 		/// Validate this tree. For testing.
 		void Validate() const;
@@ -223,63 +232,60 @@ namespace Jazz2::Collisions
 		}
 	}
 
-	/*template<typename T>
-	inline void DynamicTree::RayCast(T* callback, const b2RayCastInput& input) const
+	template<typename T>
+	inline void DynamicTree::RayCast(T* callback, const RayCastInput& input) const
 	{
-		b2Vec2 p1 = input.p1;
-		b2Vec2 p2 = input.p2;
-		b2Vec2 r = p2 - p1;
-		b2Assert(r.LengthSquared() > 0.0f);
+		Vector2f p1 = input.P1;
+		Vector2f p2 = input.P2;
+		Vector2f r = p2 - p1;
+		if (r.SqrLength() <= 0.0f) {
+			return;
+		}
 		r.Normalize();
 
 		// v is perpendicular to the segment.
-		b2Vec2 v = b2Cross(1.0f, r);
-		b2Vec2 abs_v = b2Abs(v);
+		Vector2f v = Vector2f(-r.Y, r.X);
+		Vector2f absV = Vector2f(std::abs(v.X), std::abs(v.Y));
 
 		// Separating axis for segment (Gino, p80).
 		// |dot(v, p1 - c)| > dot(|v|, h)
 
-		float maxFraction = input.maxFraction;
+		float maxFraction = input.MaxFraction;
 
 		// Build a bounding box for the segment.
-		b2AABB segmentAABB;
-		{
-			b2Vec2 t = p1 + maxFraction * (p2 - p1);
-			segmentAABB.lowerBound = b2Min(p1, t);
-			segmentAABB.upperBound = b2Max(p1, t);
-		}
+		AABBf segmentAABB = AABBf(p1, p1 + (p2 - p1) * maxFraction);
 
-		b2GrowableStack<int32, 256> stack;
-		stack.Push(m_root);
+		SmallVector<std::int32_t, 256> stack;
+		stack.push_back(_root);
 
-		while (stack.GetCount() > 0) {
-			int32 nodeId = stack.Pop();
-			if (nodeId == b2_nullNode) {
+		while (!stack.empty()) {
+			std::int32_t nodeId = stack.pop_back_val();
+			if (nodeId == NullNode) {
 				continue;
 			}
 
-			const TreeNode* node = m_nodes + nodeId;
+			const TreeNode* node = &_nodes[nodeId];
 
-			if (b2TestOverlap(node->aabb, segmentAABB) == false) {
+			if (!node->Aabb.Overlaps(segmentAABB)) {
 				continue;
 			}
 
 			// Separating axis for segment (Gino, p80).
 			// |dot(v, p1 - c)| > dot(|v|, h)
-			b2Vec2 c = node->aabb.GetCenter();
-			b2Vec2 h = node->aabb.GetExtents();
-			float separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+			Vector2f c = node->Aabb.GetCenter();
+			Vector2f h = node->Aabb.GetExtents();
+			float separation = std::abs(Vector2f::Dot(v, p1 - c)) - Vector2f::Dot(absV, h);
 			if (separation > 0.0f) {
 				continue;
 			}
 
 			if (node->IsLeaf()) {
-				b2RayCastInput subInput;
-				subInput.p1 = input.p1;
-				subInput.p2 = input.p2;
-				subInput.maxFraction = maxFraction;
+				RayCastInput subInput;
+				subInput.P1 = input.P1;
+				subInput.P2 = input.P2;
+				subInput.MaxFraction = maxFraction;
 
-				float value = callback->RayCastCallback(subInput, nodeId);
+				float value = callback->OnRayCastQuery(subInput, nodeId);
 
 				if (value == 0.0f) {
 					// The client has terminated the ray cast.
@@ -289,14 +295,12 @@ namespace Jazz2::Collisions
 				if (value > 0.0f) {
 					// Update segment bounding box.
 					maxFraction = value;
-					b2Vec2 t = p1 + maxFraction * (p2 - p1);
-					segmentAABB.lowerBound = b2Min(p1, t);
-					segmentAABB.upperBound = b2Max(p1, t);
+					segmentAABB = AABBf(p1, p1 + (p2 - p1) * maxFraction);
 				}
 			} else {
-				stack.Push(node->child1);
-				stack.Push(node->child2);
+				stack.push_back(node->Child1);
+				stack.push_back(node->Child2);
 			}
 		}
-	}*/
+	}
 }
\ No newline at end of file
@@ -84,8 +84,8 @@ namespace Jazz2::Collisions
 		/// number of proxies in the tree.
 		/// @param input the ray-cast input data. The ray extends from p1 to p1 + maxFraction * (p2 - p1).
 		/// @param callback a callback class that is called for each proxy that is hit by the ray.
-		//template <typename T>
-		//void RayCast(T* callback, const b2RayCastInput& input) const;
+		template <typename T>
+		void RayCast(T* callback, const RayCastInput& input) const;
 
 		/// Get the height of the embedded tree.
 		std::int32_t GetTreeHeight() const;
@@ -212,11 +212,11 @@ namespace Jazz2::Collisions
 		_tree.Query(callback, aabb);
 	}
 
-	/*template <typename T>
-	inline void DynamicTreeBroadPhase::RayCast(T* callback, const b2RayCastInput& input) const
+	template <typename T>
+	inline void DynamicTreeBroadPhase::RayCast(T* callback, const RayCastInput& input) const
 	{
 		_tree.RayCast(callback, input);
-	}*/
+	}
 
 	inline void DynamicTreeBroadPhase::ShiftOrigin(Vector2f newOrigin)
 	{
@@ -0,0 +1,159 @@
+﻿#include "ConversionManifest.h"
+#include "../ContentResolver.h"
+
+#include <IO/FileSystem.h>
+
+using namespace Death::IO;
+
+namespace Jazz2::Compatibility
+{
+	ConversionManifest::ConversionManifest()
+		: _converterVersion(0)
+	{
+	}
+
+	bool ConversionManifest::Load(const StringView path, std::uint32_t converterVersion)
+	{
+		_entries.clear();
+		_converterVersion = converterVersion;
+
+		auto s = fs::Open(path, FileAccess::Read);
+		if (s->GetSize() < 18) {
+			return false;
+		}
+
+		std::uint64_t signature = s->ReadValue<std::uint64_t>();
+		std::uint8_t fileType = s->ReadValue<std::uint8_t>();
+		std::uint8_t version = s->ReadValue<std::uint8_t>();
+		if (signature != 0x2095A59FF0BFBBEF || fileType != ContentResolver::CacheIndexFile || version != 1) {
+			return false;
+		}
+
+		if (s->ReadValue<std::uint32_t>() != converterVersion) {
+			LOGI("Converters were changed, all files will be converted again");
+			return false;
+		}
+
+		std::uint32_t entryCount = s->ReadValue<std::uint32_t>();
+		for (std::uint32_t i = 0; i < entryCount; i++) {
+			std::uint16_t nameLength = s->ReadValue<std::uint16_t>();
+			String sourceName(NoInit, nameLength);
+			s->Read(sourceName.data(), nameLength);
+
+			Entry entry;
+			entry.Hash = s->ReadValue<std::uint64_t>();
+
+			std::uint16_t outputCount = s->ReadValue<std::uint16_t>();
+			for (std::uint32_t j = 0; j < outputCount; j++) {
+				std::uint16_t length = s->ReadValue<std::uint16_t>();
+				String& output = entry.Outputs.emplace_back(NoInit, length);
+				s->Read(output.data(), length);
+			}
+
+			std::uint16_t dependencyCount = s->ReadValue<std::uint16_t>();
+			for (std::uint32_t j = 0; j < dependencyCount; j++) {
+				std::uint16_t length = s->ReadValue<std::uint16_t>();
+				String& dependency = entry.Dependencies.emplace_back(NoInit, length);
+				s->Read(dependency.data(), length);
+			}
+
+			if (s->GetPosition() > s->GetSize()) {
+				// File is truncated
+				_entries.clear();
+				return false;
+			}
+
+			_entries.emplace(std::move(sourceName), std::move(entry));
+		}
+
+		return true;
+	}
+
+	bool ConversionManifest::Save(const StringView path) const
+	{
+		auto so = fs::Open(path, FileAccess::Write);
+		if (!so->IsValid()) {
+			return false;
+		}
+
+		so->WriteValue<std::uint64_t>(0x2095A59FF0BFBBEF);	// Signature
+		so->WriteValue<std::uint8_t>(ContentResolver::CacheIndexFile);
+		so->WriteValue<std::uint8_t>(1);					// Version
+		so->WriteValue<std::uint32_t>(_converterVersion);
+		so->WriteValue<std::uint32_t>((std::uint32_t)_entries.size());
+
+		for (auto& [sourceName, entry] : _entries) {
+			so->WriteValue<std::uint16_t>((std::uint16_t)sourceName.size());
+			so->Write(sourceName.data(), (std::int32_t)sourceName.size());
+			so->WriteValue<std::uint64_t>(entry.Hash);
+
+			so->WriteValue<std::uint16_t>((std::uint16_t)entry.Outputs.size());
+			for (auto& output : entry.Outputs) {
+				so->WriteValue<std::uint16_t>((std::uint16_t)output.size());
+				so->Write(output.data(), (std::int32_t)output.size());
+			}
+
+			so->WriteValue<std::uint16_t>((std::uint16_t)entry.Dependencies.size());
+			for (auto& dependency : entry.Dependencies) {
+				so->WriteValue<std::uint16_t>((std::uint16_t)dependency.size());
+				so->Write(dependency.data(), (std::int32_t)dependency.size());
+			}
+		}
+
+		return true;
+	}
+
+	const ConversionManifest::Entry* ConversionManifest::Find(const StringView sourceName, std::uint64_t hash) const
+	{
+		auto it = _entries.find(String::nullTerminatedView(sourceName));
+		return (it != _entries.end() && it->second.Hash == hash ? &it->second : nullptr);
+	}
+
+	void ConversionManifest::Set(const StringView sourceName, Entry&& entry)
+	{
+		_entries[String(sourceName)] = std::move(entry);
+	}
+
+	SmallVector<String, 0> ConversionManifest::GetStaleOutputs(const ConversionManifest& current) const
+	{
+		HashMap<String, bool> currentOutputs;
+		for (auto& [sourceName, entry] : current._entries) {
+			for (auto& output : entry.Outputs) {
+				currentOutputs.emplace(output, true);
+			}
+		}
+
+		SmallVector<String, 0> staleOutputs;
+		for (auto& [sourceName, entry] : _entries) {
+			for (auto& output : entry.Outputs) {
+				if (currentOutputs.find(output) == currentOutputs.end()) {
+					staleOutputs.push_back(output);
+				}
+			}
+		}
+		return staleOutputs;
+	}
+
+	std::uint64_t ConversionManifest::HashFile(const StringView path, std::uint64_t hash)
+	{
+		auto s = fs::Open(path, FileAccess::Read);
+		if (!s->IsValid()) {
+			return hash;
+		}
+
+		// FNV-1a, file size is included too, so empty files still change the hash
+		std::int64_t size = s->GetSize();
+		for (std::int32_t i = 0; i < 8; i++) {
+			hash = (hash ^ (std::uint8_t)(size >> (i * 8))) * 0x100000001B3ULL;
+		}
+
+		std::uint8_t buffer[16384];
+		std::int32_t bytesRead;
+		while ((bytesRead = s->Read(buffer, sizeof(buffer))) > 0) {
+			for (std::int32_t i = 0; i < bytesRead; i++) {
+				hash = (hash ^ buffer[i]) * 0x100000001B3ULL;
+			}
+		}
+		return hash;
+	}
+}
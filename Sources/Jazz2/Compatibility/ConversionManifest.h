@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include "../../Common.h"
+#include "../../nCine/Base/HashMap.h"
+
+#include <Containers/SmallVector.h>
+#include <Containers/String.h>
+#include <Containers/StringView.h>
+
+using namespace Death::Containers;
+using namespace nCine;
+
+namespace Jazz2::Compatibility
+{
+	class ConversionManifest
+	{
+	public:
+		struct Entry {
+			// Hash of content of the source file and all files it depends on
+			std::uint64_t Hash;
+			// Converted files relative to the cache directory
+			SmallVector<String, 1> Outputs;
+			// Additional files required by converted files (e.g., tilesets used by level)
+			SmallVector<String, 0> Dependencies;
+		};
+
+		static constexpr std::uint64_t InitialHash = 0xCBF29CE484222325ULL;
+
+		ConversionManifest();
+
+		// Loads the manifest, it fails if it was created by different version of converters
+		bool Load(const StringView path, std::uint32_t converterVersion);
+		bool Save(const StringView path) const;
+
+		// Returns the entry if the source file was already converted from the same content
+		const Entry* Find(const StringView sourceName, std::uint64_t hash) const;
+		void Set(const StringView sourceName, Entry&& entry);
+
+		// Returns outputs of all entries that are not present in the specified manifest anymore
+		SmallVector<String, 0> GetStaleOutputs(const ConversionManifest& current) const;
+
+		std::uint32_t GetConverterVersion() const {
+			return _converterVersion;
+		}
+		void SetConverterVersion(std::uint32_t value) {
+			_converterVersion = value;
+		}
+
+		// Hashes content of the file, the hash can be chained with previous hash to include multiple files, returns `hash` unchanged if the file doesn't exist
+		static std::uint64_t HashFile(const StringView path, std::uint64_t hash = InitialHash);
+
+	private:
+		HashMap<String, Entry> _entries;
+		std::uint32_t _converterVersion;
+	};
+}
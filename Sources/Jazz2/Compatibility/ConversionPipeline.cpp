@@ -0,0 +1,91 @@
+﻿#include "ConversionPipeline.h"
+
+#if defined(WITH_THREADS)
+#	include "../../nCine/Threading/Thread.h"
+
+#	include <memory>
+
+#	include <Containers/SmallVector.h>
+#endif
+
+using namespace nCine;
+
+namespace Jazz2::Compatibility
+{
+#if defined(WITH_THREADS)
+	namespace
+	{
+		struct PipelineState
+		{
+			FunctionRef<void(std::int32_t)>* Process;
+			std::int32_t Count;
+			Atomic32 NextItem;
+			std::unique_ptr<Atomic32[]> Processed;
+		};
+
+		bool TryProcessNextItem(PipelineState& state)
+		{
+			std::int32_t i = state.NextItem.fetchAdd(1);
+			if (i >= state.Count) {
+				return false;
+			}
+
+			(*state.Process)(i);
+			state.Processed[i].store(1, Atomic32::MemoryModel::RELEASE);
+			return true;
+		}
+	}
+#endif
+
+	void ConversionPipeline::Run(std::int32_t count, FunctionRef<void(std::int32_t)> process, FunctionRef<void(std::int32_t)> commit)
+	{
+		if (count <= 0) {
+			return;
+		}
+
+#if defined(WITH_THREADS)
+		std::uint32_t threadCount = std::min(std::min(Thread::GetProcessorCount(), MaxThreads), (std::uint32_t)count);
+		if (threadCount > 1) {
+			PipelineState state;
+			state.Process = &process;
+			state.Count = count;
+			state.Processed = std::make_unique<Atomic32[]>(count);
+
+			// The calling thread is used too, so one thread less is needed
+			SmallVector<Thread, 0> threads;
+			threads.reserve(threadCount - 1);
+			for (std::uint32_t i = 1; i < threadCount; i++) {
+				threads.emplace_back([](void* arg) {
+					Thread::SetCurrentName("Content conversion");
+
+					auto& state = *static_cast<PipelineState*>(arg);
+					while (TryProcessNextItem(state)) {
+						// Process items until there is nothing left
+					}
+				}, &state);
+			}
+
+			// Commit processed items in the original order and help with processing while waiting
+			std::int32_t nextCommit = 0;
+			while (nextCommit < count) {
+				if (state.Processed[nextCommit].load(Atomic32::MemoryModel::ACQUIRE) != 0) {
+					commit(nextCommit);
+					nextCommit++;
+				} else if (!TryProcessNextItem(state)) {
+					Thread::YieldExecution();
+				}
+			}
+
+			for (auto& thread : threads) {
+				thread.Join();
+			}
+			return;
+		}
+#endif
+
+		for (std::int32_t i = 0; i < count; i++) {
+			process(i);
+			commit(i);
+		}
+	}
+}
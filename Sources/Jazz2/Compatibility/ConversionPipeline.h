@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include "../../Common.h"
+
+#include <Containers/FunctionRef.h>
+
+using namespace Death::Containers;
+
+namespace Jazz2::Compatibility
+{
+	class ConversionPipeline
+	{
+	public:
+		// Max. number of threads used for conversion, more threads wouldn't help much, because it's limited by I/O too
+		static constexpr std::uint32_t MaxThreads = 8;
+
+		ConversionPipeline() = delete;
+
+		// Calls `process` for all items in parallel, `commit` is called on the calling thread in the original order as soon as the item is processed
+		static void Run(std::int32_t count, FunctionRef<void(std::int32_t)> process, FunctionRef<void(std::int32_t)> commit);
+	};
+}
@@ -2,6 +2,7 @@
 #include "JJ2Anims.Palettes.h"
 #include "JJ2Block.h"
 #include "AnimSetMapping.h"
+#include "ConversionPipeline.h"
 
 #include <Containers/StringConcatenable.h>
 #include <IO/FileSystem.h>
@@ -301,14 +302,19 @@ namespace Jazz2::Compatibility
 
 		AnimSetMapping animMapping = AnimSetMapping::GetAnimMapping(version);
 
-		for (auto& anim : anims) {
+		// Animations are converted in parallel, but they are added to the .pak file in the original order
+		SmallVector<std::unique_ptr<MemoryStream>, 0> convertedAnims(anims.size());
+		SmallVector<String, 0> filenames(anims.size());
+
+		ConversionPipeline::Run((std::int32_t)anims.size(), [&](std::int32_t i) {
+			auto& anim = anims[i];
 			if (anim.FrameCount == 0) {
-				continue;
+				return;
 			}
 
 			AnimSetMapping::Entry* entry = animMapping.Get(anim.Set, anim.Anim);
 			if (entry == nullptr || entry->Category == AnimSetMapping::Discard) {
-				continue;
+				return;
 			}
 
 			std::int32_t sizeX = (anim.AdjustedSizeX + AddBorder * 2);
@@ -356,12 +362,9 @@ namespace Jazz2::Compatibility
 				LOGI("Applying \"Player Flare\" image fix to %i:%u", anim.Set, anim.Anim);
 			}
 
-			String filename;
 			if (entry->Name.empty()) {
 				ASSERT(!entry->Name.empty());
-				continue;
-			} else {
-				filename = fs::CombinePath({ "Animations"_s, entry->Category, String(entry->Name + ".aura"_s) });
+				return;
 			}
 
 			std::int32_t stride = sizeX * anim.FrameConfigurationX;
@@ -440,11 +443,11 @@ namespace Jazz2::Compatibility
 			}
 
 			// TODO: Use single channel instead
-			MemoryStream so(16384);
-			WriteImageToStream(so, pixels.get(), sizeX, sizeY, 4, anim, entry);
-			so.Seek(0, SeekOrigin::Begin);
-			bool success = pakWriter.AddFile(so, filename);
-			ASSERT_MSG(success, "Cannot add file to .pak container");
+			auto so = std::make_unique<MemoryStream>(16384);
+			WriteImageToStream(*so, pixels.get(), sizeX, sizeY, 4, anim, entry);
+			so->Seek(0, SeekOrigin::Begin);
+			convertedAnims[i] = std::move(so);
+			filenames[i] = fs::CombinePath({ "Animations"_s, entry->Category, String(entry->Name + ".aura"_s) });
 
 			/*if (!string.IsNullOrEmpty(data.Name) && !data.SkipNormalMap) {
 				PngWriter normalMap = NormalMapGenerator.FromSprite(img,
@@ -453,7 +456,13 @@ namespace Jazz2::Compatibility
 
 				normalMap.Save(filename.Replace(".png", ".n.png"));
 			}*/
-		}
+		}, [&](std::int32_t i) {
+			if (convertedAnims[i] != nullptr) {
+				bool success = pakWriter.AddFile(*convertedAnims[i], filenames[i]);
+				ASSERT_MSG(success, "Cannot add file to .pak container");
+				convertedAnims[i] = nullptr;
+			}
+		});
 	}
 
 	void JJ2Anims::ImportAudioSamples(PakWriter& pakWriter, JJ2Version version, SmallVectorImpl<SampleSection>& samples)
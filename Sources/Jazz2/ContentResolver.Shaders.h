@@ -2,7 +2,7 @@
 
 namespace Jazz2::Shaders
 {
-	constexpr std::uint64_t Version = 4;
+	constexpr std::uint64_t Version = 6;
 
 	constexpr char LightingVs[] = "#line " DEATH_LINE_STRING "\n" R"(
 uniform mat4 uProjectionMatrix;
@@ -649,6 +649,46 @@ void main() {
 	fragColor = mix(texColor, horizonColorWithStars, horizonOpacity);
 	fragColor.a = 1.0;
 }
+)";
+
+	constexpr char TileMapChunkVs[] = "#line " DEATH_LINE_STRING "\n" R"(
+uniform mat4 uProjectionMatrix;
+uniform mat4 uViewMatrix;
+
+layout (std140) uniform InstanceBlock
+{
+	mat4 modelMatrix;
+	vec4 color;
+};
+
+in vec2 aPosition;
+in vec2 aTexCoords;
+in vec4 aColor;
+
+out vec2 vTexCoords;
+out vec4 vColor;
+
+void main() {
+	gl_Position = uProjectionMatrix * uViewMatrix * modelMatrix * vec4(aPosition, 0.0, 1.0);
+	vTexCoords = aTexCoords;
+	vColor = color * aColor;
+}
+)";
+
+	constexpr char TileMapChunkFs[] = "#line " DEATH_LINE_STRING "\n" R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+uniform sampler2D uTexture;
+
+in vec2 vTexCoords;
+in vec4 vColor;
+out vec4 fragColor;
+
+void main() {
+	fragColor = texture(uTexture, vTexCoords) * vColor;
+}
 )";
 
 	constexpr char ColorizedFs[] = "#line " DEATH_LINE_STRING "\n" R"(
@@ -669,6 +709,26 @@ void main() {
 	vec4 gray = vec4(average, average, average, original.a);
 	fragColor = gray * dye;
 }
+)";
+
+	constexpr char PaletteFs[] = "#line " DEATH_LINE_STRING "\n" R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+uniform sampler2D uTexture; // Palette index in red channel, alpha in green channel
+uniform sampler2D uPalette; // All palettes, 256 colors per row
+
+in vec2 vTexCoords;
+in highp vec4 vColor; // Red channel contains palette offset, green channel contains brightness
+out vec4 fragColor;
+
+void main() {
+	vec4 tex = texture(uTexture, vTexCoords);
+	highp int index = int(vColor.r + 0.5) + int(tex.r * 255.0 + 0.5);
+	vec4 color = texelFetch(uPalette, ivec2(index & 255, index >> 8), 0);
+	fragColor = vec4(color.rgb * vColor.g, color.a * tex.g * vColor.a);
+}
 )";
 
 	constexpr char TintedFs[] = "#line " DEATH_LINE_STRING "\n" R"(
@@ -14,6 +14,12 @@
 #include "../nCine/Graphics/ITextureLoader.h"
 #include "../nCine/Graphics/RenderResources.h"
 #include "../nCine/Base/Random.h"
+#include "../nCine/Base/TimeStamp.h"
+
+#if defined(WITH_AUDIO)
+#	include "../nCine/Audio/IAudioLoader.h"
+#	include "../nCine/Audio/IAudioReader.h"
+#endif
 
 #if defined(DEATH_TARGET_ANDROID)
 #	include "../nCine/Backends/Android/AndroidApplication.h"
@@ -61,6 +67,9 @@ namespace Jazz2
 		: _isHeadless(false), _isLoading(false), _cachedMetadata(64), _cachedGraphics(256),
 #if defined(WITH_AUDIO)
 			_cachedSounds(192),
+#endif
+#if defined(WITH_THREADS)
+			_pendingGeneration(0), _pendingRunningCount(0),
 #endif
 			_palettes {}
 	{
@@ -73,8 +82,11 @@ namespace Jazz2
 
 	void ContentResolver::Release()
 	{
+		CancelPendingLoads();
+
 		_cachedMetadata.clear();
 		_cachedGraphics.clear();
+		_spriteAtlas.Clear();
 #if defined(WITH_AUDIO)
 		_cachedSounds.clear();
 #endif
@@ -86,6 +98,8 @@ namespace Jazz2
 		for (std::int32_t i = 0; i < (std::int32_t)PrecompiledShader::Count; i++) {
 			_precompiledShaders[i] = nullptr;
 		}
+
+		_paletteTexture = nullptr;
 	}
 
 	StringView ContentResolver::GetContentPath() const
@@ -400,6 +414,7 @@ namespace Jazz2
 			auto it = _cachedGraphics.begin();
 			while (it != _cachedGraphics.end()) {
 				if ((it->second->Flags & GenericGraphicResourceFlags::Referenced) != GenericGraphicResourceFlags::Referenced) {
+					_spriteAtlas.Remove(it->second.get());
 					it = _cachedGraphics.erase(it);
 #if defined(DEATH_DEBUG)
 					animationsReleased++;
@@ -441,10 +456,103 @@ namespace Jazz2
 		_isLoading = false;
 	}
 
+#if defined(WITH_THREADS)
+	class ContentResolver::LoadMetadataCommand : public IThreadCommand
+	{
+	public:
+		LoadMetadataCommand(ContentResolver* owner, std::shared_ptr<PendingMetadata> pending)
+			: _owner(owner), _pending(std::move(pending))
+		{
+		}
+
+		void Execute() override
+		{
+			_owner->ExecutePendingMetadata(*_pending);
+		}
+
+	private:
+		ContentResolver* _owner;
+		std::shared_ptr<PendingMetadata> _pending;
+	};
+#endif
+
+	ContentResolver::LoadedGraphics::LoadedGraphics(const StringView path, std::uint16_t paletteOffset)
+		: Path(path), PaletteOffset(paletteOffset), Width(0), Height(0), LinearSampling(false), Standalone(false), Indexed(false), Base(nullptr)
+	{
+	}
+
 	void ContentResolver::PreloadMetadataAsync(const StringView path)
 	{
-		// TODO: Reimplement async preloading
+#if defined(WITH_THREADS)
+		if (!theApplication().GetAppConfiguration().withThreads) {
+			RequestMetadata(path);
+			return;
+		}
+
+		String pathNormalized = fs::ToNativeSeparators(path);
+		auto it = _cachedMetadata.find(pathNormalized);
+		if (it != _cachedMetadata.end()) {
+			// Already loaded - Mark as referenced
+			RequestMetadata(pathNormalized);
+			return;
+		}
+
+		if (_pendingMetadata.find(pathNormalized) != _pendingMetadata.end()) {
+			// Already queued
+			return;
+		}
+
+		auto pending = std::make_shared<PendingMetadata>();
+		pending->Loaded.Path = pathNormalized;
+		pending->State = PendingLoadState::Queued;
+		pending->IsValid = false;
+
+		_pendingMutex.Lock();
+		pending->Generation = _pendingGeneration;
+		_pendingMutex.Unlock();
+
+		_pendingMetadata.emplace(std::move(pathNormalized), pending);
+		theServiceLocator().GetThreadPool().EnqueueCommand(std::make_unique<LoadMetadataCommand>(this, std::move(pending)));
+#else
 		RequestMetadata(path);
+#endif
+	}
+
+	void ContentResolver::ProcessPendingLoads(float timeBudget)
+	{
+#if defined(WITH_THREADS)
+		if (_pendingMetadata.empty()) {
+			return;
+		}
+
+		ZoneScopedC(0x888888);
+
+		TimeStamp startTime = TimeStamp::now();
+
+		auto it = _pendingMetadata.begin();
+		while (it != _pendingMetadata.end()) {
+			_pendingMutex.Lock();
+			bool isDone = (it->second->State == PendingLoadState::Done);
+			_pendingMutex.Unlock();
+
+			if (!isDone) {
+				++it;
+				continue;
+			}
+
+			// Only texture and audio buffer uploads are left, everything else was done by a worker thread
+			std::shared_ptr<PendingMetadata> pending = std::move(it->second);
+			it = _pendingMetadata.erase(it);
+			if (pending->IsValid && _cachedMetadata.find(pending->Loaded.Path) == _cachedMetadata.end()) {
+				FinalizeMetadata(pending->Loaded);
+			}
+
+			if (startTime.millisecondsSince() >= timeBudget) {
+				// Continue in the next frame
+				break;
+			}
+		}
+#endif
 	}
 
 	Metadata* ContentResolver::RequestMetadata(const StringView path)
@@ -470,34 +578,58 @@ namespace Jazz2
 			return it->second.get();
 		}
 
+#if defined(WITH_THREADS)
+		auto pendingIt = _pendingMetadata.find(pathNormalized);
+		if (pendingIt != _pendingMetadata.end()) {
+			// Preloading was already requested, so finish it now
+			std::shared_ptr<PendingMetadata> pending = std::move(pendingIt->second);
+			_pendingMetadata.erase(pendingIt);
+
+			if (TryAcquirePendingMetadata(*pending)) {
+				return (pending->IsValid ? FinalizeMetadata(pending->Loaded) : nullptr);
+			}
+		}
+#endif
+
 		// Try to load it
-		auto s = fs::Open(fs::CombinePath({ GetContentPath(), "Metadata"_s, String(pathNormalized + ".res"_s) }), FileAccess::Read);
+		LoadedMetadata loaded;
+		loaded.Path = std::move(pathNormalized);
+		if (!LoadMetadata(loaded)) {
+			return nullptr;
+		}
+
+		return FinalizeMetadata(loaded);
+	}
+
+	bool ContentResolver::LoadMetadata(LoadedMetadata& loaded)
+	{
+		// This function can be called from worker threads, so it must not access any cached resources
+		auto s = fs::Open(fs::CombinePath({ GetContentPath(), "Metadata"_s, String(loaded.Path + ".res"_s) }), FileAccess::Read);
 		auto fileSize = s->GetSize();
 		if (fileSize < 4 || fileSize > 64 * 1024 * 1024) {
 			// 64 MB file size limit
-			return nullptr;
+			return false;
 		}
 
 		auto buffer = std::make_unique<char[]>(fileSize + simdjson::SIMDJSON_PADDING);
 		s->Read(buffer.get(), fileSize);
+		s->Dispose();
 		buffer[fileSize] = '\0';
 
 		bool multipleAnimsNoStatesWarning = false;
 
-		std::unique_ptr<Metadata> metadata = std::make_unique<Metadata>();
-		metadata->Path = std::move(pathNormalized);
-		metadata->Flags |= MetadataFlags::Referenced;
+		loaded.BoundingBox = Vector2i(InvalidValue, InvalidValue);
 
 		ondemand::parser parser;
 		ondemand::document doc;
 		if (parser.iterate(buffer.get(), fileSize, fileSize + simdjson::SIMDJSON_PADDING).get(doc) == SUCCESS) {
-			metadata->BoundingBox = GetVector2iFromJson(doc["BoundingBox"], Vector2i(InvalidValue, InvalidValue));
+			loaded.BoundingBox = GetVector2iFromJson(doc["BoundingBox"], Vector2i(InvalidValue, InvalidValue));
 
 			ondemand::object animations;
 			if (doc["Animations"].get(animations) == SUCCESS) {
 				std::size_t count;
 				if (animations.count_fields().get(count) == SUCCESS) {
-					metadata->Animations.reserve(count);
+					loaded.Animations.reserve(count);
 				}
 
 				for (auto it : animations) {
@@ -508,58 +640,69 @@ namespace Jazz2
 						continue;
 					}
 
-					GraphicResource graphics;
-					graphics.LoopMode = AnimationLoopMode::Loop;
+					LoadedAnimation anim;
+					anim.LoopMode = AnimationLoopMode::Loop;
 
 					//bool keepIndexed = false;
+					bool standalone = false;
 
 					std::uint64_t flags;
 					if (value["Flags"].get(flags) == SUCCESS) {
 						if ((flags & 0x01) == 0x01) {
-							graphics.LoopMode = AnimationLoopMode::Once;
+							anim.LoopMode = AnimationLoopMode::Once;
 						}
 						//if ((flags & 0x02) == 0x02) {
 						//	keepIndexed = true;
 						//}
+						// Texture is sampled outside of frames (e.g., wrapping), so it cannot be packed into sprite atlas
+						if ((flags & 0x04) == 0x04) {
+							standalone = true;
+						}
 					}
 
-					// TODO: Implement true indexed sprites
 					std::uint64_t paletteOffset;
 					if (value["PaletteOffset"].get(paletteOffset) != SUCCESS) {
 						paletteOffset = 0;
 					}
 
-					graphics.Base = RequestGraphics(assetPath, (uint16_t)paletteOffset);
-					if (graphics.Base == nullptr) {
-						continue;
+					// The same graphics can be shared by more animations
+					String assetPathNormalized = fs::ToNativeSeparators(assetPath);
+					anim.GraphicsIndex = -1;
+					for (std::int32_t i = 0; i < (std::int32_t)loaded.Graphics.size(); i++) {
+						if (loaded.Graphics[i].PaletteOffset == (std::uint16_t)paletteOffset && loaded.Graphics[i].Path == assetPathNormalized) {
+							anim.GraphicsIndex = i;
+							break;
+						}
+					}
+					if (anim.GraphicsIndex < 0) {
+						anim.GraphicsIndex = (std::int32_t)loaded.Graphics.size();
+						loaded.Graphics.emplace_back(assetPathNormalized, (std::uint16_t)paletteOffset);
+					}
+					if (standalone) {
+						loaded.Graphics[anim.GraphicsIndex].Standalone = true;
 					}
 
 					std::int64_t frameOffset;
 					if (value["FrameOffset"].get(frameOffset) != SUCCESS) {
 						frameOffset = 0;
 					}
-					graphics.FrameOffset = (int32_t)frameOffset;
-
-					graphics.AnimDuration = graphics.Base->AnimDuration;
-					graphics.FrameCount = graphics.Base->FrameCount;
+					anim.FrameOffset = (std::int32_t)frameOffset;
 
 					std::int64_t frameCount;
 					if (value["FrameCount"].get(frameCount) == SUCCESS) {
-						graphics.FrameCount = (int32_t)frameCount;
+						anim.FrameCount = (std::int32_t)frameCount;
 					} else {
-						graphics.FrameCount -= graphics.FrameOffset;
+						anim.FrameCount = -1;
 					}
 
 					// TODO: Use AnimDuration instead
 					double frameRate;
 					if (value["FrameRate"].get(frameRate) == SUCCESS) {
-						graphics.AnimDuration = (frameRate <= 0 ? -1.0f : (1.0f / (float)frameRate) * 5.0f);
-					}
-
-					// If no bounding box is provided, use the first sprite
-					if (metadata->BoundingBox == Vector2i(InvalidValue, InvalidValue)) {
-						// TODO: Remove this bounding box reduction
-						metadata->BoundingBox = graphics.Base->FrameDimensions - Vector2i(2, 2);
+						anim.AnimDuration = (frameRate <= 0 ? -1.0f : (1.0f / (float)frameRate) * 5.0f);
+						anim.HasAnimDuration = true;
+					} else {
+						anim.AnimDuration = 0.0f;
+						anim.HasAnimDuration = false;
 					}
 
 					ondemand::array states;
@@ -569,40 +712,37 @@ namespace Jazz2
 							if (stateItem.get(state) == SUCCESS) {
 #if defined(DEATH_DEBUG)
 								// Additional checks only for Debug configuration
-								for (const auto& anim : metadata->Animations) {
-									if (anim.State == (AnimState)state) {
-										LOGW("Animation state %u defined twice in file \"%s\"", (std::uint32_t)state, path.data());
+								for (const auto& otherAnim : loaded.Animations) {
+									if (otherAnim.State == (AnimState)state) {
+										LOGW("Animation state %u defined twice in file \"%s\"", (std::uint32_t)state, loaded.Path.data());
 										break;
 									}
 								}
 #endif
-								graphics.State = (AnimState)state;
-								metadata->Animations.push_back(graphics);
+								anim.State = (AnimState)state;
+								loaded.Animations.push_back(anim);
 							}
 						}
 					} else if (count > 1) {
 						if (!multipleAnimsNoStatesWarning) {
 							multipleAnimsNoStatesWarning = true;
-							LOGW("Multiple animations defined but no states specified in file \"%s\"", path.data());
+							LOGW("Multiple animations defined but no states specified in file \"%s\"", loaded.Path.data());
 						}
 					} else {
-						graphics.State = AnimState::Default;
-						metadata->Animations.push_back(graphics);
+						anim.State = AnimState::Default;
+						loaded.Animations.push_back(anim);
 					}
 				}
-
-				// Animation states must be sorted, so binary search can be used
-				sort(metadata->Animations.begin(), metadata->Animations.end());
 			}
 
 #if defined(WITH_AUDIO)
-			if (!_isHeadless) {
-				// Don't load sounds in headless mode
+			if (!_isHeadless && theServiceLocator().GetAudioDevice().isValid()) {
+				// Don't load sounds in headless mode or if audio is disabled
 				ondemand::object sounds;
 				if (doc["Sounds"].get(sounds) == SUCCESS) {
 					std::size_t count;
 					if (sounds.count_fields().get(count) == SUCCESS) {
-						metadata->Sounds.reserve(count);
+						loaded.Sounds.reserve(count);
 					}
 
 					for (auto it : sounds) {
@@ -615,58 +755,150 @@ namespace Jazz2
 							continue;
 						}
 
-						SoundResource sound;
 						for (auto assetPathItem : assetPaths) {
 							std::string_view assetPath;
 							if (assetPathItem.get(assetPath) == SUCCESS && !assetPath.empty()) {
-								auto assetPathNormalized = fs::ToNativeSeparators(assetPath);
-								auto it = _cachedSounds.find(assetPathNormalized);
-								if (it != _cachedSounds.end()) {
-									it->second->Flags |= GenericSoundResourceFlags::Referenced;
-									sound.Buffers.emplace_back(it->second.get());
-								} else {
-									auto s = OpenContentFile(fs::CombinePath("Animations"_s, assetPathNormalized));
-									auto res = _cachedSounds.emplace(assetPathNormalized, std::make_unique<GenericSoundResource>(std::move(s), assetPathNormalized));
-									res.first->second->Flags |= GenericSoundResourceFlags::Referenced;
-									sound.Buffers.emplace_back(res.first->second.get());
-								}
+								auto& sound = loaded.Sounds.emplace_back();
+								sound.Key = key;
+								sound.Path = fs::ToNativeSeparators(assetPath);
+								sound.SamplesSize = 0;
+								sound.Format = AudioBuffer::Format::Mono8;
+								sound.Frequency = 0;
 							}
 						}
-
-						if (!sound.Buffers.empty()) {
-							metadata->Sounds.emplace(key, std::move(sound));
-						}
 					}
 				}
 			}
 #endif
 		}
 
+		return true;
+	}
+
+	Metadata* ContentResolver::FinalizeMetadata(LoadedMetadata& loaded)
+	{
+		std::unique_ptr<Metadata> metadata = std::make_unique<Metadata>();
+		metadata->Path = std::move(loaded.Path);
+		metadata->Flags |= MetadataFlags::Referenced;
+		metadata->BoundingBox = loaded.BoundingBox;
+
+		for (auto& graphics : loaded.Graphics) {
+			graphics.Base = ResolveGraphics(graphics);
+
+			// If no bounding box is provided, use the first sprite
+			if (graphics.Base != nullptr && metadata->BoundingBox == Vector2i(InvalidValue, InvalidValue)) {
+				// TODO: Remove this bounding box reduction
+				metadata->BoundingBox = graphics.Base->FrameDimensions - Vector2i(2, 2);
+			}
+		}
+
+		metadata->Animations.reserve(loaded.Animations.size());
+
+		for (const auto& anim : loaded.Animations) {
+			GenericGraphicResource* base = loaded.Graphics[anim.GraphicsIndex].Base;
+			if (base == nullptr) {
+				continue;
+			}
+
+			GraphicResource& graphics = metadata->Animations.emplace_back();
+			graphics.Base = base;
+			graphics.State = anim.State;
+			graphics.LoopMode = anim.LoopMode;
+			graphics.FrameOffset = anim.FrameOffset;
+			graphics.FrameCount = (anim.FrameCount >= 0 ? anim.FrameCount : base->FrameCount - anim.FrameOffset);
+			graphics.AnimDuration = (anim.HasAnimDuration ? anim.AnimDuration : base->AnimDuration);
+		}
+
+		// Animation states must be sorted, so binary search can be used
+		sort(metadata->Animations.begin(), metadata->Animations.end());
+
+#if defined(WITH_AUDIO)
+		for (auto& sound : loaded.Sounds) {
+			GenericSoundResource* base;
+			auto it = _cachedSounds.find(sound.Path);
+			if (it != _cachedSounds.end()) {
+				base = it->second.get();
+			} else if (sound.Samples != nullptr) {
+				// Samples were already decoded by a worker thread
+				auto res = _cachedSounds.emplace(sound.Path, std::make_unique<GenericSoundResource>(sound.Format, sound.Frequency, sound.Samples.get(), sound.SamplesSize));
+				base = res.first->second.get();
+			} else {
+				auto s = OpenContentFile(fs::CombinePath("Animations"_s, sound.Path));
+				auto res = _cachedSounds.emplace(sound.Path, std::make_unique<GenericSoundResource>(std::move(s), sound.Path));
+				base = res.first->second.get();
+			}
+
+			base->Flags |= GenericSoundResourceFlags::Referenced;
+			metadata->Sounds[sound.Key].Buffers.emplace_back(base);
+		}
+#endif
+
 		return _cachedMetadata.emplace(metadata->Path, std::move(metadata)).first->second.get();
 	}
 
-	GenericGraphicResource* ContentResolver::RequestGraphics(const StringView path, uint16_t paletteOffset)
+	GenericGraphicResource* ContentResolver::RequestGraphics(const StringView path, std::uint16_t paletteOffset)
+	{
+		LoadedGraphics loaded(fs::ToNativeSeparators(path), paletteOffset);
+		return ResolveGraphics(loaded);
+	}
+
+	GenericGraphicResource* ContentResolver::ResolveGraphics(LoadedGraphics& loaded)
 	{
 		// First resources are requested, reset _isLoading flag, because palette should be already applied
 		_isLoading = false;
 
-		auto pathNormalized = fs::ToNativeSeparators(path);
-		auto it = _cachedGraphics.find(Pair(String::nullTerminatedView(pathNormalized), paletteOffset));
+		auto it = _cachedGraphics.find(Pair(String::nullTerminatedView(loaded.Path), loaded.PaletteOffset));
 		if (it != _cachedGraphics.end()) {
 			// Already loaded - Mark as referenced
 			it->second->Flags |= GenericGraphicResourceFlags::Referenced;
 			return it->second.get();
 		}
 
-		if (fs::GetExtension(pathNormalized) == "aura"_s) {
-			return RequestGraphicsAura(pathNormalized, paletteOffset);
+		if (loaded.PaletteOffset != 0) {
+			// Palette variants of the same sprite sheet share indexed texture and collision mask,
+			// so only a new resource with different palette offset is needed
+			for (auto& resource : _cachedGraphics) {
+				GenericGraphicResource* source = resource.second.get();
+				if (source->IsIndexed() && resource.first.first() == loaded.Path) {
+					std::unique_ptr<GenericGraphicResource> graphics = std::make_unique<GenericGraphicResource>();
+					graphics->Flags = GenericGraphicResourceFlags::Referenced | GenericGraphicResourceFlags::Indexed;
+					graphics->TextureDiffuse = source->TextureDiffuse;
+					graphics->TextureOffset = source->TextureOffset;
+					graphics->Mask = source->Mask;
+					graphics->MaskBounds = source->MaskBounds;
+					graphics->MaskStride = source->MaskStride;
+					graphics->FrameDimensions = source->FrameDimensions;
+					graphics->FrameConfiguration = source->FrameConfiguration;
+					graphics->AnimDuration = source->AnimDuration;
+					graphics->FrameCount = source->FrameCount;
+					graphics->Hotspot = source->Hotspot;
+					graphics->Coldspot = source->Coldspot;
+					graphics->Gunspot = source->Gunspot;
+					graphics->PaletteOffset = loaded.PaletteOffset;
+					return _cachedGraphics.emplace(Pair(String(loaded.Path), loaded.PaletteOffset), std::move(graphics)).first->second.get();
+				}
+			}
 		}
 
-		auto s = fs::Open(fs::CombinePath({ GetContentPath(), "Animations"_s, String(pathNormalized + ".res"_s) }), FileAccess::Read);
+		if (loaded.Resource == nullptr && !LoadGraphics(loaded)) {
+			return nullptr;
+		}
+
+		return FinalizeGraphics(loaded);
+	}
+
+	bool ContentResolver::LoadGraphics(LoadedGraphics& loaded)
+	{
+		// This function can be called from worker threads, so it must not access any cached resources
+		if (fs::GetExtension(loaded.Path) == "aura"_s) {
+			return LoadGraphicsAura(loaded);
+		}
+
+		auto s = fs::Open(fs::CombinePath({ GetContentPath(), "Animations"_s, String(loaded.Path + ".res"_s) }), FileAccess::Read);
 		auto fileSize = s->GetSize();
 		if (fileSize < 4 || fileSize > 64 * 1024 * 1024) {
 			// 64 MB file size limit, also if not found try to use cache
-			return nullptr;
+			return false;
 		}
 
 		auto buffer = std::make_unique<char[]>(fileSize + simdjson::SIMDJSON_PADDING);
@@ -676,104 +908,85 @@ namespace Jazz2
 
 		ondemand::parser parser;
 		ondemand::document doc;
-		if (parser.iterate(buffer.get(), fileSize, fileSize + simdjson::SIMDJSON_PADDING).get(doc) == SUCCESS) {
-			// Try to load it
-			std::unique_ptr<GenericGraphicResource> graphics = std::make_unique<GenericGraphicResource>();
-			graphics->Flags |= GenericGraphicResourceFlags::Referenced;
+		if (parser.iterate(buffer.get(), fileSize, fileSize + simdjson::SIMDJSON_PADDING).get(doc) != SUCCESS) {
+			return false;
+		}
 
-			String fullPath = fs::CombinePath({ GetContentPath(), "Animations"_s, pathNormalized });
-			std::unique_ptr<ITextureLoader> texLoader = ITextureLoader::createFromFile(fullPath);
-			if (texLoader->hasLoaded()) {
-				auto texFormat = texLoader->texFormat().internalFormat();
-				if (texFormat != GL_RGBA8 && texFormat != GL_RGB8) {
-					return nullptr;
-				}
+		String fullPath = fs::CombinePath({ GetContentPath(), "Animations"_s, loaded.Path });
+		std::unique_ptr<ITextureLoader> texLoader = ITextureLoader::createFromFile(fullPath);
+		if (!texLoader->hasLoaded()) {
+			return false;
+		}
 
-				std::int32_t w = texLoader->width();
-				std::int32_t h = texLoader->height();
-				std::uint32_t* pixels = (std::uint32_t*)texLoader->pixels();
-				const std::uint32_t* palette = _palettes + paletteOffset;
-				bool linearSampling = false;
-				bool needsMask = true;
+		auto texFormat = texLoader->texFormat().internalFormat();
+		if (texFormat != GL_RGBA8 && texFormat != GL_RGB8) {
+			return false;
+		}
 
-				std::uint64_t flags;
-				if (doc["Flags"].get(flags) == SUCCESS) {
-					// Palette already applied, keep as is
-					if ((flags & 0x01) != 0x01) {
-						palette = nullptr;
-						// TODO: Apply linear sampling only to these images
-						if ((flags & 0x02) == 0x02) {
-							linearSampling = true;
-						}
-					}
-					if ((flags & 0x08) == 0x08) {
-						needsMask = false;
-					}
-				}
+		std::unique_ptr<GenericGraphicResource> graphics = std::make_unique<GenericGraphicResource>();
+		loaded.Width = texLoader->width();
+		loaded.Height = texLoader->height();
 
-				if (needsMask) {
-					graphics->Mask = std::make_unique<std::uint8_t[]>(w * h);
+		bool applyPalette = true;
+		bool needsMask = true;
 
-					for (std::int32_t i = 0; i < w * h; i++) {
-						// Save original alpha value for collision checking
-						graphics->Mask[i] = ((pixels[i] >> 24) & 0xff);
-						if (palette != nullptr) {
-							std::uint32_t color = palette[pixels[i] & 0xff];
-							pixels[i] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[i] >> 24) & 0xff) / 255) << 24);
-						}
-					}
-				} else if (palette != nullptr) {
-					for (std::int32_t i = 0; i < w * h; i++) {
-						std::uint32_t color = palette[pixels[i] & 0xff];
-						pixels[i] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[i] >> 24) & 0xff) / 255) << 24);
-					}
+		std::uint64_t flags;
+		if (doc["Flags"].get(flags) == SUCCESS) {
+			// Palette already applied, keep as is
+			if ((flags & 0x01) != 0x01) {
+				applyPalette = false;
+				// TODO: Apply linear sampling only to these images
+				if ((flags & 0x02) == 0x02) {
+					loaded.LinearSampling = true;
 				}
+			}
+			if ((flags & 0x08) == 0x08) {
+				needsMask = false;
+			}
+		}
 
-				if (!_isHeadless) {
-					// Don't load textures in headless mode, only collision masks
-					graphics->TextureDiffuse = std::make_unique<Texture>(fullPath.data(), Texture::Format::RGBA8, w, h);
-					graphics->TextureDiffuse->loadFromTexels((unsigned char*)pixels, 0, 0, w, h);
-					graphics->TextureDiffuse->setMinFiltering(linearSampling ? SamplerFilter::Linear : SamplerFilter::Nearest);
-					graphics->TextureDiffuse->setMagFiltering(linearSampling ? SamplerFilter::Linear : SamplerFilter::Nearest);
-				}
+		loaded.Resource = std::move(graphics);
 
-				double animDuration;
-				if (doc["Duration"].get(animDuration) != SUCCESS) {
-					animDuration = 0.0;
-				}
-				graphics->AnimDuration = (float)animDuration;
+		double animDuration;
+		if (doc["Duration"].get(animDuration) != SUCCESS) {
+			animDuration = 0.0;
+		}
+		loaded.Resource->AnimDuration = (float)animDuration;
 
-				std::int64_t frameCount;
-				if (doc["FrameCount"].get(frameCount) != SUCCESS) {
-					frameCount = 0;
-				}
-				graphics->FrameCount = (std::int32_t)frameCount;
+		std::int64_t frameCount;
+		if (doc["FrameCount"].get(frameCount) != SUCCESS) {
+			frameCount = 0;
+		}
+		loaded.Resource->FrameCount = (std::int32_t)frameCount;
 
-				graphics->FrameDimensions = GetVector2iFromJson(doc["FrameSize"]);
-				graphics->FrameConfiguration = GetVector2iFromJson(doc["FrameConfiguration"]);
-				
-				graphics->Hotspot = GetVector2iFromJson(doc["Hotspot"]);
-				graphics->Coldspot = GetVector2iFromJson(doc["Coldspot"], Vector2i(InvalidValue, InvalidValue));
-				graphics->Gunspot = GetVector2iFromJson(doc["Gunspot"], Vector2i(InvalidValue, InvalidValue));
+		loaded.Resource->FrameDimensions = GetVector2iFromJson(doc["FrameSize"]);
+		loaded.Resource->FrameConfiguration = GetVector2iFromJson(doc["FrameConfiguration"]);
 
-#if defined(DEATH_DEBUG)
-				MigrateGraphics(pathNormalized);
-#endif
-				return _cachedGraphics.emplace(Pair(String(pathNormalized), paletteOffset), std::move(graphics)).first->second.get();
-			}
+		loaded.Resource->Hotspot = GetVector2iFromJson(doc["Hotspot"]);
+		loaded.Resource->Coldspot = GetVector2iFromJson(doc["Coldspot"], Vector2i(InvalidValue, InvalidValue));
+		loaded.Resource->Gunspot = GetVector2iFromJson(doc["Gunspot"], Vector2i(InvalidValue, InvalidValue));
+
+		// Frame dimensions have to be known before the collision mask is built
+		std::uint32_t* pixels = (std::uint32_t*)texLoader->pixels();
+		ApplyPaletteAndMask(loaded, pixels, applyPalette, needsMask);
+
+		if (!_isHeadless && !loaded.Indexed) {
+			// Don't load textures in headless mode, only collision masks
+			loaded.Pixels = std::make_unique<std::uint32_t[]>(loaded.Width * loaded.Height);
+			std::memcpy(loaded.Pixels.get(), pixels, loaded.Width * loaded.Height * sizeof(std::uint32_t));
 		}
 
-		return nullptr;
+		return true;
 	}
 
-	GenericGraphicResource* ContentResolver::RequestGraphicsAura(const StringView path, std::uint16_t paletteOffset)
+	bool ContentResolver::LoadGraphicsAura(LoadedGraphics& loaded)
 	{
-		auto s = OpenContentFile(fs::CombinePath("Animations"_s, path));
+		auto s = OpenContentFile(fs::CombinePath("Animations"_s, loaded.Path));
 
 		auto fileSize = s->GetSize();
 		if (fileSize < 16 || fileSize > 64 * 1024 * 1024) {
 			// 64 MB file size limit, also if not found try to use cache
-			return nullptr;
+			return false;
 		}
 
 		std::uint64_t signature1 = s->ReadValue<std::uint64_t>();
@@ -782,7 +995,7 @@ namespace Jazz2
 		std::uint8_t flags = s->ReadValue<std::uint8_t>();
 
 		if (signature1 != 0xB8EF8498E2BFBBEF || signature2 != 0x208F || version != 2 || (flags & 0x80) != 0x80) {
-			return nullptr;
+			return false;
 		}
 
 		std::uint8_t channelCount = s->ReadValue<std::uint8_t>();
@@ -806,50 +1019,20 @@ namespace Jazz2
 		std::uint32_t width = frameDimensionsX * frameConfigurationX;
 		std::uint32_t height = frameDimensionsY * frameConfigurationY;
 
-		std::unique_ptr<std::uint32_t[]> pixels = std::make_unique<std::uint32_t[]>(width * height);
-
-		ReadImageFromFile(s, (std::uint8_t*)pixels.get(), width, height, channelCount);
-
 		std::unique_ptr<GenericGraphicResource> graphics = std::make_unique<GenericGraphicResource>();
-		graphics->Flags |= GenericGraphicResourceFlags::Referenced;
+		loaded.Width = (std::int32_t)width;
+		loaded.Height = (std::int32_t)height;
 
-		const std::uint32_t* palette = _palettes + paletteOffset;
-		bool linearSampling = false;
+		bool applyPalette = true;
 		bool needsMask = true;
 		if ((flags & 0x01) == 0x01) {
-			palette = nullptr;
-			linearSampling = true;
+			applyPalette = false;
+			loaded.LinearSampling = true;
 		}
 		if ((flags & 0x02) == 0x02) {
 			needsMask = false;
 		}
 
-		if (needsMask) {
-			graphics->Mask = std::make_unique<std::uint8_t[]>(width * height);
-
-			for (std::uint32_t i = 0; i < width * height; i++) {
-				// Save original alpha value for collision checking
-				graphics->Mask[i] = ((pixels[i] >> 24) & 0xff);
-				if (palette != nullptr) {
-					std::uint32_t color = palette[pixels[i] & 0xff];
-					pixels[i] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[i] >> 24) & 0xff) / 255) << 24);
-				}
-			}
-		} else if (palette != nullptr) {
-			for (std::uint32_t i = 0; i < width * height; i++) {
-				std::uint32_t color = palette[pixels[i] & 0xff];
-				pixels[i] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[i] >> 24) & 0xff) / 255) << 24);
-			}
-		}
-
-		if (!_isHeadless) {
-			// Don't load textures in headless mode, only collision masks
-			graphics->TextureDiffuse = std::make_unique<Texture>(path.data(), Texture::Format::RGBA8, width, height);
-			graphics->TextureDiffuse->loadFromTexels((unsigned char*)pixels.get(), 0, 0, width, height);
-			graphics->TextureDiffuse->setMinFiltering(linearSampling ? SamplerFilter::Linear : SamplerFilter::Nearest);
-			graphics->TextureDiffuse->setMagFiltering(linearSampling ? SamplerFilter::Linear : SamplerFilter::Nearest);
-		}
-
 		// AnimDuration is multiplied by 256 before saving, so divide it here back
 		graphics->AnimDuration = animDuration / 256.0f;
 		graphics->FrameDimensions = Vector2i(frameDimensionsX, frameDimensionsY);
@@ -874,11 +1057,244 @@ namespace Jazz2
 			graphics->Gunspot = Vector2i(InvalidValue, InvalidValue);
 		}
 
-		return _cachedGraphics.emplace(Pair(String(path), paletteOffset), std::move(graphics)).first->second.get();
+		loaded.Resource = std::move(graphics);
+
+		// Collision mask and palette are applied to each group of rows right after it's decoded, while it's still in cache
+		BeginPaletteAndMask(loaded, applyPalette, needsMask);
+
+		std::unique_ptr<std::uint32_t[]> pixels = std::make_unique<std::uint32_t[]>(width * height);
+		std::int32_t rowsPerGroup = std::max(ParallelRowGroupPixels / (std::int32_t)width, 1);
+		ReadImageFromFileParallel(s, (std::uint8_t*)pixels.get(), width, height, channelCount, rowsPerGroup, [&](std::int32_t firstRow, std::int32_t lastRow) {
+			ApplyPaletteAndMaskRows(loaded, pixels.get(), applyPalette, needsMask, firstRow, lastRow);
+		});
+
+		EndPaletteAndMask(loaded, needsMask);
+
+		if (!_isHeadless && !loaded.Indexed) {
+			// Don't load textures in headless mode, only collision masks
+			loaded.Pixels = std::move(pixels);
+		}
+		return true;
+	}
+
+	void ContentResolver::ApplyPaletteAndMask(LoadedGraphics& loaded, std::uint32_t* pixels, bool applyPalette, bool needsMask)
+	{
+		BeginPaletteAndMask(loaded, applyPalette, needsMask);
+		ApplyPaletteAndMaskRows(loaded, pixels, applyPalette, needsMask, 0, loaded.Height);
+		EndPaletteAndMask(loaded, needsMask);
+	}
+
+	void ContentResolver::BeginPaletteAndMask(LoadedGraphics& loaded, bool applyPalette, bool needsMask)
+	{
+		if (needsMask) {
+			loaded.Resource->BeginCollisionMask();
+		}
+
+		if (applyPalette && loaded.PaletteOffset != 0) {
+			// Palette variants keep only palette index and alpha, palette is applied in shader instead, so all variants can share one texture
+			loaded.Indexed = true;
+			if (!_isHeadless) {
+				loaded.Pixels = std::make_unique<std::uint32_t[]>(GetIndexedRowStride(loaded.Width) * loaded.Height / sizeof(std::uint32_t));
+			}
+		}
+	}
+
+	void ContentResolver::ApplyPaletteAndMaskRows(LoadedGraphics& loaded, std::uint32_t* pixels, bool applyPalette, bool needsMask, std::int32_t firstRow, std::int32_t lastRow)
+	{
+		// This function can be called for different rows from multiple threads at once
+		if (needsMask) {
+			// Use original alpha value for collision checking
+			loaded.Resource->AddCollisionMaskRows(pixels, loaded.Width, firstRow, lastRow);
+		}
+
+		if (!applyPalette || _isHeadless) {
+			// Don't apply palette in headless mode, pixels are not used anyway
+			return;
+		}
+
+		if (loaded.Indexed) {
+			std::uint8_t* indexed = (std::uint8_t*)loaded.Pixels.get();
+			std::int32_t stride = GetIndexedRowStride(loaded.Width);
+			for (std::int32_t y = firstRow; y < lastRow; y++) {
+				const std::uint32_t* src = &pixels[y * loaded.Width];
+				std::uint8_t* dst = &indexed[y * stride];
+				for (std::int32_t x = 0; x < loaded.Width; x++) {
+					dst[x * 2] = (std::uint8_t)(src[x] & 0xff);
+					dst[x * 2 + 1] = (std::uint8_t)((src[x] >> 24) & 0xff);
+				}
+			}
+		} else {
+			const std::uint32_t* palette = _palettes + loaded.PaletteOffset;
+			std::int32_t end = lastRow * loaded.Width;
+			for (std::int32_t i = firstRow * loaded.Width; i < end; i++) {
+				std::uint32_t color = palette[pixels[i] & 0xff];
+				pixels[i] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[i] >> 24) & 0xff) / 255) << 24);
+			}
+		}
+	}
+
+	void ContentResolver::EndPaletteAndMask(LoadedGraphics& loaded, bool needsMask)
+	{
+		if (needsMask) {
+			loaded.Resource->EndCollisionMask();
+		}
+	}
+
+	GenericGraphicResource* ContentResolver::FinalizeGraphics(LoadedGraphics& loaded)
+	{
+		std::unique_ptr<GenericGraphicResource> graphics = std::move(loaded.Resource);
+		graphics->Flags |= GenericGraphicResourceFlags::Referenced;
+		graphics->PaletteOffset = loaded.PaletteOffset;
+		if (loaded.Indexed) {
+			graphics->Flags |= GenericGraphicResourceFlags::Indexed;
+		}
+
+		if (!_isHeadless && loaded.Pixels != nullptr) {
+			// Small sprite sheets share textures, so sprites of different animations can be batched together
+			bool packed = (!loaded.LinearSampling && !loaded.Standalone && !loaded.Indexed && SpriteAtlas::CanAdd(loaded.Width, loaded.Height) &&
+				_spriteAtlas.Add(graphics.get(), loaded.Pixels.get(), loaded.Width, loaded.Height));
+			if (loaded.Indexed) {
+				graphics->TextureDiffuse = std::make_shared<Texture>(loaded.Path.data(), Texture::Format::RG8, loaded.Width, loaded.Height);
+				graphics->TextureDiffuse->loadFromTexels((unsigned char*)loaded.Pixels.get(), 0, 0, loaded.Width, loaded.Height);
+				graphics->TextureDiffuse->setMinFiltering(SamplerFilter::Nearest);
+				graphics->TextureDiffuse->setMagFiltering(SamplerFilter::Nearest);
+			} else if (!packed) {
+				graphics->TextureDiffuse = std::make_shared<Texture>(loaded.Path.data(), Texture::Format::RGBA8, loaded.Width, loaded.Height);
+				graphics->TextureDiffuse->loadFromTexels((unsigned char*)loaded.Pixels.get(), 0, 0, loaded.Width, loaded.Height);
+				graphics->TextureDiffuse->setMinFiltering(loaded.LinearSampling ? SamplerFilter::Linear : SamplerFilter::Nearest);
+				graphics->TextureDiffuse->setMagFiltering(loaded.LinearSampling ? SamplerFilter::Linear : SamplerFilter::Nearest);
+			}
+			loaded.Pixels = nullptr;
+		}
+
+#if defined(DEATH_DEBUG)
+		if (fs::GetExtension(loaded.Path) != "aura"_s) {
+			MigrateGraphics(loaded.Path);
+		}
+#endif
+
+		return _cachedGraphics.emplace(Pair(String(loaded.Path), loaded.PaletteOffset), std::move(graphics)).first->second.get();
+	}
+
+#if defined(WITH_AUDIO)
+	void ContentResolver::LoadSound(LoadedSound& loaded)
+	{
+		auto s = OpenContentFile(fs::CombinePath("Animations"_s, loaded.Path));
+		std::unique_ptr<IAudioLoader> audioLoader = IAudioLoader::createFromStream(std::move(s), loaded.Path);
+		if (!audioLoader->hasLoaded()) {
+			// It will be retried on the main thread
+			return;
+		}
+
+		std::int32_t bytesPerSample = audioLoader->bytesPerSample();
+		std::int32_t numChannels = audioLoader->numChannels();
+		if ((bytesPerSample != 1 && bytesPerSample != 2) || (numChannels != 1 && numChannels != 2)) {
+			return;
+		}
+
+		loaded.Format = (bytesPerSample == 2
+			? (numChannels == 2 ? AudioBuffer::Format::Stereo16 : AudioBuffer::Format::Mono16)
+			: (numChannels == 2 ? AudioBuffer::Format::Stereo8 : AudioBuffer::Format::Mono8));
+		loaded.Frequency = audioLoader->frequency();
+		loaded.SamplesSize = audioLoader->bufferSize();
+		loaded.Samples = std::make_unique<unsigned char[]>(loaded.SamplesSize);
+
+		std::unique_ptr<IAudioReader> audioReader = audioLoader->createReader();
+		audioReader->read(loaded.Samples.get(), loaded.SamplesSize);
+	}
+#endif
+
+#if defined(WITH_THREADS)
+	void ContentResolver::ExecutePendingMetadata(PendingMetadata& pending)
+	{
+		_pendingMutex.Lock();
+		if (pending.State != PendingLoadState::Queued || pending.Generation != _pendingGeneration) {
+			// Request was cancelled or taken over by the main thread
+			_pendingMutex.Unlock();
+			return;
+		}
+		pending.State = PendingLoadState::Running;
+		_pendingRunningCount++;
+		_pendingMutex.Unlock();
+
+		pending.IsValid = LoadMetadata(pending.Loaded);
+		if (pending.IsValid) {
+			auto& allGraphics = pending.Loaded.Graphics;
+			for (std::size_t i = 0; i < allGraphics.size(); i++) {
+				// Palette variants of the same sprite sheet share one indexed texture in ResolveGraphics(), so it's decoded only once
+				bool isSharedVariant = false;
+				if (allGraphics[i].PaletteOffset != 0) {
+					for (std::size_t j = 0; j < i; j++) {
+						if (allGraphics[j].Indexed && allGraphics[j].Path == allGraphics[i].Path) {
+							isSharedVariant = true;
+							break;
+						}
+					}
+				}
+				if (!isSharedVariant) {
+					LoadGraphics(allGraphics[i]);
+				}
+			}
+#	if defined(WITH_AUDIO)
+			for (auto& sound : pending.Loaded.Sounds) {
+				LoadSound(sound);
+			}
+#	endif
+		}
+
+		_pendingMutex.Lock();
+		pending.State = PendingLoadState::Done;
+		_pendingRunningCount--;
+		_pendingCV.Broadcast();
+		_pendingMutex.Unlock();
+	}
+
+	bool ContentResolver::TryAcquirePendingMetadata(PendingMetadata& pending)
+	{
+		_pendingMutex.Lock();
+		if (pending.State == PendingLoadState::Queued) {
+			// Worker thread hasn't started yet, it's faster to load it directly
+			pending.State = PendingLoadState::Cancelled;
+			_pendingMutex.Unlock();
+			return false;
+		}
+		while (pending.State == PendingLoadState::Running) {
+			_pendingCV.Wait(_pendingMutex);
+		}
+		_pendingMutex.Unlock();
+		return true;
+	}
+#endif
+
+	void ContentResolver::CancelPendingLoads()
+	{
+#if defined(WITH_THREADS)
+		if (_pendingMetadata.empty()) {
+			return;
+		}
+
+		// Worker threads read palettes, so wait until all running requests are done, queued requests will be skipped
+		_pendingMutex.Lock();
+		_pendingGeneration++;
+		while (_pendingRunningCount > 0) {
+			_pendingCV.Wait(_pendingMutex);
+		}
+		_pendingMutex.Unlock();
+
+		_pendingMetadata.clear();
+#endif
 	}
 
 	void ContentResolver::ReadImageFromFile(std::unique_ptr<Stream>& s, std::uint8_t* data, std::int32_t width, std::int32_t height, std::int32_t channelCount)
 	{
+		ReadImageFromFile(s, data, width, height, channelCount, height, [](std::int32_t, std::int32_t) {});
+	}
+
+	void ContentResolver::ReadImageFromFile(std::unique_ptr<Stream>& s, std::uint8_t* data, std::int32_t width, std::int32_t height, std::int32_t channelCount,
+		std::int32_t rowsPerGroup, FunctionRef<void(std::int32_t, std::int32_t)> onRowsDecoded)
+	{
+		ZoneScoped;
+
 		typedef union {
 			struct {
 				unsigned char r, g, b, a;
@@ -897,54 +1313,142 @@ namespace Jazz2
 
 		#define QOI_COLOR_HASH(C) (C.rgba.r*3 + C.rgba.g*5 + C.rgba.b*7 + C.rgba.a*11)
 
+		// Input is read from the stream in blocks, so the decoder doesn't need to call the stream for every byte.
+		// The image data are followed by other data in some files and streams cannot be always rewound, so
+		// the block must never exceed the image data. Every operation encodes at most 62 pixels, so at least
+		// 1 byte per 62 remaining pixels is always available.
+		constexpr std::int32_t BlockSize = 16384;
+		constexpr std::int32_t MaxPixelsPerOp = 62;
+		constexpr std::int32_t MaxOpSize = 5;
+
+		std::uint8_t block[BlockSize];
+		std::int32_t blockPos = 0;
+		std::int32_t blockEnd = 0;
+
 		rgba_t index[64] { };
 		rgba_t px;
-		std::int32_t run = 0;
-		std::int32_t px_len = width * height * channelCount;
-
 		px.rgba.r = 0;
 		px.rgba.g = 0;
 		px.rgba.b = 0;
 		px.rgba.a = 255;
 
-		for (std::int32_t px_pos = 0; px_pos < px_len; px_pos += channelCount) {
-			if (run > 0) {
-				run--;
+		std::int32_t pixelCount = width * height;
+		std::int32_t pixelPos = 0;
+		std::int32_t nextGroupRow = std::min(rowsPerGroup, height);
+		std::int32_t lastGroupRow = 0;
+
+		while (pixelPos < pixelCount) {
+			if (blockEnd - blockPos < MaxOpSize) {
+				// Move remaining bytes to the beginning and refill the block
+				std::int32_t remaining = blockEnd - blockPos;
+				std::memmove(block, block + blockPos, remaining);
+				blockPos = 0;
+				blockEnd = remaining;
+
+				std::int32_t available = (pixelCount - pixelPos + MaxPixelsPerOp - 1) / MaxPixelsPerOp - remaining;
+				std::int32_t bytesToRead = std::min(available, BlockSize - remaining);
+				if (bytesToRead > 0) {
+					std::int32_t bytesRead = s->Read(block + blockEnd, bytesToRead);
+					if (bytesRead > 0) {
+						blockEnd += bytesRead;
+					}
+				}
+				if (blockEnd == 0) {
+					// Image data are truncated
+					break;
+				}
+			}
+
+			std::int32_t b1 = block[blockPos];
+			std::int32_t opSize = (b1 == QOI_OP_RGBA ? 5 : (b1 == QOI_OP_RGB ? 4 : ((b1 & QOI_MASK_2) == QOI_OP_LUMA ? 2 : 1)));
+			if (blockEnd - blockPos < opSize) {
+				// Near the end of the image data, read exactly the rest of the operation
+				std::int32_t bytesRead = s->Read(block + blockEnd, opSize - (blockEnd - blockPos));
+				if (bytesRead != opSize - (blockEnd - blockPos)) {
+					break;
+				}
+				blockEnd += bytesRead;
+			}
+
+			const std::uint8_t* op = block + blockPos;
+			blockPos += opSize;
+
+			std::int32_t runLength = 1;
+			if (b1 == QOI_OP_RGB) {
+				px.rgba.r = op[1];
+				px.rgba.g = op[2];
+				px.rgba.b = op[3];
+			} else if (b1 == QOI_OP_RGBA) {
+				px.rgba.r = op[1];
+				px.rgba.g = op[2];
+				px.rgba.b = op[3];
+				px.rgba.a = op[4];
+			} else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX) {
+				px = index[b1];
+			} else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF) {
+				px.rgba.r += ((b1 >> 4) & 0x03) - 2;
+				px.rgba.g += ((b1 >> 2) & 0x03) - 2;
+				px.rgba.b += (b1 & 0x03) - 2;
+			} else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA) {
+				std::int32_t b2 = op[1];
+				std::int32_t vg = (b1 & 0x3f) - 32;
+				px.rgba.r += vg - 8 + ((b2 >> 4) & 0x0f);
+				px.rgba.g += vg;
+				px.rgba.b += vg - 8 + (b2 & 0x0f);
+			} else if ((b1 & QOI_MASK_2) == QOI_OP_RUN) {
+				runLength += (b1 & 0x3f);
+			}
+
+			index[QOI_COLOR_HASH(px) & 63] = px;
+
+			// The whole span of repeated pixels is written at once
+			runLength = std::min(runLength, pixelCount - pixelPos);
+			if (channelCount == 4) {
+				std::uint32_t* dst = (std::uint32_t*)data + pixelPos;
+				for (std::int32_t i = 0; i < runLength; i++) {
+					dst[i] = px.v;
+				}
 			} else {
-				std::int32_t b1 = s->ReadValue<std::uint8_t>();
-
-				if (b1 == QOI_OP_RGB) {
-					px.rgba.r = s->ReadValue<std::uint8_t>();
-					px.rgba.g = s->ReadValue<std::uint8_t>();
-					px.rgba.b = s->ReadValue<std::uint8_t>();
-				} else if (b1 == QOI_OP_RGBA) {
-					px.rgba.r = s->ReadValue<std::uint8_t>();
-					px.rgba.g = s->ReadValue<std::uint8_t>();
-					px.rgba.b = s->ReadValue<std::uint8_t>();
-					px.rgba.a = s->ReadValue<std::uint8_t>();
-				} else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX) {
-					px = index[b1];
-				} else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF) {
-					px.rgba.r += ((b1 >> 4) & 0x03) - 2;
-					px.rgba.g += ((b1 >> 2) & 0x03) - 2;
-					px.rgba.b += (b1 & 0x03) - 2;
-				} else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA) {
-					std::int32_t b2 = s->ReadValue<std::uint8_t>();
-					std::int32_t vg = (b1 & 0x3f) - 32;
-					px.rgba.r += vg - 8 + ((b2 >> 4) & 0x0f);
-					px.rgba.g += vg;
-					px.rgba.b += vg - 8 + (b2 & 0x0f);
-				} else if ((b1 & QOI_MASK_2) == QOI_OP_RUN) {
-					run = (b1 & 0x3f);
+				for (std::int32_t i = 0; i < runLength; i++) {
+					std::memcpy(data + (pixelPos + i) * channelCount, &px, sizeof(px));
 				}
+			}
+			pixelPos += runLength;
 
-				index[QOI_COLOR_HASH(px) & 63] = px;
+			while (nextGroupRow > lastGroupRow && pixelPos >= nextGroupRow * width) {
+				onRowsDecoded(lastGroupRow, nextGroupRow);
+				lastGroupRow = nextGroupRow;
+				nextGroupRow = std::min(nextGroupRow + rowsPerGroup, height);
 			}
+		}
 
-			*(rgba_t*)(data + px_pos) = px;
+		if (lastGroupRow < height) {
+			// Image data are truncated, process the rest of rows anyway
+			onRowsDecoded(lastGroupRow, height);
 		}
 	}
 
+	void ContentResolver::ReadImageFromFileParallel(std::unique_ptr<Stream>& s, std::uint8_t* data, std::int32_t width, std::int32_t height, std::int32_t channelCount,
+		std::int32_t rowsPerGroup, FunctionRef<void(std::int32_t, std::int32_t)> processRows)
+	{
+		if (rowsPerGroup >= height) {
+			// Image is too small to be split, process all rows on the calling thread
+			ReadImageFromFile(s, data, width, height, channelCount, height, processRows);
+			return;
+		}
+
+		IThreadPool& threadPool = theServiceLocator().GetThreadPool();
+		Job* root = threadPool.CreateJob(static_cast<JobFunction>(nullptr));
+		ReadImageFromFile(s, data, width, height, channelCount, rowsPerGroup, [&threadPool, root, processRows](std::int32_t firstRow, std::int32_t lastRow) {
+			Job* job = threadPool.CreateChildJob(root, [processRows, firstRow, lastRow]() {
+				processRows(firstRow, lastRow);
+			});
+			threadPool.Run(job);
+		});
+		threadPool.Run(root);
+		threadPool.Wait(root);
+	}
+
 	std::unique_ptr<Tiles::TileSet> ContentResolver::RequestTileSet(const StringView path, std::uint16_t captionTileId, bool applyPalette, const std::uint8_t* paletteRemapping)
 	{
 		// Try "Content" directory first, then "Cache" directory
@@ -988,12 +1492,14 @@ namespace Jazz2
 #endif
 					_cachedMetadata.clear();
 					_cachedGraphics.clear();
+					_spriteAtlas.Clear();
 
 					for (std::int32_t i = 0; i < (std::int32_t)FontType::Count; i++) {
 						_fonts[i] = nullptr;
 					}
 				}
 
+				CancelPendingLoads();
 				std::memcpy(_palettes, newPalette, ColorsPerPalette * sizeof(std::uint32_t));
 				RecreateGemPalettes();
 			}
@@ -1017,94 +1523,97 @@ namespace Jazz2
 
 		if (!_isHeadless) {
 			// Don't load textures in headless mode, only collision masks
-			// Load raw pixels from file
-			std::unique_ptr<std::uint32_t[]> pixels = std::make_unique<std::uint32_t[]>(width * height);
-			ReadImageFromFile(s, (std::uint8_t*)pixels.get(), width, height, channelCount);
-
-			// Then add 1px padding to each tile
+			// Load raw pixels from file and add 1px padding to each tile, every row of tiles is padded as soon as
+			// it's decoded, rows of tiles are independent, so large tilesets are processed by worker threads
 			std::uint32_t tilesPerRow = width / TileSet::DefaultTileSize;
 			std::uint32_t tilesPerColumn = height / TileSet::DefaultTileSize;
 
 			std::uint32_t widthWithPadding = width + (2 * tilesPerRow);
 			std::uint32_t heightWithPadding = height + (2 * tilesPerColumn);
+			std::unique_ptr<std::uint32_t[]> pixels = std::make_unique<std::uint32_t[]>(width * height);
 			std::unique_ptr<uint32_t[]> pixelsWithPadding = std::make_unique<uint32_t[]>(widthWithPadding * heightWithPadding);
-			for (uint32_t i = 0; i < tilesPerColumn; i++) {
-				std::uint32_t yf = i * TileSet::DefaultTileSize;
-				std::uint32_t yt = i * (TileSet::DefaultTileSize + 2);
-				for (std::uint32_t j = 0; j < tilesPerRow; j++) {
-					std::uint32_t xf = j * TileSet::DefaultTileSize;
-					std::uint32_t xt = j * (TileSet::DefaultTileSize + 2);
-
-					if (paletteRemapping != nullptr) {
-						for (std::uint32_t y = 0; y < TileSet::DefaultTileSize; y++) {
-							for (std::uint32_t x = 0; x < TileSet::DefaultTileSize; x++) {
-								std::uint32_t from = yf * width + xf + y * width + x;
-								std::uint32_t to = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (x + 1);
 
-								std::uint32_t color = _palettes[paletteRemapping[pixels[from] & 0xff]];
-								pixelsWithPadding[to] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[from] >> 24) & 0xff) / 255) << 24);
+			std::int32_t rowsPerGroup = std::max(ParallelRowGroupPixels / (std::int32_t)(width * TileSet::DefaultTileSize), 1) * TileSet::DefaultTileSize;
+			ReadImageFromFileParallel(s, (std::uint8_t*)pixels.get(), width, height, channelCount, rowsPerGroup, [&](std::int32_t firstRow, std::int32_t lastRow) {
+				std::uint32_t lastTileRow = std::min((std::uint32_t)lastRow / TileSet::DefaultTileSize, tilesPerColumn);
+				for (std::uint32_t i = (std::uint32_t)firstRow / TileSet::DefaultTileSize; i < lastTileRow; i++) {
+					std::uint32_t yf = i * TileSet::DefaultTileSize;
+					std::uint32_t yt = i * (TileSet::DefaultTileSize + 2);
+					for (std::uint32_t j = 0; j < tilesPerRow; j++) {
+						std::uint32_t xf = j * TileSet::DefaultTileSize;
+						std::uint32_t xt = j * (TileSet::DefaultTileSize + 2);
+
+						if (paletteRemapping != nullptr) {
+							for (std::uint32_t y = 0; y < TileSet::DefaultTileSize; y++) {
+								for (std::uint32_t x = 0; x < TileSet::DefaultTileSize; x++) {
+									std::uint32_t from = yf * width + xf + y * width + x;
+									std::uint32_t to = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (x + 1);
+
+									std::uint32_t color = _palettes[paletteRemapping[pixels[from] & 0xff]];
+									pixelsWithPadding[to] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[from] >> 24) & 0xff) / 255) << 24);
+								}
 							}
-						}
-					} else {
-						for (std::uint32_t y = 0; y < TileSet::DefaultTileSize; y++) {
-							for (std::uint32_t x = 0; x < TileSet::DefaultTileSize; x++) {
-								std::uint32_t from = yf * width + xf + y * width + x;
-								std::uint32_t to = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (x + 1);
+						} else {
+							for (std::uint32_t y = 0; y < TileSet::DefaultTileSize; y++) {
+								for (std::uint32_t x = 0; x < TileSet::DefaultTileSize; x++) {
+									std::uint32_t from = yf * width + xf + y * width + x;
+									std::uint32_t to = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (x + 1);
 
-								std::uint32_t color = _palettes[pixels[from] & 0xff];
-								pixelsWithPadding[to] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[from] >> 24) & 0xff) / 255) << 24);
+									std::uint32_t color = _palettes[pixels[from] & 0xff];
+									pixelsWithPadding[to] = (color & 0xffffff) | ((((color >> 24) & 0xff) * ((pixels[from] >> 24) & 0xff) / 255) << 24);
+								}
 							}
 						}
-					}
 
-					// Top
-					for (std::uint32_t x = 0; x < TileSet::DefaultTileSize; x++) {
-						std::uint32_t from = yt * widthWithPadding + xt + 1 * widthWithPadding + (x + 1);
-						std::uint32_t to = yt * widthWithPadding + xt + 0 * widthWithPadding + (x + 1);
-						pixelsWithPadding[to] = pixelsWithPadding[from];
-					}
-					// Bottom
-					for (std::uint32_t x = 0; x < TileSet::DefaultTileSize; x++) {
-						std::uint32_t from = yt * widthWithPadding + xt + (TileSet::DefaultTileSize) * widthWithPadding + (x + 1);
-						std::uint32_t to = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding + (x + 1);
-						pixelsWithPadding[to] = pixelsWithPadding[from];
-					}
-					// Left
-					for (std::uint32_t y = 0; y < TileSet::DefaultTileSize; y++) {
-						std::uint32_t from = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (1);
-						std::uint32_t to = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (0);
-						pixelsWithPadding[to] = pixelsWithPadding[from];
-					}
-					// Right
-					for (std::uint32_t y = 0; y < TileSet::DefaultTileSize; y++) {
-						std::uint32_t from = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (TileSet::DefaultTileSize);
-						std::uint32_t to = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (TileSet::DefaultTileSize + 1);
-						pixelsWithPadding[to] = pixelsWithPadding[from];
-					}
+						// Top
+						for (std::uint32_t x = 0; x < TileSet::DefaultTileSize; x++) {
+							std::uint32_t from = yt * widthWithPadding + xt + 1 * widthWithPadding + (x + 1);
+							std::uint32_t to = yt * widthWithPadding + xt + 0 * widthWithPadding + (x + 1);
+							pixelsWithPadding[to] = pixelsWithPadding[from];
+						}
+						// Bottom
+						for (std::uint32_t x = 0; x < TileSet::DefaultTileSize; x++) {
+							std::uint32_t from = yt * widthWithPadding + xt + (TileSet::DefaultTileSize) * widthWithPadding + (x + 1);
+							std::uint32_t to = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding + (x + 1);
+							pixelsWithPadding[to] = pixelsWithPadding[from];
+						}
+						// Left
+						for (std::uint32_t y = 0; y < TileSet::DefaultTileSize; y++) {
+							std::uint32_t from = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (1);
+							std::uint32_t to = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (0);
+							pixelsWithPadding[to] = pixelsWithPadding[from];
+						}
+						// Right
+						for (std::uint32_t y = 0; y < TileSet::DefaultTileSize; y++) {
+							std::uint32_t from = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (TileSet::DefaultTileSize);
+							std::uint32_t to = yt * widthWithPadding + xt + (y + 1) * widthWithPadding + (TileSet::DefaultTileSize + 1);
+							pixelsWithPadding[to] = pixelsWithPadding[from];
+						}
 
-					// Corners (TL, LR, BL, BR)
-					{
-						std::uint32_t from = yt * widthWithPadding + xt + 0 * widthWithPadding + 1;
-						std::uint32_t to = yt * widthWithPadding + xt + 0 * widthWithPadding;
-						pixelsWithPadding[to] = pixelsWithPadding[from];
-					}
-					{
-						std::uint32_t from = yt * widthWithPadding + xt + 0 * widthWithPadding + TileSet::DefaultTileSize;
-						std::uint32_t to = yt * widthWithPadding + xt + 0 * widthWithPadding + (TileSet::DefaultTileSize + 1);
-						pixelsWithPadding[to] = pixelsWithPadding[from];
-					}
-					{
-						std::uint32_t from = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding + 1;
-						std::uint32_t to = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding;
-						pixelsWithPadding[to] = pixelsWithPadding[from];
-					}
-					{
-						std::uint32_t from = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding + TileSet::DefaultTileSize;
-						std::uint32_t to = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding + (TileSet::DefaultTileSize + 1);
-						pixelsWithPadding[to] = pixelsWithPadding[from];
+						// Corners (TL, LR, BL, BR)
+						{
+							std::uint32_t from = yt * widthWithPadding + xt + 0 * widthWithPadding + 1;
+							std::uint32_t to = yt * widthWithPadding + xt + 0 * widthWithPadding;
+							pixelsWithPadding[to] = pixelsWithPadding[from];
+						}
+						{
+							std::uint32_t from = yt * widthWithPadding + xt + 0 * widthWithPadding + TileSet::DefaultTileSize;
+							std::uint32_t to = yt * widthWithPadding + xt + 0 * widthWithPadding + (TileSet::DefaultTileSize + 1);
+							pixelsWithPadding[to] = pixelsWithPadding[from];
+						}
+						{
+							std::uint32_t from = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding + 1;
+							std::uint32_t to = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding;
+							pixelsWithPadding[to] = pixelsWithPadding[from];
+						}
+						{
+							std::uint32_t from = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding + TileSet::DefaultTileSize;
+							std::uint32_t to = yt * widthWithPadding + xt + (TileSet::DefaultTileSize + 1) * widthWithPadding + (TileSet::DefaultTileSize + 1);
+							pixelsWithPadding[to] = pixelsWithPadding[from];
+						}
 					}
 				}
-			}
+			});
 
 			textureDiffuse = std::make_unique<Texture>(fullPath.data(), Texture::Format::RGBA8, widthWithPadding, heightWithPadding);
 			textureDiffuse->loadFromTexels((std::uint8_t*)pixelsWithPadding.get(), 0, 0, widthWithPadding, heightWithPadding);
@@ -1221,12 +1730,14 @@ namespace Jazz2
 				if (_isLoading) {
 					_cachedMetadata.clear();
 					_cachedGraphics.clear();
+					_spriteAtlas.Clear();
 
 					for (std::int32_t i = 0; i < (std::int32_t)FontType::Count; i++) {
 						_fonts[i] = nullptr;
 					}
 				}
 
+				CancelPendingLoads();
 				std::memcpy(_palettes, newPalette, ColorsPerPalette * sizeof(std::uint32_t));
 				RecreateGemPalettes();
 			}
@@ -1297,12 +1808,14 @@ namespace Jazz2
 			if (_isLoading) {
 				_cachedMetadata.clear();
 				_cachedGraphics.clear();
+				_spriteAtlas.Clear();
 
 				for (std::int32_t i = 0; i < (std::int32_t)FontType::Count; i++) {
 					_fonts[i] = nullptr;
 				}
 			}
 
+			CancelPendingLoads();
 			std::memcpy(_palettes, SpritePalette, ColorsPerPalette * sizeof(std::uint32_t));
 			RecreateGemPalettes();
 		}
@@ -1385,8 +1898,8 @@ namespace Jazz2
 	std::unique_ptr<AudioStreamPlayer> ContentResolver::GetMusic(const StringView path)
 	{
 #if defined(WITH_AUDIO)
-		// Don't load sounds in headless mode
-		if (_isHeadless) {
+		// Don't load sounds in headless mode or if audio is disabled
+		if (_isHeadless || !theServiceLocator().GetAudioDevice().isValid()) {
 			return nullptr;
 		}
 
@@ -1447,6 +1960,8 @@ namespace Jazz2
 
 		_precompiledShaders[(std::int32_t)PrecompiledShader::TexturedBackground] = CompileShader("TexturedBackground", Shader::DefaultVertex::SPRITE, Shaders::TexturedBackgroundFs);
 		_precompiledShaders[(std::int32_t)PrecompiledShader::TexturedBackgroundCircle] = CompileShader("TexturedBackgroundCircle", Shader::DefaultVertex::SPRITE, Shaders::TexturedBackgroundCircleFs);
+		_precompiledShaders[(std::int32_t)PrecompiledShader::TileMapChunk] = CompileShader("TileMapChunk", Shaders::TileMapChunkVs, Shaders::TileMapChunkFs);
+		_precompiledShaders[(std::int32_t)PrecompiledShader::TileMapChunkTinted] = CompileShader("TileMapChunkTinted", Shaders::TileMapChunkVs, Shaders::TintedFs);
 
 		_precompiledShaders[(std::int32_t)PrecompiledShader::Colorized] = CompileShader("Colorized", Shader::DefaultVertex::SPRITE, Shaders::ColorizedFs);
 		_precompiledShaders[(std::int32_t)PrecompiledShader::BatchedColorized] = CompileShader("BatchedColorized", Shader::DefaultVertex::BATCHED_SPRITES, Shaders::ColorizedFs, Shader::Introspection::NoUniformsInBlocks);
@@ -1480,6 +1995,10 @@ namespace Jazz2
 		_precompiledShaders[(std::int32_t)PrecompiledShader::BatchedShieldLightning] = CompileShader("BatchedShieldFire", Shaders::BatchedShieldVs, Shaders::ShieldLightningFs, Shader::Introspection::NoUniformsInBlocks);
 		_precompiledShaders[(std::int32_t)PrecompiledShader::ShieldLightning]->registerBatchedShader(*_precompiledShaders[(int32_t)PrecompiledShader::BatchedShieldLightning]);
 
+		_precompiledShaders[(std::int32_t)PrecompiledShader::Palette] = CompileShader("Palette", Shader::DefaultVertex::SPRITE, Shaders::PaletteFs);
+		_precompiledShaders[(std::int32_t)PrecompiledShader::BatchedPalette] = CompileShader("BatchedPalette", Shader::DefaultVertex::BATCHED_SPRITES, Shaders::PaletteFs, Shader::Introspection::NoUniformsInBlocks);
+		_precompiledShaders[(std::int32_t)PrecompiledShader::Palette]->registerBatchedShader(*_precompiledShaders[(int32_t)PrecompiledShader::BatchedPalette]);
+
 #if !defined(DISABLE_RESCALE_SHADERS)
 		_precompiledShaders[(std::int32_t)PrecompiledShader::ResizeHQ2x] = CompileShader("ResizeHQ2x", Shaders::ResizeHQ2xVs, Shaders::ResizeHQ2xFs);
 		_precompiledShaders[(std::int32_t)PrecompiledShader::Resize3xBrz] = CompileShader("Resize3xBrz", Shaders::Resize3xBrzVs, Shaders::Resize3xBrzFs);
@@ -1609,6 +2128,21 @@ namespace Jazz2
 		return shader;
 	}
 
+	Texture* ContentResolver::GetPaletteTexture()
+	{
+		if (_isHeadless) {
+			return nullptr;
+		}
+
+		if (_paletteTexture == nullptr) {
+			_paletteTexture = std::make_unique<Texture>("Palettes", Texture::Format::RGBA8, ColorsPerPalette, PaletteCount);
+			_paletteTexture->loadFromTexels((unsigned char*)_palettes, 0, 0, ColorsPerPalette, PaletteCount);
+			_paletteTexture->setMinFiltering(SamplerFilter::Nearest);
+			_paletteTexture->setMagFiltering(SamplerFilter::Nearest);
+		}
+		return _paletteTexture.get();
+	}
+
 	std::unique_ptr<Texture> ContentResolver::GetNoiseTexture()
 	{
 		std::uint32_t texels[64 * 64];
@@ -1662,6 +2196,11 @@ namespace Jazz2
 				}
 			}
 		}
+
+		if (_paletteTexture != nullptr) {
+			// Indexed sprites read colors directly from the texture, so it must be kept in sync
+			_paletteTexture->loadFromTexels((unsigned char*)_palettes, 0, 0, ColorsPerPalette, PaletteCount);
+		}
 	}
 
 #if defined(DEATH_DEBUG)
@@ -5,6 +5,7 @@
 #include "GameDifficulty.h"
 #include "LevelDescriptor.h"
 #include "Resources.h"
+#include "SpriteAtlas.h"
 #include "WeaponType.h"
 #include "UI/Font.h"
 
@@ -16,6 +17,11 @@
 #include "../nCine/Graphics/Viewport.h"
 #include "../nCine/Base/HashMap.h"
 
+#if defined(WITH_THREADS)
+#	include "../nCine/Threading/ThreadSync.h"
+#endif
+
+#include <Containers/FunctionRef.h>
 #include <Containers/Pair.h>
 #include <Containers/Reference.h>
 #include <Containers/SmallVector.h>
@@ -45,10 +51,15 @@ namespace Jazz2
 		static constexpr std::uint8_t ConfigFile = 4;
 		static constexpr std::uint8_t StateFile = 5;
 		static constexpr std::uint8_t SfxListFile = 6;
+		static constexpr std::uint8_t ScriptByteCodeFile = 7;
 
 		static constexpr std::int32_t PaletteCount = 256;
 		static constexpr std::int32_t ColorsPerPalette = 256;
 		static constexpr std::int32_t InvalidValue = INT_MAX;
+		// Max. time spent by finalizing resources loaded in background per frame
+		static constexpr float PendingLoadsTimeBudget = 2.0f;
+		// Min. number of pixels per group of rows of decoded images processed by one worker thread
+		static constexpr std::int32_t ParallelRowGroupPixels = 64 * 1024;
 
 		static ContentResolver& Get();
 
@@ -72,6 +83,7 @@ namespace Jazz2
 		void EndLoading();
 
 		void PreloadMetadataAsync(const StringView path);
+		void ProcessPendingLoads(float timeBudget = PendingLoadsTimeBudget);
 		Metadata* RequestMetadata(const StringView path);
 		GenericGraphicResource* RequestGraphics(const StringView path, std::uint16_t paletteOffset);
 
@@ -87,6 +99,8 @@ namespace Jazz2
 		Shader* GetShader(PrecompiledShader shader);
 		void CompileShaders();
 		static std::unique_ptr<Texture> GetNoiseTexture();
+		// Returns texture with all palettes used by indexed sprites, it's `nullptr` in headless mode
+		Texture* GetPaletteTexture();
 
 		const std::uint32_t* GetPalettes() const {
 			return _palettes;
@@ -100,6 +114,81 @@ namespace Jazz2
 			}
 		};
 
+		// Graphics decoded to CPU memory, texture is created later on the main thread
+		struct LoadedGraphics
+		{
+			String Path;
+			std::uint16_t PaletteOffset;
+			std::int32_t Width;
+			std::int32_t Height;
+			bool LinearSampling;
+			// Sprite sheet must not be packed into sprite atlas
+			bool Standalone;
+			// Pixels contain palette index and alpha (2 bytes per pixel, rows aligned to 4 bytes)
+			bool Indexed;
+			std::unique_ptr<GenericGraphicResource> Resource;
+			std::unique_ptr<std::uint32_t[]> Pixels;
+			GenericGraphicResource* Base;
+
+			LoadedGraphics(const StringView path, std::uint16_t paletteOffset);
+		};
+
+		struct LoadedAnimation
+		{
+			std::int32_t GraphicsIndex;
+			AnimState State;
+			AnimationLoopMode LoopMode;
+			std::int32_t FrameOffset;
+			// Negative value if not specified, it's taken from graphics then
+			std::int32_t FrameCount;
+			float AnimDuration;
+			bool HasAnimDuration;
+		};
+
+#if defined(WITH_AUDIO)
+		// Sound decoded to PCM samples, audio buffer is created later on the main thread
+		struct LoadedSound
+		{
+			String Key;
+			String Path;
+			std::unique_ptr<unsigned char[]> Samples;
+			unsigned long int SamplesSize;
+			AudioBuffer::Format Format;
+			std::int32_t Frequency;
+		};
+#endif
+
+		struct LoadedMetadata
+		{
+			String Path;
+			Vector2i BoundingBox;
+			SmallVector<LoadedGraphics, 0> Graphics;
+			SmallVector<LoadedAnimation, 0> Animations;
+#if defined(WITH_AUDIO)
+			SmallVector<LoadedSound, 0> Sounds;
+#endif
+		};
+
+#if defined(WITH_THREADS)
+		enum class PendingLoadState
+		{
+			Queued,
+			Running,
+			Done,
+			Cancelled
+		};
+
+		struct PendingMetadata
+		{
+			LoadedMetadata Loaded;
+			PendingLoadState State;
+			std::uint32_t Generation;
+			bool IsValid;
+		};
+
+		class LoadMetadataCommand;
+#endif
+
 		ContentResolver();
 
 		ContentResolver(const ContentResolver&) = delete;
@@ -107,8 +196,35 @@ namespace Jazz2
 
 		void InitializePaths();
 
-		GenericGraphicResource* RequestGraphicsAura(const StringView path, std::uint16_t paletteOffset);
+		bool LoadMetadata(LoadedMetadata& loaded);
+		Metadata* FinalizeMetadata(LoadedMetadata& loaded);
+		GenericGraphicResource* ResolveGraphics(LoadedGraphics& loaded);
+		bool LoadGraphics(LoadedGraphics& loaded);
+		bool LoadGraphicsAura(LoadedGraphics& loaded);
+		GenericGraphicResource* FinalizeGraphics(LoadedGraphics& loaded);
+		void ApplyPaletteAndMask(LoadedGraphics& loaded, std::uint32_t* pixels, bool applyPalette, bool needsMask);
+		void BeginPaletteAndMask(LoadedGraphics& loaded, bool applyPalette, bool needsMask);
+		void ApplyPaletteAndMaskRows(LoadedGraphics& loaded, std::uint32_t* pixels, bool applyPalette, bool needsMask, std::int32_t firstRow, std::int32_t lastRow);
+		void EndPaletteAndMask(LoadedGraphics& loaded, bool needsMask);
+#if defined(WITH_AUDIO)
+		void LoadSound(LoadedSound& loaded);
+#endif
+#if defined(WITH_THREADS)
+		void ExecutePendingMetadata(PendingMetadata& pending);
+		bool TryAcquirePendingMetadata(PendingMetadata& pending);
+#endif
+		void CancelPendingLoads();
+
 		static void ReadImageFromFile(std::unique_ptr<Stream>& s, std::uint8_t* data, std::int32_t width, std::int32_t height, std::int32_t channelCount);
+		// Calls `onRowsDecoded(firstRow, lastRow)` for every group of rows as soon as all its pixels are decoded
+		static void ReadImageFromFile(std::unique_ptr<Stream>& s, std::uint8_t* data, std::int32_t width, std::int32_t height, std::int32_t channelCount,
+			std::int32_t rowsPerGroup, FunctionRef<void(std::int32_t, std::int32_t)> onRowsDecoded);
+		// Decoded groups of rows are processed by worker threads, while the rest of the image is still being decoded
+		static void ReadImageFromFileParallel(std::unique_ptr<Stream>& s, std::uint8_t* data, std::int32_t width, std::int32_t height, std::int32_t channelCount,
+			std::int32_t rowsPerGroup, FunctionRef<void(std::int32_t, std::int32_t)> processRows);
+		static std::int32_t GetIndexedRowStride(std::int32_t width) {
+			return (width * 2 + 3) & ~3;
+		}
 		
 		std::unique_ptr<Shader> CompileShader(const char* shaderName, Shader::DefaultVertex vertex, const char* fragment, Shader::Introspection introspection = Shader::Introspection::Enabled);
 		std::unique_ptr<Shader> CompileShader(const char* shaderName, const char* vertex, const char* fragment, Shader::Introspection introspection = Shader::Introspection::Enabled);
@@ -121,13 +237,22 @@ namespace Jazz2
 		bool _isHeadless;
 		bool _isLoading;
 		std::uint32_t _palettes[PaletteCount * ColorsPerPalette];
+		SpriteAtlas _spriteAtlas;
 		HashMap<Reference<String>, std::unique_ptr<Metadata>, FNV1aHashFunc<String>, StringRefEqualTo> _cachedMetadata;
 		HashMap<Pair<String, std::uint16_t>, std::unique_ptr<GenericGraphicResource>> _cachedGraphics;
 #if defined(WITH_AUDIO)
 		HashMap<String, std::unique_ptr<GenericSoundResource>> _cachedSounds;
+#endif
+#if defined(WITH_THREADS)
+		HashMap<String, std::shared_ptr<PendingMetadata>> _pendingMetadata;
+		Mutex _pendingMutex;
+		CondVariable _pendingCV;
+		std::uint32_t _pendingGeneration;
+		std::int32_t _pendingRunningCount;
 #endif
 		std::unique_ptr<UI::Font> _fonts[(int32_t)FontType::Count];
 		std::unique_ptr<Shader> _precompiledShaders[(int32_t)PrecompiledShader::Count];
+		std::unique_ptr<Texture> _paletteTexture;
 #if !defined(DEATH_TARGET_EMSCRIPTEN)
 		SmallVector<std::unique_ptr<PakFile>> _mountedPaks;
 #endif
@@ -9,7 +9,7 @@
 namespace Jazz2::Events
 {
 	EventMap::EventMap(const Vector2i& layoutSize)
-		: _levelHandler(nullptr), _layoutSize(layoutSize), _pitType(PitType::FallForever)
+		: _levelHandler(nullptr), _layoutSize(layoutSize), _pitType(PitType::FallForever), _generatorTime(0.0), _eventIndexDirty(true)
 	{
 	}
 
@@ -91,6 +91,11 @@ namespace Jazz2::Events
 				}
 			}
 		}
+
+		// Some events could be restored or deactivated, so all zones have to be checked again
+		_eventIndexDirty = true;
+		InvalidateActivationZones();
+		SyncActiveGenerators();
 	}
 
 	void EventMap::StoreTileEvent(std::int32_t x, std::int32_t y, EventType eventType, Actors::ActorState eventFlags, std::uint8_t* tileParams)
@@ -100,6 +105,14 @@ namespace Jazz2::Events
 		}
 
 		EventTile& previousEvent = _eventLayout[x + y * _layoutSize.X];
+		if (previousEvent.Event == EventType::Empty && eventType != EventType::Empty && !_eventIndexDirty) {
+			_pendingEventTiles.push_back(x + y * _layoutSize.X);
+		}
+
+		std::uint32_t prevGeneratorIdx = UINT32_MAX;
+		if (previousEvent.Event == EventType::Generator && eventType != EventType::Generator) {
+			prevGeneratorIdx = *(std::uint32_t*)previousEvent.EventParams;
+		}
 
 		EventTile newEvent = { };
 		newEvent.Event = eventType,
@@ -112,43 +125,66 @@ namespace Jazz2::Events
 		}
 
 		previousEvent = newEvent;
+
+		// Empty tiles are never activated, so activation zones don't have to check them again
+		if (!newEvent.IsEventActive && eventType != EventType::Empty) {
+			InvalidateActivationZones(x, y);
+		}
+		if (prevGeneratorIdx < _generators.size() && _generators[prevGeneratorIdx].EventPos == x + y * _layoutSize.X) {
+			SetGeneratorActive(prevGeneratorIdx, false);
+		}
 	}
 
 	void EventMap::PreloadEventsAsync()
 	{
 		ZoneScopedC(0x9D5BA3);
 
-		auto eventSpawner = _levelHandler->EventSpawner();
+		struct PreloadEntry {
+			EventType Event;
+			std::uint8_t* EventParams;
+		};
 
-		// TODO
-		//ContentResolver::Get().SuspendAsync();
+		// Most events are placed many times with the same parameters, so each unique combination is preloaded only once
+		SmallVector<PreloadEntry, 0> entries;
+		entries.reserve(_generators.size() + 64);
 
-		// Preload all events
 		for (auto& tile : _eventLayout) {
 			// TODO: Exclude also some modifiers here ?
 			if (tile.Event != EventType::Empty && tile.Event != EventType::Generator && tile.Event != EventType::AreaWeather) {
-				eventSpawner->PreloadEvent(tile.Event, tile.EventParams);
+				entries.push_back({ tile.Event, tile.EventParams });
 			}
 		}
 
-		// Preload all generators
 		for (auto& generator : _generators) {
-			eventSpawner->PreloadEvent(generator.Event, generator.EventParams);
+			entries.push_back({ generator.Event, generator.EventParams });
 		}
 
-		// Don't wait for finalization of resources, it will be done in a few next frames
-		//ContentResolver::Get().ResumeAsync();
+		std::sort(entries.begin(), entries.end(), [](const PreloadEntry& a, const PreloadEntry& b) {
+			return (a.Event != b.Event ? a.Event < b.Event : std::memcmp(a.EventParams, b.EventParams, EventSpawner::SpawnParamsSize) < 0);
+		});
+
+		auto eventSpawner = _levelHandler->EventSpawner();
+
+		// Metadata are loaded by worker threads, so don't wait for finalization of resources, it will be done in a few next frames
+		for (std::size_t i = 0; i < entries.size(); i++) {
+			if (i > 0 && entries[i].Event == entries[i - 1].Event &&
+				std::memcmp(entries[i].EventParams, entries[i - 1].EventParams, EventSpawner::SpawnParamsSize) == 0) {
+				continue;
+			}
+			eventSpawner->PreloadEvent(entries[i].Event, entries[i].EventParams);
+		}
 	}
 
 	void EventMap::ProcessGenerators(float timeMult)
 	{
 		ZoneScopedC(0x9D5BA3);
 
-		for (auto& generator : _generators) {
-			if (!_eventLayout[generator.EventPos].IsEventActive) {
-				// Generator is inactive (and recharging)
-				generator.TimeLeft -= timeMult;
-			} else if (generator.SpawnedActor == nullptr || generator.SpawnedActor->GetHealth() <= 0) {
+		// Inactive generators are not processed at all, elapsed time is applied to them when they are activated again
+		_generatorTime += timeMult;
+
+		for (std::size_t i = 0; i < _activeGenerators.size(); i++) {
+			auto& generator = _generators[_activeGenerators[i]];
+			if (generator.SpawnedActor == nullptr || generator.SpawnedActor->GetHealth() <= 0) {
 				if (generator.TimeLeft <= 0.0f) {
 					// Generator is active and is ready to spawn new actor
 					generator.TimeLeft = generator.Delay * FrameTimer::FramesPerSecond;
@@ -176,39 +212,76 @@ namespace Jazz2::Events
 	{
 		ZoneScopedC(0x9D5BA3);
 
+		UpdateEventIndex();
+
 		std::int32_t x1 = std::max(0, tx1);
 		std::int32_t x2 = std::min(_layoutSize.X - 1, tx2);
 		std::int32_t y1 = std::max(0, ty1);
 		std::int32_t y2 = std::min(_layoutSize.Y - 1, ty2);
 
-		for (std::int32_t x = x1; x <= x2; x++) {
-			for (std::int32_t y = y1; y <= y2; y++) {
-				auto& tile = _eventLayout[x + y * _layoutSize.X];
-				if (!tile.IsEventActive && tile.Event != EventType::Empty) {
-					tile.IsEventActive = true;
+		ActivateEventsInRect(x1, y1, x2, y2, allowAsync);
+	}
 
-					if (tile.Event == EventType::AreaWeather) {
-						_levelHandler->SetWeather((WeatherType)tile.EventParams[0], tile.EventParams[1]);
-					} else if (tile.Event != EventType::Generator) {
-						Actors::ActorState flags = Actors::ActorState::IsCreatedFromEventMap | tile.EventFlags;
-						if (allowAsync) {
-							flags |= Actors::ActorState::Async;
-						}
+	void EventMap::ActivateEventsInZone(std::int32_t zoneIndex, const AABBi& zone, bool allowAsync)
+	{
+		ZoneScopedC(0x9D5BA3);
 
-						std::shared_ptr<Actors::ActorBase> actor = _levelHandler->EventSpawner()->SpawnEvent(tile.Event, tile.EventParams, flags, x, y, ILevelHandler::SpritePlaneZ);
-						if (actor != nullptr) {
-							_levelHandler->AddActor(actor);
-						}
-					}
-				}
-			}
+		UpdateEventIndex();
+
+		if (zoneIndex >= (std::int32_t)_activationZones.size()) {
+			_activationZones.resize(zoneIndex + 1, ActivationZone{ AABBi(), false });
+		}
+
+		AABBi newZone(std::max(0, zone.L), std::max(0, zone.T), std::min(_layoutSize.X - 1, zone.R), std::min(_layoutSize.Y - 1, zone.B));
+		ActivationZone& activationZone = _activationZones[zoneIndex];
+		if (newZone.L > newZone.R || newZone.T > newZone.B) {
+			activationZone.IsValid = false;
+			return;
+		}
+
+		AABBi prevZone = activationZone.Zone;
+		bool wasValid = (activationZone.IsValid && prevZone.Overlaps(newZone));
+
+		// Zone is updated before spawning, so it can be invalidated by events deactivated in the meantime
+		activationZone.Zone = newZone;
+		activationZone.IsValid = true;
+
+		if (!wasValid) {
+			ActivateEventsInRect(newZone.L, newZone.T, newZone.R, newZone.B, allowAsync);
+			return;
+		}
+
+		// All events in the previous zone are still active, so only newly exposed strips have to be checked
+		if (newZone.T < prevZone.T) {
+			ActivateEventsInRect(newZone.L, newZone.T, newZone.R, prevZone.T - 1, allowAsync);
+		}
+		if (newZone.B > prevZone.B) {
+			ActivateEventsInRect(newZone.L, prevZone.B + 1, newZone.R, newZone.B, allowAsync);
+		}
+
+		std::int32_t y1 = std::max(newZone.T, prevZone.T);
+		std::int32_t y2 = std::min(newZone.B, prevZone.B);
+		if (newZone.L < prevZone.L) {
+			ActivateEventsInRect(newZone.L, y1, prevZone.L - 1, y2, allowAsync);
+		}
+		if (newZone.R > prevZone.R) {
+			ActivateEventsInRect(prevZone.R + 1, y1, newZone.R, y2, allowAsync);
 		}
 	}
 
 	void EventMap::Deactivate(std::int32_t x, std::int32_t y)
 	{
 		if (HasEventByPosition(x, y)) {
-			_eventLayout[x + y * _layoutSize.X].IsEventActive = false;
+			auto& tile = _eventLayout[x + y * _layoutSize.X];
+			tile.IsEventActive = false;
+			InvalidateActivationZones(x, y);
+
+			if (tile.Event == EventType::Generator) {
+				std::uint32_t generatorIdx = *(std::uint32_t*)tile.EventParams;
+				if (generatorIdx < _generators.size()) {
+					SetGeneratorActive(generatorIdx, false);
+				}
+			}
 		}
 	}
 
@@ -350,7 +423,9 @@ namespace Jazz2::Events
 						generator.Event = (EventType)eventType;
 						std::memcpy(generator.EventParams, eventParams, sizeof(eventParams));
 						generator.Delay = generatorDelay;
+						generator.IsActive = false;
 						generator.TimeLeft = timeLeft;
+						generator.InactiveSince = _generatorTime;
 
 						*(std::uint32_t*)eventParams = generatorIdx;
 						StoreTileEvent(x, y, EventType::Generator, actorFlags, eventParams);
@@ -437,6 +512,10 @@ namespace Jazz2::Events
 			tile.EventFlags = (Actors::ActorState)src.ReadVariableUint32();
 			src.Read(tile.EventParams, sizeof(tile.EventParams));
 		}
+
+		_eventIndexDirty = true;
+		InvalidateActivationZones();
+		SyncActiveGenerators();
 	}
 
 	void EventMap::SerializeResumableToStream(Stream& dest)
@@ -450,4 +529,143 @@ namespace Jazz2::Events
 			dest.Write(tile.EventParams, sizeof(tile.EventParams)); // TODO: Optimize this
 		}
 	}
+
+	void EventMap::RebuildEventIndex()
+	{
+		ZoneScopedC(0x9D5BA3);
+
+		_rowEventOffsets.resize(_layoutSize.Y + 1);
+		_rowEventColumns.clear();
+
+		for (std::int32_t y = 0; y < _layoutSize.Y; y++) {
+			_rowEventOffsets[y] = (std::int32_t)_rowEventColumns.size();
+			const EventTile* row = &_eventLayout[y * _layoutSize.X];
+			for (std::int32_t x = 0; x < _layoutSize.X; x++) {
+				if (row[x].Event != EventType::Empty) {
+					_rowEventColumns.push_back(x);
+				}
+			}
+		}
+		_rowEventOffsets[_layoutSize.Y] = (std::int32_t)_rowEventColumns.size();
+
+		_pendingEventTiles.clear();
+		_eventIndexDirty = false;
+	}
+
+	void EventMap::UpdateEventIndex()
+	{
+		if (_eventIndexDirty) {
+			RebuildEventIndex();
+			return;
+		}
+
+		// Only a few events are added at runtime, so they are inserted directly instead of rebuilding the whole index
+		for (std::int32_t pos : _pendingEventTiles) {
+			std::int32_t x = pos % _layoutSize.X;
+			std::int32_t y = pos / _layoutSize.X;
+			auto begin = _rowEventColumns.begin() + _rowEventOffsets[y];
+			auto end = _rowEventColumns.begin() + _rowEventOffsets[y + 1];
+			auto it = std::lower_bound(begin, end, x);
+			if (it != end && *it == x) {
+				// The tile was emptied earlier, but it's still in the index
+				continue;
+			}
+
+			_rowEventColumns.insert(it, x);
+			for (std::int32_t i = y + 1; i <= _layoutSize.Y; i++) {
+				_rowEventOffsets[i]++;
+			}
+		}
+		_pendingEventTiles.clear();
+	}
+
+	void EventMap::ActivateEventsInRect(std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, bool allowAsync)
+	{
+		// The index is not rebuilt here, events stored during spawning will be picked up in the next call
+		for (std::int32_t y = y1; y <= y2; y++) {
+			const std::int32_t* begin = _rowEventColumns.data() + _rowEventOffsets[y];
+			const std::int32_t* end = _rowEventColumns.data() + _rowEventOffsets[y + 1];
+			for (const std::int32_t* it = std::lower_bound(begin, end, x1); it != end && *it <= x2; ++it) {
+				ActivateEventTile(*it, y, allowAsync);
+			}
+		}
+	}
+
+	void EventMap::ActivateEventTile(std::int32_t x, std::int32_t y, bool allowAsync)
+	{
+		auto& tile = _eventLayout[x + y * _layoutSize.X];
+		if (tile.IsEventActive || tile.Event == EventType::Empty) {
+			return;
+		}
+
+		tile.IsEventActive = true;
+
+		if (tile.Event == EventType::AreaWeather) {
+			_levelHandler->SetWeather((WeatherType)tile.EventParams[0], tile.EventParams[1]);
+		} else if (tile.Event == EventType::Generator) {
+			std::uint32_t generatorIdx = *(std::uint32_t*)tile.EventParams;
+			if (generatorIdx < _generators.size()) {
+				SetGeneratorActive(generatorIdx, true);
+			}
+		} else {
+			Actors::ActorState flags = Actors::ActorState::IsCreatedFromEventMap | tile.EventFlags;
+			if (allowAsync) {
+				flags |= Actors::ActorState::Async;
+			}
+
+			std::shared_ptr<Actors::ActorBase> actor = _levelHandler->EventSpawner()->SpawnEvent(tile.Event, tile.EventParams, flags, x, y, ILevelHandler::SpritePlaneZ);
+			if (actor != nullptr) {
+				_levelHandler->AddActor(actor);
+			}
+		}
+	}
+
+	void EventMap::InvalidateActivationZones()
+	{
+		for (auto& activationZone : _activationZones) {
+			activationZone.IsValid = false;
+		}
+	}
+
+	void EventMap::InvalidateActivationZones(std::int32_t x, std::int32_t y)
+	{
+		// Deactivated event must be checked again by all zones that already covered it
+		for (auto& activationZone : _activationZones) {
+			if (activationZone.IsValid && activationZone.Zone.Contains(x, y)) {
+				activationZone.IsValid = false;
+			}
+		}
+	}
+
+	void EventMap::SetGeneratorActive(std::uint32_t generatorIdx, bool active)
+	{
+		GeneratorInfo& generator = _generators[generatorIdx];
+		if (generator.IsActive == active) {
+			return;
+		}
+
+		generator.IsActive = active;
+
+		if (active) {
+			// Generator was recharging while it was inactive
+			generator.TimeLeft -= (float)(_generatorTime - generator.InactiveSince);
+			_activeGenerators.push_back(generatorIdx);
+		} else {
+			generator.InactiveSince = _generatorTime;
+			for (std::size_t i = 0; i < _activeGenerators.size(); i++) {
+				if (_activeGenerators[i] == generatorIdx) {
+					_activeGenerators[i] = _activeGenerators.back();
+					_activeGenerators.pop_back();
+					break;
+				}
+			}
+		}
+	}
+
+	void EventMap::SyncActiveGenerators()
+	{
+		for (std::uint32_t i = 0; i < (std::uint32_t)_generators.size(); i++) {
+			SetGeneratorActive(i, _eventLayout[_generators[i].EventPos].IsEventActive);
+		}
+	}
 }
\ No newline at end of file
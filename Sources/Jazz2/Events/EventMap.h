@@ -41,6 +41,8 @@ namespace Jazz2::Events
 
 		void ProcessGenerators(float timeMult);
 		void ActivateEvents(std::int32_t tx1, std::int32_t ty1, std::int32_t tx2, std::int32_t ty2, bool allowAsync);
+		/// Activates events in a zone that moves over time (e.g., around a player), only newly exposed tiles are checked
+		void ActivateEventsInZone(std::int32_t zoneIndex, const AABBi& zone, bool allowAsync);
 		void Deactivate(std::int32_t x, std::int32_t y);
 		void ResetGenerator(std::int32_t tx, std::int32_t ty);
 
@@ -65,11 +67,18 @@ namespace Jazz2::Events
 			EventType Event;
 			std::uint8_t EventParams[EventSpawner::SpawnParamsSize];
 			std::uint8_t Delay;
+			bool IsActive;
 			float TimeLeft;
+			double InactiveSince;
 
 			std::shared_ptr<Actors::ActorBase> SpawnedActor;
 		};
 
+		struct ActivationZone {
+			AABBi Zone;
+			bool IsValid;
+		};
+
 		struct SpawnPoint {
 			std::uint8_t PlayerTypeMask;
 			Vector2f Pos;
@@ -86,7 +95,25 @@ namespace Jazz2::Events
 		SmallVector<EventTile, 0> _eventLayout;
 		SmallVector<EventTile, 0> _eventLayoutForRollback;
 		SmallVector<GeneratorInfo, 0> _generators;
+		SmallVector<std::uint32_t, 0> _activeGenerators;
 		SmallVector<SpawnPoint, 0> _spawnPoints;
 		SmallVector<WarpTarget, 0> _warpTargets;
+		// Sorted columns of all non-empty event tiles, grouped by rows, tiles that became empty are kept there
+		SmallVector<std::int32_t, 0> _rowEventOffsets;
+		SmallVector<std::int32_t, 0> _rowEventColumns;
+		// Tiles that became non-empty and have to be inserted to the index before the next activation
+		SmallVector<std::int32_t, 0> _pendingEventTiles;
+		SmallVector<ActivationZone, 0> _activationZones;
+		double _generatorTime;
+		bool _eventIndexDirty;
+
+		void RebuildEventIndex();
+		void UpdateEventIndex();
+		void ActivateEventsInRect(std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, bool allowAsync);
+		void ActivateEventTile(std::int32_t x, std::int32_t y, bool allowAsync);
+		void InvalidateActivationZones();
+		void InvalidateActivationZones(std::int32_t x, std::int32_t y);
+		void SetGeneratorActive(std::uint32_t generatorIdx, bool active);
+		void SyncActiveGenerators();
 	};
 }
\ No newline at end of file
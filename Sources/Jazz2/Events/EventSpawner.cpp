@@ -219,7 +219,7 @@ namespace Jazz2::Events
 	void EventSpawner::RegisterSpawnable(EventType type)
 	{
 		_spawnableEvents[type] = { [](const ActorActivationDetails& details) -> std::shared_ptr<ActorBase> {
-			std::shared_ptr<ActorBase> actor = std::make_shared<T>();
+			std::shared_ptr<ActorBase> actor = CreateActor<T>();
 			actor->OnActivated(details);
 			return actor;
 		}, T::Preload };
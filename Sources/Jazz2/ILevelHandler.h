@@ -9,6 +9,8 @@
 #include "../nCine/Audio/AudioBufferPlayer.h"
 
 #include <Base/TypeInfo.h>
+#include <Containers/FunctionRef.h>
+#include <Containers/SmallVector.h>
 
 namespace Death::IO
 {
@@ -35,6 +37,41 @@ namespace Jazz2
 		class Player;
 	}
 
+	// Result of a ray-cast query
+	struct RayCastResult
+	{
+		// Point where the ray was stopped, or end of the ray if nothing was hit
+		Vector2f Point;
+		// Fraction of the ray where it was stopped, 1.0 if nothing was hit
+		float Fraction;
+		// Actor that stopped the ray, nullptr if a tile was hit or nothing was hit
+		Actors::ActorBase* Actor;
+	};
+
+	// Type of a side effect deferred from parallel update of actors
+	enum class DeferredCommandType
+	{
+		// Plays sound `Identifier` of `Actor` with `Gain` and `Pitch`
+		PlaySfx,
+		// Creates explosion of type `Param` at `Pos`
+		CreateExplosion,
+		// Decreases health of `Actor` by `Param`
+		DecreaseHealth
+	};
+
+	// Side effect deferred from parallel update of actors, only fields used by the command type have to be set
+	struct DeferredCommand
+	{
+		DeferredCommandType Type;
+		Actors::ActorBase* Actor;
+		// Must stay valid until the end of the frame
+		StringView Identifier;
+		Vector3i Pos;
+		std::int32_t Param;
+		float Gain;
+		float Pitch;
+	};
+
 	class ILevelHandler
 	{
 		DEATH_RUNTIME_OBJECT();
@@ -67,6 +104,13 @@ namespace Jazz2
 		virtual void SetAmbientLight(Actors::Player* player, float value) = 0;
 
 		virtual void AddActor(std::shared_ptr<Actors::ActorBase> actor) = 0;
+		// Returns the actor referenced by the handle, or nullptr if the actor was already destroyed
+		virtual Actors::ActorBase* ResolveActor(Actors::ActorHandle handle) const = 0;
+
+		// Returns true if called from parallel update of actors, side effects have to be deferred by `InvokeDeferred()` then
+		virtual bool IsUpdatingInParallel() const = 0;
+		// Invokes the command after parallel update in deterministic order, or immediately if not called from parallel update
+		virtual void InvokeDeferred(const DeferredCommand& command) = 0;
 
 		virtual std::shared_ptr<AudioBufferPlayer> PlaySfx(Actors::ActorBase* self, const StringView identifier, AudioBuffer* buffer, const Vector3f& pos, bool sourceRelative, float gain = 1.0f, float pitch = 1.0f) = 0;
 		virtual std::shared_ptr<AudioBufferPlayer> PlayCommonSfx(const StringView identifier, const Vector3f& pos, float gain = 1.0f, float pitch = 1.0f) = 0;
@@ -79,9 +123,22 @@ namespace Jazz2
 			return IsPositionEmpty(self, aabb, params, &collider);
 		}
 
-		virtual void FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, const std::function<bool(Actors::ActorBase*)>& callback) = 0;
-		virtual void FindCollisionActorsByRadius(float x, float y, float radius, const std::function<bool(Actors::ActorBase*)>& callback) = 0;
-		virtual void GetCollidingPlayers(const AABBf& aabb, const std::function<bool(Actors::ActorBase*)> callback) = 0;
+		// Same as `IsPositionEmpty()`, but only `candidates` are checked instead of querying all actors, they should be found by `FindCollisionActorsByAABBs()`
+		virtual bool IsPositionEmpty(Actors::ActorBase* self, const AABBf& aabb, Tiles::TileCollisionParams& params, ArrayView<Actors::ActorBase* const> candidates) = 0;
+
+		virtual void FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback) = 0;
+		virtual void FindCollisionActorsByRadius(float x, float y, float radius, FunctionRef<bool(Actors::ActorBase*)> callback) = 0;
+		virtual void GetCollidingPlayers(const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback) = 0;
+		// Actors colliding with `aabbs[i]` are stored in `result` at indices from `offsets[i]` to `offsets[i + 1]`, so `offsets` must have one more item than `aabbs`
+		virtual void FindCollisionActorsByAABBs(Actors::ActorBase* self, ArrayView<const AABBf> aabbs, SmallVectorImpl<Actors::ActorBase*>& result, ArrayView<std::uint32_t> offsets) = 0;
+		// Casts a ray against tiles and actors that have all `actorFilter` flags set (no actors are hit if it's `None`), returns true if the ray was stopped
+		virtual bool CastRay(Actors::ActorBase* self, const Vector2f& from, const Vector2f& to, Actors::ActorState actorFilter, RayCastResult& result) = 0;
+
+		bool IsInLineOfSight(const Vector2f& from, const Vector2f& to)
+		{
+			RayCastResult result;
+			return !CastRay(nullptr, from, to, Actors::ActorState::None, result);
+		}
 
 		virtual void BroadcastTriggeredEvent(Actors::ActorBase* initiator, EventType eventType, std::uint8_t* eventParams) = 0;
 		virtual void BeginLevelChange(Actors::ActorBase* initiator, ExitType exitType, const StringView nextLevel = {}) = 0;
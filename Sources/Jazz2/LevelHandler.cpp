@@ -25,6 +25,7 @@
 #include "../nCine/Graphics/RenderQueue.h"
 #include "../nCine/Audio/AudioReaderMpt.h"
 
+#include "Actors/Explosion.h"
 #include "Actors/Player.h"
 #include "Actors/SolidObjectBase.h"
 #include "Actors/Enemies/Bosses/BossBase.h"
@@ -48,70 +49,51 @@ namespace Jazz2
 
 	using namespace Jazz2::Resources;
 
-#if defined(WITH_AUDIO)
-	class AudioBufferPlayerForSplitscreen : public AudioBufferPlayer
-	{
-		DEATH_RUNTIME_OBJECT(AudioBufferPlayer);
-
-	public:
-		explicit AudioBufferPlayerForSplitscreen(AudioBuffer* audioBuffer, ArrayView<std::unique_ptr<PlayerViewport>> viewports);
-
-		Vector3f getAdjustedPosition(IAudioDevice& device, const Vector3f& pos, bool isSourceRelative, bool isAs2D) override;
-
-		void updatePosition();
-		void updateViewports(ArrayView<std::unique_ptr<PlayerViewport>> viewports);
-
-	private:
-		ArrayView<std::unique_ptr<PlayerViewport>> _viewports;
-	};
-
-	AudioBufferPlayerForSplitscreen::AudioBufferPlayerForSplitscreen(AudioBuffer* audioBuffer, ArrayView<std::unique_ptr<PlayerViewport>> viewports)
-		: AudioBufferPlayer(audioBuffer), _viewports(viewports)
+	namespace
 	{
-	}
+		// Command buffer of the batch that is currently updated in parallel by this thread
+		DEATH_THREAD_LOCAL SmallVectorImpl<DeferredCommand>* CurrentDeferredCommands = nullptr;
 
-	Vector3f AudioBufferPlayerForSplitscreen::getAdjustedPosition(IAudioDevice& device, const Vector3f& pos, bool isSourceRelative, bool isAs2D)
-	{
-		if (isSourceRelative || isAs2D) {
-			return AudioBufferPlayer::getAdjustedPosition(device, pos, isSourceRelative, isAs2D);
-		}
-
-		std::size_t minIndex = 0;
-		float minDistance = FLT_MAX;
-
-		for (std::size_t i = 0; i < _viewports.size(); i++) {
-			float distance = (pos.ToVector2() - _viewports[i]->_cameraPos).SqrLength();
-			if (minDistance > distance) {
-				minDistance = distance;
-				minIndex = i;
+		// Returns fraction of the ray where it enters the AABB (slab test), or -1.0 if the ray misses it
+		float IntersectRayWithAABB(const Vector2f& from, const Vector2f& dir, float maxFraction, const AABBf& aabb)
+		{
+			float tMin = 0.0f;
+			float tMax = maxFraction;
+
+			for (std::int32_t i = 0; i < 2; i++) {
+				float origin = (i == 0 ? from.X : from.Y);
+				float d = (i == 0 ? dir.X : dir.Y);
+				float lower = (i == 0 ? aabb.L : aabb.T);
+				float upper = (i == 0 ? aabb.R : aabb.B);
+
+				if (std::abs(d) < FLT_EPSILON) {
+					if (origin < lower || origin > upper) {
+						return -1.0f;
+					}
+				} else {
+					float t1 = (lower - origin) / d;
+					float t2 = (upper - origin) / d;
+					if (t1 > t2) {
+						std::swap(t1, t2);
+					}
+					tMin = std::max(tMin, t1);
+					tMax = std::min(tMax, t2);
+					if (tMin > tMax) {
+						return -1.0f;
+					}
+				}
 			}
-		}
 
-		Vector3f relativePos = (pos - Vector3f(_viewports[minIndex]->_cameraPos, 0.0f));
-		return AudioBufferPlayer::getAdjustedPosition(device, relativePos, false, false);
-	}
-
-	void AudioBufferPlayerForSplitscreen::updatePosition()
-	{
-		if (state_ != PlayerState::Playing || GetFlags(PlayerFlags::SourceRelative) || GetFlags(PlayerFlags::As2D)) {
-			return;
+			return tMin;
 		}
-
-		IAudioDevice& device = theServiceLocator().GetAudioDevice();
-		setPositionInternal(getAdjustedPosition(device, position_, false, false));
 	}
 
-	void AudioBufferPlayerForSplitscreen::updateViewports(ArrayView<std::unique_ptr<PlayerViewport>> viewports)
-	{
-		_viewports = viewports;
-	}
-#endif
-
 	LevelHandler::LevelHandler(IRootController* root)
 		: _root(root), _lightingShader(nullptr), _blurShader(nullptr), _downsampleShader(nullptr), _combineShader(nullptr), _combineWithWaterShader(nullptr),
 			_eventSpawner(this), _difficulty(GameDifficulty::Default), _isReforged(false), _cheatsUsed(false), _checkpointCreated(false),
 			_cheatsBufferLength(0), _nextLevelType(ExitType::None), _nextLevelTime(0.0f), _elapsedFrames(0.0f), _checkpointFrames(0.0f),
-			_waterLevel(FLT_MAX), _weatherType(WeatherType::None), _pressedKeys(ValueInit, (std::size_t)KeySym::COUNT), _overrideActions(0)
+			_waterLevel(FLT_MAX), _weatherType(WeatherType::None), _pressedKeys(ValueInit, (std::size_t)KeySym::COUNT), _overrideActions(0),
+			_emittedLightsFrame(UINT32_MAX)
 	{
 	}
 
@@ -210,7 +192,7 @@ namespace Jazz2
 		_players.reserve(playerCount);
 
 		for (std::uint32_t i = 0; i < playerCount; i++) {
-			std::shared_ptr<Actors::Player> player = std::make_shared<Actors::Player>();
+			std::shared_ptr<Actors::Player> player = Actors::CreateActor<Actors::Player>();
 			player->InitializeFromStream(this, src);
 
 			Actors::Player* ptr = player.get();
@@ -423,7 +405,7 @@ namespace Jazz2
 				}
 			}
 
-			std::shared_ptr<Actors::Player> player = std::make_shared<Actors::Player>();
+			std::shared_ptr<Actors::Player> player = Actors::CreateActor<Actors::Player>();
 			std::uint8_t playerParams[2] = { (std::uint8_t)levelInit.PlayerCarryOvers[i].Type, (std::uint8_t)i };
 			player->OnActivated(Actors::ActorActivationDetails(
 				this,
@@ -469,49 +451,53 @@ namespace Jazz2
 			}
 		}
 
-		auto it = _playingSounds.begin();
-		while (it != _playingSounds.end()) {
-			if ((*it)->isStopped()) {
-				it = _playingSounds.eraseUnordered(it);
-				continue;
-			}
-			++it;
-		}
 #endif
 
-		if (!IsPausable() || _pauseMenu == nullptr) {
-			if (_nextLevelType != ExitType::None) {
-				_nextLevelTime -= timeMult;
-				ProcessQueuedNextLevel();
-			}
+		BeginFrameUpdate(timeMult, [](FramePhase) { });
+	}
 
-			ProcessEvents(timeMult);
-			ProcessWeather(timeMult);
+	void LevelHandler::BeginFrameUpdate(float timeMult, FunctionRef<void(FramePhase)> onPhaseEnd)
+	{
+		if (IsPausable() && _pauseMenu != nullptr) {
+			return;
+		}
 
-			// Active Boss
-			if (_activeBoss != nullptr && _activeBoss->GetHealth() <= 0) {
-				_activeBoss = nullptr;
-				BeginLevelChange(nullptr, ExitType::Boss);
-			}
+		if (_nextLevelType != ExitType::None) {
+			_nextLevelTime -= timeMult;
+			ProcessQueuedNextLevel();
+		}
+
+		ProcessEvents(timeMult);
+		ProcessWeather(timeMult);
+
+		// Active Boss
+		if (_activeBoss != nullptr && _activeBoss->GetHealth() <= 0) {
+			_activeBoss = nullptr;
+			BeginLevelChange(nullptr, ExitType::Boss);
+		}
+		onPhaseEnd(FramePhase::Events);
 
 #if defined(WITH_ANGELSCRIPT)
-			if (_scripts != nullptr) {
-				_scripts->OnLevelUpdate(timeMult);
-			}
+		if (_scripts != nullptr) {
+			_scripts->OnLevelUpdate(timeMult);
+		}
 #endif
+		onPhaseEnd(FramePhase::Scripts);
+
+		if (_rootNode->isUpdateEnabled()) {
+			UpdateActorsInParallel(timeMult);
 		}
+		onPhaseEnd(FramePhase::Actors);
 	}
 
-	void LevelHandler::OnEndFrame()
+	void LevelHandler::EndFrameUpdate(float timeMult, FunctionRef<void(FramePhase)> onPhaseEnd)
 	{
-		ZoneScopedC(0x4876AF);
-
-		float timeMult = theApplication().GetTimeMult();
-
 		_tileMap->OnEndFrame();
+		onPhaseEnd(FramePhase::TileMap);
 
 		if (!IsPausable() || _pauseMenu == nullptr) {
 			ResolveCollisions(timeMult);
+			onPhaseEnd(FramePhase::Collisions);
 
 #if defined(NCINE_HAS_GAMEPAD_RUMBLE)
 			_rumble.OnEndFrame(timeMult);
@@ -530,15 +516,11 @@ namespace Jazz2
 						Vector3f(_assignedViewports[0]->_targetPlayer->GetSpeed(), 0.0f));
 				} else {
 					audioDevice.updateListener(Vector3f::Zero, Vector3f::Zero);
-
-					// All audio players must be updated to the nearest listener
-					for (auto& current : _playingSounds) {
-						if (auto* current2 = runtime_cast<AudioBufferPlayerForSplitscreen*>(current)) {
-							current2->updatePosition();
-						}
-					}
 				}
 			}
+
+			// Advance virtual voices and update sound effects to the nearest listener in split-screen
+			_voices.OnEndFrame(timeMult);
 #endif
 
 			_elapsedFrames += timeMult;
@@ -547,6 +529,16 @@ namespace Jazz2
 		for (auto& viewport : _assignedViewports) {
 			viewport->OnEndFrame();
 		}
+		onPhaseEnd(FramePhase::Other);
+	}
+
+	void LevelHandler::OnEndFrame()
+	{
+		ZoneScopedC(0x4876AF);
+
+		float timeMult = theApplication().GetTimeMult();
+
+		EndFrameUpdate(timeMult, [](FramePhase) { });
 
 #if defined(DEATH_DEBUG) && defined(WITH_IMGUI)
 		if (PreferencesCache::ShowPerformanceMetrics) {
@@ -601,8 +593,8 @@ namespace Jazz2
 		if (notInitialized) {
 			LOGI("Acquiring required shaders");
 
-			_lightingShader = resolver.GetShader(PrecompiledShader::Lighting);
-			if (_lightingShader == nullptr) { LOGW("PrecompiledShader::Lighting failed"); }
+			_lightingShader = resolver.GetShader(PrecompiledShader::BatchedLighting);
+			if (_lightingShader == nullptr) { LOGW("PrecompiledShader::BatchedLighting failed"); }
 			_blurShader = resolver.GetShader(PrecompiledShader::Blur);
 			if (_blurShader == nullptr) { LOGW("PrecompiledShader::Blur failed"); }
 			_downsampleShader = resolver.GetShader(PrecompiledShader::Downsample);
@@ -794,28 +786,49 @@ namespace Jazz2
 			actor->CollisionProxyID = _collisions.CreateProxy(actor->AABB, actor.get());
 		}
 
-		_actors.emplace_back(actor);
+		std::uint32_t slotIndex;
+		if (!_freeActorSlots.empty()) {
+			slotIndex = _freeActorSlots.pop_back_val();
+		} else {
+			slotIndex = (std::uint32_t)_actorSlots.size();
+			_actorSlots.push_back({ nullptr, 1 });
+		}
+		_actorSlots[slotIndex].Actor = actor.get();
+		actor->Handle = Actors::ActorHandle(slotIndex, _actorSlots[slotIndex].Generation);
+
+		_actors.emplace_back(std::move(actor));
 	}
 
-	std::shared_ptr<AudioBufferPlayer> LevelHandler::PlaySfx(Actors::ActorBase* self, const StringView identifier, AudioBuffer* buffer, const Vector3f& pos, bool sourceRelative, float gain, float pitch)
+	Actors::ActorBase* LevelHandler::ResolveActor(Actors::ActorHandle handle) const
 	{
-#if defined(WITH_AUDIO)
-		auto& player = _playingSounds.emplace_back(_assignedViewports.size() > 1
-			? std::make_shared<AudioBufferPlayerForSplitscreen>(buffer, _assignedViewports)
-			: std::make_shared<AudioBufferPlayer>(buffer));
-		player->setPosition(Vector3f(pos.X, pos.Y, 100.0f));
-		player->setGain(gain * PreferencesCache::MasterVolume * PreferencesCache::SfxVolume);
-		player->setSourceRelative(sourceRelative);
-
-		if (pos.Y >= _waterLevel) {
-			player->setLowPass(0.05f);
-			player->setPitch(pitch * 0.7f);
+		if (handle.Index >= _actorSlots.size()) {
+			return nullptr;
+		}
+		const ActorSlot& slot = _actorSlots[handle.Index];
+		return (slot.Generation == handle.Generation ? slot.Actor : nullptr);
+	}
+
+	bool LevelHandler::IsUpdatingInParallel() const
+	{
+		return (CurrentDeferredCommands != nullptr);
+	}
+
+	void LevelHandler::InvokeDeferred(const DeferredCommand& command)
+	{
+		if (CurrentDeferredCommands != nullptr) {
+			CurrentDeferredCommands->push_back(command);
 		} else {
-			player->setPitch(pitch);
+			ExecuteDeferredCommand(command);
 		}
+	}
 
-		player->play();
-		return player;
+	std::shared_ptr<AudioBufferPlayer> LevelHandler::PlaySfx(Actors::ActorBase* self, const StringView identifier, AudioBuffer* buffer, const Vector3f& pos, bool sourceRelative, float gain, float pitch)
+	{
+#if defined(WITH_AUDIO)
+		bool isUnderwater = (pos.Y >= _waterLevel);
+		return _voices.Play(identifier, buffer, Vector3f(pos.X, pos.Y, 100.0f), sourceRelative,
+			gain * PreferencesCache::MasterVolume * PreferencesCache::SfxVolume,
+			isUnderwater ? pitch * 0.7f : pitch, isUnderwater ? 0.05f : 1.0f);
 #else
 		return nullptr;
 #endif
@@ -830,21 +843,10 @@ namespace Jazz2
 		}
 		std::int32_t idx = (it->second.Buffers.size() > 1 ? Random().Next(0, (std::int32_t)it->second.Buffers.size()) : 0);
 		auto* buffer = &it->second.Buffers[idx]->Buffer;
-		auto& player = _playingSounds.emplace_back(_assignedViewports.size() > 1
-			? std::make_shared<AudioBufferPlayerForSplitscreen>(buffer, _assignedViewports)
-			: std::make_shared<AudioBufferPlayer>(buffer));
-		player->setPosition(Vector3f(pos.X, pos.Y, 100.0f));
-		player->setGain(gain * PreferencesCache::MasterVolume * PreferencesCache::SfxVolume);
-
-		if (pos.Y >= _waterLevel) {
-			player->setLowPass(0.05f);
-			player->setPitch(pitch * 0.7f);
-		} else {
-			player->setPitch(pitch);
-		}
-
-		player->play();
-		return player;
+		bool isUnderwater = (pos.Y >= _waterLevel);
+		return _voices.Play(identifier, buffer, Vector3f(pos.X, pos.Y, 100.0f), false,
+			gain * PreferencesCache::MasterVolume * PreferencesCache::SfxVolume,
+			isUnderwater ? pitch * 0.7f : pitch, isUnderwater ? 0.05f : 1.0f);
 #else
 		return nullptr;
 #endif
@@ -863,57 +865,18 @@ namespace Jazz2
 	{
 		*collider = nullptr;
 
-		if (self->GetState(Actors::ActorState::CollideWithTileset)) {
-			if (_tileMap != nullptr) {
-				if (self->GetState(Actors::ActorState::CollideWithTilesetReduced) && aabb.B - aabb.T >= 20.0f) {
-					// If hitbox height is larger than 20px, check bottom and top separately (and top only if going upwards)
-					AABBf aabbTop = aabb;
-					aabbTop.B = aabbTop.T + 6.0f;
-					AABBf aabbBottom = aabb;
-					aabbBottom.T = aabbBottom.B - 14.0f;
-					if (!_tileMap->IsTileEmpty(aabbBottom, params)) {
-						return false;
-					}
-					if (!params.Downwards) {
-						params.Downwards = false;
-						if (!_tileMap->IsTileEmpty(aabbTop, params)) {
-							return false;
-						}
-					}
-				} else {
-					if (!_tileMap->IsTileEmpty(aabb, params)) {
-						return false;
-					}
-				}
-			}
+		if (!IsTileMapEmpty(self, aabb, params)) {
+			return false;
 		}
 
 		// Check for solid objects
 		if (self->GetState(Actors::ActorState::CollideWithSolidObjects)) {
 			Actors::ActorBase* colliderActor = nullptr;
-			FindCollisionActorsByAABB(self, aabb, [self, &colliderActor, &params](Actors::ActorBase* actor) -> bool {
-				if ((actor->GetState() & (Actors::ActorState::IsSolidObject | Actors::ActorState::IsDestroyed)) != Actors::ActorState::IsSolidObject) {
-					return true;
-				}
-				if (self->GetState(Actors::ActorState::ExcludeSimilar) && actor->GetState(Actors::ActorState::ExcludeSimilar)) {
-					// If both objects have ExcludeSimilar, ignore it
-					return true;
+			FindCollisionActorsByAABB(self, aabb, [this, self, &colliderActor, &params](Actors::ActorBase* actor) -> bool {
+				if (IsSolidObjectBlocking(self, actor, params)) {
+					colliderActor = actor;
+					return false;
 				}
-				if (self->GetState(Actors::ActorState::CollideWithSolidObjectsBelow) &&
-					self->AABBInner.B > (actor->AABBInner.T + actor->AABBInner.B) * 0.5f) {
-					return true;
-				}
-
-				auto* solidObject = runtime_cast<Actors::SolidObjectBase*>(actor);
-				if (solidObject == nullptr || !solidObject->IsOneWay || params.Downwards) {
-					std::shared_ptr selfShared = self->shared_from_this();
-					std::shared_ptr actorShared = actor->shared_from_this();
-					if (!selfShared->OnHandleCollision(actorShared) && !actorShared->OnHandleCollision(selfShared)) {
-						colliderActor = actor;
-						return false;
-					}
-				}
-
 				return true;
 			});
 
@@ -923,13 +886,79 @@ namespace Jazz2
 		return (*collider == nullptr);
 	}
 
-	void LevelHandler::FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, const std::function<bool(Actors::ActorBase*)>& callback)
+	bool LevelHandler::IsPositionEmpty(Actors::ActorBase* self, const AABBf& aabb, TileCollisionParams& params, ArrayView<Actors::ActorBase* const> candidates)
+	{
+		if (!IsTileMapEmpty(self, aabb, params)) {
+			return false;
+		}
+
+		if (self->GetState(Actors::ActorState::CollideWithSolidObjects)) {
+			for (Actors::ActorBase* actor : candidates) {
+				if (IsSolidObjectBlocking(self, actor, params)) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool LevelHandler::IsTileMapEmpty(Actors::ActorBase* self, const AABBf& aabb, TileCollisionParams& params)
+	{
+		if (_tileMap == nullptr || !self->GetState(Actors::ActorState::CollideWithTileset)) {
+			return true;
+		}
+
+		if (self->GetState(Actors::ActorState::CollideWithTilesetReduced) && aabb.B - aabb.T >= 20.0f) {
+			// If hitbox height is larger than 20px, check bottom and top separately (and top only if going upwards)
+			AABBf aabbTop = aabb;
+			aabbTop.B = aabbTop.T + 6.0f;
+			AABBf aabbBottom = aabb;
+			aabbBottom.T = aabbBottom.B - 14.0f;
+			if (!_tileMap->IsTileEmpty(aabbBottom, params)) {
+				return false;
+			}
+			if (!params.Downwards) {
+				params.Downwards = false;
+				if (!_tileMap->IsTileEmpty(aabbTop, params)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		return _tileMap->IsTileEmpty(aabb, params);
+	}
+
+	bool LevelHandler::IsSolidObjectBlocking(Actors::ActorBase* self, Actors::ActorBase* actor, TileCollisionParams& params)
+	{
+		if ((actor->GetState() & (Actors::ActorState::IsSolidObject | Actors::ActorState::IsDestroyed)) != Actors::ActorState::IsSolidObject) {
+			return false;
+		}
+		if (self->GetState(Actors::ActorState::ExcludeSimilar) && actor->GetState(Actors::ActorState::ExcludeSimilar)) {
+			// If both objects have ExcludeSimilar, ignore it
+			return false;
+		}
+		if (self->GetState(Actors::ActorState::CollideWithSolidObjectsBelow) &&
+			self->AABBInner.B > (actor->AABBInner.T + actor->AABBInner.B) * 0.5f) {
+			return false;
+		}
+
+		auto* solidObject = runtime_cast<Actors::SolidObjectBase*>(actor);
+		if (solidObject == nullptr || !solidObject->IsOneWay || params.Downwards) {
+			return (!self->OnHandleCollision(actor) && !actor->OnHandleCollision(self));
+		}
+
+		return false;
+	}
+
+	void LevelHandler::FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback)
 	{
 		struct QueryHelper {
 			const LevelHandler* Handler;
 			const Actors::ActorBase* Self;
 			const AABBf& AABB;
-			const std::function<bool(Actors::ActorBase*)>& Callback;
+			FunctionRef<bool(Actors::ActorBase*)> Callback;
 
 			bool OnCollisionQuery(std::int32_t nodeId) {
 				Actors::ActorBase* actor = (Actors::ActorBase*)Handler->_collisions.GetUserData(nodeId);
@@ -945,9 +974,12 @@ namespace Jazz2
 
 		QueryHelper helper = { this, self, aabb, callback };
 		_collisions.Query(&helper, aabb);
+#if defined(WITH_PROFILER)
+		Profiler::AddCounter(ProfilerCounter::CollisionQueries);
+#endif
 	}
 
-	void LevelHandler::FindCollisionActorsByRadius(float x, float y, float radius, const std::function<bool(Actors::ActorBase*)>& callback)
+	void LevelHandler::FindCollisionActorsByRadius(float x, float y, float radius, FunctionRef<bool(Actors::ActorBase*)> callback)
 	{
 		AABBf aabb = AABBf(x - radius, y - radius, x + radius, y + radius);
 		float radiusSquared = (radius * radius);
@@ -956,7 +988,7 @@ namespace Jazz2
 			const LevelHandler* Handler;
 			const float x, y;
 			const float RadiusSquared;
-			const std::function<bool(Actors::ActorBase*)>& Callback;
+			FunctionRef<bool(Actors::ActorBase*)> Callback;
 
 			bool OnCollisionQuery(std::int32_t nodeId) {
 				Actors::ActorBase* actor = (Actors::ActorBase*)Handler->_collisions.GetUserData(nodeId);
@@ -984,9 +1016,12 @@ namespace Jazz2
 
 		QueryHelper helper = { this, x, y, radiusSquared, callback };
 		_collisions.Query(&helper, aabb);
+#if defined(WITH_PROFILER)
+		Profiler::AddCounter(ProfilerCounter::CollisionQueries);
+#endif
 	}
 
-	void LevelHandler::GetCollidingPlayers(const AABBf& aabb, const std::function<bool(Actors::ActorBase*)> callback)
+	void LevelHandler::GetCollidingPlayers(const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback)
 	{
 		for (auto& player : _players) {
 			if (aabb.Overlaps(player->AABB)) {
@@ -997,6 +1032,102 @@ namespace Jazz2
 		}
 	}
 
+	void LevelHandler::FindCollisionActorsByAABBs(Actors::ActorBase* self, ArrayView<const AABBf> aabbs, SmallVectorImpl<Actors::ActorBase*>& result, ArrayView<std::uint32_t> offsets)
+	{
+		ASSERT_MSG(offsets.size() == aabbs.size() + 1, "Offsets must have one more item than AABBs");
+
+		result.clear();
+		if (aabbs.empty()) {
+			offsets[0] = 0;
+			return;
+		}
+
+		// The tree is traversed only once with union of all AABBs, the candidates are then tested against each AABB
+		AABBf bounds = aabbs[0];
+		for (std::size_t i = 1; i < aabbs.size(); i++) {
+			bounds = AABBf::Combine(bounds, aabbs[i]);
+		}
+
+		struct QueryHelper {
+			const LevelHandler* Handler;
+			const Actors::ActorBase* Self;
+			SmallVectorImpl<Actors::ActorBase*>& Candidates;
+
+			bool OnCollisionQuery(std::int32_t nodeId) {
+				Actors::ActorBase* actor = (Actors::ActorBase*)Handler->_collisions.GetUserData(nodeId);
+				if (Self != actor && (actor->GetState() & (Actors::ActorState::CollideWithOtherActors | Actors::ActorState::IsDestroyed)) == Actors::ActorState::CollideWithOtherActors) {
+					Candidates.push_back(actor);
+				}
+				return true;
+			}
+		};
+
+		SmallVector<Actors::ActorBase*, 64> candidates;
+		QueryHelper helper = { this, self, candidates };
+		_collisions.Query(&helper, bounds);
+#if defined(WITH_PROFILER)
+		Profiler::AddCounter(ProfilerCounter::CollisionQueries);
+#endif
+
+		for (std::size_t i = 0; i < aabbs.size(); i++) {
+			offsets[i] = (std::uint32_t)result.size();
+			for (Actors::ActorBase* actor : candidates) {
+				if (actor->IsCollidingWith(aabbs[i])) {
+					result.push_back(actor);
+				}
+			}
+		}
+		offsets[aabbs.size()] = (std::uint32_t)result.size();
+	}
+
+	bool LevelHandler::CastRay(Actors::ActorBase* self, const Vector2f& from, const Vector2f& to, Actors::ActorState actorFilter, RayCastResult& result)
+	{
+		// Tiles are checked first, so the ray is already shortened when the tree is traversed
+		float fraction = 1.0f;
+		bool hit = (_tileMap != nullptr && _tileMap->CastRay(from, to, fraction));
+
+		struct QueryHelper {
+			const LevelHandler* Handler;
+			const Actors::ActorBase* Self;
+			Actors::ActorState Filter;
+			Actors::ActorBase* Actor;
+			float Fraction;
+
+			float OnRayCastQuery(const Collisions::RayCastInput& input, std::int32_t nodeId) {
+				Actors::ActorBase* actor = (Actors::ActorBase*)Handler->_collisions.GetUserData(nodeId);
+				if (Self == actor || (actor->GetState() & (Filter | Actors::ActorState::IsDestroyed)) != Filter) {
+					return -1.0f;
+				}
+				float fraction = IntersectRayWithAABB(input.P1, input.P2 - input.P1, input.MaxFraction, actor->AABBInner);
+				if (fraction < 0.0f) {
+					return -1.0f;
+				}
+				// Clip the ray, so only closer actors can be found, zero terminates the query because nothing can be closer
+				Actor = actor;
+				Fraction = fraction;
+				return fraction;
+			}
+		};
+
+		QueryHelper helper = { this, self, actorFilter, nullptr, fraction };
+		if (actorFilter != Actors::ActorState::None) {
+			_collisions.RayCast(&helper, { from, to, fraction });
+#if defined(WITH_PROFILER)
+			Profiler::AddCounter(ProfilerCounter::CollisionQueries);
+#endif
+		}
+
+		if (helper.Actor != nullptr) {
+			hit = true;
+			fraction = helper.Fraction;
+		}
+
+		result.Fraction = (hit ? fraction : 1.0f);
+		result.Point = from + (to - from) * result.Fraction;
+		result.Actor = helper.Actor;
+		return hit;
+	}
+
 	void LevelHandler::BroadcastTriggeredEvent(Actors::ActorBase* initiator, EventType eventType, std::uint8_t* eventParams)
 	{
 		switch (eventType) {
@@ -1225,7 +1356,7 @@ namespace Jazz2
 		auto it = _commonResources->Sounds.find(String::nullTerminatedView("SugarRush"_s));
 		if (it != _commonResources->Sounds.end()) {
 			std::int32_t idx = (it->second.Buffers.size() > 1 ? Random().Next(0, (std::int32_t)it->second.Buffers.size()) : 0);
-			_sugarRushMusic = _playingSounds.emplace_back(std::make_shared<AudioBufferPlayer>(&it->second.Buffers[idx]->Buffer));
+			_sugarRushMusic = std::make_shared<AudioBufferPlayer>(&it->second.Buffers[idx]->Buffer);
 			_sugarRushMusic->setPosition(Vector3f(0.0f, 0.0f, 100.0f));
 			_sugarRushMusic->setGain(PreferencesCache::MasterVolume * PreferencesCache::MusicVolume);
 			_sugarRushMusic->setSourceRelative(true);
@@ -1408,7 +1539,7 @@ namespace Jazz2
 		});
 
 		if (!iceBlockFound) {
-			std::shared_ptr<Actors::Environment::IceBlock> iceBlock = std::make_shared<Actors::Environment::IceBlock>();
+			std::shared_ptr<Actors::Environment::IceBlock> iceBlock = Actors::CreateActor<Actors::Environment::IceBlock>();
 			iceBlock->OnActivated(Actors::ActorActivationDetails(
 				this,
 				Vector3i(x - 1, y - 2, ILevelHandler::MainPlaneZ)
@@ -1467,8 +1598,7 @@ namespace Jazz2
 			}
 
 			for (std::size_t i = 0; i < playerZones.size(); i += 2) {
-				const auto& activationZone = playerZones[i];
-				_eventMap->ActivateEvents(activationZone.L, activationZone.T, activationZone.R, activationZone.B, true);
+				_eventMap->ActivateEventsInZone((std::int32_t)(i / 2), playerZones[i], true);
 			}
 
 			if (!_checkpointCreated) {
@@ -1631,9 +1761,9 @@ namespace Jazz2
 						std::uint32_t col = curAnimFrame % resBase->FrameConfiguration.X;
 						std::uint32_t row = curAnimFrame / resBase->FrameConfiguration.X;
 						debris.TexScaleX = (float(resBase->FrameDimensions.X) / float(texSize.X));
-						debris.TexBiasX = (float(resBase->FrameDimensions.X * col) / float(texSize.X));
+						debris.TexBiasX = (float(resBase->TextureOffset.X + resBase->FrameDimensions.X * col) / float(texSize.X));
 						debris.TexScaleY = (float(resBase->FrameDimensions.Y) / float(texSize.Y));
-						debris.TexBiasY = (float(resBase->FrameDimensions.Y * row) / float(texSize.Y));
+						debris.TexBiasY = (float(resBase->TextureOffset.Y + resBase->FrameDimensions.Y * row) / float(texSize.Y));
 
 						debris.DiffuseTexture = resBase->TextureDiffuse.get();
 						debris.Flags = debrisFlags;
@@ -1670,9 +1800,9 @@ namespace Jazz2
 						std::uint32_t col = curAnimFrame % resBase->FrameConfiguration.X;
 						std::uint32_t row = curAnimFrame / resBase->FrameConfiguration.X;
 						debris.TexScaleX = (float(resBase->FrameDimensions.X) / float(texSize.X));
-						debris.TexBiasX = (float(resBase->FrameDimensions.X * col) / float(texSize.X));
+						debris.TexBiasX = (float(resBase->TextureOffset.X + resBase->FrameDimensions.X * col) / float(texSize.X));
 						debris.TexScaleY = (float(resBase->FrameDimensions.Y) / float(texSize.Y));
-						debris.TexBiasY = (float(resBase->FrameDimensions.Y * row) / float(texSize.Y));
+						debris.TexBiasY = (float(resBase->TextureOffset.Y + resBase->FrameDimensions.Y * row) / float(texSize.Y));
 
 						debris.DiffuseTexture = resBase->TextureDiffuse.get();
 						debris.Flags = debrisFlags;
@@ -1684,6 +1814,68 @@ namespace Jazz2
 		}
 	}
 
+	void LevelHandler::UpdateActorsInParallel(float timeMult)
+	{
+		ZoneScopedC(0x4876AF);
+
+		// Actors that collide with solid objects could modify other actors and frozen actors spawn
+		// explosions when they thaw, so they are always updated serially from the scene graph
+		_parallelActors.clear();
+		for (auto& actor : _actors) {
+			if ((actor->_state & (Actors::ActorState::AllowParallelUpdate | Actors::ActorState::CollideWithSolidObjects | Actors::ActorState::IsDestroyed)) == Actors::ActorState::AllowParallelUpdate &&
+				actor->_frozenTimeLeft <= 0.0f && actor->_renderer.isUpdateEnabled()) {
+				_parallelActors.push_back(actor.get());
+			}
+		}
+
+		if (_parallelActors.empty()) {
+			return;
+		}
+
+		std::int32_t count = (std::int32_t)_parallelActors.size();
+		std::int32_t batchCount = (count + ParallelUpdateBatchSize - 1) / ParallelUpdateBatchSize;
+		if (_deferredCommands.size() < (std::size_t)batchCount) {
+			_deferredCommands.resize(batchCount);
+		}
+
+		theServiceLocator().GetThreadPool().ParallelFor(count, ParallelUpdateBatchSize, [this, timeMult](std::int32_t start, std::int32_t end) {
+			CurrentDeferredCommands = &_deferredCommands[start / ParallelUpdateBatchSize];
+			for (std::int32_t i = start; i < end; i++) {
+				Actors::ActorBase* actor = _parallelActors[i];
+				actor->OnUpdate(timeMult);
+				actor->_updatedInParallel = true;
+			}
+			CurrentDeferredCommands = nullptr;
+#if defined(WITH_PROFILER)
+			Profiler::AddCounter(ProfilerCounter::ActorsUpdated, end - start);
+#endif
+		});
+
+		// Side effects are applied in the same order as if actors were updated serially, regardless of thread scheduling
+		for (std::int32_t i = 0; i < batchCount; i++) {
+			auto& commands = _deferredCommands[i];
+			for (const auto& command : commands) {
+				ExecuteDeferredCommand(command);
+			}
+			commands.clear();
+		}
+	}
+
+	void LevelHandler::ExecuteDeferredCommand(const DeferredCommand& command)
+	{
+		switch (command.Type) {
+			case DeferredCommandType::PlaySfx:
+				command.Actor->PlaySfx(command.Identifier, command.Gain, command.Pitch);
+				break;
+			case DeferredCommandType::CreateExplosion:
+				Actors::Explosion::Create(this, command.Pos, (Actors::Explosion::Type)command.Param);
+				break;
+			case DeferredCommandType::DecreaseHealth:
+				command.Actor->DecreaseHealth(command.Param);
+				break;
+		}
+	}
+
 	void LevelHandler::ResolveCollisions(float timeMult)
 	{
 		ZoneScopedC(0x4876AF);
@@ -1697,6 +1889,14 @@ namespace Jazz2
 					_collisions.DestroyProxy(actor->CollisionProxyID);
 					actor->CollisionProxyID = Collisions::NullNode;
 				}
+				if (actor->Handle.IsValid()) {
+					// Invalidate all existing handles to the actor, generation 0 is reserved for invalid handles
+					ActorSlot& slot = _actorSlots[actor->Handle.Index];
+					slot.Actor = nullptr;
+					slot.Generation = (slot.Generation == UINT32_MAX ? 1 : slot.Generation + 1);
+					_freeActorSlots.push_back(actor->Handle.Index);
+					actor->Handle = {};
+				}
 				it = _actors.eraseUnordered(it);
 				continue;
 			}
@@ -1722,10 +1922,8 @@ namespace Jazz2
 				}
 
 				if (actorA->IsCollidingWith(actorB)) {
-					std::shared_ptr<Actors::ActorBase> actorSharedA = actorA->shared_from_this();
-					std::shared_ptr<Actors::ActorBase> actorSharedB = actorB->shared_from_this();
-					if (!actorSharedA->OnHandleCollision(actorSharedB->shared_from_this())) {
-						actorSharedB->OnHandleCollision(actorSharedA->shared_from_this());
+					if (!actorA->OnHandleCollision(actorB)) {
+						actorB->OnHandleCollision(actorA);
 					}
 				}
 			}
@@ -1734,16 +1932,29 @@ namespace Jazz2
 		_collisions.UpdatePairs(&helper);
 	}
 
+	ArrayView<const LightEmitter> LevelHandler::GetEmittedLights()
+	{
+		// Lights are collected only by the first viewport in each frame
+		std::uint32_t frameCount = (std::uint32_t)theApplication().GetFrameCount();
+		if (_emittedLightsFrame != frameCount) {
+			_emittedLightsFrame = frameCount;
+			_emittedLights.clear();
+
+			std::size_t actorsCount = _actors.size();
+			for (std::size_t i = 0; i < actorsCount; i++) {
+				_actors[i]->OnEmitLights(_emittedLights);
+			}
+		}
+
+		return _emittedLights;
+	}
+
 	void LevelHandler::AssignViewport(Actors::Player* player)
 	{
 		_assignedViewports.emplace_back(std::make_unique<PlayerViewport>(this, player));
 
 #if defined(WITH_AUDIO)
-		for (auto& current : _playingSounds) {
-			if (auto* current2 = runtime_cast<AudioBufferPlayerForSplitscreen*>(current)) {
-				current2->updateViewports(_assignedViewports);
-			}
-		}
+		_voices.SetViewports(_assignedViewports);
 #endif
 	}
 
@@ -2130,14 +2341,15 @@ namespace Jazz2
 			_music->setLowPass(0.1f);
 		}
 		if (IsPausable()) {
-			for (auto& sound : _playingSounds) {
-				if (sound->isPlaying()) {
-					sound->pause();
-				}
-			}
+			_voices.PauseAll();
 			// If Sugar Rush music is playing, pause it and play normal music instead
-			if (_sugarRushMusic != nullptr && _music != nullptr) {
-				_music->play();
+			if (_sugarRushMusic != nullptr) {
+				if (_sugarRushMusic->isPlaying()) {
+					_sugarRushMusic->pause();
+				}
+				if (_music != nullptr) {
+					_music->play();
+				}
 			}
 		}
 #endif
@@ -2152,15 +2364,16 @@ namespace Jazz2
 
 #if defined(WITH_AUDIO)
 		// If Sugar Rush music was playing, resume it and pause normal music again
-		if (_sugarRushMusic != nullptr && _music != nullptr) {
-			_music->pause();
-		}
-		// Resume all SFX
-		for (auto& sound : _playingSounds) {
-			if (sound->isPaused()) {
-				sound->play();
+		if (_sugarRushMusic != nullptr) {
+			if (_music != nullptr) {
+				_music->pause();
+			}
+			if (_sugarRushMusic->isPaused()) {
+				_sugarRushMusic->play();
 			}
 		}
+		// Resume all SFX
+		_voices.ResumeAll();
 		if (_music != nullptr) {
 			_music->setLowPass(1.0f);
 		}
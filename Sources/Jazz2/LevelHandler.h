@@ -5,7 +5,9 @@
 #include "IStateHandler.h"
 #include "IRootController.h"
 #include "LevelDescriptor.h"
+#include "LightEmitter.h"
 #include "RumbleProcessor.h"
+#include "SoundVoiceManager.h"
 #include "WeatherType.h"
 #include "Events/EventMap.h"
 #include "Events/EventSpawner.h"
@@ -48,6 +50,10 @@ namespace Jazz2
 	}
 #endif
 
+#if defined(WITH_BENCHMARK)
+	class SimulationBenchmark;
+#endif
+
 	namespace UI
 	{
 		class HUD;
@@ -68,6 +74,9 @@ namespace Jazz2
 		friend class PlayerViewport;
 #if defined(WITH_ANGELSCRIPT)
 		friend class Scripting::LevelScriptLoader;
+#endif
+#if defined(WITH_BENCHMARK)
+		friend class SimulationBenchmark;
 #endif
 		friend class UI::HUD;
 		friend class UI::Menu::InGameMenu;
@@ -76,6 +85,7 @@ namespace Jazz2
 		static constexpr std::int32_t DefaultWidth = 720;
 		static constexpr std::int32_t DefaultHeight = 405;
 		static constexpr std::int32_t ActivateTileRange = 26;
+		static constexpr std::int32_t ParallelUpdateBatchSize = 32;
 
 		LevelHandler(IRootController* root);
 		~LevelHandler() override;
@@ -111,14 +121,20 @@ namespace Jazz2
 		void OnTouchEvent(const TouchEvent& event) override;
 
 		void AddActor(std::shared_ptr<Actors::ActorBase> actor) override;
+		Actors::ActorBase* ResolveActor(Actors::ActorHandle handle) const override;
+		bool IsUpdatingInParallel() const override;
+		void InvokeDeferred(const DeferredCommand& command) override;
 
 		std::shared_ptr<AudioBufferPlayer> PlaySfx(Actors::ActorBase* self, const StringView identifier, AudioBuffer* buffer, const Vector3f& pos, bool sourceRelative, float gain, float pitch) override;
 		std::shared_ptr<AudioBufferPlayer> PlayCommonSfx(const StringView identifier, const Vector3f& pos, float gain = 1.0f, float pitch = 1.0f) override;
 		void WarpCameraToTarget(Actors::ActorBase* actor, bool fast = false) override;
 		bool IsPositionEmpty(Actors::ActorBase* self, const AABBf& aabb, Tiles::TileCollisionParams& params, Actors::ActorBase** collider) override;
-		void FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, const std::function<bool(Actors::ActorBase*)>& callback) override;
-		void FindCollisionActorsByRadius(float x, float y, float radius, const std::function<bool(Actors::ActorBase*)>& callback) override;
-		void GetCollidingPlayers(const AABBf& aabb, const std::function<bool(Actors::ActorBase*)> callback) override;
+		bool IsPositionEmpty(Actors::ActorBase* self, const AABBf& aabb, Tiles::TileCollisionParams& params, ArrayView<Actors::ActorBase* const> candidates) override;
+		void FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback) override;
+		void FindCollisionActorsByRadius(float x, float y, float radius, FunctionRef<bool(Actors::ActorBase*)> callback) override;
+		void GetCollidingPlayers(const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback) override;
+		void FindCollisionActorsByAABBs(Actors::ActorBase* self, ArrayView<const AABBf> aabbs, SmallVectorImpl<Actors::ActorBase*>& result, ArrayView<std::uint32_t> offsets) override;
+		bool CastRay(Actors::ActorBase* self, const Vector2f& from, const Vector2f& to, Actors::ActorState actorFilter, RayCastResult& result) override;
 
 		void BroadcastTriggeredEvent(Actors::ActorBase* initiator, EventType eventType, std::uint8_t* eventParams) override;
 		void BeginLevelChange(Actors::ActorBase* initiator, ExitType exitType, const StringView nextLevel = {}) override;
@@ -170,6 +186,22 @@ namespace Jazz2
 			PlayerInput();
 		};
 
+		// Slot of an actor referenced by `Actors::ActorHandle`, generation is incremented when the slot is released
+		struct ActorSlot {
+			Actors::ActorBase* Actor;
+			std::uint32_t Generation;
+		};
+
+		// Phase of the gameplay update, it's reported to the callback of `BeginFrameUpdate()` and `EndFrameUpdate()` when finished
+		enum class FramePhase {
+			Events,
+			Scripts,
+			Actors,
+			TileMap,
+			Collisions,
+			Other
+		};
+
 		IRootController* _root;
 
 		Shader* _lightingShader;
@@ -189,6 +221,10 @@ namespace Jazz2
 #endif
 		SmallVector<std::shared_ptr<Actors::ActorBase>, 0> _actors;
 		SmallVector<Actors::Player*, LevelInitialization::MaxPlayerCount> _players;
+		SmallVector<ActorSlot, 0> _actorSlots;
+		SmallVector<std::uint32_t, 0> _freeActorSlots;
+		SmallVector<Actors::ActorBase*, 0> _parallelActors;
+		SmallVector<SmallVector<DeferredCommand, 0>, 0> _deferredCommands; // One command buffer per batch of `_parallelActors`
 
 		String _levelFileName;
 		String _episodeName;
@@ -221,7 +257,7 @@ namespace Jazz2
 		Vector4f _defaultAmbientLight;
 #if defined(WITH_AUDIO)
 		std::unique_ptr<AudioStreamPlayer> _music;
-		SmallVector<std::shared_ptr<AudioBufferPlayer>> _playingSounds;
+		SoundVoiceManager _voices;
 		std::shared_ptr<AudioBufferPlayer> _sugarRushMusic;
 #endif
 		Metadata* _commonResources;
@@ -232,6 +268,8 @@ namespace Jazz2
 		BitArray _pressedKeys;
 		std::uint32_t _overrideActions;
 		PlayerInput _playerInputs[UI::ControlScheme::MaxSupportedPlayers];
+		SmallVector<LightEmitter, 0> _emittedLights; // Collected once per frame and shared by all viewports
+		std::uint32_t _emittedLightsFrame;
 
 #if defined(NCINE_HAS_GAMEPAD_RUMBLE)
 		RumbleProcessor _rumble;
@@ -246,7 +284,14 @@ namespace Jazz2
 
 		Recti GetPlayerViewportBounds(std::int32_t w, std::int32_t h, std::int32_t index);
 		void ProcessWeather(float timeMult);
+		void BeginFrameUpdate(float timeMult, FunctionRef<void(FramePhase)> onPhaseEnd);
+		void EndFrameUpdate(float timeMult, FunctionRef<void(FramePhase)> onPhaseEnd);
+		void UpdateActorsInParallel(float timeMult);
+		void ExecuteDeferredCommand(const DeferredCommand& command);
 		void ResolveCollisions(float timeMult);
+		bool IsTileMapEmpty(Actors::ActorBase* self, const AABBf& aabb, Tiles::TileCollisionParams& params);
+		bool IsSolidObjectBlocking(Actors::ActorBase* self, Actors::ActorBase* actor, Tiles::TileCollisionParams& params);
+		ArrayView<const LightEmitter> GetEmittedLights();
 		void AssignViewport(Actors::Player* player);
 		void InitializeCamera(PlayerViewport& viewport);
 		void UpdatePressedActions();
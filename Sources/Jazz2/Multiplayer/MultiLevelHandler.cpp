@@ -55,7 +55,7 @@ namespace Jazz2::Multiplayer
 	MultiLevelHandler::MultiLevelHandler(IRootController* root, NetworkManager* networkManager)
 		: LevelHandler(root), _gameMode(MultiplayerGameMode::Unknown), _networkManager(networkManager), _updateTimeLeft(1.0f),
 			_initialUpdateSent(false), _lastSpawnedActorId(-1), _seqNum(0), _seqNumWarped(0), _suppressRemoting(false),
-			_ignorePackets(false)
+			_ignorePackets(false), _lastSnapshotSeqNum(0), _interestGridWidth(0), _interestGridHeight(0)
 #if defined(DEATH_DEBUG) && defined(WITH_IMGUI)
 			, _plotIndex(0), _actorsMaxCount(0.0f), _actorsCount{}, _remoteActorsCount{}, _remotingActorsCount{},
 			_mirroredActorsCount{}, _updatePacketMaxSize(0.0f), _updatePacketSize {}, _compressedUpdatePacketSize {}
@@ -154,8 +154,11 @@ namespace Jazz2::Multiplayer
 				_initialUpdateSent = true;
 
 				if (!_isServer) {
-					MemoryStream packet(5);
+					MemoryStream packet(11);
 					packet.WriteValue<std::uint8_t>((std::uint8_t)ClientPacketType::LevelReady);
+					// View size is used by the server to determine which actors are relevant to this client
+					packet.WriteVariableInt32(_viewSize.X);
+					packet.WriteVariableInt32(_viewSize.Y);
 					_networkManager->SendToPeer(nullptr, NetworkChannel::Main, packet.GetBuffer(), packet.GetSize());
 				}
 			}
@@ -186,103 +189,37 @@ namespace Jazz2::Multiplayer
 #endif
 
 			if (_isServer) {
-				std::uint32_t actorCount = (std::uint32_t)(_players.size() + _remotingActors.size());
+				_lastSnapshotSeqNum++;
 
-				MemoryStream packet(5 + actorCount * 19);
-				//packet.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::UpdateAllActors);
-				packet.WriteVariableUint32(actorCount);
+				Snapshot& snapshot = _snapshots[_lastSnapshotSeqNum % SnapshotHistorySize];
+				snapshot.SeqNum = _lastSnapshotSeqNum;
+				snapshot.Actors.clear();
 
+				_interestActors.clear();
+				_interestActors.reserve(_players.size() + _remotingActors.size());
 				for (Actors::Player* player : _players) {
-					/*Vector2f pos;
-					auto it = _playerStates.find(player->_playerIndex);
-					if (it != _playerStates.end()) {
-						// Remote players
-						pos = player->_pos;
-
-						// TODO: This should be WarpUpdatesLeft
-						if (it->second.WarpTimeLeft > 0.0f) {
-							it->second.WarpTimeLeft -= timeMult;
-							if (it->second.WarpTimeLeft <= 0.0f) {
-								it->second.WarpTimeLeft = 0.0f;
-								LOGW("Player warped without permission (possible cheating attempt)");
-							}
-						} else if (it->second.WarpTimeLeft < 0.0f) {
-							it->second.WarpTimeLeft += timeMult;
-							if (it->second.WarpTimeLeft >= 0.0f) {
-								it->second.WarpTimeLeft = 0.0f;
-								LOGW("Player failed to warp in time (possible cheating attempt)");
-							}
-						}
-					} else {
-						// Local players
-						pos = player->_pos;
-					}*/
-					Vector2f pos = player->_pos;
-
-					packet.WriteVariableUint32(player->_playerIndex);
-					packet.WriteValue<std::int32_t>((std::int32_t)(pos.X * 512.0f));
-					packet.WriteValue<std::int32_t>((std::int32_t)(pos.Y * 512.0f));
-					packet.WriteVariableUint32((std::uint32_t)(player->_currentTransition != nullptr ? player->_currentTransition->State : player->_currentAnimation->State));
-
-					float rotation = player->_renderer.rotation();
-					if (rotation < 0.0f) rotation += fRadAngle360;
-					packet.WriteValue<std::uint8_t>((std::uint8_t)(rotation * 255.0f / fRadAngle360));
-
-					std::uint8_t flags = 0;
-					if (player->IsFacingLeft()) {
-						flags |= 0x01;
-					}
-					if (player->_renderer.isDrawEnabled()) {
-						flags |= 0x02;
-					}
-					if (player->_renderer.AnimPaused) {
-						flags |= 0x04;
-					}
-					packet.WriteValue<std::uint8_t>(flags);
-
-					Actors::ActorRendererType rendererType = player->_renderer.GetRendererType();
-					packet.WriteValue<std::uint8_t>((std::uint8_t)rendererType);
+					_interestActors.push_back({ player, player->_playerIndex, InterestKind::Player });
 				}
-
 				for (const auto& [remotingActor, remotingActorId] : _remotingActors) {
-					packet.WriteVariableUint32(remotingActorId);
-					packet.WriteValue<std::int32_t>((std::int32_t)(remotingActor->_pos.X * 512.0f));
-					packet.WriteValue<std::int32_t>((std::int32_t)(remotingActor->_pos.Y * 512.0f));
-					packet.WriteVariableUint32((std::uint32_t)(remotingActor->_currentTransition != nullptr ? remotingActor->_currentTransition->State : (remotingActor->_currentAnimation != nullptr ? remotingActor->_currentAnimation->State : AnimState::Idle)));
-					
-					float rotation = remotingActor->_renderer.rotation();
-					if (rotation < 0.0f) rotation += fRadAngle360;
-					packet.WriteValue<std::uint8_t>((std::uint8_t)(rotation * 255.0f / fRadAngle360));
+					_interestActors.push_back({ remotingActor, remotingActorId, ActorShouldBeMirrored(remotingActor) ? InterestKind::Mirrored : InterestKind::Remote });
+				}
 
-					std::uint8_t flags = 0;
-					if (remotingActor->IsFacingLeft()) {
-						flags |= 0x01;
-					}
-					if (remotingActor->_renderer.isDrawEnabled()) {
-						flags |= 0x02;
-					}
-					if (remotingActor->_renderer.AnimPaused) {
-						flags |= 0x04;
-					}
-					packet.WriteValue<std::uint8_t>(flags);
+				std::sort(_interestActors.begin(), _interestActors.end(), [](const InterestActor& a, const InterestActor& b) {
+					return a.Id < b.Id;
+				});
 
-					Actors::ActorRendererType rendererType = remotingActor->_renderer.GetRendererType();
-					packet.WriteValue<std::uint8_t>((std::uint8_t)rendererType);
+				snapshot.Actors.resize(_interestActors.size());
+				for (std::size_t i = 0; i < _interestActors.size(); i++) {
+					FillSnapshotActor(snapshot.Actors[i], _interestActors[i].Id, _interestActors[i].Actor);
 				}
 
-				MemoryStream packetCompressed(1024);
-				packetCompressed.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::UpdateAllActors);
-				DeflateWriter dw(packetCompressed);
-				dw.Write(packet.GetBuffer(), packet.GetSize());
-				dw.Dispose();
-
-#if defined(DEATH_DEBUG) && defined(WITH_IMGUI)
-				_updatePacketSize[_plotIndex] = packet.GetSize();
-				_updatePacketMaxSize = std::max(_updatePacketMaxSize, _updatePacketSize[_plotIndex]);
-				_compressedUpdatePacketSize[_plotIndex] = packetCompressed.GetSize();
-#endif
+				BuildInterestGrid(snapshot);
 
-				_networkManager->SendToAll(NetworkChannel::UnreliableUpdates, packetCompressed.GetBuffer(), packetCompressed.GetSize());
+				for (auto& [peer, peerDesc] : _peerDesc) {
+					if (peerDesc.State == PeerState::LevelSynchronized && peerDesc.Player != nullptr) {
+						SendSnapshotToPeer(peer, peerDesc, snapshot);
+					}
+				}
 
 				SynchronizePeers();
 			} else {
@@ -316,6 +253,8 @@ namespace Jazz2::Multiplayer
 					packet.WriteValue<std::int16_t>((std::int16_t)(player->_speed.X * 512.0f));
 					packet.WriteValue<std::int16_t>((std::int16_t)(player->_speed.Y * 512.0f));
 					packet.WriteVariableUint32((std::uint32_t)flags);
+					// Acknowledge the last received snapshot, so the server can use it as baseline for delta encoding
+					packet.WriteVariableUint32(_lastSnapshotSeqNum);
 
 					if (_seqNumWarped != 0) {
 						packet.WriteVariableUint64(_seqNumWarped);
@@ -456,25 +395,8 @@ namespace Jazz2::Multiplayer
 						_networkManager->SendToPeer(peer, NetworkChannel::Main, packet.GetBuffer(), packet.GetSize());
 					}
 				}
-			} else {
-				const auto& metadataPath = actorPtr->_metadata->Path;
-
-				for (const auto& [peer, peerDesc] : _peerDesc) {
-					MemoryStream packet(24 + metadataPath.size());
-					packet.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::CreateRemoteActor);
-					packet.WriteVariableUint32(actorId);
-					packet.WriteVariableInt32((std::int32_t)actorPtr->_pos.X);
-					packet.WriteVariableInt32((std::int32_t)actorPtr->_pos.Y);
-					packet.WriteVariableInt32((std::int32_t)actorPtr->_renderer.layer());
-					packet.WriteVariableUint32((std::uint32_t)actorPtr->_state);
-					packet.WriteVariableUint32((std::uint32_t)metadataPath.size());
-					packet.Write(metadataPath.data(), (std::uint32_t)metadataPath.size());
-					packet.WriteVariableUint32((std::uint32_t)(actorPtr->_currentTransition != nullptr ? actorPtr->_currentTransition->State : actorPtr->_currentAnimation->State));
-
-					// TODO: If it fail, it will release the packet which is wrong
-					_networkManager->SendToPeer(peer, NetworkChannel::Main, packet.GetBuffer(), packet.GetSize());
-				}
 			}
+			// Remote actors are created on the client side only when they enter area of interest of the peer
 		}
 	}
 
@@ -493,7 +415,7 @@ namespace Jazz2::Multiplayer
 
 			if (actorId != UINT32_MAX) {
 				for (const auto& [peer, peerDesc] : _peerDesc) {
-					if (self == peerDesc.Player) {
+					if (self == peerDesc.Player || !peerDesc.Interest.contains(actorId)) {
 						continue;
 					}
 
@@ -548,17 +470,17 @@ namespace Jazz2::Multiplayer
 		return LevelHandler::IsPositionEmpty(self, aabb, params, collider);
 	}
 
-	void MultiLevelHandler::FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, const std::function<bool(Actors::ActorBase*)>& callback)
+	void MultiLevelHandler::FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback)
 	{
 		LevelHandler::FindCollisionActorsByAABB(self, aabb, callback);
 	}
 
-	void MultiLevelHandler::FindCollisionActorsByRadius(float x, float y, float radius, const std::function<bool(Actors::ActorBase*)>& callback)
+	void MultiLevelHandler::FindCollisionActorsByRadius(float x, float y, float radius, FunctionRef<bool(Actors::ActorBase*)> callback)
 	{
 		LevelHandler::FindCollisionActorsByRadius(x, y, radius, callback);
 	}
 
-	void MultiLevelHandler::GetCollidingPlayers(const AABBf& aabb, const std::function<bool(Actors::ActorBase*)> callback)
+	void MultiLevelHandler::GetCollidingPlayers(const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback)
 	{
 		LevelHandler::GetCollidingPlayers(aabb, callback);
 	}
@@ -978,7 +900,7 @@ namespace Jazz2::Multiplayer
 				}
 			}
 
-			std::shared_ptr<Actors::Multiplayer::LocalPlayerOnServer> player = std::make_shared<Actors::Multiplayer::LocalPlayerOnServer>();
+			std::shared_ptr<Actors::Multiplayer::LocalPlayerOnServer> player = Actors::CreateActor<Actors::Multiplayer::LocalPlayerOnServer>();
 			std::uint8_t playerParams[2] = { (std::uint8_t)levelInit.PlayerCarryOvers[i].Type, (std::uint8_t)i };
 			player->OnActivated(Actors::ActorActivationDetails(
 				this,
@@ -1090,9 +1012,17 @@ namespace Jazz2::Multiplayer
 					return true;
 				}
 				case ClientPacketType::LevelReady: {
-					LOGD("ClientPacketType::LevelReady received - peer: %p", peer._enet);
+					MemoryStream packet(data + 1, dataLength - 1);
+					Vector2i viewSize;
+					viewSize.X = packet.ReadVariableInt32();
+					viewSize.Y = packet.ReadVariableInt32();
+					if (viewSize.X <= 0 || viewSize.Y <= 0) {
+						viewSize = Vector2i(DefaultWidth, DefaultHeight);
+					}
+
+					LOGD("ClientPacketType::LevelReady received - peer: %p, view: %ix%i", peer._enet, viewSize.X, viewSize.Y);
 
-					_peerDesc[peer] = PeerDesc(nullptr, PeerState::LevelLoaded);
+					_peerDesc[peer] = PeerDesc(nullptr, PeerState::LevelLoaded, viewSize);
 					return true;
 				}
 				case ClientPacketType::PlayerUpdate: {
@@ -1121,6 +1051,10 @@ namespace Jazz2::Multiplayer
 					float speedX = packet.ReadValue<std::int16_t>() / 512.0f;
 					float speedY = packet.ReadValue<std::int16_t>() / 512.0f;
 					PlayerFlags flags = (PlayerFlags)packet.ReadVariableUint32();
+					std::uint32_t ackSnapshot = packet.ReadVariableUint32();
+					if (it->second.LastAckSnapshot < ackSnapshot && ackSnapshot <= _lastSnapshotSeqNum) {
+						it->second.LastAckSnapshot = ackSnapshot;
+					}
 
 					/*bool justWarped = (flags & PlayerFlags::JustWarped) == PlayerFlags::JustWarped;
 					if (justWarped) {
@@ -1287,7 +1221,7 @@ namespace Jazz2::Multiplayer
 					_lastSpawnedActorId = playerIndex;
 
 					_root->InvokeAsync([this, playerType, health, teamId, posX, posY]() {
-						std::shared_ptr<Actors::Multiplayer::RemotablePlayer> player = std::make_shared<Actors::Multiplayer::RemotablePlayer>();
+						std::shared_ptr<Actors::Multiplayer::RemotablePlayer> player = Actors::CreateActor<Actors::Multiplayer::RemotablePlayer>();
 						std::uint8_t playerParams[2] = { (std::uint8_t)playerType, 0 };
 						player->OnActivated(Actors::ActorActivationDetails(
 							this,
@@ -1322,7 +1256,7 @@ namespace Jazz2::Multiplayer
 					LOGD("Remote actor %u created on [%i;%i] with metadata \"%s\"", actorId, posX, posY, metadataPath.data());
 
 					_root->InvokeAsync([this, actorId, posX, posY, posZ, state, metadataPath = std::move(metadataPath), anim]() {
-						std::shared_ptr<Actors::Multiplayer::RemoteActor> remoteActor = std::make_shared<Actors::Multiplayer::RemoteActor>();
+						std::shared_ptr<Actors::Multiplayer::RemoteActor> remoteActor = Actors::CreateActor<Actors::Multiplayer::RemoteActor>();
 						remoteActor->OnActivated(Actors::ActorActivationDetails(this, Vector3i(posX, posY, posZ)));
 						remoteActor->AssignMetadata(metadataPath, (AnimState)anim, state);
 
@@ -1371,25 +1305,40 @@ namespace Jazz2::Multiplayer
 				}
 				case ServerPacketType::UpdateAllActors: {
 					MemoryStream packetCompressed(data + 1, dataLength - 1);
+					std::uint32_t seqNum = packetCompressed.ReadVariableUint32();
+					std::uint32_t baselineSeqNum = packetCompressed.ReadVariableUint32();
+					if (seqNum <= _lastSnapshotSeqNum) {
+						// Packet arrived out of order, newer snapshot was already received
+						return true;
+					}
+
+					const Snapshot* baseline = nullptr;
+					if (baselineSeqNum != 0) {
+						baseline = &_snapshots[baselineSeqNum % SnapshotHistorySize];
+						if (baseline->SeqNum != baselineSeqNum || seqNum - baselineSeqNum >= SnapshotHistorySize) {
+							LOGD("Snapshot #%u dropped, because baseline #%u is not available", seqNum, baselineSeqNum);
+							return true;
+						}
+					}
+
+					Snapshot snapshot;
+					snapshot.SeqNum = seqNum;
 					DeflateStream packet(packetCompressed);
-					std::uint32_t actorCount = packet.ReadVariableUint32();
-					for (std::uint32_t i = 0; i < actorCount; i++) {
-						std::uint32_t index = packet.ReadVariableUint32();
-						float posX = packet.ReadValue<std::int32_t>() / 512.0f;
-						float posY = packet.ReadValue<std::int32_t>() / 512.0f;
-						std::uint32_t anim = packet.ReadVariableUint32();
-						float rotation = packet.ReadValue<std::uint8_t>() * fRadAngle360 / 255.0f;
-						std::uint8_t flags = packet.ReadValue<std::uint8_t>();
-						Actors::ActorRendererType rendererType = (Actors::ActorRendererType)packet.ReadValue<std::uint8_t>();
-
-						auto it = _remoteActors.find(index);
+					ReadSnapshotDelta(packet, snapshot, baseline);
+
+					for (const auto& actor : snapshot.Actors) {
+						auto it = _remoteActors.find(actor.Id);
 						if (it != _remoteActors.end()) {
 							if (auto* remoteActor = runtime_cast<Actors::Multiplayer::RemoteActor*>(it->second)) {
-								remoteActor->SyncWithServer(Vector2f(posX, posY), (AnimState)anim, rotation,
-									(flags & 0x02) != 0, (flags & 0x01) != 0, (flags & 0x04) != 0, rendererType);
+								remoteActor->SyncWithServer(Vector2f(actor.PosX / 512.0f, actor.PosY / 512.0f), (AnimState)actor.Anim,
+									actor.Rotation * fRadAngle360 / 255.0f, (actor.Flags & 0x02) != 0, (actor.Flags & 0x01) != 0,
+									(actor.Flags & 0x04) != 0, (Actors::ActorRendererType)actor.RendererType);
 							}
 						}
 					}
+
+					_snapshots[seqNum % SnapshotHistorySize] = std::move(snapshot);
+					_lastSnapshotSeqNum = seqNum;
 					return true;
 				}
 				case ServerPacketType::SyncTileMap: {
@@ -1646,8 +1595,19 @@ namespace Jazz2::Multiplayer
 		}
 
 		std::uint32_t actorId = it->second;
+		bool isMirrored = ActorShouldBeMirrored(actor);
 
 		for (auto& [peer, peerDesc] : _peerDesc) {
+			// Mirrored actors are created on all peers, remote actors only on peers that were interested in them
+			auto interestIt = peerDesc.Interest.find(actorId);
+			bool isCreated = (interestIt != peerDesc.Interest.end() && interestIt->second.IsCreated);
+			if (interestIt != peerDesc.Interest.end()) {
+				peerDesc.Interest.erase(interestIt);
+			}
+			if (!isMirrored && !isCreated) {
+				continue;
+			}
+
 			MemoryStream packet(5);
 			packet.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::DestroyRemoteActor);
 			packet.WriteVariableUint32(actorId);
@@ -1694,7 +1654,7 @@ namespace Jazz2::Multiplayer
 			std::uint8_t playerIndex = FindFreePlayerId();
 			LOGD("Syncing player %u", playerIndex);
 
-			std::shared_ptr<Actors::Multiplayer::RemotePlayerOnServer> player = std::make_shared<Actors::Multiplayer::RemotePlayerOnServer>();
+			std::shared_ptr<Actors::Multiplayer::RemotePlayerOnServer> player = Actors::CreateActor<Actors::Multiplayer::RemotePlayerOnServer>();
 			std::uint8_t playerParams[2] = { (std::uint8_t)PlayerType::Spaz, (std::uint8_t)playerIndex };
 			player->OnActivated(Actors::ActorActivationDetails(
 				this,
@@ -1765,39 +1725,24 @@ namespace Jazz2::Multiplayer
 				_networkManager->SendToPeer(peer, NetworkChannel::Main, packet.GetBuffer(), packet.GetSize());
 			}
 
+			// Remote actors are created later when they enter area of interest of the peer
 			for (const auto& [remotingActor, remotingActorId] : _remotingActors) {
-				if (ActorShouldBeMirrored(remotingActor)) {
-					Vector2i originTile = remotingActor->_originTile;
-					const auto& eventTile = _eventMap->GetEventTile(originTile.X, originTile.Y);
-					if (eventTile.Event != EventType::Empty) {
-						for (const auto& [peer, peerDesc] : _peerDesc) {
-							MemoryStream packet(13 + Events::EventSpawner::SpawnParamsSize);
-							packet.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::CreateMirroredActor);
-							packet.WriteVariableUint32(remotingActorId);
-							packet.WriteVariableUint32((std::uint32_t)eventTile.Event);
-							packet.Write(eventTile.EventParams, Events::EventSpawner::SpawnParamsSize);
-							packet.WriteVariableUint32((std::uint32_t)eventTile.EventFlags);
-							packet.WriteVariableInt32((std::int32_t)originTile.X);
-							packet.WriteVariableInt32((std::int32_t)originTile.Y);
-							packet.WriteVariableInt32((std::int32_t)remotingActor->_renderer.layer());
-
-							// TODO: If it fail, it will release the packet which is wrong
-							_networkManager->SendToPeer(peer, NetworkChannel::Main, packet.GetBuffer(), packet.GetSize());
-						}
-					}
-				} else {
-					const auto& metadataPath = remotingActor->_metadata->Path;
+				if (!ActorShouldBeMirrored(remotingActor)) {
+					continue;
+				}
 
-					MemoryStream packet(24 + metadataPath.size());
-					packet.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::CreateRemoteActor);
+				Vector2i originTile = remotingActor->_originTile;
+				const auto& eventTile = _eventMap->GetEventTile(originTile.X, originTile.Y);
+				if (eventTile.Event != EventType::Empty) {
+					MemoryStream packet(13 + Events::EventSpawner::SpawnParamsSize);
+					packet.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::CreateMirroredActor);
 					packet.WriteVariableUint32(remotingActorId);
-					packet.WriteVariableInt32((std::int32_t)remotingActor->_pos.X);
-					packet.WriteVariableInt32((std::int32_t)remotingActor->_pos.Y);
+					packet.WriteVariableUint32((std::uint32_t)eventTile.Event);
+					packet.Write(eventTile.EventParams, Events::EventSpawner::SpawnParamsSize);
+					packet.WriteVariableUint32((std::uint32_t)eventTile.EventFlags);
+					packet.WriteVariableInt32((std::int32_t)originTile.X);
+					packet.WriteVariableInt32((std::int32_t)originTile.Y);
 					packet.WriteVariableInt32((std::int32_t)remotingActor->_renderer.layer());
-					packet.WriteVariableUint32((std::uint32_t)remotingActor->_state);
-					packet.WriteVariableUint32((std::uint32_t)metadataPath.size());
-					packet.Write(metadataPath.data(), (std::uint32_t)metadataPath.size());
-					packet.WriteVariableUint32((std::uint32_t)(remotingActor->_currentTransition != nullptr ? remotingActor->_currentTransition->State : remotingActor->_currentAnimation->State));
 
 					// TODO: If it fail, it will release the packet which is wrong
 					_networkManager->SendToPeer(peer, NetworkChannel::Main, packet.GetBuffer(), packet.GetSize());
@@ -1828,6 +1773,182 @@ namespace Jazz2::Multiplayer
 		}
 	}
 
+	void MultiLevelHandler::BuildInterestGrid(const Snapshot& snapshot)
+	{
+		// Actors are bucketed to a uniform grid over the tile map, so each peer has to check only nearby cells
+		Vector2i levelSize = _tileMap->GetSize();
+		_interestGridWidth = std::max((levelSize.X * TileSet::DefaultTileSize + InterestGridCellSize - 1) / InterestGridCellSize, 1);
+		_interestGridHeight = std::max((levelSize.Y * TileSet::DefaultTileSize + InterestGridCellSize - 1) / InterestGridCellSize, 1);
+
+		_interestGrid.clear();
+		_interestGrid.reserve(snapshot.Actors.size());
+
+		for (std::size_t i = 0; i < snapshot.Actors.size(); i++) {
+			const auto& actor = snapshot.Actors[i];
+			std::int32_t x = std::clamp(actor.PosX / (512 * InterestGridCellSize), 0, _interestGridWidth - 1);
+			std::int32_t y = std::clamp(actor.PosY / (512 * InterestGridCellSize), 0, _interestGridHeight - 1);
+			_interestGrid.emplace_back((std::uint32_t)(y * _interestGridWidth + x), (std::uint32_t)i);
+		}
+
+		std::sort(_interestGrid.begin(), _interestGrid.end());
+	}
+
+	void MultiLevelHandler::SendSnapshotToPeer(const Peer& peer, PeerDesc& peerDesc, const Snapshot& snapshot)
+	{
+		if (peerDesc.Snapshots.empty()) {
+			peerDesc.Snapshots.resize(SnapshotHistorySize);
+		}
+
+		std::uint32_t seqNum = snapshot.SeqNum;
+		const Snapshot* prevSnapshot = &peerDesc.Snapshots[(seqNum - 1) % SnapshotHistorySize];
+		if (prevSnapshot->SeqNum != seqNum - 1) {
+			prevSnapshot = nullptr;
+		}
+
+		Snapshot& peerSnapshot = peerDesc.Snapshots[seqNum % SnapshotHistorySize];
+		peerSnapshot.SeqNum = seqNum;
+		peerSnapshot.Actors.clear();
+
+		// Actors inside the viewport (with some margin) are always updated, actors farther away accumulate priority
+		// based on their distance and they are updated only when the priority reaches 1, the rest is not sent at all
+		Vector2f center = peerDesc.Player->_pos;
+		float innerHalfW = peerDesc.ViewSize.X * 0.5f + InterestMargin;
+		float innerHalfH = peerDesc.ViewSize.Y * 0.5f + InterestMargin;
+		float outerHalfW = innerHalfW + InterestFarDistance;
+		float outerHalfH = innerHalfH + InterestFarDistance;
+
+		std::int32_t x1 = std::clamp((std::int32_t)(center.X - outerHalfW) / InterestGridCellSize, 0, _interestGridWidth - 1);
+		std::int32_t y1 = std::clamp((std::int32_t)(center.Y - outerHalfH) / InterestGridCellSize, 0, _interestGridHeight - 1);
+		std::int32_t x2 = std::clamp((std::int32_t)(center.X + outerHalfW) / InterestGridCellSize, 0, _interestGridWidth - 1);
+		std::int32_t y2 = std::clamp((std::int32_t)(center.Y + outerHalfH) / InterestGridCellSize, 0, _interestGridHeight - 1);
+
+		SmallVector<std::uint32_t, 128> relevantActors;
+		for (std::int32_t y = y1; y <= y2; y++) {
+			std::uint32_t firstCell = (std::uint32_t)(y * _interestGridWidth + x1);
+			std::uint32_t lastCell = (std::uint32_t)(y * _interestGridWidth + x2);
+			auto it = std::lower_bound(_interestGrid.begin(), _interestGrid.end(), std::make_pair(firstCell, 0u));
+			for (; it != _interestGrid.end() && it->first <= lastCell; ++it) {
+				relevantActors.push_back(it->second);
+			}
+		}
+
+		// Snapshot must be sorted by actor ID, indices are in the same order as IDs
+		std::sort(relevantActors.begin(), relevantActors.end());
+
+		for (std::uint32_t actorIdx : relevantActors) {
+			const auto& interestActor = _interestActors[actorIdx];
+			const auto& actor = snapshot.Actors[actorIdx];
+			if (interestActor.Actor == peerDesc.Player) {
+				continue;
+			}
+
+			float dx = std::max(std::abs(actor.PosX / 512.0f - center.X) - innerHalfW, 0.0f);
+			float dy = std::max(std::abs(actor.PosY / 512.0f - center.Y) - innerHalfH, 0.0f);
+			if (dx > InterestFarDistance || dy > InterestFarDistance) {
+				continue;
+			}
+
+			auto& interest = peerDesc.Interest[actor.Id];
+			interest.LastRelevantSeqNum = seqNum;
+
+			bool forceUpdate = false;
+			if (interestActor.Kind == InterestKind::Remote && !interest.IsCreated) {
+				SendCreateRemoteActor(peer, interestActor.Actor, actor.Id);
+				interest.IsCreated = true;
+				forceUpdate = true;
+			}
+
+			if (forceUpdate || (dx <= 0.0f && dy <= 0.0f)) {
+				interest.Priority = 0.0f;
+				peerSnapshot.Actors.push_back(actor);
+				continue;
+			}
+
+			float distance = std::sqrt(dx * dx + dy * dy);
+			interest.Priority += std::max(InterestFarUpdateRate * (1.0f - distance / InterestFarDistance), 1.0f / UpdatesPerSecond);
+			if (interest.Priority >= 1.0f) {
+				interest.Priority = 0.0f;
+				peerSnapshot.Actors.push_back(actor);
+				continue;
+			}
+
+			// Not updated in this snapshot, repeat the last sent state, so nothing is written by delta encoding
+			const SnapshotActor* prevActor = nullptr;
+			if (prevSnapshot != nullptr) {
+				auto prevIt = std::lower_bound(prevSnapshot->Actors.begin(), prevSnapshot->Actors.end(), actor.Id, [](const SnapshotActor& a, std::uint32_t id) {
+					return a.Id < id;
+				});
+				if (prevIt != prevSnapshot->Actors.end() && prevIt->Id == actor.Id) {
+					prevActor = &*prevIt;
+				}
+			}
+			peerSnapshot.Actors.push_back(prevActor != nullptr ? *prevActor : actor);
+		}
+
+		// Actors that left area of interest for a longer time are destroyed on the client side
+		SmallVector<std::uint32_t, 16> expiredActors;
+		for (const auto& [actorId, interest] : peerDesc.Interest) {
+			if (seqNum - interest.LastRelevantSeqNum > InterestDestroyDelay) {
+				expiredActors.push_back(actorId);
+			}
+		}
+		for (std::uint32_t actorId : expiredActors) {
+			auto it = peerDesc.Interest.find(actorId);
+			if (it->second.IsCreated) {
+				MemoryStream packet(5);
+				packet.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::DestroyRemoteActor);
+				packet.WriteVariableUint32(actorId);
+				_networkManager->SendToPeer(peer, NetworkChannel::Main, packet.GetBuffer(), packet.GetSize());
+			}
+			peerDesc.Interest.erase(it);
+		}
+
+		std::uint32_t baselineSeqNum = peerDesc.LastAckSnapshot;
+		if (baselineSeqNum != 0 && (baselineSeqNum >= seqNum || seqNum - baselineSeqNum >= SnapshotHistorySize ||
+			peerDesc.Snapshots[baselineSeqNum % SnapshotHistorySize].SeqNum != baselineSeqNum)) {
+			// Baseline is too old, send full snapshot instead
+			baselineSeqNum = 0;
+		}
+
+		MemoryStream packet(16 + peerSnapshot.Actors.size() * 8);
+		WriteSnapshotDelta(packet, peerSnapshot, baselineSeqNum != 0 ? &peerDesc.Snapshots[baselineSeqNum % SnapshotHistorySize] : nullptr);
+
+		MemoryStream packetCompressed(1024);
+		packetCompressed.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::UpdateAllActors);
+		packetCompressed.WriteVariableUint32(seqNum);
+		packetCompressed.WriteVariableUint32(baselineSeqNum);
+		DeflateWriter dw(packetCompressed);
+		dw.Write(packet.GetBuffer(), packet.GetSize());
+		dw.Dispose();
+
+#if defined(DEATH_DEBUG) && defined(WITH_IMGUI)
+		_updatePacketSize[_plotIndex] = packet.GetSize();
+		_updatePacketMaxSize = std::max(_updatePacketMaxSize, _updatePacketSize[_plotIndex]);
+		_compressedUpdatePacketSize[_plotIndex] = packetCompressed.GetSize();
+#endif
+
+		_networkManager->SendToPeer(peer, NetworkChannel::UnreliableUpdates, packetCompressed.GetBuffer(), packetCompressed.GetSize());
+	}
+
+	void MultiLevelHandler::SendCreateRemoteActor(const Peer& peer, Actors::ActorBase* actor, std::uint32_t actorId)
+	{
+		const auto& metadataPath = actor->_metadata->Path;
+
+		MemoryStream packet(24 + metadataPath.size());
+		packet.WriteValue<std::uint8_t>((std::uint8_t)ServerPacketType::CreateRemoteActor);
+		packet.WriteVariableUint32(actorId);
+		packet.WriteVariableInt32((std::int32_t)actor->_pos.X);
+		packet.WriteVariableInt32((std::int32_t)actor->_pos.Y);
+		packet.WriteVariableInt32((std::int32_t)actor->_renderer.layer());
+		packet.WriteVariableUint32((std::uint32_t)actor->_state);
+		packet.WriteVariableUint32((std::uint32_t)metadataPath.size());
+		packet.Write(metadataPath.data(), (std::uint32_t)metadataPath.size());
+		packet.WriteVariableUint32((std::uint32_t)(actor->_currentTransition != nullptr ? actor->_currentTransition->State : actor->_currentAnimation->State));
+
+		// TODO: If it fail, it will release the packet which is wrong
+		_networkManager->SendToPeer(peer, NetworkChannel::Main, packet.GetBuffer(), packet.GetSize());
+	}
+
 	std::uint32_t MultiLevelHandler::FindFreeActorId()
 	{
 		//return ++_lastSpawnedActorId;
@@ -1881,6 +2002,176 @@ namespace Jazz2::Multiplayer
 				runtime_cast<Actors::Solid::PinballPaddle*>(actor) || runtime_cast<Actors::Solid::SpikeBall*>(actor));
 	}
 
+	void MultiLevelHandler::FillSnapshotActor(SnapshotActor& dest, std::uint32_t actorId, Actors::ActorBase* actor)
+	{
+		dest.Id = actorId;
+		dest.PosX = (std::int32_t)(actor->_pos.X * 512.0f);
+		dest.PosY = (std::int32_t)(actor->_pos.Y * 512.0f);
+		dest.Anim = (std::uint32_t)(actor->_currentTransition != nullptr ? actor->_currentTransition->State : (actor->_currentAnimation != nullptr ? actor->_currentAnimation->State : AnimState::Idle));
+
+		float rotation = actor->_renderer.rotation();
+		if (rotation < 0.0f) rotation += fRadAngle360;
+		dest.Rotation = (std::uint8_t)(rotation * 255.0f / fRadAngle360);
+
+		std::uint8_t flags = 0;
+		if (actor->IsFacingLeft()) {
+			flags |= 0x01;
+		}
+		if (actor->_renderer.isDrawEnabled()) {
+			flags |= 0x02;
+		}
+		if (actor->_renderer.AnimPaused) {
+			flags |= 0x04;
+		}
+		dest.Flags = flags;
+		dest.RendererType = (std::uint8_t)actor->_renderer.GetRendererType();
+	}
+
+	void MultiLevelHandler::WriteSnapshotDelta(Stream& dest, const Snapshot& snapshot, const Snapshot* baseline)
+	{
+		// Both snapshots are sorted by actor ID, so they can be merged in one pass, only changed fields are written,
+		// actors that are not present in the baseline are written with all fields (as delta from zero)
+		SmallVector<std::uint32_t, 16> removedIds;
+		MemoryStream changes(16 + snapshot.Actors.size() * 8);
+		std::uint32_t changedCount = 0;
+		std::uint32_t lastId = 0;
+		std::size_t j = 0;
+
+		for (const auto& actor : snapshot.Actors) {
+			const SnapshotActor* prev = nullptr;
+			if (baseline != nullptr) {
+				while (j < baseline->Actors.size() && baseline->Actors[j].Id < actor.Id) {
+					removedIds.push_back(baseline->Actors[j].Id);
+					j++;
+				}
+				if (j < baseline->Actors.size() && baseline->Actors[j].Id == actor.Id) {
+					prev = &baseline->Actors[j];
+					j++;
+				}
+			}
+
+			SnapshotFields fields;
+			if (prev == nullptr) {
+				fields = SnapshotFields::All;
+			} else {
+				fields = SnapshotFields::None;
+				if (actor.PosX != prev->PosX) fields |= SnapshotFields::PosX;
+				if (actor.PosY != prev->PosY) fields |= SnapshotFields::PosY;
+				if (actor.Anim != prev->Anim) fields |= SnapshotFields::Anim;
+				if (actor.Rotation != prev->Rotation) fields |= SnapshotFields::Rotation;
+				if (actor.Flags != prev->Flags) fields |= SnapshotFields::Flags;
+				if (actor.RendererType != prev->RendererType) fields |= SnapshotFields::RendererType;
+
+				if (fields == SnapshotFields::None) {
+					continue;
+				}
+			}
+
+			changes.WriteVariableUint32(actor.Id - lastId);
+			changes.WriteValue<std::uint8_t>((std::uint8_t)fields);
+			lastId = actor.Id;
+			changedCount++;
+
+			if ((fields & SnapshotFields::PosX) == SnapshotFields::PosX) {
+				changes.WriteVariableInt32(actor.PosX - (prev != nullptr ? prev->PosX : 0));
+			}
+			if ((fields & SnapshotFields::PosY) == SnapshotFields::PosY) {
+				changes.WriteVariableInt32(actor.PosY - (prev != nullptr ? prev->PosY : 0));
+			}
+			if ((fields & SnapshotFields::Anim) == SnapshotFields::Anim) {
+				changes.WriteVariableUint32(actor.Anim);
+			}
+			if ((fields & SnapshotFields::Rotation) == SnapshotFields::Rotation) {
+				changes.WriteValue<std::uint8_t>(actor.Rotation);
+			}
+			if ((fields & SnapshotFields::Flags) == SnapshotFields::Flags) {
+				changes.WriteValue<std::uint8_t>(actor.Flags);
+			}
+			if ((fields & SnapshotFields::RendererType) == SnapshotFields::RendererType) {
+				changes.WriteValue<std::uint8_t>(actor.RendererType);
+			}
+		}
+
+		if (baseline != nullptr) {
+			for (; j < baseline->Actors.size(); j++) {
+				removedIds.push_back(baseline->Actors[j].Id);
+			}
+		}
+
+		dest.WriteVariableUint32((std::uint32_t)removedIds.size());
+		lastId = 0;
+		for (std::uint32_t id : removedIds) {
+			dest.WriteVariableUint32(id - lastId);
+			lastId = id;
+		}
+
+		dest.WriteVariableUint32(changedCount);
+		dest.Write(changes.GetBuffer(), (std::int32_t)changes.GetSize());
+	}
+
+	void MultiLevelHandler::ReadSnapshotDelta(Stream& src, Snapshot& snapshot, const Snapshot* baseline)
+	{
+		std::uint32_t removedCount = src.ReadVariableUint32();
+		SmallVector<std::uint32_t, 16> removedIds;
+		removedIds.reserve(removedCount);
+		std::uint32_t lastId = 0;
+		for (std::uint32_t i = 0; i < removedCount; i++) {
+			lastId += src.ReadVariableUint32();
+			removedIds.push_back(lastId);
+		}
+
+		// Start with all actors from the baseline except removed ones, both lists are sorted
+		snapshot.Actors.clear();
+		if (baseline != nullptr) {
+			snapshot.Actors.reserve(baseline->Actors.size());
+			std::size_t j = 0;
+			for (const auto& actor : baseline->Actors) {
+				while (j < removedIds.size() && removedIds[j] < actor.Id) {
+					j++;
+				}
+				if (j < removedIds.size() && removedIds[j] == actor.Id) {
+					continue;
+				}
+				snapshot.Actors.push_back(actor);
+			}
+		}
+
+		std::uint32_t changedCount = src.ReadVariableUint32();
+		lastId = 0;
+		for (std::uint32_t i = 0; i < changedCount; i++) {
+			lastId += src.ReadVariableUint32();
+			SnapshotFields fields = (SnapshotFields)src.ReadValue<std::uint8_t>();
+
+			auto it = std::lower_bound(snapshot.Actors.begin(), snapshot.Actors.end(), lastId, [](const SnapshotActor& a, std::uint32_t id) {
+				return a.Id < id;
+			});
+			if (it == snapshot.Actors.end() || it->Id != lastId) {
+				SnapshotActor newActor = { };
+				newActor.Id = lastId;
+				it = snapshot.Actors.insert(it, newActor);
+			}
+
+			if ((fields & SnapshotFields::PosX) == SnapshotFields::PosX) {
+				it->PosX += src.ReadVariableInt32();
+			}
+			if ((fields & SnapshotFields::PosY) == SnapshotFields::PosY) {
+				it->PosY += src.ReadVariableInt32();
+			}
+			if ((fields & SnapshotFields::Anim) == SnapshotFields::Anim) {
+				it->Anim = src.ReadVariableUint32();
+			}
+			if ((fields & SnapshotFields::Rotation) == SnapshotFields::Rotation) {
+				it->Rotation = src.ReadValue<std::uint8_t>();
+			}
+			if ((fields & SnapshotFields::Flags) == SnapshotFields::Flags) {
+				it->Flags = src.ReadValue<std::uint8_t>();
+			}
+			if ((fields & SnapshotFields::RendererType) == SnapshotFields::RendererType) {
+				it->RendererType = src.ReadValue<std::uint8_t>();
+			}
+		}
+	}
+
 	/*void MultiLevelHandler::UpdatePlayerLocalPos(Actors::Player* player, PlayerState& playerState, float timeMult)
 	{
 		if (playerState.WarpTimeLeft > 0.0f || !player->_controllable || !player->GetState(Actors::ActorState::CollideWithTileset)) {
@@ -51,9 +51,9 @@ namespace Jazz2::Multiplayer
 		std::shared_ptr<AudioBufferPlayer> PlayCommonSfx(const StringView identifier, const Vector3f& pos, float gain = 1.0f, float pitch = 1.0f) override;
 		void WarpCameraToTarget(Actors::ActorBase* actor, bool fast = false) override;
 		bool IsPositionEmpty(Actors::ActorBase* self, const AABBf& aabb, TileCollisionParams& params, Actors::ActorBase** collider) override;
-		void FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, const std::function<bool(Actors::ActorBase*)>& callback) override;
-		void FindCollisionActorsByRadius(float x, float y, float radius, const std::function<bool(Actors::ActorBase*)>& callback) override;
-		void GetCollidingPlayers(const AABBf& aabb, const std::function<bool(Actors::ActorBase*)> callback) override;
+		void FindCollisionActorsByAABB(Actors::ActorBase* self, const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback) override;
+		void FindCollisionActorsByRadius(float x, float y, float radius, FunctionRef<bool(Actors::ActorBase*)> callback) override;
+		void GetCollidingPlayers(const AABBf& aabb, FunctionRef<bool(Actors::ActorBase*)> callback) override;
 
 		void BroadcastTriggeredEvent(Actors::ActorBase* initiator, EventType eventType, uint8_t* eventParams) override;
 		void BeginLevelChange(Actors::ActorBase* initiator, ExitType exitType, const StringView nextLevel = {}) override;
@@ -114,13 +114,74 @@ namespace Jazz2::Multiplayer
 			LevelSynchronized
 		};
 
+		enum class SnapshotFields : std::uint8_t {
+			None = 0,
+
+			PosX = 0x01,
+			PosY = 0x02,
+			Anim = 0x04,
+			Rotation = 0x08,
+			Flags = 0x10,
+			RendererType = 0x20,
+
+			All = PosX | PosY | Anim | Rotation | Flags | RendererType
+		};
+
+		DEFINE_PRIVATE_ENUM_OPERATORS(SnapshotFields);
+
+		// Quantized state of one actor, position is in 1/512 pixel units
+		struct SnapshotActor {
+			std::uint32_t Id;
+			std::int32_t PosX;
+			std::int32_t PosY;
+			std::uint32_t Anim;
+			std::uint8_t Rotation;
+			std::uint8_t Flags;
+			std::uint8_t RendererType;
+		};
+
+		struct Snapshot {
+			std::uint32_t SeqNum;
+			// Sorted by actor ID
+			SmallVector<SnapshotActor, 0> Actors;
+
+			Snapshot() : SeqNum(0) {}
+		};
+
+		// Server: Interest of one peer in one actor
+		struct ActorInterest {
+			float Priority;
+			std::uint32_t LastRelevantSeqNum;
+			bool IsCreated;
+
+			ActorInterest() : Priority(0.0f), LastRelevantSeqNum(0), IsCreated(false) {}
+		};
+
 		struct PeerDesc {
 			Actors::Multiplayer::RemotePlayerOnServer* Player;
 			PeerState State;
 			std::uint32_t LastUpdated;
+			std::uint32_t LastAckSnapshot;
+			Vector2i ViewSize;
+			// Snapshots sent to the peer, each peer receives only actors in its area of interest
+			SmallVector<Snapshot, 0> Snapshots;
+			HashMap<std::uint32_t, ActorInterest> Interest;
 
 			PeerDesc() {}
-			PeerDesc(Actors::Multiplayer::RemotePlayerOnServer* player, PeerState state) : Player(player), State(state), LastUpdated(0) {}
+			PeerDesc(Actors::Multiplayer::RemotePlayerOnServer* player, PeerState state, Vector2i viewSize)
+				: Player(player), State(state), LastUpdated(0), LastAckSnapshot(0), ViewSize(viewSize) {}
+		};
+
+		enum class InterestKind : std::uint8_t {
+			Player,
+			Mirrored,
+			Remote
+		};
+
+		struct InterestActor {
+			Actors::ActorBase* Actor;
+			std::uint32_t Id;
+			InterestKind Kind;
 		};
 
 		enum class PlayerFlags {
@@ -150,6 +211,12 @@ namespace Jazz2::Multiplayer
 
 		static constexpr float UpdatesPerSecond = 16.0f; // ~62 ms interval
 		static constexpr std::int64_t ServerDelay = 64;
+		static constexpr std::uint32_t SnapshotHistorySize = 32; // ~2 seconds
+		static constexpr float InterestMargin = 128.0f;
+		static constexpr float InterestFarDistance = 1024.0f;
+		static constexpr float InterestFarUpdateRate = 0.5f;
+		static constexpr std::uint32_t InterestDestroyDelay = SnapshotHistorySize + 16; // Must be longer than snapshot history
+		static constexpr std::int32_t InterestGridCellSize = 512;
 
 		NetworkManager* _networkManager;
 		MultiplayerGameMode _gameMode;
@@ -165,12 +232,24 @@ namespace Jazz2::Multiplayer
 		std::uint64_t _seqNumWarped; // Client: set to _seqNum from HandlePlayerWarped() when warped
 		bool _suppressRemoting; // Server: if true, actor will not be automatically remoted to other players
 		bool _ignorePackets;
+		Snapshot _snapshots[SnapshotHistorySize]; // Server: Snapshots of all actors, Client: Received snapshots
+		std::uint32_t _lastSnapshotSeqNum; // Server: sequence number of the last sent snapshot, Client: the last received snapshot
+		SmallVector<InterestActor, 0> _interestActors; // Server: Actors in the last snapshot, in the same order
+		SmallVector<std::pair<std::uint32_t, std::uint32_t>, 0> _interestGrid; // Server: Grid cell -> index to `_interestActors`, sorted by cell
+		std::int32_t _interestGridWidth; // Server
+		std::int32_t _interestGridHeight; // Server
 
 		void SynchronizePeers();
+		void BuildInterestGrid(const Snapshot& snapshot);
+		void SendSnapshotToPeer(const Peer& peer, PeerDesc& peerDesc, const Snapshot& snapshot);
+		void SendCreateRemoteActor(const Peer& peer, Actors::ActorBase* actor, std::uint32_t actorId);
 		std::uint32_t FindFreeActorId();
 		std::uint8_t FindFreePlayerId();
 
 		static bool ActorShouldBeMirrored(Actors::ActorBase* actor);
+		static void FillSnapshotActor(SnapshotActor& dest, std::uint32_t actorId, Actors::ActorBase* actor);
+		static void WriteSnapshotDelta(Stream& dest, const Snapshot& snapshot, const Snapshot* baseline);
+		static void ReadSnapshotDelta(Stream& src, Snapshot& snapshot, const Snapshot* baseline);
 
 #if defined(DEATH_DEBUG) && defined(WITH_IMGUI)
 		static constexpr std::int32_t PlotValueCount = 512;
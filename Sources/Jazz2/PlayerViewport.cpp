@@ -12,23 +12,65 @@ namespace Jazz2
 	bool LightingRenderer::OnDraw(RenderQueue& renderQueue)
 	{
 		_renderCommandsCount = 0;
-		_emittedLightsCache.clear();
 
-		// Collect all active light emitters
-		auto actors = _owner->_levelHandler->GetActors();
-		std::size_t actorsCount = actors.size();
-		for (std::size_t i = 0; i < actorsCount; i++) {
-			actors[i]->OnEmitLights(_emittedLightsCache);
+		if (_owner->_levelHandler->_lightingShader == nullptr) {
+			return true;
 		}
 
-		for (auto& light : _emittedLightsCache) {
-			auto command = RentRenderCommand();
-			auto instanceBlock = command->material().uniformBlock(Material::InstanceBlockName);
-			instanceBlock->uniform(Material::TexRectUniformName)->setFloatValue(light.Pos.X, light.Pos.Y, light.RadiusNear / light.RadiusFar, 0.0f);
-			instanceBlock->uniform(Material::SpriteSizeUniformName)->setFloatValue(light.RadiusFar * 2.0f, light.RadiusFar * 2.0f);
-			instanceBlock->uniform(Material::ColorUniformName)->setFloatValue(light.Intensity, light.Brightness, 0.0f, 0.0f);
-			command->setTransformation(Matrix4x4f::Translation(light.Pos.X, light.Pos.Y, 0));
+		// Light emitters are collected only once per frame and then culled for each viewport
+		auto lights = _owner->_levelHandler->GetEmittedLights();
+
+		Vector2f halfView = _owner->GetViewportSize().As<float>() * 0.5f;
+		float viewLeft = _owner->_cameraPos.X - halfView.X;
+		float viewTop = _owner->_cameraPos.Y - halfView.Y;
+		float viewRight = _owner->_cameraPos.X + halfView.X;
+		float viewBottom = _owner->_cameraPos.Y + halfView.Y;
+
+		// All visible lights are drawn using instanced draws, usually only one per viewport
+		RenderCommand* command = nullptr;
+		GLUniformBlockCache* instancesBlock = nullptr;
+		std::int32_t count = 0;
+		std::int32_t capacity = 0;
+
+		for (auto& light : lights) {
+			if (light.Pos.X + light.RadiusFar < viewLeft || light.Pos.X - light.RadiusFar > viewRight ||
+				light.Pos.Y + light.RadiusFar < viewTop || light.Pos.Y - light.RadiusFar > viewBottom) {
+				continue;
+			}
+
+			if (count >= capacity) {
+				if (command != nullptr) {
+					FinalizeRenderCommand(command, instancesBlock, count);
+					renderQueue.addCommand(command);
+				}
 
+				command = RentRenderCommand();
+				instancesBlock = command->material().uniformBlock(Material::InstancesBlockName);
+				capacity = (std::int32_t)(instancesBlock->size() / sizeof(LightInstance));
+				count = 0;
+			}
+
+			LightInstance instance;
+			instance.ModelMatrix = Matrix4x4f::Translation(light.Pos.X, light.Pos.Y, 0.0f);
+			instance.Color[0] = light.Intensity;
+			instance.Color[1] = light.Brightness;
+			instance.Color[2] = 0.0f;
+			instance.Color[3] = 0.0f;
+			instance.TexRect[0] = light.Pos.X;
+			instance.TexRect[1] = light.Pos.Y;
+			instance.TexRect[2] = light.RadiusNear / light.RadiusFar;
+			instance.TexRect[3] = 0.0f;
+			instance.SpriteSize[0] = light.RadiusFar * 2.0f;
+			instance.SpriteSize[1] = light.RadiusFar * 2.0f;
+			instance.Padding[0] = 0.0f;
+			instance.Padding[1] = 0.0f;
+
+			instancesBlock->copyData(count * sizeof(LightInstance), reinterpret_cast<const GLubyte*>(&instance), sizeof(LightInstance));
+			count++;
+		}
+
+		if (command != nullptr) {
+			FinalizeRenderCommand(command, instancesBlock, count);
 			renderQueue.addCommand(command);
 		}
 
@@ -48,7 +90,6 @@ namespace Jazz2
 			command->material().setBlendingEnabled(true);
 			command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE);
 			command->material().reserveUniformsDataMemory();
-			command->geometry().setDrawParameters(GL_TRIANGLE_STRIP, 0, 4);
 
 			GLUniformCache* textureUniform = command->material().uniform(Material::TextureUniformName);
 			if (textureUniform && textureUniform->intValue(0) != 0) {
@@ -58,6 +99,13 @@ namespace Jazz2
 		}
 	}
 
+	void LightingRenderer::FinalizeRenderCommand(RenderCommand* command, GLUniformBlockCache* instancesBlock, std::int32_t count)
+	{
+		instancesBlock->setUsedSize(count * sizeof(LightInstance));
+		command->setBatchSize(count);
+		command->geometry().setDrawParameters(GL_TRIANGLES, 0, 6 * count);
+	}
+
 	void BlurRenderPass::Initialize(Texture* source, std::int32_t width, std::int32_t height, const Vector2f& direction)
 	{
 		_source = source;
@@ -12,19 +12,30 @@ namespace Jazz2
 		LightingRenderer(PlayerViewport* owner)
 			: _owner(owner), _renderCommandsCount(0)
 		{
-			_emittedLightsCache.reserve(32);
 			setVisitOrderState(SceneNode::VisitOrderState::Disabled);
 		}
 
 		bool OnDraw(RenderQueue& renderQueue) override;
 
 	private:
+		// Layout of one instance in `InstancesBlock` of the batched lighting shader (std140)
+		struct LightInstance
+		{
+			Matrix4x4f ModelMatrix;
+			float Color[4];
+			float TexRect[4];
+			float SpriteSize[2];
+			float Padding[2];
+		};
+
+		static_assert(sizeof(LightInstance) == 112, "LightInstance must match layout of the shader");
+
 		PlayerViewport* _owner;
 		SmallVector<std::unique_ptr<RenderCommand>, 0> _renderCommands;
 		std::int32_t _renderCommandsCount;
-		SmallVector<LightEmitter, 0> _emittedLightsCache;
 
 		RenderCommand* RentRenderCommand();
+		static void FinalizeRenderCommand(RenderCommand* command, GLUniformBlockCache* instancesBlock, std::int32_t count);
 	};
 
 	class BlurRenderPass : public SceneNode
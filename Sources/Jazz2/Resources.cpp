@@ -3,10 +3,108 @@
 namespace Jazz2
 {
 	GenericGraphicResource::GenericGraphicResource() noexcept
-		: Flags(GenericGraphicResourceFlags::None)
+		: Flags(GenericGraphicResourceFlags::None), MaskStride(0), PaletteOffset(0)
 	{
 	}
 
+	void GenericGraphicResource::BuildCollisionMask(const std::uint32_t* pixels, std::int32_t width)
+	{
+		BeginCollisionMask();
+		AddCollisionMaskRows(pixels, width, 0, FrameDimensions.Y * FrameConfiguration.Y);
+		EndCollisionMask();
+	}
+
+	void GenericGraphicResource::BeginCollisionMask()
+	{
+		std::int32_t frameWidth = FrameDimensions.X;
+		std::int32_t frameHeight = FrameDimensions.Y;
+		std::int32_t frameCount = FrameConfiguration.X * FrameConfiguration.Y;
+		if (frameWidth <= 0 || frameHeight <= 0 || frameCount <= 0) {
+			return;
+		}
+
+		// Each frame is stored twice (facing right and facing left), rows of the same 32 columns are stored
+		// together, so multiple rows can be tested at once
+		MaskStride = (frameWidth + 31) / 32;
+		std::int32_t wordsPerFrame = MaskStride * frameHeight;
+		Mask = std::shared_ptr<std::uint32_t[]>(new std::uint32_t[frameCount * 2 * wordsPerFrame]());
+		MaskBounds = std::shared_ptr<Recti[]>(new Recti[frameCount]);
+	}
+
+	void GenericGraphicResource::AddCollisionMaskRows(const std::uint32_t* pixels, std::int32_t width, std::int32_t firstRow, std::int32_t lastRow)
+	{
+		if (Mask == nullptr) {
+			return;
+		}
+
+		std::int32_t frameWidth = FrameDimensions.X;
+		std::int32_t frameHeight = FrameDimensions.Y;
+		std::int32_t wordsPerFrame = MaskStride * frameHeight;
+		lastRow = std::min(lastRow, frameHeight * FrameConfiguration.Y);
+
+		// Every row of a frame is stored in different words, so rows can be added independently
+		for (std::int32_t row = firstRow; row < lastRow; row++) {
+			std::int32_t y = row % frameHeight;
+			std::int32_t firstFrame = (row / frameHeight) * FrameConfiguration.X;
+
+			for (std::int32_t column = 0; column < FrameConfiguration.X; column++) {
+				const std::uint32_t* src = &pixels[row * width + column * frameWidth];
+				std::uint32_t* maskRight = &Mask[(firstFrame + column) * 2 * wordsPerFrame];
+				std::uint32_t* maskLeft = maskRight + wordsPerFrame;
+
+				for (std::int32_t x = 0; x < frameWidth; x++) {
+					if (((src[x] >> 24) & 0xff) <= MaskAlphaThreshold) {
+						continue;
+					}
+
+					std::int32_t xm = frameWidth - 1 - x;
+					maskRight[(x >> 5) * frameHeight + y] |= (1u << (x & 31));
+					maskLeft[(xm >> 5) * frameHeight + y] |= (1u << (xm & 31));
+				}
+			}
+		}
+	}
+
+	void GenericGraphicResource::EndCollisionMask()
+	{
+		if (Mask == nullptr) {
+			return;
+		}
+
+		std::int32_t frameHeight = FrameDimensions.Y;
+		std::int32_t frameCount = FrameConfiguration.X * FrameConfiguration.Y;
+		std::int32_t wordsPerFrame = MaskStride * frameHeight;
+
+		for (std::int32_t frame = 0; frame < frameCount; frame++) {
+			const std::uint32_t* maskRight = &Mask[frame * 2 * wordsPerFrame];
+
+			std::int32_t minX = INT32_MAX, minY = INT32_MAX, maxX = -1, maxY = -1;
+			for (std::int32_t word = 0; word < MaskStride; word++) {
+				for (std::int32_t y = 0; y < frameHeight; y++) {
+					std::uint32_t bits = maskRight[word * frameHeight + y];
+					if (bits == 0) {
+						continue;
+					}
+
+					std::int32_t first = 0, last = 31;
+					while ((bits & (1u << first)) == 0) {
+						first++;
+					}
+					while ((bits & (1u << last)) == 0) {
+						last--;
+					}
+
+					minX = std::min(minX, word * 32 + first);
+					maxX = std::max(maxX, word * 32 + last);
+					minY = std::min(minY, y);
+					maxY = std::max(maxY, y);
+				}
+			}
+
+			MaskBounds[frame] = (maxX >= 0 ? Recti(minX, minY, maxX - minX + 1, maxY - minY + 1) : Recti(0, 0, 0, 0));
+		}
+	}
+
 	GraphicResource::GraphicResource() noexcept
 	{
 	}
@@ -22,6 +120,13 @@ namespace Jazz2
 	{
 	}
 
+	GenericSoundResource::GenericSoundResource(AudioBuffer::Format format, std::int32_t frequency, const unsigned char* samples, unsigned long int samplesSize) noexcept
+		: Flags(GenericSoundResourceFlags::None)
+	{
+		Buffer.init(format, frequency);
+		Buffer.loadFromSamples(samples, samplesSize);
+	}
+
 	SoundResource::SoundResource() noexcept
 	{
 	}
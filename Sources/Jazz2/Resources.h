@@ -6,6 +6,7 @@
 #include "../nCine/Audio/AudioBuffer.h"
 #include "../nCine/Base/HashMap.h"
 #include "../nCine/Graphics/Texture.h"
+#include "../nCine/Primitives/Rect.h"
 #include "../nCine/Primitives/Vector2.h"
 
 #include <memory>
@@ -24,17 +25,30 @@ namespace Jazz2
 	{
 		None = 0x00,
 
-		Referenced = 0x01
+		Referenced = 0x01,
+		// Texture contains palette indices and alpha instead of colors, palette is applied in shader
+		Indexed = 0x02
 	};
 
 	DEFINE_ENUM_OPERATORS(GenericGraphicResourceFlags);
 
 	struct GenericGraphicResource
 	{
+		// Pixels with higher alpha are considered solid for collision checking
+		static constexpr std::uint8_t MaskAlphaThreshold = 40;
+
 		GenericGraphicResourceFlags Flags;
-		std::unique_ptr<Texture> TextureDiffuse;
+		// Texture can be shared by more resources if the sprite sheet is packed into a texture atlas
+		std::shared_ptr<Texture> TextureDiffuse;
 		//std::unique_ptr<Texture> TextureNormal;
-		std::unique_ptr<uint8_t[]> Mask;
+		// Position of the sprite sheet in the texture, it's zero if the resource doesn't share the texture
+		Vector2i TextureOffset;
+		// Bit-packed collision mask of all frames, it's stored also mirrored for frames facing left
+		std::shared_ptr<std::uint32_t[]> Mask;
+		// Tight bounds of solid pixels of each frame (not mirrored), empty if the frame has no solid pixels
+		std::shared_ptr<Recti[]> MaskBounds;
+		// Number of 32-bit words per row of a frame in the collision mask
+		std::int32_t MaskStride;
 		Vector2i FrameDimensions;
 		Vector2i FrameConfiguration;
 		float AnimDuration;
@@ -42,8 +56,33 @@ namespace Jazz2
 		Vector2i Hotspot;
 		Vector2i Coldspot;
 		Vector2i Gunspot;
+		// Offset to palettes used by indexed texture, all palette variants share the same texture and collision mask
+		std::uint16_t PaletteOffset;
 
 		GenericGraphicResource() noexcept;
+
+		bool IsIndexed() const {
+			return (Flags & GenericGraphicResourceFlags::Indexed) == GenericGraphicResourceFlags::Indexed;
+		}
+
+		// Builds collision mask from alpha channel of the whole sprite sheet, frame dimensions and configuration must be already set
+		void BuildCollisionMask(const std::uint32_t* pixels, std::int32_t width);
+		// Allocates empty collision mask, frame dimensions and configuration must be already set
+		void BeginCollisionMask();
+		// Adds rows `[firstRow, lastRow)` of the sprite sheet to collision mask, different rows can be added from multiple threads at once
+		void AddCollisionMaskRows(const std::uint32_t* pixels, std::int32_t width, std::int32_t firstRow, std::int32_t lastRow);
+		// Computes tight bounds of all frames, it must be called after all rows are added
+		void EndCollisionMask();
+
+		// Returns specified 32 columns of all rows of a frame, the bit N represents column `word * 32 + N`
+		const std::uint32_t* GetMaskColumn(std::int32_t frame, bool isFacingLeft, std::int32_t word) const {
+			return &Mask[((frame * 2 + (isFacingLeft ? 1 : 0)) * MaskStride + word) * FrameDimensions.Y];
+		}
+
+		// Returns true if a pixel of a frame (not mirrored) is solid, frames without collision mask are considered solid
+		bool IsMaskPixelSet(std::int32_t frame, std::int32_t x, std::int32_t y) const {
+			return (Mask == nullptr || ((GetMaskColumn(frame, false, x >> 5)[y] >> (x & 31)) & 1) != 0);
+		}
 	};
 
 	struct GraphicResource
@@ -75,6 +114,7 @@ namespace Jazz2
 		GenericSoundResourceFlags Flags;
 
 		GenericSoundResource(std::unique_ptr<Stream> stream, const StringView filename) noexcept;
+		GenericSoundResource(AudioBuffer::Format format, std::int32_t frequency, const unsigned char* samples, unsigned long int samplesSize) noexcept;
 	};
 
 	struct SoundResource
@@ -143,6 +183,8 @@ namespace Jazz2
 
 		TexturedBackground,
 		TexturedBackgroundCircle,
+		TileMapChunk,
+		TileMapChunkTinted,
 
 		Colorized,
 		BatchedColorized,
@@ -160,6 +202,8 @@ namespace Jazz2
 		BatchedShieldFire,
 		ShieldLightning,
 		BatchedShieldLightning,
+		Palette,
+		BatchedPalette,
 
 #if !defined(DISABLE_RESCALE_SHADERS)
 		ResizeHQ2x,
@@ -50,8 +50,9 @@ namespace Jazz2::Scripting
 	}
 
 	LevelScriptLoader::LevelScriptLoader(LevelHandler* levelHandler, const StringView& scriptPath)
-		: _levelHandler(levelHandler), _onLevelUpdate(nullptr), _onLevelUpdateLastFrame(-1), _onDrawAmmo(nullptr),
-			_onDrawHealth(nullptr), _onDrawLives(nullptr), _onDrawPlayerTimer(nullptr), _onDrawScore(nullptr), _onDrawGameModeHUD(nullptr)
+		: _levelHandler(levelHandler), _onLevelLoad(nullptr), _onLevelBegin(nullptr), _onLevelReload(nullptr), _onLevelUpdate(nullptr),
+			_onLevelUpdateLastFrame(-1), _onPlayer(nullptr), _onFunction{}, _onDrawAmmo(nullptr), _onDrawHealth(nullptr), _onDrawLives(nullptr),
+			_onDrawPlayerTimer(nullptr), _onDrawScore(nullptr), _onDrawGameModeHUD(nullptr)
 	{
 		// Try to load the script
 		HashMap<String, bool> DefinedSymbols = {
@@ -120,9 +121,44 @@ namespace Jazz2::Scripting
 
 		std::int32_t r = Build(); RETURN_ASSERT_MSG(r >= 0, "Cannot compile the script. Please correct the code and try again.");
 
+		ResolveCallbacks();
+	}
+
+	void LevelScriptLoader::ResolveCallbacks()
+	{
+		// All callbacks are resolved only once, so no string lookups are needed at runtime
+		_onLevelLoad = _module->GetFunctionByDecl("void onLevelLoad()");
+		_onLevelBegin = _module->GetFunctionByDecl("void onLevelBegin()");
+		_onLevelReload = _module->GetFunctionByDecl("void onLevelReload()");
+
+		// Event callbacks can have different parameters, so they are matched only by name (onFunction0 - onFunction255)
+		asUINT funcCount = _module->GetFunctionCount();
+		for (asUINT i = 0; i < funcCount; i++) {
+			asIScriptFunction* func = _module->GetFunctionByIndex(i);
+			StringView name = func->GetName();
+			if (!name.hasPrefix("onFunction"_s)) {
+				continue;
+			}
+
+			StringView suffix = name.exceptPrefix("onFunction"_s);
+			std::uint32_t index = 0;
+			bool isValid = !suffix.empty() && suffix.size() <= 3;
+			for (char c : suffix) {
+				if (c < '0' || c > '9') {
+					isValid = false;
+					break;
+				}
+				index = index * 10 + (c - '0');
+			}
+			if (isValid && index < arraySize(_onFunction) && _onFunction[index] == nullptr) {
+				_onFunction[index] = func;
+			}
+		}
+
 		switch (_scriptContextType) {
 			case ScriptContextType::Legacy:
 				_onLevelUpdate = _module->GetFunctionByDecl("void onMain()");
+				_onPlayer = _module->GetFunctionByDecl("void onPlayer(jjPLAYER@)");
 				_onDrawAmmo = _module->GetFunctionByDecl("bool onDrawAmmo(jjPLAYER@ player, jjCANVAS@ canvas)");
 				_onDrawHealth = _module->GetFunctionByDecl("bool onDrawHealth(jjPLAYER@ player, jjCANVAS@ canvas)");
 				_onDrawLives = _module->GetFunctionByDecl("bool onDrawLives(jjPLAYER@ player, jjCANVAS@ canvas)");
@@ -161,43 +197,21 @@ namespace Jazz2::Scripting
 
 	void LevelScriptLoader::OnLevelLoad()
 	{
-		asIScriptFunction* func = _module->GetFunctionByDecl("void onLevelLoad()");
-		if (func == nullptr) {
-			return;
-		}
-
-		asIScriptContext* ctx = _engine->RequestContext();
-
-		ctx->Prepare(func);
-		std::int32_t r = ctx->Execute();
-		if (r == asEXECUTION_EXCEPTION) {
-			OnException(ctx);
-		}
-
-		_engine->ReturnContext(ctx);
+		CallFunction(_onLevelLoad);
 	}
 
 	void LevelScriptLoader::OnLevelBegin()
 	{
-		asIScriptFunction* func = _module->GetFunctionByDecl("void onLevelBegin()");
-		if (func == nullptr) {
-			return;
-		}
-
-		asIScriptContext* ctx = _engine->RequestContext();
-
-		ctx->Prepare(func);
-		std::int32_t r = ctx->Execute();
-		if (r == asEXECUTION_EXCEPTION) {
-			OnException(ctx);
-		}
-
-		_engine->ReturnContext(ctx);
+		CallFunction(_onLevelBegin);
 	}
 
 	void LevelScriptLoader::OnLevelReload()
 	{
-		asIScriptFunction* func = _module->GetFunctionByDecl("void onLevelReload()");
+		CallFunction(_onLevelReload);
+	}
+
+	void LevelScriptLoader::CallFunction(asIScriptFunction* func)
+	{
 		if (func == nullptr) {
 			return;
 		}
@@ -217,9 +231,7 @@ namespace Jazz2::Scripting
 	{
 		switch (_scriptContextType) {
 			case ScriptContextType::Legacy: {
-				asIScriptFunction* onPlayer = _module->GetFunctionByName("void onPlayer(jjPLAYER@)");
-
-				if (_onLevelUpdate == nullptr && onPlayer == nullptr) {
+				if (_onLevelUpdate == nullptr && _onPlayer == nullptr) {
 					_onLevelUpdateLastFrame = (std::int32_t)_levelHandler->_elapsedFrames;
 					return;
 				}
@@ -239,9 +251,9 @@ namespace Jazz2::Scripting
 							_onLevelUpdate = nullptr;
 						}
 					}
-					if (onPlayer != nullptr) {
+					if (_onPlayer != nullptr) {
 						for (auto* player : _levelHandler->_players) {
-							ctx->Prepare(onPlayer);
+							ctx->Prepare(_onPlayer);
 
 							jjPLAYER* playerWrapper = new(asAllocMem(sizeof(jjPLAYER))) jjPLAYER(this, player);
 							ctx->SetArgObject(0, playerWrapper);
@@ -287,9 +299,7 @@ namespace Jazz2::Scripting
 
 	void LevelScriptLoader::OnLevelCallback(Actors::ActorBase* initiator, uint8_t* eventParams)
 	{
-		char funcName[32];
-		formatString(funcName, sizeof(funcName), "onFunction%i", eventParams[0]);
-		asIScriptFunction* func = _module->GetFunctionByName(funcName);
+		asIScriptFunction* func = _onFunction[eventParams[0]];
 		if (func != nullptr) {
 			asIScriptContext* ctx = _engine->RequestContext();
 			ctx->Prepare(func);
@@ -369,7 +379,7 @@ namespace Jazz2::Scripting
 			return;
 		}*/
 
-		LOGW("Callback function \"%s\" was not found in the script. Please correct the code and try again.", funcName);
+		LOGW("Callback function \"onFunction%i\" was not found in the script. Please correct the code and try again.", eventParams[0]);
 	}
 
 	bool LevelScriptLoader::OnDraw(UI::HUD* hud, DrawType type)
@@ -3364,6 +3374,11 @@ namespace Jazz2::Scripting
 		return _levelHandler->_players;
 	}
 
+	Actors::ActorBase* LevelScriptLoader::ResolveActor(Actors::ActorHandle handle) const
+	{
+		return _levelHandler->ResolveActor(handle);
+	}
+
 	uint8_t LevelScriptLoader::asGetDifficulty()
 	{
 		auto ctx = asGetActiveContext();
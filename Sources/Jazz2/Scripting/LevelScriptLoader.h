@@ -33,6 +33,7 @@ namespace Jazz2::Scripting
 		LevelScriptLoader(LevelHandler* levelHandler, const StringView& scriptPath);
 
 		const SmallVectorImpl<Actors::Player*>& GetPlayers() const;
+		Actors::ActorBase* ResolveActor(Actors::ActorHandle handle) const;
 
 		void OnLevelLoad();
 		void OnLevelBegin();
@@ -47,8 +48,13 @@ namespace Jazz2::Scripting
 
 	private:
 		LevelHandler* _levelHandler;
+		asIScriptFunction* _onLevelLoad;
+		asIScriptFunction* _onLevelBegin;
+		asIScriptFunction* _onLevelReload;
 		asIScriptFunction* _onLevelUpdate;
 		int32_t _onLevelUpdateLastFrame;
+		asIScriptFunction* _onPlayer;
+		asIScriptFunction* _onFunction[256];
 		asIScriptFunction* _onDrawAmmo;
 		asIScriptFunction* _onDrawHealth;
 		asIScriptFunction* _onDrawLives;
@@ -127,6 +133,8 @@ namespace Jazz2::Scripting
 		void RegisterLegacyFunctions(asIScriptEngine* engine);
 		void RegisterStandardFunctions(asIScriptEngine* engine, asIScriptModule* module);
 
+		void ResolveCallbacks();
+		void CallFunction(asIScriptFunction* func);
 		void OnException(asIScriptContext* ctx);
 
 		static uint8_t asGetDifficulty();
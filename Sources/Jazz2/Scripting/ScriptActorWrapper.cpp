@@ -120,6 +120,8 @@ shared abstract class )" AsClassName R"(
 	bool MoveTo(float x, float y, bool force = false) { return _obj.MoveTo(x, y, force); }
 	bool MoveBy(float x, float y, bool force = false) { return _obj.MoveBy(x, y, force); }
 	void TryStandardMovement(float timeMult) { _obj.TryStandardMovement(timeMult); }
+	bool IsInLineOfSight(float x, float y) { return _obj.IsInLineOfSight(x, y); }
+	bool CastRay(float x, float y, bool hitActors, float &out hitX, float &out hitY) { return _obj.CastRay(x, y, hitActors, hitX, hitY); }
 
 	void RequestMetadata(const string &in path) { _obj.RequestMetadata(path); }
 	void PlaySfx(const string &in identifier, float gain = 1.0, float pitch = 1.0) { _obj.PlaySfx(identifier, gain, pitch); }
@@ -164,6 +166,8 @@ shared abstract class CollectibleBase : )" AsClassName R"(
 		r = engine->RegisterObjectMethod(AsClassNameInternal, "bool MoveTo(float, float, bool)", asMETHOD(ScriptActorWrapper, asMoveTo), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
 		r = engine->RegisterObjectMethod(AsClassNameInternal, "bool MoveBy(float, float, bool)", asMETHOD(ScriptActorWrapper, asMoveBy), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
 		r = engine->RegisterObjectMethod(AsClassNameInternal, "void TryStandardMovement(float)", asMETHOD(ScriptActorWrapper, asTryStandardMovement), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
+		r = engine->RegisterObjectMethod(AsClassNameInternal, "bool IsInLineOfSight(float, float)", asMETHOD(ScriptActorWrapper, asIsInLineOfSight), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
+		r = engine->RegisterObjectMethod(AsClassNameInternal, "bool CastRay(float, float, bool, float &out, float &out)", asMETHOD(ScriptActorWrapper, asCastRay), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
 		r = engine->RegisterObjectMethod(AsClassNameInternal, "void RequestMetadata(const string &in)", asMETHOD(ScriptActorWrapper, asRequestMetadata), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
 		r = engine->RegisterObjectMethod(AsClassNameInternal, "void PlaySfx(const string &in, float, float)", asMETHOD(ScriptActorWrapper, asPlaySfx), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
 		r = engine->RegisterObjectMethod(AsClassNameInternal, "void SetAnimation(int)", asMETHOD(ScriptActorWrapper, asSetAnimationState), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
@@ -370,7 +374,7 @@ shared abstract class CollectibleBase : )" AsClassName R"(
 		engine->ReturnContext(ctx);
 	}
 
-	bool ScriptActorWrapper::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool ScriptActorWrapper::OnHandleCollision(ActorBase* other)
 	{
 		if (_onHandleCollision != nullptr) {
 			if (auto* otherWrapper = runtime_cast<ScriptActorWrapper*>(other)) {
@@ -582,6 +586,20 @@ shared abstract class CollectibleBase : )" AsClassName R"(
 		TryStandardMovement(timeMult, params);
 	}
 
+	bool ScriptActorWrapper::asIsInLineOfSight(float x, float y)
+	{
+		return _levelHandler->IsInLineOfSight(_pos, Vector2f(x, y));
+	}
+
+	bool ScriptActorWrapper::asCastRay(float x, float y, bool hitActors, float& hitX, float& hitY)
+	{
+		RayCastResult result;
+		bool hit = _levelHandler->CastRay(this, _pos, Vector2f(x, y), hitActors ? ActorState::CollideWithOtherActors : ActorState::None, result);
+		hitX = result.Point.X;
+		hitY = result.Point.Y;
+		return hit;
+	}
+
 	void ScriptActorWrapper::asRequestMetadata(const String& path)
 	{
 		RequestMetadata(path);
@@ -634,7 +652,7 @@ shared abstract class CollectibleBase : )" AsClassName R"(
 		async_return success;
 	}
 
-	bool ScriptCollectibleWrapper::OnHandleCollision(std::shared_ptr<ActorBase> other)
+	bool ScriptCollectibleWrapper::OnHandleCollision(ActorBase* other)
 	{
 		if (auto* player = runtime_cast<Player*>(other)) {
 			if (OnCollect(player)) {
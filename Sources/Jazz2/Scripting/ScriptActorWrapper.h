@@ -40,7 +40,7 @@ namespace Jazz2::Scripting
 			return *this;
 		}
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 	protected:
 		LevelScriptLoader* _levelScripts;
@@ -76,6 +76,8 @@ namespace Jazz2::Scripting
 		bool asMoveTo(float x, float y, bool force);
 		bool asMoveBy(float x, float y, bool force);
 		void asTryStandardMovement(float timeMult);
+		bool asIsInLineOfSight(float x, float y);
+		bool asCastRay(float x, float y, bool hitActors, float& hitX, float& hitY);
 		void asRequestMetadata(const String& path);
 		void asPlaySfx(const String& identifier, float gain, float pitch);
 		void asSetAnimation(const String& name);
@@ -101,7 +103,7 @@ namespace Jazz2::Scripting
 	public:
 		ScriptCollectibleWrapper(LevelScriptLoader* levelScripts, asIScriptObject* obj);
 
-		bool OnHandleCollision(std::shared_ptr<ActorBase> other) override;
+		bool OnHandleCollision(ActorBase* other) override;
 
 	protected:
 		Task<bool> OnActivatedAsync(const Actors::ActorActivationDetails& details) override;
@@ -2,6 +2,7 @@
 
 #include "ScriptLoader.h"
 #include "../ContentResolver.h"
+#include "../../nCine/Base/HashFunctions.h"
 
 #include <Containers/GrowableArray.h>
 #include <Containers/StringConcatenable.h>
@@ -29,6 +30,37 @@ using namespace Death::IO;
 
 namespace Jazz2::Scripting
 {
+	namespace
+	{
+		class ByteCodeStream : public asIBinaryStream
+		{
+		public:
+			ByteCodeStream(Stream* stream)
+				: _stream(stream)
+			{
+			}
+
+			int Write(const void* ptr, asUINT size) override
+			{
+				if (size == 0) {
+					return 0;
+				}
+				return (_stream->Write(ptr, (std::int32_t)size) == (std::int32_t)size ? 0 : -1);
+			}
+
+			int Read(void* ptr, asUINT size) override
+			{
+				if (size == 0) {
+					return 0;
+				}
+				return (_stream->Read(ptr, (std::int32_t)size) == (std::int32_t)size ? 0 : -1);
+			}
+
+		private:
+			Stream* _stream;
+		};
+	}
+
 	ScriptLoader::ScriptLoader()
 		:
 		_module(nullptr),
@@ -315,9 +347,8 @@ namespace Jazz2::Scripting
 			}
 		}
 
-		// Append the actual script
-		_engine->SetEngineProperty(asEP_COPY_SCRIPT_SECTIONS, true);
-		_module->AddScriptSection(path.data(), scriptContent.data(), scriptSize, 0);
+		// Append the actual script, sections are added to the module in Build() only if no cached bytecode is found
+		_scriptSections.emplace_back(path, std::move(scriptContent));
 
 		if (includes.size() > 0) {
 			// Load all included scripts
@@ -333,11 +364,29 @@ namespace Jazz2::Scripting
 
 	int ScriptLoader::Build()
 	{
-		int r = _module->Build();
-		if (r < 0) {
-			return r;
+		std::uint64_t scriptHash = GetScriptHash();
+		char fileName[32];
+		formatString(fileName, sizeof(fileName), "%016llx.asbc", (unsigned long long)scriptHash);
+		String byteCodePath = fs::CombinePath({ ContentResolver::Get().GetCachePath(), "Scripts"_s, fileName });
+
+		if (LoadByteCode(byteCodePath, scriptHash)) {
+			LOGD("Script was loaded from cache \"%s\"", fileName);
+		} else {
+			_engine->SetEngineProperty(asEP_COPY_SCRIPT_SECTIONS, true);
+			for (auto& section : _scriptSections) {
+				_module->AddScriptSection(section.Name.data(), section.Content.data(), section.Content.size(), 0);
+			}
+
+			int r = _module->Build();
+			if (r < 0) {
+				return r;
+			}
+
+			SaveByteCode(byteCodePath, scriptHash);
 		}
 
+		_scriptSections.clear();
+
 		// After the script has been built, the metadata strings should be stored for later lookup
 		for (auto& decl : _foundDeclarations) {
 			_module->SetDefaultNamespace(decl.Namespace.data());
@@ -493,6 +542,66 @@ namespace Jazz2::Scripting
 		return 0;
 	}
 
+	std::uint64_t ScriptLoader::GetScriptHash() const
+	{
+		// Bytecode depends on the engine version and on the registered interface, which depends on the context type
+		static const char EngineVersion[] = NCINE_VERSION "|" ANGELSCRIPT_VERSION_STRING;
+		std::uint64_t hash = CityHash64WithSeed(EngineVersion, arraySize(EngineVersion) - 1, ((std::uint64_t)ByteCodeCacheVersion << 8) | (std::uint64_t)_scriptContextType);
+		for (auto& section : _scriptSections) {
+			hash = CityHash64WithSeed(section.Name.data(), section.Name.size(), hash);
+			hash = CityHash64WithSeed(section.Content.data(), section.Content.size(), hash);
+		}
+		return hash;
+	}
+
+	bool ScriptLoader::LoadByteCode(const StringView& path, std::uint64_t scriptHash)
+	{
+		auto s = fs::Open(path, FileAccess::Read);
+		if (s->GetSize() < 20) {
+			return false;
+		}
+
+		std::uint64_t signature = s->ReadValue<std::uint64_t>();
+		std::uint8_t fileType = s->ReadValue<std::uint8_t>();
+		std::uint16_t version = s->ReadValue<std::uint16_t>();
+		std::uint64_t hash = s->ReadValue<std::uint64_t>();
+		if (signature != 0x2095A59FF0BFBBEF || fileType != ContentResolver::ScriptByteCodeFile || version != ByteCodeCacheVersion || hash != scriptHash) {
+			return false;
+		}
+
+		ByteCodeStream stream(s.get());
+		bool wasDebugInfoStripped = false;
+		if (_module->LoadByteCode(&stream, &wasDebugInfoStripped) < 0) {
+			// Module is discarded by the engine if the bytecode is invalid, so it can be compiled from sources again
+			LOGW("Cached script \"%s\" is invalid, compiling from sources", String::nullTerminatedView(path).data());
+			return false;
+		}
+
+		return true;
+	}
+
+	void ScriptLoader::SaveByteCode(const StringView& path, std::uint64_t scriptHash)
+	{
+		fs::CreateDirectories(fs::GetDirectoryName(path));
+
+		auto so = fs::Open(path, FileAccess::Write);
+		if (!so->IsValid()) {
+			return;
+		}
+
+		so->WriteValue<std::uint64_t>(0x2095A59FF0BFBBEF);
+		so->WriteValue<std::uint8_t>(ContentResolver::ScriptByteCodeFile);
+		so->WriteValue<std::uint16_t>(ByteCodeCacheVersion);
+		so->WriteValue<std::uint64_t>(scriptHash);
+
+		// Line numbers are kept, so exceptions still point to the right place in the source file
+		ByteCodeStream stream(so.get());
+		if (_module->SaveByteCode(&stream, false) < 0) {
+			so->Dispose();
+			fs::RemoveFile(path);
+		}
+	}
+
 	int ScriptLoader::ExcludeCode(String& scriptContent, int pos)
 	{
 		int scriptSize = (int)scriptContent.size();
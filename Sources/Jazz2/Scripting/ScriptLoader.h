@@ -66,6 +66,9 @@ namespace Jazz2::Scripting
 		static String MakeRelativePath(const StringView& path, const StringView& relativeToFile);
 
 	private:
+		// Bytecode cache files are invalidated if this number is changed
+		static constexpr std::uint16_t ByteCodeCacheVersion = 1;
+
 		enum class MetadataType {
 			Unknown,
 			Type,
@@ -86,6 +89,13 @@ namespace Jazz2::Scripting
 			String Namespace;
 		};
 
+		struct ScriptSection {
+			ScriptSection(const StringView& name, String&& content) : Name(name), Content(std::move(content)) { }
+
+			String Name;
+			String Content;
+		};
+
 		struct ClassMetadata {
 			HashMap<int, Array<String>> FuncMetadataMap;
 			HashMap<int, Array<String>> VarMetadataMap;
@@ -94,12 +104,17 @@ namespace Jazz2::Scripting
 		SmallVector<asIScriptContext*, 4> _contextPool;
 
 		HashMap<String, bool> _includedFiles;
+		SmallVector<ScriptSection, 0> _scriptSections;
 		SmallVector<RawMetadataDeclaration, 0> _foundDeclarations;
 		HashMap<int, Array<String>> _typeMetadataMap;
 		HashMap<int, Array<String>> _funcMetadataMap;
 		HashMap<int, Array<String>> _varMetadataMap;
 		HashMap<int, ClassMetadata> _classMetadataMap;
 
+		std::uint64_t GetScriptHash() const;
+		bool LoadByteCode(const StringView& path, std::uint64_t scriptHash);
+		void SaveByteCode(const StringView& path, std::uint64_t scriptHash);
+
 		int ExcludeCode(String& scriptContent, int pos);
 		int SkipStatement(String& scriptContent, int pos);
 		int ExtractMetadata(MutableStringView scriptContent, int pos, SmallVectorImpl<String>& metadata);
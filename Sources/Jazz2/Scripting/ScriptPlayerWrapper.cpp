@@ -17,14 +17,16 @@ namespace Jazz2::Scripting
 		_refCount(1)
 	{
 		auto& players = levelScripts->GetPlayers();
-		_player = (playerIndex < players.size() ? players[playerIndex] : nullptr);
+		if (playerIndex < players.size()) {
+			_handle = players[playerIndex]->Handle;
+		}
 	}
 
 	ScriptPlayerWrapper::ScriptPlayerWrapper(LevelScriptLoader* levelScripts, Player* player)
 		:
 		_levelScripts(levelScripts),
 		_refCount(1),
-		_player(player)
+		_handle(player != nullptr ? player->Handle : ActorHandle())
 	{
 	}
 
@@ -71,6 +73,12 @@ namespace Jazz2::Scripting
 		r = engine->RegisterObjectMethod(AsClassName, "void MorphRevert()", asMETHOD(ScriptPlayerWrapper, asMorphRevert), asCALL_THISCALL); RETURN_ASSERT(r >= 0);
 	}
 
+	Player* ScriptPlayerWrapper::GetPlayer() const
+	{
+		// Player may be already destroyed (e.g., left the multiplayer session), so only the handle is stored
+		return static_cast<Player*>(_levelScripts->ResolveActor(_handle));
+	}
+
 	ScriptPlayerWrapper* ScriptPlayerWrapper::Factory(int playerIndex)
 	{
 		auto ctx = asGetActiveContext();
@@ -95,155 +103,180 @@ namespace Jazz2::Scripting
 
 	bool ScriptPlayerWrapper::asIsInGame() const
 	{
-		return (_player != nullptr);
+		return (GetPlayer() != nullptr);
 	}
 
 	int ScriptPlayerWrapper::asGetIndex() const
 	{
-		return (_player != nullptr ? _player->_playerIndex : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_playerIndex : -1);
 	}
 
 	int ScriptPlayerWrapper::asGetPlayerType() const
 	{
-		return (_player != nullptr ? (int)_player->_playerType : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? (int)player->_playerType : -1);
 	}
 
 	float ScriptPlayerWrapper::asGetX() const
 	{
-		return (_player != nullptr ? _player->_pos.X : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_pos.X : -1);
 	}
 
 	float ScriptPlayerWrapper::asGetY() const
 	{
-		return (_player != nullptr ? _player->_pos.Y : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_pos.Y : -1);
 	}
 
 	float ScriptPlayerWrapper::asGetSpeedX() const
 	{
-		return (_player != nullptr ? _player->_speed.X : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_speed.X : -1);
 	}
 
 	float ScriptPlayerWrapper::asGetSpeedY() const
 	{
-		return (_player != nullptr ? _player->_speed.Y : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_speed.Y : -1);
 	}
 
 	int ScriptPlayerWrapper::asGetHealth() const
 	{
-		return (_player != nullptr ? _player->_health : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_health : -1);
 	}
 
 	int ScriptPlayerWrapper::asGetLives() const
 	{
-		return (_player != nullptr ? _player->_lives : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_lives : -1);
 	}
 
 	int ScriptPlayerWrapper::asGetFoodEaten() const
 	{
-		return (_player != nullptr ? _player->_foodEaten : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_foodEaten : -1);
 	}
 
 	int ScriptPlayerWrapper::asGetScore() const
 	{
-		return (_player != nullptr ? _player->_score : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_score : -1);
 	}
 
 	void ScriptPlayerWrapper::asSetScore(int value)
 	{
-		if (_player != nullptr) {
-			_player->_score = value;
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->_score = value;
 		}
 	}
 
 	uint16_t ScriptPlayerWrapper::asGetLayer() const
 	{
-		return (_player != nullptr ? _player->_renderer.layer() : 0);
+		Player* player = GetPlayer();
+		return (player != nullptr ? player->_renderer.layer() : 0);
 	}
 
 	void ScriptPlayerWrapper::asSetLayer(uint16_t value)
 	{
-		if (_player != nullptr) {
-			_player->_renderer.setLayer(value);
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->_renderer.setLayer(value);
 		}
 	}
 
 	bool ScriptPlayerWrapper::asGetWeaponAllowed() const
 	{
-		return (_player != nullptr && _player->_weaponAllowed);
+		Player* player = GetPlayer();
+		return (player != nullptr && player->_weaponAllowed);
 	}
 
 	void ScriptPlayerWrapper::asSetWeaponAllowed(bool value)
 	{
-		if (_player != nullptr) {
-			_player->_weaponAllowed = value;
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->_weaponAllowed = value;
 		}
 	}
 
 	int ScriptPlayerWrapper::asGetWeaponAmmo(int weaponType) const
 	{
-		return (_player != nullptr && weaponType >= 0 && weaponType < (int)WeaponType::Count ? _player->_weaponAmmo[weaponType] : -1);
+		Player* player = GetPlayer();
+		return (player != nullptr && weaponType >= 0 && weaponType < (int)WeaponType::Count ? player->_weaponAmmo[weaponType] : -1);
 	}
 
 	void ScriptPlayerWrapper::asSetWeaponAmmo(int weaponType, int value)
 	{
-		if (_player != nullptr && weaponType >= 0 && weaponType < (int)WeaponType::Count) {
-			_player->_weaponAmmo[weaponType] = value;
+		Player* player = GetPlayer();
+		if (player != nullptr && weaponType >= 0 && weaponType < (int)WeaponType::Count) {
+			player->_weaponAmmo[weaponType] = value;
 		}
 	}
 
 	void ScriptPlayerWrapper::asDecreaseHealth(int amount)
 	{
-		if (_player != nullptr) {
-			_player->DecreaseHealth(amount);
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->DecreaseHealth(amount);
 		}
 	}
 
 	void ScriptPlayerWrapper::asMoveTo(float x, float y)
 	{
-		if (_player != nullptr) {
-			_player->WarpToPosition(Vector2f(x, y), WarpFlags::Fast);
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->WarpToPosition(Vector2f(x, y), WarpFlags::Fast);
 		}
 	}
 
 	void ScriptPlayerWrapper::asWarpTo(float x, float y)
 	{
-		if (_player != nullptr) {
-			_player->WarpToPosition(Vector2f(x, y), WarpFlags::Default);
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->WarpToPosition(Vector2f(x, y), WarpFlags::Default);
 		}
 	}
 
 	void ScriptPlayerWrapper::asMoveBy(float x, float y)
 	{
-		if (_player != nullptr) {
-			_player->WarpToPosition(Vector2f(_player->_pos.X + x, _player->_pos.Y + y), WarpFlags::Fast);
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->WarpToPosition(Vector2f(player->_pos.X + x, player->_pos.Y + y), WarpFlags::Fast);
 		}
 	}
 
 	void ScriptPlayerWrapper::asPlaySfx(const String& identifier, float gain, float pitch)
 	{
-		if (_player != nullptr) {
-			_player->PlayPlayerSfx(identifier, gain, pitch);
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->PlayPlayerSfx(identifier, gain, pitch);
 		}
 	}
 
 	void ScriptPlayerWrapper::asSetAnimationState(int state)
 	{
-		if (_player != nullptr) {
-			_player->SetAnimation((AnimState)state);
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->SetAnimation((AnimState)state);
 		}
 	}
 
 	void ScriptPlayerWrapper::asMorphTo(int playerType)
 	{
-		if (_player != nullptr) {
-			_player->MorphTo((PlayerType)playerType);
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->MorphTo((PlayerType)playerType);
 		}
 	}
 
 	void ScriptPlayerWrapper::asMorphRevert()
 	{
-		if (_player != nullptr) {
-			_player->MorphRevert();
+		Player* player = GetPlayer();
+		if (player != nullptr) {
+			player->MorphRevert();
 		}
 	}
 }
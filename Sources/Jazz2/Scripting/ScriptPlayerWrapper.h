@@ -42,7 +42,9 @@ namespace Jazz2::Scripting
 
 	protected:
 		LevelScriptLoader* _levelScripts;
-		Actors::Player* _player;
+		Actors::ActorHandle _handle;
+
+		Actors::Player* GetPlayer() const;
 
 		bool asIsInGame() const;
 		int asGetIndex() const;
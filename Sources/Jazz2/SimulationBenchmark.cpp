@@ -0,0 +1,563 @@
+﻿#if defined(WITH_BENCHMARK)
+
+#include "SimulationBenchmark.h"
+#include "ContentResolver.h"
+#include "LevelHandler.h"
+#include "PreferencesCache.h"
+#include "../nCine/Base/Algorithms.h"
+#include "../nCine/Base/Random.h"
+#include "../nCine/Base/TimeStamp.h"
+#include "../nCine/Graphics/Viewport.h"
+#include "../nCine/Threading/Atomic.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include <Containers/StaticArray.h>
+#include <IO/FileSystem.h>
+
+#if defined(DEATH_TARGET_WINDOWS) && !defined(DEATH_TARGET_WINDOWS_RT)
+#	include <CommonWindows.h>
+#	include <psapi.h>
+#elif defined(DEATH_TARGET_APPLE) || defined(DEATH_TARGET_UNIX)
+#	include <sys/resource.h>
+#endif
+
+using namespace Death::IO;
+
+#if !defined(WITH_TRACY)
+namespace
+{
+	// Global allocation operators are already overriden if Tracy integration is enabled, so allocations are not counted then
+	nCine::Atomic64 AllocationCount;
+	nCine::Atomic64 AllocatedBytes;
+
+	void* AllocateCounted(std::size_t count)
+	{
+		AllocationCount.fetchAdd(1, nCine::Atomic64::MemoryModel::RELAXED);
+		AllocatedBytes.fetchAdd((std::int64_t)count, nCine::Atomic64::MemoryModel::RELAXED);
+
+		void* ptr = malloc(count > 0 ? count : 1);
+		if DEATH_UNLIKELY(ptr == nullptr) {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+			throw std::bad_alloc();
+#else
+			// Exceptions are disabled, so the failure cannot be reported to the caller
+			std::abort();
+#endif
+		}
+		return ptr;
+	}
+}
+
+void* operator new(std::size_t count)
+{
+	return AllocateCounted(count);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void* operator new[](std::size_t count)
+{
+	return AllocateCounted(count);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	free(ptr);
+}
+#endif
+
+namespace Jazz2
+{
+	namespace
+	{
+		// Names of actions that can be used in input files, in the same order as `PlayerActions`
+		constexpr StringView ActionNames[] = {
+			"Left"_s, "Right"_s, "Up"_s, "Down"_s, "Fire"_s, "Jump"_s, "Run"_s, "ChangeWeapon"_s, "Menu"_s
+		};
+
+		static_assert(arraySize(ActionNames) == (std::int32_t)PlayerActions::CountInMenu, "ActionNames must match PlayerActions");
+
+		constexpr std::uint32_t ActionMask(PlayerActions action)
+		{
+			return (1u << (std::int32_t)action);
+		}
+
+		// Escapes quotes, backslashes and control characters, so the value can be written as a JSON string
+		String EscapeJsonString(StringView value)
+		{
+			SmallVector<char, 64> result;
+			for (char c : value) {
+				if (c == '"' || c == '\\') {
+					result.push_back('\\');
+					result.push_back(c);
+				} else if ((unsigned char)c < 0x20) {
+					char escaped[8];
+					std::int32_t length = formatString(escaped, sizeof(escaped), "\\u%04x", (std::uint32_t)c);
+					result.append(escaped, escaped + length);
+				} else {
+					result.push_back(c);
+				}
+			}
+			return String(result.data(), result.size());
+		}
+
+		void GetAllocationStats(std::int64_t& count, std::int64_t& bytes)
+		{
+#if !defined(WITH_TRACY)
+			count = AllocationCount.load(Atomic64::MemoryModel::RELAXED);
+			bytes = AllocatedBytes.load(Atomic64::MemoryModel::RELAXED);
+#else
+			count = -1;
+			bytes = -1;
+#endif
+		}
+	}
+
+	SimulationBenchmark::Configuration::Configuration()
+		: FrameCount(DefaultFrameCount), TimeMult(1.0f), Seed(DefaultSeed), Difficulty(GameDifficulty::Normal), Player(PlayerType::Jazz)
+	{
+	}
+
+	bool SimulationBenchmark::TryParseArguments(const AppConfiguration& config, Configuration& result)
+	{
+		bool found = false;
+		for (std::int32_t i = 0; i < (std::int32_t)config.argc(); i++) {
+			auto arg = config.argv(i);
+			if (arg.hasPrefix("/benchmark:"_s)) {
+				auto level = arg.exceptPrefix("/benchmark:"_s).partition('/');
+				if (level[0].empty() || level[2].empty()) {
+					LOGE("Level must be specified as \"/benchmark:<episode>/<level>\"");
+					continue;
+				}
+				result.EpisodeName = level[0];
+				result.LevelName = level[2];
+				found = true;
+			} else if (arg.hasPrefix("/benchmark-frames:"_s)) {
+				long value = strtol(arg.exceptPrefix("/benchmark-frames:"_s).data(), nullptr, 10);
+				if (value > 0) {
+					result.FrameCount = (std::int32_t)value;
+				}
+			} else if (arg.hasPrefix("/benchmark-time-mult:"_s)) {
+				float value = strtof(arg.exceptPrefix("/benchmark-time-mult:"_s).data(), nullptr);
+				if (value > 0.0f) {
+					result.TimeMult = value;
+				}
+			} else if (arg.hasPrefix("/benchmark-seed:"_s)) {
+				result.Seed = strtoull(arg.exceptPrefix("/benchmark-seed:"_s).data(), nullptr, 10);
+			} else if (arg.hasPrefix("/benchmark-input:"_s)) {
+				result.InputPath = arg.exceptPrefix("/benchmark-input:"_s);
+			} else if (arg.hasPrefix("/benchmark-output:"_s)) {
+				result.OutputPath = arg.exceptPrefix("/benchmark-output:"_s);
+			} else if (arg == "/benchmark-easy"_s) {
+				result.Difficulty = GameDifficulty::Easy;
+			} else if (arg == "/benchmark-hard"_s) {
+				result.Difficulty = GameDifficulty::Hard;
+			} else if (arg == "/benchmark-spaz"_s) {
+				result.Player = PlayerType::Spaz;
+			} else if (arg == "/benchmark-lori"_s) {
+				result.Player = PlayerType::Lori;
+			}
+		}
+		return found;
+	}
+
+	SimulationBenchmark::SimulationBenchmark(Configuration&& config)
+		: _config(std::move(config)), _levelChanged(false)
+	{
+	}
+
+	SimulationBenchmark::~SimulationBenchmark()
+	{
+	}
+
+	bool SimulationBenchmark::Run()
+	{
+		LOGI("Running benchmark of \"%s/%s\" for %i frames...", _config.EpisodeName.data(), _config.LevelName.data(), _config.FrameCount);
+
+		if (!_config.InputPath.empty() && !LoadInput(_config.InputPath)) {
+			LOGE("Cannot load input from \"%s\"", _config.InputPath.data());
+			return false;
+		}
+
+		// Everything must be initialized the same way in every run
+		Random().Initialize(_config.Seed, _config.Seed ^ 0x5DEECE66Dull);
+
+		TimeStamp loadStart = TimeStamp::now();
+
+		_levelHandler = std::make_unique<LevelHandler>(this);
+		LevelInitialization levelInit(_config.EpisodeName, _config.LevelName, _config.Difficulty,
+			PreferencesCache::EnableReforgedGameplay, false, _config.Player);
+		if (!_levelHandler->Initialize(levelInit)) {
+			LOGE("Cannot load level \"%s/%s\"", _config.EpisodeName.data(), _config.LevelName.data());
+			_levelHandler = nullptr;
+			return false;
+		}
+
+		// Viewports are needed only for cameras, nothing is drawn
+		Viewport::chain().clear();
+		_levelHandler->OnInitializeViewport(LevelHandler::DefaultWidth, LevelHandler::DefaultHeight);
+
+		float loadTime = loadStart.millisecondsSince();
+
+		for (auto& timings : _timings) {
+			timings.reserve(_config.FrameCount);
+		}
+
+		auto& resolver = ContentResolver::Get();
+		std::size_t inputIndex = 0;
+		std::size_t maxActorCount = 0;
+		std::int64_t allocationCountStart, allocatedBytesStart;
+		GetAllocationStats(allocationCountStart, allocatedBytesStart);
+
+		std::int32_t frame = 0;
+		for (; frame < _config.FrameCount && !_levelChanged; frame++) {
+			// Deferred callbacks and background loading are not part of the simulation, so they are not measured
+			if (!_pendingCallbacks.empty()) {
+				for (std::size_t i = 0; i < _pendingCallbacks.size(); i++) {
+					_pendingCallbacks[i]();
+				}
+				_pendingCallbacks.clear();
+			}
+			resolver.ProcessPendingLoads();
+
+			ApplyInput(frame, inputIndex);
+			SimulateFrame(_config.TimeMult);
+
+			maxActorCount = std::max(maxActorCount, _levelHandler->_actors.size());
+		}
+
+		std::int64_t allocationCountEnd, allocatedBytesEnd;
+		GetAllocationStats(allocationCountEnd, allocatedBytesEnd);
+
+		if (_levelChanged) {
+			LOGI("Level ended after %i frames", frame);
+		}
+
+		bool result = SaveResults(loadTime, frame, allocationCountEnd - allocationCountStart, allocatedBytesEnd - allocatedBytesStart, maxActorCount);
+
+		_levelHandler = nullptr;
+		_pendingCallbacks.clear();
+		return result;
+	}
+
+	void SimulationBenchmark::InvokeAsync(const std::function<void()>& callback)
+	{
+		_pendingCallbacks.emplace_back(callback);
+	}
+
+	void SimulationBenchmark::InvokeAsync(std::function<void()>&& callback)
+	{
+		_pendingCallbacks.emplace_back(std::move(callback));
+	}
+
+	void SimulationBenchmark::GoToMainMenu(bool afterIntro)
+	{
+		_levelChanged = true;
+	}
+
+	void SimulationBenchmark::ChangeLevel(LevelInitialization&& levelInit)
+	{
+		// Only one level is simulated, so the benchmark ends when the level is finished
+		_levelChanged = true;
+	}
+
+	bool SimulationBenchmark::HasResumableState() const
+	{
+		return false;
+	}
+
+	void SimulationBenchmark::ResumeSavedState()
+	{
+	}
+
+	bool SimulationBenchmark::SaveCurrentStateIfAny()
+	{
+		return false;
+	}
+
+#if defined(WITH_MULTIPLAYER)
+	bool SimulationBenchmark::ConnectToServer(const StringView address, std::uint16_t port)
+	{
+		return false;
+	}
+
+	bool SimulationBenchmark::CreateServer(LevelInitialization&& levelInit, std::uint16_t port)
+	{
+		return false;
+	}
+#endif
+
+	IRootController::Flags SimulationBenchmark::GetFlags() const
+	{
+		return Flags::IsInitialized | Flags::IsVerified | Flags::IsPlayable;
+	}
+
+	StringView SimulationBenchmark::GetNewestVersion() const
+	{
+		return {};
+	}
+
+	void SimulationBenchmark::RefreshCacheLevels()
+	{
+	}
+
+	bool SimulationBenchmark::LoadInput(StringView path)
+	{
+		// Each line contains a frame number and actions that are pressed from that frame, e.g. "120 Right+Run+Jump",
+		// lines starting with '#' are ignored and the frame numbers must be in ascending order
+		auto s = fs::Open(path, FileAccess::Read);
+		if (!s->IsValid()) {
+			return false;
+		}
+
+		std::int32_t size = (std::int32_t)s->GetSize();
+		String content(NoInit, size);
+		s->Read(content.data(), size);
+
+		_input.clear();
+
+		StringView remaining = content;
+		while (!remaining.empty()) {
+			auto parts = remaining.partition('\n');
+			StringView line = parts[0].trimmed();
+			remaining = parts[2];
+			if (line.empty() || line[0] == '#') {
+				continue;
+			}
+
+			auto lineParts = line.partition(' ');
+			String frameString = lineParts[0];
+			char* end;
+			long frame = strtol(frameString.data(), &end, 10);
+			if (end == frameString.data() || frame < 0 || (!_input.empty() && frame < _input.back().Frame)) {
+				LOGE("Invalid frame number \"%s\" in input file", frameString.data());
+				return false;
+			}
+
+			std::uint32_t actions = 0;
+			StringView actionsString = lineParts[2].trimmed();
+			while (!actionsString.empty()) {
+				auto actionParts = actionsString.partition('+');
+				StringView actionName = actionParts[0].trimmed();
+				actionsString = actionParts[2];
+				if (actionName.empty() || actionName == "None"_s) {
+					continue;
+				}
+
+				std::int32_t actionIndex = -1;
+				for (std::int32_t i = 0; i < (std::int32_t)arraySize(ActionNames); i++) {
+					if (actionName == ActionNames[i]) {
+						actionIndex = i;
+						break;
+					}
+				}
+				if (actionIndex < 0) {
+					LOGE("Unknown action \"%s\" in input file", String(actionName).data());
+					return false;
+				}
+				actions |= (1u << actionIndex);
+			}
+
+			_input.push_back({ (std::int32_t)frame, actions });
+		}
+
+		return true;
+	}
+
+	std::uint32_t SimulationBenchmark::GetScriptedInput(std::int32_t frame) const
+	{
+		// Run right most of the time and turn around for a while every 10 seconds, jump and fire periodically
+		std::uint32_t actions = ActionMask(PlayerActions::Run);
+		actions |= ((frame % 600) < 480 ? ActionMask(PlayerActions::Right) : ActionMask(PlayerActions::Left));
+		if ((frame % 90) < 30) {
+			actions |= ActionMask(PlayerActions::Jump);
+		}
+		if ((frame % 20) < 2) {
+			actions |= ActionMask(PlayerActions::Fire);
+		}
+		if ((frame % 1200) == 1199) {
+			actions |= ActionMask(PlayerActions::ChangeWeapon);
+		}
+		return actions;
+	}
+
+	void SimulationBenchmark::ApplyInput(std::int32_t frame, std::size_t& inputIndex)
+	{
+		std::uint32_t actions;
+		if (_config.InputPath.empty()) {
+			actions = GetScriptedInput(frame);
+		} else {
+			while (inputIndex < _input.size() && _input[inputIndex].Frame <= frame) {
+				inputIndex++;
+			}
+			actions = (inputIndex > 0 ? _input[inputIndex - 1].Actions : 0);
+		}
+
+		// Only the first player is controlled, the same way as `LevelHandler::UpdatePressedActions()` does it
+		auto& input = _levelHandler->_playerInputs[0];
+		input.PressedActionsLast = input.PressedActions;
+		input.PressedActions = actions;
+		input.RequiredMovement.X = ((actions & ActionMask(PlayerActions::Right)) != 0 ? 1.0f
+			: ((actions & ActionMask(PlayerActions::Left)) != 0 ? -1.0f : 0.0f));
+		input.RequiredMovement.Y = ((actions & ActionMask(PlayerActions::Down)) != 0 ? 1.0f
+			: ((actions & ActionMask(PlayerActions::Up)) != 0 ? -1.0f : 0.0f));
+	}
+
+	void SimulationBenchmark::SimulateFrame(float timeMult)
+	{
+		static_assert((std::int32_t)Phase::Other == (std::int32_t)LevelHandler::FramePhase::Other, "Phase must match LevelHandler::FramePhase");
+
+		// The same frame update as `LevelHandler::OnBeginFrame()`, scene graph update and `LevelHandler::OnEndFrame()`,
+		// only input devices, pause menu and rendering are skipped, and every phase is measured separately
+		LevelHandler* levelHandler = _levelHandler.get();
+		float phaseTimes[(std::int32_t)Phase::Count] = {};
+
+		TimeStamp frameStart = TimeStamp::now();
+		TimeStamp phaseStart = frameStart;
+		auto endPhase = [&phaseTimes, &phaseStart](LevelHandler::FramePhase phase) {
+			TimeStamp now = TimeStamp::now();
+			phaseTimes[(std::int32_t)phase] += (now - phaseStart).milliseconds();
+			phaseStart = now;
+		};
+
+		levelHandler->BeginFrameUpdate(timeMult, endPhase);
+
+		// Scene graph is updated by the application between both parts of the frame
+		SceneNode* rootNode = levelHandler->_rootNode.get();
+		Tiles::TileMap* tileMap = levelHandler->_tileMap.get();
+		if (rootNode->isUpdateEnabled()) {
+			// Tile map is the first child of the root node, so it's updated first and then excluded from the scene graph update
+			bool tileMapUpdateEnabled = tileMap->isUpdateEnabled();
+			if (tileMapUpdateEnabled) {
+				tileMap->OnUpdate(timeMult);
+			}
+			endPhase(LevelHandler::FramePhase::TileMap);
+
+			tileMap->setUpdateEnabled(false);
+			rootNode->OnUpdate(timeMult);
+			tileMap->setUpdateEnabled(tileMapUpdateEnabled);
+			endPhase(LevelHandler::FramePhase::Actors);
+		}
+
+		levelHandler->EndFrameUpdate(timeMult, endPhase);
+
+		phaseTimes[(std::int32_t)Phase::Frame] = frameStart.millisecondsSince();
+
+		for (std::int32_t i = 0; i < (std::int32_t)Phase::Count; i++) {
+			_timings[i].push_back(phaseTimes[i]);
+		}
+	}
+
+	bool SimulationBenchmark::SaveResults(float loadTime, std::int32_t framesSimulated, std::int64_t allocationCount, std::int64_t allocatedBytes, std::size_t maxActorCount)
+	{
+		std::uint64_t peakMemory = GetPeakMemoryUsage();
+
+		std::unique_ptr<Stream> s;
+		if (!_config.OutputPath.empty()) {
+			s = fs::Open(_config.OutputPath, FileAccess::Write);
+			if (!s->IsValid()) {
+				LOGE("Cannot open \"%s\" for writing", _config.OutputPath.data());
+				s = nullptr;
+			}
+		}
+
+		char buffer[512];
+		std::int32_t length;
+
+		if (s != nullptr) {
+			String episodeName = EscapeJsonString(_config.EpisodeName);
+			String levelName = EscapeJsonString(_config.LevelName);
+			length = formatString(buffer, sizeof(buffer), "{\n\t\"version\": \"%s\",\n\t\"level\": \"%s/%s\",\n\t\"input\": \"%s\",\n"
+				"\t\"frames\": %i,\n\t\"framesSimulated\": %i,\n\t\"timeMult\": %.3f,\n\t\"seed\": %llu,\n\t\"levelEnded\": %s,\n\t\"loadTime\": %.3f,\n\t\"phases\": {",
+				NCINE_VERSION, episodeName.data(), levelName.data(), _config.InputPath.empty() ? "scripted" : "recorded",
+				_config.FrameCount, framesSimulated, _config.TimeMult, (unsigned long long)_config.Seed, _levelChanged ? "true" : "false", loadTime);
+			s->Write(buffer, length);
+		}
+
+		LOGI("Benchmark finished: %i frames simulated, level loaded in %.2f ms", framesSimulated, loadTime);
+
+		for (std::int32_t i = 0; i < (std::int32_t)Phase::Count; i++) {
+			auto& timings = _timings[i];
+			double total = 0.0;
+			for (float value : timings) {
+				total += value;
+			}
+
+			std::sort(timings.begin(), timings.end());
+			std::size_t count = timings.size();
+			float mean = (count > 0 ? (float)(total / count) : 0.0f);
+			float median = (count > 0 ? timings[count / 2] : 0.0f);
+			float p95 = (count > 0 ? timings[std::min(count - 1, count * 95 / 100)] : 0.0f);
+			float max = (count > 0 ? timings[count - 1] : 0.0f);
+
+			const char* name = GetPhaseName((Phase)i);
+			LOGI("  %-10s mean %.4f ms, median %.4f ms, 95th %.4f ms, max %.4f ms", name, mean, median, p95, max);
+
+			if (s != nullptr) {
+				length = formatString(buffer, sizeof(buffer), "%s\n\t\t\"%s\": { \"total\": %.3f, \"mean\": %.4f, \"median\": %.4f, \"p95\": %.4f, \"max\": %.4f }",
+					i == 0 ? "" : ",", name, total, mean, median, p95, max);
+				s->Write(buffer, length);
+			}
+		}
+
+		double allocationsPerFrame = (framesSimulated > 0 && allocationCount >= 0 ? (double)allocationCount / framesSimulated : 0.0);
+		LOGI("  Allocations: %lli (%lli bytes, %.1f per frame), peak memory: %llu bytes, max. actors: %u",
+			(long long)allocationCount, (long long)allocatedBytes, allocationsPerFrame, (unsigned long long)peakMemory, (std::uint32_t)maxActorCount);
+
+		if (s != nullptr) {
+			length = formatString(buffer, sizeof(buffer), "\n\t},\n\t\"allocations\": { \"count\": %lli, \"bytes\": %lli, \"perFrame\": %.2f },\n"
+				"\t\"peakMemory\": %llu,\n\t\"maxActors\": %u\n}\n", (long long)allocationCount, (long long)allocatedBytes, allocationsPerFrame,
+				(unsigned long long)peakMemory, (std::uint32_t)maxActorCount);
+			s->Write(buffer, length);
+		}
+
+		return true;
+	}
+
+	const char* SimulationBenchmark::GetPhaseName(Phase phase)
+	{
+		switch (phase) {
+			case Phase::Events: return "events";
+			case Phase::Scripts: return "scripts";
+			case Phase::Actors: return "actors";
+			case Phase::TileMap: return "tileMap";
+			case Phase::Collisions: return "collisions";
+			case Phase::Other: return "other";
+			case Phase::Frame: return "frame";
+			default: return "unknown";
+		}
+	}
+
+	std::uint64_t SimulationBenchmark::GetPeakMemoryUsage()
+	{
+#if defined(DEATH_TARGET_WINDOWS) && !defined(DEATH_TARGET_WINDOWS_RT)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters))) {
+			return counters.PeakWorkingSetSize;
+		}
+		return 0;
+#elif defined(DEATH_TARGET_APPLE) || defined(DEATH_TARGET_UNIX)
+		struct rusage usage;
+		if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+			return 0;
+		}
+#	if defined(DEATH_TARGET_APPLE)
+		// Reported in bytes on Apple platforms
+		return (std::uint64_t)usage.ru_maxrss;
+#	else
+		// Reported in kilobytes on Linux
+		return (std::uint64_t)usage.ru_maxrss * 1024;
+#	endif
+#else
+		return 0;
+#endif
+	}
+}
+
+#endif
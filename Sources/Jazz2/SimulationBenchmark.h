@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#if defined(WITH_BENCHMARK)
+
+#include "IRootController.h"
+#include "LevelInitialization.h"
+#include "../nCine/AppConfiguration.h"
+
+#include <memory>
+
+#include <Containers/SmallVector.h>
+#include <Containers/String.h>
+#include <Containers/StringView.h>
+
+using namespace Death::Containers;
+using namespace nCine;
+
+namespace Jazz2
+{
+	class LevelHandler;
+
+	/**
+		@brief Plays a level with scripted or recorded input and measures cost of the simulation
+
+		The level is simulated at fixed time multiplier without rendering and audio, so results are comparable between
+		runs and releases. Per-phase timings, allocation counts and peak memory usage are saved as JSON.
+	*/
+	class SimulationBenchmark : public IRootController
+	{
+	public:
+		/** @brief Benchmark configuration parsed from command-line */
+		struct Configuration
+		{
+			/** @brief Episode name */
+			String EpisodeName;
+			/** @brief Level name */
+			String LevelName;
+			/** @brief Path to a file with recorded input, scripted input is used if empty */
+			String InputPath;
+			/** @brief Path to a file where results are saved, results are written to log if empty */
+			String OutputPath;
+			/** @brief Number of frames to simulate */
+			std::int32_t FrameCount;
+			/** @brief Fixed time multiplier of each frame */
+			float TimeMult;
+			/** @brief Seed of the random generator */
+			std::uint64_t Seed;
+			/** @brief Difficulty */
+			GameDifficulty Difficulty;
+			/** @brief Player type */
+			PlayerType Player;
+
+			Configuration();
+		};
+
+		static constexpr std::int32_t DefaultFrameCount = 3600;
+		static constexpr std::uint64_t DefaultSeed = 0x2095A59FF0BFBBEF;
+
+		/** @brief Parses `/benchmark:<episode>/<level>` and related command-line options, returns `false` if not specified */
+		static bool TryParseArguments(const AppConfiguration& config, Configuration& result);
+
+		explicit SimulationBenchmark(Configuration&& config);
+		~SimulationBenchmark() override;
+
+		/** @brief Loads the level and simulates all frames, returns `false` if the level cannot be loaded */
+		bool Run();
+
+		void InvokeAsync(const std::function<void()>& callback) override;
+		void InvokeAsync(std::function<void()>&& callback) override;
+		void GoToMainMenu(bool afterIntro) override;
+		void ChangeLevel(LevelInitialization&& levelInit) override;
+		bool HasResumableState() const override;
+		void ResumeSavedState() override;
+		bool SaveCurrentStateIfAny() override;
+
+#if defined(WITH_MULTIPLAYER)
+		bool ConnectToServer(const StringView address, std::uint16_t port) override;
+		bool CreateServer(LevelInitialization&& levelInit, std::uint16_t port) override;
+#endif
+
+		Flags GetFlags() const override;
+		StringView GetNewestVersion() const override;
+
+		void RefreshCacheLevels() override;
+
+	private:
+		/** @brief Measured phase of a frame */
+		enum class Phase
+		{
+			Events,
+			Scripts,
+			Actors,
+			TileMap,
+			Collisions,
+			Other,
+			Frame,
+
+			Count
+		};
+
+		/** @brief Pressed actions starting at a specified frame */
+		struct InputEntry
+		{
+			std::int32_t Frame;
+			std::uint32_t Actions;
+		};
+
+		Configuration _config;
+		std::unique_ptr<LevelHandler> _levelHandler;
+		SmallVector<std::function<void()>, 0> _pendingCallbacks;
+		SmallVector<InputEntry, 0> _input;
+		SmallVector<float, 0> _timings[(std::int32_t)Phase::Count];
+		bool _levelChanged;
+
+		bool LoadInput(StringView path);
+		std::uint32_t GetScriptedInput(std::int32_t frame) const;
+		void ApplyInput(std::int32_t frame, std::size_t& inputIndex);
+		void SimulateFrame(float timeMult);
+		bool SaveResults(float loadTime, std::int32_t framesSimulated, std::int64_t allocationCount, std::int64_t allocatedBytes, std::size_t maxActorCount);
+
+		static const char* GetPhaseName(Phase phase);
+		static std::uint64_t GetPeakMemoryUsage();
+	};
+}
+
+#endif
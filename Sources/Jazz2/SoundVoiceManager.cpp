@@ -0,0 +1,378 @@
+﻿#if defined(WITH_AUDIO)
+
+#include "SoundVoiceManager.h"
+#include "PlayerViewport.h"
+#include "../nCine/ServiceLocator.h"
+
+#include <float.h>
+
+namespace Jazz2
+{
+	namespace
+	{
+		// Distances (in pixels) matching the linear clamped distance model of the audio device
+		constexpr float AudibleReferenceDistance = IAudioDevice::ReferenceDistance / IAudioDevice::LengthToPhysical;
+		constexpr float AudibleMaxDistance = IAudioDevice::MaxDistance / IAudioDevice::LengthToPhysical;
+
+		// A virtual voice must be noticeably more important to steal a source, so similar voices don't swap sources every frame
+		constexpr float PriorityHysteresis = 1.25f;
+
+		std::uint32_t HashIdentifier(StringView identifier)
+		{
+			// FNV-1a
+			std::uint32_t hash = 2166136261u;
+			for (char c : identifier) {
+				hash = (hash ^ (std::uint8_t)c) * 16777619u;
+			}
+			return hash;
+		}
+	}
+
+	VoicePlayer::VoicePlayer(SoundVoiceManager* owner)
+		: _owner(owner), _identifierHash(0), _startTime(0.0f), _elapsedTime(0.0f), _priority(0.0f), _isVirtual(false)
+	{
+	}
+
+	void VoicePlayer::play()
+	{
+		if (_owner == nullptr || state_ == PlayerState::Paused) {
+			AudioBufferPlayer::play();
+			return;
+		}
+
+		if (!_isVirtual && state_ != PlayerState::Playing) {
+			_owner->StartVoice(this);
+		}
+	}
+
+	void VoicePlayer::stop()
+	{
+		_isVirtual = false;
+		AudioBufferPlayer::stop();
+	}
+
+	Vector3f VoicePlayer::getAdjustedPosition(IAudioDevice& device, const Vector3f& pos, bool isSourceRelative, bool isAs2D)
+	{
+		if (isSourceRelative || isAs2D || _owner == nullptr || _owner->_viewports.size() <= 1) {
+			return AudioBufferPlayer::getAdjustedPosition(device, pos, isSourceRelative, isAs2D);
+		}
+
+		// Listener is in the origin in split-screen, so the position is relative to the nearest viewport
+		auto viewports = _owner->_viewports;
+		std::size_t minIndex = 0;
+		float minDistance = FLT_MAX;
+
+		for (std::size_t i = 0; i < viewports.size(); i++) {
+			float distance = (pos.ToVector2() - viewports[i]->_cameraPos).SqrLength();
+			if (minDistance > distance) {
+				minDistance = distance;
+				minIndex = i;
+			}
+		}
+
+		Vector3f relativePos = (pos - Vector3f(viewports[minIndex]->_cameraPos, 0.0f));
+		return AudioBufferPlayer::getAdjustedPosition(device, relativePos, false, false);
+	}
+
+	void VoicePlayer::UpdatePosition()
+	{
+		if (state_ != PlayerState::Playing || GetFlags(PlayerFlags::SourceRelative) || GetFlags(PlayerFlags::As2D)) {
+			return;
+		}
+
+		IAudioDevice& device = theServiceLocator().GetAudioDevice();
+		setPositionInternal(getAdjustedPosition(device, position_, false, false));
+	}
+
+	SoundVoiceManager::SoundVoiceManager()
+		: _time(0.0f)
+	{
+	}
+
+	SoundVoiceManager::~SoundVoiceManager()
+	{
+		// Players can outlive the manager if they are still referenced by someone else
+		for (auto& voice : _voices) {
+			voice->stop();
+			voice->_owner = nullptr;
+		}
+		for (auto& voice : _pooledPlayers) {
+			voice->_owner = nullptr;
+		}
+	}
+
+	std::shared_ptr<AudioBufferPlayer> SoundVoiceManager::Play(StringView identifier, AudioBuffer* buffer, const Vector3f& pos, bool sourceRelative, float gain, float pitch, float lowPass)
+	{
+		std::uint32_t identifierHash = HashIdentifier(identifier);
+		float priority = GetPriority(pos, sourceRelative, gain);
+
+		std::int32_t instanceCount = 0;
+		VoicePlayer* weakestInstance = nullptr;
+		for (auto& voice : _voices) {
+			if (voice->_identifierHash != identifierHash || !(voice->_isVirtual || voice->isPlaying() || voice->isPaused())) {
+				continue;
+			}
+
+			// Explosion chains often request the same sound many times in a row, play it only once,
+			// but only if nobody else holds the player, so it can't be unexpectedly shared
+			if (_time - voice->_startTime < DeduplicationTime && voice.use_count() == 1 && !voice->isLooping() &&
+				voice->isSourceRelative() == sourceRelative && (voice->position().ToVector2() - pos.ToVector2()).SqrLength() < DeduplicationDistance * DeduplicationDistance) {
+				if (voice->gain() < gain) {
+					voice->setGain(gain);
+					voice->_priority = std::max(voice->_priority, priority);
+				}
+				return voice;
+			}
+
+			instanceCount++;
+			if (!voice->isLooping() && (weakestInstance == nullptr || weakestInstance->_priority > voice->_priority)) {
+				weakestInstance = voice.get();
+			}
+		}
+
+		if (instanceCount >= MaxInstancesPerIdentifier) {
+			// Replace the least important instance, looping sounds are never replaced
+			if (weakestInstance == nullptr || weakestInstance->_priority > priority) {
+				return nullptr;
+			}
+			weakestInstance->stop();
+		}
+
+		std::shared_ptr<VoicePlayer> voice;
+		if (!_pooledPlayers.empty()) {
+			voice = _pooledPlayers.pop_back_val();
+		} else {
+			voice = std::make_shared<VoicePlayer>(this);
+		}
+
+		voice->setAudioBuffer(buffer);
+		voice->setLooping(false);
+		voice->setAs2D(false);
+		voice->setSourceRelative(sourceRelative);
+		voice->setPosition(pos);
+		voice->setGain(gain);
+		voice->setPitch(pitch);
+		voice->setLowPass(lowPass);
+		voice->_identifierHash = identifierHash;
+		voice->_startTime = _time;
+
+		_voices.push_back(voice);
+		StartVoice(voice.get());
+		return voice;
+	}
+
+	void SoundVoiceManager::OnEndFrame(float timeMult)
+	{
+		float timeDelta = timeMult * FrameTimer::SecondsPerFrame;
+		_time += timeDelta;
+
+		bool isSplitscreen = (_viewports.size() > 1);
+		std::int32_t realVoiceCount = 0;
+
+		auto it = _voices.begin();
+		while (it != _voices.end()) {
+			VoicePlayer* voice = it->get();
+
+			if (voice->_isVirtual) {
+				if (voice->isLooping() && it->use_count() == 1) {
+					// Looping sound was abandoned by its owner, it would never end
+					voice->_isVirtual = false;
+				} else {
+					// Virtual voices keep time, so they continue from the right position once they become audible
+					voice->_elapsedTime += timeDelta * voice->pitch();
+					float duration = voice->duration();
+					if (voice->_elapsedTime >= duration) {
+						if (voice->isLooping() && duration > 0.0f) {
+							voice->_elapsedTime = std::fmod(voice->_elapsedTime, duration);
+						} else {
+							voice->_isVirtual = false;
+						}
+					}
+				}
+			}
+
+			if (!voice->_isVirtual && !voice->isPlaying() && !voice->isPaused()) {
+				if (it->use_count() == 1) {
+					// Nobody references the player anymore, so it can be reused
+					if (_pooledPlayers.size() < MaxPooledPlayers) {
+						_pooledPlayers.push_back(std::move(*it));
+					}
+					it = _voices.eraseUnordered(it);
+					continue;
+				}
+				++it;
+				continue;
+			}
+
+			voice->_priority = GetPriority(voice->position(), voice->isSourceRelative() || voice->isAs2D(), voice->gain());
+
+			if (voice->isPlaying()) {
+				if (voice->_priority <= 0.0f) {
+					// Sound is out of range of all listeners, release its source
+					Demote(voice);
+				} else {
+					realVoiceCount++;
+					if (isSplitscreen) {
+						voice->UpdatePosition();
+					}
+				}
+			} else if (voice->isPaused()) {
+				realVoiceCount++;
+			}
+			++it;
+		}
+
+		// Assign free sources to the most important virtual voices, or steal them from less important voices
+		std::int32_t maxRealVoices = GetMaxRealVoices();
+		for (std::size_t n = 0; n < _voices.size(); n++) {
+			VoicePlayer* bestVirtual = nullptr;
+			for (auto& voice : _voices) {
+				if (voice->_isVirtual && voice->_priority > 0.0f && (bestVirtual == nullptr || bestVirtual->_priority < voice->_priority)) {
+					bestVirtual = voice.get();
+				}
+			}
+			if (bestVirtual == nullptr) {
+				break;
+			}
+
+			if (realVoiceCount >= maxRealVoices) {
+				VoicePlayer* lowestReal = FindLowestRealVoice();
+				if (lowestReal == nullptr || lowestReal->_priority * PriorityHysteresis >= bestVirtual->_priority) {
+					break;
+				}
+				Demote(lowestReal);
+				realVoiceCount--;
+			}
+
+			if (!TryPromote(bestVirtual)) {
+				break;
+			}
+			realVoiceCount++;
+		}
+	}
+
+	void SoundVoiceManager::SetViewports(ArrayView<std::unique_ptr<PlayerViewport>> viewports)
+	{
+		_viewports = viewports;
+	}
+
+	void SoundVoiceManager::PauseAll()
+	{
+		for (auto& voice : _voices) {
+			if (voice->isPlaying()) {
+				voice->pause();
+			}
+		}
+	}
+
+	void SoundVoiceManager::ResumeAll()
+	{
+		for (auto& voice : _voices) {
+			if (voice->isPaused()) {
+				voice->play();
+			}
+		}
+	}
+
+	void SoundVoiceManager::StartVoice(VoicePlayer* voice)
+	{
+		voice->_priority = GetPriority(voice->position(), voice->isSourceRelative() || voice->isAs2D(), voice->gain());
+		voice->_elapsedTime = 0.0f;
+		voice->_isVirtual = true;
+
+		if (voice->_priority <= 0.0f) {
+			// Not audible yet, keep it virtual until it gets close enough to any listener
+			return;
+		}
+
+		if (GetRealVoiceCount() >= GetMaxRealVoices()) {
+			VoicePlayer* lowestReal = FindLowestRealVoice();
+			if (lowestReal == nullptr || lowestReal->_priority >= voice->_priority) {
+				return;
+			}
+			Demote(lowestReal);
+		}
+
+		TryPromote(voice);
+	}
+
+	float SoundVoiceManager::GetPriority(const Vector3f& pos, bool sourceRelative, float gain) const
+	{
+		if (sourceRelative || _viewports.empty()) {
+			return gain;
+		}
+
+		float minDistance = FLT_MAX;
+		for (auto& viewport : _viewports) {
+			float distance = (pos.ToVector2() - viewport->_cameraPos).SqrLength();
+			if (minDistance > distance) {
+				minDistance = distance;
+			}
+		}
+
+		float attenuation = 1.0f - std::clamp((std::sqrt(minDistance) - AudibleReferenceDistance) / (AudibleMaxDistance - AudibleReferenceDistance), 0.0f, 1.0f);
+		return gain * attenuation;
+	}
+
+	std::int32_t SoundVoiceManager::GetMaxRealVoices() const
+	{
+		IAudioDevice& device = theServiceLocator().GetAudioDevice();
+		return std::max((std::int32_t)device.maxNumPlayers() - ReservedSources, 1);
+	}
+
+	std::int32_t SoundVoiceManager::GetRealVoiceCount() const
+	{
+		std::int32_t count = 0;
+		for (auto& voice : _voices) {
+			if (voice->isPlaying() || voice->isPaused()) {
+				count++;
+			}
+		}
+		return count;
+	}
+
+	bool SoundVoiceManager::TryPromote(VoicePlayer* voice)
+	{
+		// Don't even try if all sources are taken, the device would log a warning
+		IAudioDevice& device = theServiceLocator().GetAudioDevice();
+		if (device.numPlayers() >= device.maxNumPlayers()) {
+			return false;
+		}
+
+		voice->AudioBufferPlayer::play();
+		if (!voice->isPlaying()) {
+			return false;
+		}
+
+		if (voice->_elapsedTime > 0.0f) {
+			std::int32_t offset = (std::int32_t)(voice->_elapsedTime * voice->frequency());
+			if (offset > 0 && offset < (std::int32_t)voice->numSamples()) {
+				voice->setSampleOffset(offset);
+			}
+		}
+
+		voice->_isVirtual = false;
+		return true;
+	}
+
+	void SoundVoiceManager::Demote(VoicePlayer* voice)
+	{
+		std::int32_t frequency = voice->frequency();
+		voice->_elapsedTime = (frequency > 0 ? (float)voice->sampleOffset() / frequency : 0.0f);
+		voice->AudioBufferPlayer::stop();
+		voice->_isVirtual = true;
+	}
+
+	VoicePlayer* SoundVoiceManager::FindLowestRealVoice() const
+	{
+		VoicePlayer* lowestReal = nullptr;
+		for (auto& voice : _voices) {
+			if (voice->isPlaying() && (lowestReal == nullptr || lowestReal->_priority > voice->_priority)) {
+				lowestReal = voice.get();
+			}
+		}
+		return lowestReal;
+	}
+}
+
+#endif
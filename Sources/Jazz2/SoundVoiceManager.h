@@ -0,0 +1,104 @@
+﻿#pragma once
+
+#if defined(WITH_AUDIO)
+
+#include "../Common.h"
+#include "../nCine/Audio/AudioBufferPlayer.h"
+
+#include <memory>
+
+#include <Containers/ArrayView.h>
+#include <Containers/SmallVector.h>
+#include <Containers/StringView.h>
+
+using namespace Death::Containers;
+using namespace nCine;
+
+namespace Jazz2
+{
+	class PlayerViewport;
+	class SoundVoiceManager;
+
+	/** @brief Pooled sound effect player owned by @ref SoundVoiceManager */
+	class VoicePlayer : public AudioBufferPlayer
+	{
+		DEATH_RUNTIME_OBJECT(AudioBufferPlayer);
+
+		friend class SoundVoiceManager;
+
+	public:
+		explicit VoicePlayer(SoundVoiceManager* owner);
+
+		// Starts playing through the owning manager, so the voice may start as virtual if it's not audible
+		void play() override;
+		// Stops playing, including virtual playback
+		void stop() override;
+
+		// Returns true if the voice is playing, but it has no source assigned
+		bool IsVirtual() const {
+			return _isVirtual;
+		}
+
+	protected:
+		Vector3f getAdjustedPosition(IAudioDevice& device, const Vector3f& pos, bool isSourceRelative, bool isAs2D) override;
+
+	private:
+		SoundVoiceManager* _owner;
+		std::uint32_t _identifierHash;
+		float _startTime;
+		float _elapsedTime;
+		float _priority;
+		bool _isVirtual;
+
+		void UpdatePosition();
+	};
+
+	/** @brief Plays sound effects using pooled players with priorities, instance limits and virtual voices */
+	class SoundVoiceManager
+	{
+		friend class VoicePlayer;
+
+	public:
+		// Number of sources that are never used by sound effects, so music and UI sounds can always play
+		static constexpr std::int32_t ReservedSources = 8;
+		// Max. number of instances of the same sound effect that can be playing at once (including virtual ones)
+		static constexpr std::int32_t MaxInstancesPerIdentifier = 4;
+		// The same sound effect requested again at nearly the same position within this time (in seconds) is played only once
+		static constexpr float DeduplicationTime = 0.05f;
+		static constexpr float DeduplicationDistance = 16.0f;
+		// Max. number of stopped players kept for reuse
+		static constexpr std::int32_t MaxPooledPlayers = 64;
+
+		SoundVoiceManager();
+		~SoundVoiceManager();
+
+		SoundVoiceManager(const SoundVoiceManager&) = delete;
+		SoundVoiceManager& operator=(const SoundVoiceManager&) = delete;
+
+		// Plays a sound effect, returns nullptr if it was rejected because of the instance limit
+		std::shared_ptr<AudioBufferPlayer> Play(StringView identifier, AudioBuffer* buffer, const Vector3f& pos, bool sourceRelative, float gain, float pitch, float lowPass);
+		// Advances virtual voices and reassigns sources to the most important voices
+		void OnEndFrame(float timeMult);
+		// Sets viewports used as listeners for distance culling and split-screen positioning
+		void SetViewports(ArrayView<std::unique_ptr<PlayerViewport>> viewports);
+
+		void PauseAll();
+		void ResumeAll();
+
+	private:
+		SmallVector<std::shared_ptr<VoicePlayer>, 0> _voices;
+		SmallVector<std::shared_ptr<VoicePlayer>, 0> _pooledPlayers;
+		ArrayView<std::unique_ptr<PlayerViewport>> _viewports;
+		float _time;
+
+		void StartVoice(VoicePlayer* voice);
+		float GetPriority(const Vector3f& pos, bool sourceRelative, float gain) const;
+		std::int32_t GetMaxRealVoices() const;
+		std::int32_t GetRealVoiceCount() const;
+		bool TryPromote(VoicePlayer* voice);
+		void Demote(VoicePlayer* voice);
+		VoicePlayer* FindLowestRealVoice() const;
+	};
+}
+
+#endif
@@ -0,0 +1,185 @@
+﻿#include "SpriteAtlas.h"
+#include "Resources.h"
+#include "../nCine/ServiceLocator.h"
+#include "../nCine/Graphics/IGfxCapabilities.h"
+
+namespace Jazz2
+{
+	SpriteAtlas::SpriteAtlas()
+		: _pageSize(0)
+	{
+	}
+
+	bool SpriteAtlas::CanAdd(std::int32_t width, std::int32_t height)
+	{
+		return (width > 0 && height > 0 && width <= MaxSheetSize && height <= MaxSheetSize);
+	}
+
+	bool SpriteAtlas::Add(GenericGraphicResource* resource, const std::uint32_t* pixels, std::int32_t width, std::int32_t height)
+	{
+		if (_pageSize == 0) {
+			const IGfxCapabilities& gfxCaps = theServiceLocator().GetGfxCapabilities();
+			_pageSize = std::min(PageSize, gfxCaps.value(IGfxCapabilities::GLIntValues::MAX_TEXTURE_SIZE));
+		}
+
+		std::int32_t paddedWidth = width + Padding;
+		std::int32_t paddedHeight = height + Padding;
+		if (paddedWidth > _pageSize || paddedHeight > _pageSize) {
+			return false;
+		}
+
+		Page* targetPage = nullptr;
+		Vector2i pos;
+		for (auto& page : _pages) {
+			if (TryAllocate(*page, paddedWidth, paddedHeight, pos)) {
+				targetPage = page.get();
+				break;
+			}
+		}
+
+		if (targetPage == nullptr) {
+			// No space left in existing pages, create a new one
+			auto& page = _pages.emplace_back(std::make_unique<Page>());
+			page->TextureDiffuse = std::make_shared<Texture>("SpriteAtlas", Texture::Format::RGBA8, _pageSize, _pageSize);
+			page->TextureDiffuse->setMinFiltering(SamplerFilter::Nearest);
+			page->TextureDiffuse->setMagFiltering(SamplerFilter::Nearest);
+			page->NextShelfY = 0;
+			if (!TryAllocate(*page, paddedWidth, paddedHeight, pos)) {
+				_pages.pop_back();
+				return false;
+			}
+			targetPage = page.get();
+		}
+
+		Texture* texture = targetPage->TextureDiffuse.get();
+		texture->loadFromTexels((const unsigned char*)pixels, pos.X, pos.Y, width, height);
+
+		// Clear the gap, because the space could be occupied by another sprite sheet before
+		std::unique_ptr<std::uint32_t[]> emptyPixels = std::make_unique<std::uint32_t[]>(std::max(paddedWidth, paddedHeight) * Padding);
+		texture->loadFromTexels((const unsigned char*)emptyPixels.get(), pos.X + width, pos.Y, Padding, paddedHeight);
+		texture->loadFromTexels((const unsigned char*)emptyPixels.get(), pos.X, pos.Y + height, width, Padding);
+
+		targetPage->Allocations.push_back(Allocation { resource, Recti(pos.X, pos.Y, paddedWidth, paddedHeight) });
+
+		resource->TextureDiffuse = targetPage->TextureDiffuse;
+		resource->TextureOffset = pos;
+		return true;
+	}
+
+	void SpriteAtlas::Remove(GenericGraphicResource* resource)
+	{
+		if (resource->TextureDiffuse == nullptr) {
+			return;
+		}
+
+		for (std::size_t i = 0; i < _pages.size(); i++) {
+			Page& page = *_pages[i];
+			if (page.TextureDiffuse != resource->TextureDiffuse) {
+				continue;
+			}
+
+			for (std::size_t j = 0; j < page.Allocations.size(); j++) {
+				if (page.Allocations[j].Owner == resource) {
+					FreeSpan(page, page.Allocations[j].Rect);
+					page.Allocations.erase(page.Allocations.begin() + j);
+					break;
+				}
+			}
+
+			if (page.Allocations.empty()) {
+				// Texture is released when the last resource is destroyed
+				_pages.erase(_pages.begin() + i);
+			}
+			break;
+		}
+	}
+
+	void SpriteAtlas::Clear()
+	{
+		_pages.clear();
+	}
+
+	bool SpriteAtlas::TryAllocate(Page& page, std::int32_t width, std::int32_t height, Vector2i& result)
+	{
+		// Find a shelf that wastes the least vertical space
+		Shelf* bestShelf = nullptr;
+		std::int32_t bestSpan = -1;
+		std::int32_t bestWaste = INT32_MAX;
+		for (auto& shelf : page.Shelves) {
+			std::int32_t waste = shelf.Height - height;
+			if (waste < 0 || waste >= bestWaste) {
+				continue;
+			}
+			for (std::int32_t i = 0; i < (std::int32_t)shelf.FreeSpans.size(); i++) {
+				if (shelf.FreeSpans[i].Width >= width) {
+					bestShelf = &shelf;
+					bestSpan = i;
+					bestWaste = waste;
+					break;
+				}
+			}
+		}
+
+		// Start a new shelf instead if too much space would be wasted
+		if ((bestShelf == nullptr || bestWaste > height / 2) && page.NextShelfY + height <= _pageSize) {
+			auto& shelf = page.Shelves.emplace_back();
+			shelf.Y = page.NextShelfY;
+			shelf.Height = height;
+			shelf.FreeSpans.push_back(Span { 0, _pageSize });
+			page.NextShelfY += height;
+			bestShelf = &shelf;
+			bestSpan = 0;
+		}
+
+		if (bestShelf == nullptr) {
+			return false;
+		}
+
+		Span& span = bestShelf->FreeSpans[bestSpan];
+		result = Vector2i(span.X, bestShelf->Y);
+		span.X += width;
+		span.Width -= width;
+		if (span.Width <= 0) {
+			bestShelf->FreeSpans.erase(bestShelf->FreeSpans.begin() + bestSpan);
+		}
+		return true;
+	}
+
+	void SpriteAtlas::FreeSpan(Page& page, const Recti& rect)
+	{
+		std::size_t shelfIdx = 0;
+		while (shelfIdx < page.Shelves.size() && page.Shelves[shelfIdx].Y != rect.Y) {
+			shelfIdx++;
+		}
+		if (shelfIdx >= page.Shelves.size()) {
+			return;
+		}
+
+		// Free spans are kept sorted, so adjacent spans can be merged
+		auto& spans = page.Shelves[shelfIdx].FreeSpans;
+		std::size_t i = 0;
+		while (i < spans.size() && spans[i].X < rect.X) {
+			i++;
+		}
+		spans.insert(spans.begin() + i, Span { rect.X, rect.W });
+
+		if (i + 1 < spans.size() && spans[i].X + spans[i].Width == spans[i + 1].X) {
+			spans[i].Width += spans[i + 1].Width;
+			spans.erase(spans.begin() + i + 1);
+		}
+		if (i > 0 && spans[i - 1].X + spans[i - 1].Width == spans[i].X) {
+			spans[i - 1].Width += spans[i].Width;
+			spans.erase(spans.begin() + i);
+		}
+
+		// Release empty shelves at the bottom of the page, so the space can be reused by shelves of different height
+		while (!page.Shelves.empty()) {
+			auto& lastShelf = page.Shelves.back();
+			if (lastShelf.FreeSpans.size() != 1 || lastShelf.FreeSpans[0].Width != _pageSize) {
+				break;
+			}
+			page.NextShelfY = lastShelf.Y;
+			page.Shelves.pop_back();
+		}
+	}
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include "../Common.h"
+#include "../nCine/Graphics/Texture.h"
+#include "../nCine/Primitives/Rect.h"
+
+#include <memory>
+
+#include <Containers/SmallVector.h>
+
+using namespace Death::Containers;
+using namespace nCine;
+
+namespace Jazz2
+{
+	struct GenericGraphicResource;
+
+	/** @brief Packs sprite sheets of multiple animations into shared textures, so sprites can be batched together */
+	class SpriteAtlas
+	{
+	public:
+		// Preferred size of each page, it's limited by the device maximum
+		static constexpr std::int32_t PageSize = 2048;
+		// Larger sprite sheets always use their own texture
+		static constexpr std::int32_t MaxSheetSize = 512;
+
+		SpriteAtlas();
+
+		SpriteAtlas(const SpriteAtlas&) = delete;
+		SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+
+		// Returns true if a sprite sheet of specified size can be packed into the atlas
+		static bool CanAdd(std::int32_t width, std::int32_t height);
+
+		// Uploads a sprite sheet to the atlas and sets texture and its offset of the resource, returns false if there is no space left
+		bool Add(GenericGraphicResource* resource, const std::uint32_t* pixels, std::int32_t width, std::int32_t height);
+		// Releases space occupied by the sprite sheet of the resource, empty pages are released too
+		void Remove(GenericGraphicResource* resource);
+		// Releases all pages, textures are kept alive by resources that are still using them
+		void Clear();
+
+	private:
+		// Transparent gap on the right and bottom side of each sprite sheet to avoid bleeding of adjacent sheets
+		static constexpr std::int32_t Padding = 1;
+
+		struct Span
+		{
+			std::int32_t X;
+			std::int32_t Width;
+		};
+
+		struct Shelf
+		{
+			std::int32_t Y;
+			std::int32_t Height;
+			SmallVector<Span, 4> FreeSpans;
+		};
+
+		struct Allocation
+		{
+			GenericGraphicResource* Owner;
+			Recti Rect;
+		};
+
+		struct Page
+		{
+			std::shared_ptr<Texture> TextureDiffuse;
+			SmallVector<Shelf, 0> Shelves;
+			SmallVector<Allocation, 0> Allocations;
+			std::int32_t NextShelfY;
+		};
+
+		SmallVector<std::unique_ptr<Page>, 0> _pages;
+		std::int32_t _pageSize;
+
+		bool TryAllocate(Page& page, std::int32_t width, std::int32_t height, Vector2i& result);
+		void FreeSpan(Page& page, const Recti& rect);
+	};
+}
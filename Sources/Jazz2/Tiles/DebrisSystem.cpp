@@ -0,0 +1,444 @@
+﻿#include "DebrisSystem.h"
+#include "TileMap.h"
+#include "../ContentResolver.h"
+
+#include "../../nCine/ServiceLocator.h"
+#include "../../nCine/tracy.h"
+#include "../../nCine/Graphics/RenderQueue.h"
+#include "../../nCine/Graphics/RenderResources.h"
+
+#include <algorithm>
+
+#if defined(DEATH_TARGET_SSE2)
+#	include <IntrinsicsSse2.h>
+#elif defined(DEATH_TARGET_NEON)
+#	include <arm_neon.h>
+#endif
+
+namespace Jazz2::Tiles
+{
+	DebrisSystem::DebrisSystem(TileMap* owner)
+		: _owner(owner), _count(0), _renderCommandsCount(0)
+	{
+	}
+
+	void DebrisSystem::Add(const DestructibleDebris& debris)
+	{
+		const float values[(std::int32_t)Field::Count] = {
+			debris.Pos.X, debris.Pos.Y, debris.Speed.X, debris.Speed.Y, debris.Acceleration.X, debris.Acceleration.Y,
+			debris.Scale, debris.ScaleSpeed, debris.Angle, debris.AngleSpeed, debris.Alpha, debris.AlphaSpeed, debris.Time,
+			debris.Size.X, debris.Size.Y, debris.TexScaleX, debris.TexBiasX, debris.TexScaleY, debris.TexBiasY
+		};
+
+		for (std::int32_t i = 0; i < (std::int32_t)Field::Count; i++) {
+			_fields[i].push_back(values[i]);
+		}
+		_textures.push_back(debris.DiffuseTexture);
+		_depths.push_back(debris.Depth);
+		_paletteOffsets.push_back(debris.PaletteOffset);
+		_flags.push_back(debris.Flags);
+		_count++;
+	}
+
+	void DebrisSystem::Clear()
+	{
+		for (std::int32_t i = 0; i < (std::int32_t)Field::Count; i++) {
+			_fields[i].clear();
+		}
+		_textures.clear();
+		_depths.clear();
+		_paletteOffsets.clear();
+		_flags.clear();
+		_count = 0;
+	}
+
+	void DebrisSystem::OnUpdate(float timeMult)
+	{
+		ZoneScopedNC("Debris", 0xA09359);
+
+		RemoveExpired();
+		if (_count == 0) {
+			return;
+		}
+
+		// Pieces don't interact with each other and tiles are only read, so batches can be updated in parallel
+		theServiceLocator().GetThreadPool().ParallelFor(_count, ParallelUpdateBatchSize, [this, timeMult](std::int32_t start, std::int32_t end) {
+			// Collisions have to be resolved before integration, because they use the current speed
+			ResolveCollisions(timeMult, start, end);
+			Integrate(timeMult, start, end);
+		});
+	}
+
+	void DebrisSystem::OnEndFrame()
+	{
+		// OnDraw() is called multiple times if multiple viewports are active
+		_renderCommandsCount = 0;
+	}
+
+	void DebrisSystem::OnDraw(RenderQueue& renderQueue)
+	{
+		ZoneScopedNC("Debris", 0xA09359);
+
+		constexpr float MaxDebrisSize = 128.0f;
+
+		Rectf viewportRect = RenderResources::currentViewport()->cullingRect();
+		viewportRect.X -= MaxDebrisSize;
+		viewportRect.Y -= MaxDebrisSize;
+		viewportRect.W += MaxDebrisSize * 2.0f;
+		viewportRect.H += MaxDebrisSize * 2.0f;
+
+		const float* posX = GetField(Field::PosX);
+		const float* posY = GetField(Field::PosY);
+
+		_drawItems.clear();
+		for (std::int32_t i = 0; i < _count; i++) {
+			if (!viewportRect.Contains(Vector2f(posX[i], posY[i]))) {
+				continue;
+			}
+
+			bool isAdditive = ((_flags[i] & DebrisFlags::AdditiveBlending) == DebrisFlags::AdditiveBlending);
+			_drawItems.push_back({ _textures[i], ((std::uint32_t)_depths[i] << 1) | (isAdditive ? 1 : 0), i });
+		}
+
+		if (_drawItems.empty()) {
+			return;
+		}
+
+		// Pieces sharing the same texture, layer and blending are drawn using one instanced draw
+		std::sort(_drawItems.begin(), _drawItems.end(), [](const DrawItem& a, const DrawItem& b) {
+			return (a.DiffuseTexture != b.DiffuseTexture ? a.DiffuseTexture < b.DiffuseTexture : a.SortKey < b.SortKey);
+		});
+
+		const Camera::ProjectionValues& cameraValues = RenderResources::currentCamera()->projectionValues();
+		const float* sizeX = GetField(Field::SizeX);
+		const float* sizeY = GetField(Field::SizeY);
+		const float* scale = GetField(Field::Scale);
+		const float* angle = GetField(Field::Angle);
+		const float* alpha = GetField(Field::Alpha);
+		const float* texScaleX = GetField(Field::TexScaleX);
+		const float* texBiasX = GetField(Field::TexBiasX);
+		const float* texScaleY = GetField(Field::TexScaleY);
+		const float* texBiasY = GetField(Field::TexBiasY);
+
+		RenderCommand* command = nullptr;
+		GLUniformBlockCache* instancesBlock = nullptr;
+		std::int32_t count = 0;
+		std::int32_t capacity = 0;
+		float depth = 0.0f;
+
+		std::size_t drawItemCount = _drawItems.size();
+		for (std::size_t j = 0; j < drawItemCount; j++) {
+			const DrawItem& item = _drawItems[j];
+			bool isNewGroup = (j == 0 || item.DiffuseTexture != _drawItems[j - 1].DiffuseTexture || item.SortKey != _drawItems[j - 1].SortKey);
+			if (isNewGroup || count >= capacity) {
+				if (command != nullptr) {
+					FinalizeRenderCommand(command, instancesBlock, count);
+					renderQueue.addCommand(command);
+				}
+
+				std::uint16_t layer = (std::uint16_t)(item.SortKey >> 1);
+				command = RentRenderCommand((_flags[item.Index] & DebrisFlags::Indexed) == DebrisFlags::Indexed);
+				command->setLayer(layer);
+				command->material().setTexture(*item.DiffuseTexture);
+				if ((item.SortKey & 1) != 0) {
+					command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE);
+				} else {
+					command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				}
+
+				instancesBlock = command->material().uniformBlock(Material::InstancesBlockName);
+				capacity = (std::int32_t)(instancesBlock->size() / sizeof(BatchedSpriteInstance));
+				count = 0;
+				depth = RenderCommand::calculateDepth(layer, cameraValues.nearClip, cameraValues.farClip);
+			}
+
+			std::int32_t i = item.Index;
+
+			BatchedSpriteInstance instance;
+			instance.ModelMatrix = Matrix4x4f::Translation(posX[i], posY[i], 0.0f);
+			instance.ModelMatrix.RotateZ(angle[i]);
+			instance.ModelMatrix.Scale(scale[i], scale[i], 1.0f);
+			instance.ModelMatrix.Translate(sizeX[i] * -0.5f, sizeY[i] * -0.5f, 0.0f);
+			instance.ModelMatrix[3][2] = depth;
+			// Palette offset is passed in red channel of the color if the texture is indexed
+			instance.Color[0] = ((_flags[i] & DebrisFlags::Indexed) == DebrisFlags::Indexed ? (float)_paletteOffsets[i] : 1.0f);
+			instance.Color[1] = 1.0f;
+			instance.Color[2] = 1.0f;
+			instance.Color[3] = alpha[i];
+			instance.TexRect[0] = texScaleX[i];
+			instance.TexRect[1] = texBiasX[i];
+			instance.TexRect[2] = texScaleY[i];
+			instance.TexRect[3] = texBiasY[i];
+			instance.SpriteSize[0] = sizeX[i];
+			instance.SpriteSize[1] = sizeY[i];
+			instance.Padding[0] = 0.0f;
+			instance.Padding[1] = 0.0f;
+
+			instancesBlock->copyData(count * sizeof(BatchedSpriteInstance), reinterpret_cast<const GLubyte*>(&instance), sizeof(BatchedSpriteInstance));
+			count++;
+		}
+
+		FinalizeRenderCommand(command, instancesBlock, count);
+		renderQueue.addCommand(command);
+	}
+
+	void DebrisSystem::RemoveExpired()
+	{
+		float* scale = GetField(Field::Scale);
+		float* alpha = GetField(Field::Alpha);
+
+		for (std::int32_t i = 0; i < _count; i++) {
+			if (scale[i] > 0.0f && alpha[i] > 0.0f) {
+				continue;
+			}
+
+			// Move the last piece to the removed one, order is not important
+			std::int32_t last = _count - 1;
+			if (i != last) {
+				for (std::int32_t f = 0; f < (std::int32_t)Field::Count; f++) {
+					_fields[f][i] = _fields[f][last];
+				}
+				_textures[i] = _textures[last];
+				_depths[i] = _depths[last];
+				_paletteOffsets[i] = _paletteOffsets[last];
+				_flags[i] = _flags[last];
+			}
+
+			for (std::int32_t f = 0; f < (std::int32_t)Field::Count; f++) {
+				_fields[f].pop_back();
+			}
+			_textures.pop_back();
+			_depths.pop_back();
+			_paletteOffsets.pop_back();
+			_flags.pop_back();
+			_count--;
+			i--;
+		}
+	}
+
+	void DebrisSystem::ResolveCollisions(float timeMult, std::int32_t start, std::int32_t end)
+	{
+		float* posX = GetField(Field::PosX);
+		float* posY = GetField(Field::PosY);
+		float* speedX = GetField(Field::SpeedX);
+		float* speedY = GetField(Field::SpeedY);
+
+		// Most of the pieces are flying through empty tiles, so they are filtered using only the collision data
+		// of the sprite layer first, the full collision check is performed only for the remaining pieces
+		SmallVector<std::int32_t, ParallelUpdateBatchSize> collidingIndices;
+		for (std::int32_t i = start; i < end; i++) {
+			if ((_flags[i] & (DebrisFlags::Disappear | DebrisFlags::Bounce)) == DebrisFlags::None) {
+				continue;
+			}
+
+			float nx = posX[i] + speedX[i] * timeMult;
+			float ny = posY[i] + speedY[i] * timeMult;
+			if (!_owner->IsTileCollisionEmpty(AABBf(nx - 1, ny - 1, nx + 1, ny + 1))) {
+				collidingIndices.push_back(i);
+			}
+		}
+
+		if (collidingIndices.empty()) {
+			return;
+		}
+
+		float* accelerationX = GetField(Field::AccelerationX);
+		float* accelerationY = GetField(Field::AccelerationY);
+		float* scaleSpeed = GetField(Field::ScaleSpeed);
+		float* angleSpeed = GetField(Field::AngleSpeed);
+		float* alphaSpeed = GetField(Field::AlphaSpeed);
+
+		for (std::int32_t i : collidingIndices) {
+			float nx = posX[i] + speedX[i] * timeMult;
+			float ny = posY[i] + speedY[i] * timeMult;
+			AABBf aabb = AABBf(nx - 1, ny - 1, nx + 1, ny + 1);
+			TileCollisionParams params = { TileDestructType::None, true };
+			if (_owner->IsTileEmpty(aabb, params)) {
+				// Nothing...
+			} else if ((_flags[i] & DebrisFlags::Disappear) == DebrisFlags::Disappear) {
+				scaleSpeed[i] = -0.02f;
+				alphaSpeed[i] = -0.006f;
+				speedX[i] = 0.0f;
+				speedY[i] = 0.0f;
+				accelerationX[i] = 0.0f;
+				accelerationY[i] = 0.0f;
+			} else {
+				// Place us to the ground only if no horizontal movement was
+				// involved (this prevents speeds resetting if the actor
+				// collides with a wall from the side while in the air)
+				aabb.T = posY[i] - 1;
+				aabb.B = posY[i] + 1;
+
+				if (_owner->IsTileEmpty(aabb, params)) {
+					if (speedY[i] > 0.0f) {
+						speedY[i] = -(0.8f/*elasticity*/ * speedY[i]);
+					} else {
+						speedY[i] = 0;
+					}
+				}
+
+				// If the actor didn't move all the way horizontally,
+				// it hit a wall (or was already touching it)
+				aabb = AABBf(posX[i] - 1, ny - 1, posX[i] + 1, ny + 1);
+				if (_owner->IsTileEmpty(aabb, params)) {
+					speedX[i] = -(0.8f/*elasticity*/ * speedX[i]);
+					angleSpeed[i] = -(0.8f/*elasticity*/ * angleSpeed[i]);
+				}
+			}
+		}
+	}
+
+	void DebrisSystem::Integrate(float timeMult, std::int32_t start, std::int32_t end)
+	{
+		constexpr float MaxSpeed = 10.0f;
+		constexpr float FadeOutAlpha = 0.02f;
+
+		float* posX = GetField(Field::PosX);
+		float* posY = GetField(Field::PosY);
+		float* speedX = GetField(Field::SpeedX);
+		float* speedY = GetField(Field::SpeedY);
+		const float* accelerationX = GetField(Field::AccelerationX);
+		const float* accelerationY = GetField(Field::AccelerationY);
+		float* scale = GetField(Field::Scale);
+		const float* scaleSpeed = GetField(Field::ScaleSpeed);
+		float* angle = GetField(Field::Angle);
+		const float* angleSpeed = GetField(Field::AngleSpeed);
+		float* alpha = GetField(Field::Alpha);
+		const float* alphaSpeed = GetField(Field::AlphaSpeed);
+		float* time = GetField(Field::Time);
+
+		float halfTimeMult2 = 0.5f * timeMult * timeMult;
+		std::int32_t i = start;
+
+#if defined(DEATH_TARGET_SSE2)
+		const __m128 t = _mm_set1_ps(timeMult);
+		const __m128 ht2 = _mm_set1_ps(halfTimeMult2);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 maxSpeed = _mm_set1_ps(MaxSpeed);
+		const __m128 fadeOutAlpha = _mm_set1_ps(FadeOutAlpha);
+
+		for (; i + 4 <= end; i += 4) {
+			// Pieces with expired time start to fade out
+			__m128 newTime = _mm_sub_ps(_mm_loadu_ps(&time[i]), t);
+			_mm_storeu_ps(&time[i], newTime);
+			__m128 a = _mm_loadu_ps(&alpha[i]);
+			__m128 expired = _mm_cmple_ps(newTime, zero);
+			a = _mm_or_ps(_mm_and_ps(expired, _mm_sub_ps(zero, _mm_min_ps(fadeOutAlpha, a))), _mm_andnot_ps(expired, a));
+			_mm_storeu_ps(&alpha[i], _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(&alphaSpeed[i]), t)));
+
+			__m128 ax = _mm_loadu_ps(&accelerationX[i]);
+			__m128 sx = _mm_loadu_ps(&speedX[i]);
+			_mm_storeu_ps(&posX[i], _mm_add_ps(_mm_loadu_ps(&posX[i]), _mm_add_ps(_mm_mul_ps(sx, t), _mm_mul_ps(ax, ht2))));
+			// Speed is changed (and limited) only if the piece is accelerating
+			__m128 accelerating = _mm_cmpneq_ps(ax, zero);
+			__m128 newSpeed = _mm_min_ps(_mm_add_ps(sx, _mm_mul_ps(ax, t)), maxSpeed);
+			_mm_storeu_ps(&speedX[i], _mm_or_ps(_mm_and_ps(accelerating, newSpeed), _mm_andnot_ps(accelerating, sx)));
+
+			__m128 ay = _mm_loadu_ps(&accelerationY[i]);
+			__m128 sy = _mm_loadu_ps(&speedY[i]);
+			_mm_storeu_ps(&posY[i], _mm_add_ps(_mm_loadu_ps(&posY[i]), _mm_add_ps(_mm_mul_ps(sy, t), _mm_mul_ps(ay, ht2))));
+			accelerating = _mm_cmpneq_ps(ay, zero);
+			newSpeed = _mm_min_ps(_mm_add_ps(sy, _mm_mul_ps(ay, t)), maxSpeed);
+			_mm_storeu_ps(&speedY[i], _mm_or_ps(_mm_and_ps(accelerating, newSpeed), _mm_andnot_ps(accelerating, sy)));
+
+			_mm_storeu_ps(&scale[i], _mm_add_ps(_mm_loadu_ps(&scale[i]), _mm_mul_ps(_mm_loadu_ps(&scaleSpeed[i]), t)));
+			_mm_storeu_ps(&angle[i], _mm_add_ps(_mm_loadu_ps(&angle[i]), _mm_mul_ps(_mm_loadu_ps(&angleSpeed[i]), t)));
+		}
+#elif defined(DEATH_TARGET_NEON)
+		const float32x4_t t = vdupq_n_f32(timeMult);
+		const float32x4_t ht2 = vdupq_n_f32(halfTimeMult2);
+		const float32x4_t zero = vdupq_n_f32(0.0f);
+		const float32x4_t maxSpeed = vdupq_n_f32(MaxSpeed);
+		const float32x4_t fadeOutAlpha = vdupq_n_f32(FadeOutAlpha);
+
+		for (; i + 4 <= end; i += 4) {
+			// Pieces with expired time start to fade out
+			float32x4_t newTime = vsubq_f32(vld1q_f32(&time[i]), t);
+			vst1q_f32(&time[i], newTime);
+			float32x4_t a = vld1q_f32(&alpha[i]);
+			a = vbslq_f32(vcleq_f32(newTime, zero), vnegq_f32(vminq_f32(fadeOutAlpha, a)), a);
+			vst1q_f32(&alpha[i], vmlaq_f32(a, vld1q_f32(&alphaSpeed[i]), t));
+
+			float32x4_t ax = vld1q_f32(&accelerationX[i]);
+			float32x4_t sx = vld1q_f32(&speedX[i]);
+			vst1q_f32(&posX[i], vaddq_f32(vld1q_f32(&posX[i]), vaddq_f32(vmulq_f32(sx, t), vmulq_f32(ax, ht2))));
+			// Speed is changed (and limited) only if the piece is accelerating
+			uint32x4_t notAccelerating = vceqq_f32(ax, zero);
+			vst1q_f32(&speedX[i], vbslq_f32(notAccelerating, sx, vminq_f32(vmlaq_f32(sx, ax, t), maxSpeed)));
+
+			float32x4_t ay = vld1q_f32(&accelerationY[i]);
+			float32x4_t sy = vld1q_f32(&speedY[i]);
+			vst1q_f32(&posY[i], vaddq_f32(vld1q_f32(&posY[i]), vaddq_f32(vmulq_f32(sy, t), vmulq_f32(ay, ht2))));
+			notAccelerating = vceqq_f32(ay, zero);
+			vst1q_f32(&speedY[i], vbslq_f32(notAccelerating, sy, vminq_f32(vmlaq_f32(sy, ay, t), maxSpeed)));
+
+			vst1q_f32(&scale[i], vmlaq_f32(vld1q_f32(&scale[i]), vld1q_f32(&scaleSpeed[i]), t));
+			vst1q_f32(&angle[i], vmlaq_f32(vld1q_f32(&angle[i]), vld1q_f32(&angleSpeed[i]), t));
+		}
+#endif
+
+		for (; i < end; i++) {
+			time[i] -= timeMult;
+			if (time[i] <= 0.0f) {
+				alpha[i] = -std::min(FadeOutAlpha, alpha[i]);
+			}
+			alpha[i] += alphaSpeed[i] * timeMult;
+
+			posX[i] += speedX[i] * timeMult + accelerationX[i] * halfTimeMult2;
+			posY[i] += speedY[i] * timeMult + accelerationY[i] * halfTimeMult2;
+
+			if (accelerationX[i] != 0.0f) {
+				speedX[i] = std::min(speedX[i] + accelerationX[i] * timeMult, MaxSpeed);
+			}
+			if (accelerationY[i] != 0.0f) {
+				speedY[i] = std::min(speedY[i] + accelerationY[i] * timeMult, MaxSpeed);
+			}
+
+			scale[i] += scaleSpeed[i] * timeMult;
+			angle[i] += angleSpeed[i] * timeMult;
+		}
+	}
+
+	RenderCommand* DebrisSystem::RentRenderCommand(bool isIndexed)
+	{
+		RenderCommand* command;
+		if (_renderCommandsCount < _renderCommands.size()) {
+			command = _renderCommands[_renderCommandsCount].get();
+		} else {
+			command = _renderCommands.emplace_back(std::make_unique<RenderCommand>(RenderCommand::Type::Particle)).get();
+			command->material().setBlendingEnabled(true);
+		}
+		_renderCommandsCount++;
+
+		bool shaderChanged = (isIndexed
+			? command->material().setShader(ContentResolver::Get().GetShader(PrecompiledShader::BatchedPalette))
+			: command->material().setShaderProgramType(Material::ShaderProgramType::BatchedSprites));
+		if (shaderChanged) {
+			command->material().reserveUniformsDataMemory();
+
+			GLUniformCache* textureUniform = command->material().uniform(Material::TextureUniformName);
+			if (textureUniform && textureUniform->intValue(0) != 0) {
+				textureUniform->setIntValue(0); // GL_TEXTURE0
+			}
+			GLUniformCache* paletteUniform = command->material().uniform(Material::PaletteUniformName);
+			if (paletteUniform && paletteUniform->intValue(0) != 1) {
+				paletteUniform->setIntValue(1); // GL_TEXTURE1
+			}
+		}
+
+		Texture* paletteTexture = (isIndexed ? ContentResolver::Get().GetPaletteTexture() : nullptr);
+		if (paletteTexture != nullptr) {
+			command->material().setTexture(1, *paletteTexture);
+		} else {
+			command->material().setTexture(1, nullptr);
+		}
+		return command;
+	}
+
+	void DebrisSystem::FinalizeRenderCommand(RenderCommand* command, GLUniformBlockCache* instancesBlock, std::int32_t count)
+	{
+		instancesBlock->setUsedSize(count * sizeof(BatchedSpriteInstance));
+		command->setBatchSize(count);
+		command->geometry().setDrawParameters(GL_TRIANGLES, 0, 6 * count);
+	}
+}
@@ -0,0 +1,138 @@
+﻿#pragma once
+
+#include "../../Common.h"
+#include "../../nCine/Graphics/RenderCommand.h"
+#include "../../nCine/Graphics/Texture.h"
+#include "../../nCine/Primitives/Vector2.h"
+
+#include <Containers/SmallVector.h>
+
+using namespace Death::Containers;
+using namespace nCine;
+
+namespace nCine
+{
+	class RenderQueue;
+}
+
+namespace Jazz2::Tiles
+{
+	class TileMap;
+
+	enum class DebrisFlags {
+		None = 0x00,
+		Disappear = 0x01,
+		Bounce = 0x02,
+		AdditiveBlending = 0x04,
+		// Texture contains palette indices, `PaletteOffset` is used to look up colors
+		Indexed = 0x08
+	};
+
+	DEFINE_ENUM_OPERATORS(DebrisFlags);
+
+	struct DestructibleDebris {
+		Vector2f Pos;
+		std::uint16_t Depth;
+
+		Vector2f Size;
+		Vector2f Speed;
+		Vector2f Acceleration;
+
+		float Scale;
+		float ScaleSpeed;
+
+		float Angle;
+		float AngleSpeed;
+
+		float Alpha;
+		float AlphaSpeed;
+
+		float Time;
+
+		float TexScaleX;
+		float TexBiasX;
+		float TexScaleY;
+		float TexBiasY;
+
+		Texture* DiffuseTexture;
+		std::uint16_t PaletteOffset;
+
+		DebrisFlags Flags;
+	};
+
+	/** @brief Particle system of tile and sprite debris */
+	class DebrisSystem
+	{
+	public:
+		DebrisSystem(TileMap* owner);
+
+		std::int32_t GetCount() const {
+			return _count;
+		}
+
+		void Add(const DestructibleDebris& debris);
+		void Clear();
+
+		void OnUpdate(float timeMult);
+		void OnEndFrame();
+		void OnDraw(RenderQueue& renderQueue);
+
+	private:
+		// Multiple of 4, so all pieces except the last batch can be integrated using SIMD
+		static constexpr std::int32_t ParallelUpdateBatchSize = 256;
+
+		// Debris is stored as structure of arrays, so all pieces can be integrated using SIMD
+		enum class Field {
+			PosX,
+			PosY,
+			SpeedX,
+			SpeedY,
+			AccelerationX,
+			AccelerationY,
+			Scale,
+			ScaleSpeed,
+			Angle,
+			AngleSpeed,
+			Alpha,
+			AlphaSpeed,
+			Time,
+			SizeX,
+			SizeY,
+			TexScaleX,
+			TexBiasX,
+			TexScaleY,
+			TexBiasY,
+
+			Count
+		};
+
+		struct DrawItem
+		{
+			Texture* DiffuseTexture;
+			std::uint32_t SortKey;
+			std::int32_t Index;
+		};
+
+		TileMap* _owner;
+		std::int32_t _count;
+		SmallVector<float, 0> _fields[(std::int32_t)Field::Count];
+		SmallVector<Texture*, 0> _textures;
+		SmallVector<std::uint16_t, 0> _depths;
+		SmallVector<std::uint16_t, 0> _paletteOffsets;
+		SmallVector<DebrisFlags, 0> _flags;
+		SmallVector<DrawItem, 0> _drawItems;
+		SmallVector<std::unique_ptr<RenderCommand>, 0> _renderCommands;
+		std::int32_t _renderCommandsCount;
+
+		float* GetField(Field field) {
+			return _fields[(std::int32_t)field].data();
+		}
+
+		void RemoveExpired();
+		void ResolveCollisions(float timeMult, std::int32_t start, std::int32_t end);
+		void Integrate(float timeMult, std::int32_t start, std::int32_t end);
+
+		RenderCommand* RentRenderCommand(bool isIndexed);
+		static void FinalizeRenderCommand(RenderCommand* command, GLUniformBlockCache* instancesBlock, std::int32_t count);
+	};
+}
@@ -3,15 +3,114 @@
 #include "../PreferencesCache.h"
 
 #include "../../nCine/tracy.h"
+#include "../../nCine/Application.h"
 #include "../../nCine/Base/Random.h"
 #include "../../nCine/Graphics/RenderQueue.h"
 #include "../../nCine/Graphics/RenderResources.h"
+#include "../../nCine/Graphics/GL/GLShaderProgram.h"
+
+#include <cfloat>
+
+#if defined(DEATH_TARGET_SSE2)
+#	include <IntrinsicsSse2.h>
+#elif defined(DEATH_TARGET_NEON)
+#	include <arm_neon.h>
+#endif
 
 namespace Jazz2::Tiles
 {
+	namespace
+	{
+		// Checks the specified region of a bit-packed tile mask, coordinates are relative to the non-flipped tile
+		bool IsMaskRegionEmpty(const std::uint32_t* maskBits, LayerTileFlags flags, std::int32_t left, std::int32_t right, std::int32_t top, std::int32_t bottom)
+		{
+			if ((flags & LayerTileFlags::FlipX) == LayerTileFlags::FlipX) {
+				std::int32_t left2 = left;
+				left = (TileSet::DefaultTileSize - 1 - right);
+				right = (TileSet::DefaultTileSize - 1 - left2);
+			}
+			if ((flags & LayerTileFlags::FlipY) == LayerTileFlags::FlipY) {
+				std::int32_t top2 = top;
+				top = (TileSet::DefaultTileSize - 1 - bottom);
+				bottom = (TileSet::DefaultTileSize - 1 - top2);
+			}
+
+			std::uint32_t columns = (0xFFFFFFFFu >> (TileSet::DefaultTileSize - 1 - (right - left))) << left;
+			std::int32_t y = top;
+
+#if defined(DEATH_TARGET_SSE2)
+			// Test 4 rows at once, masks of all tiles are 16-byte aligned, but the first row of the region doesn't have to be
+			__m128i columns4 = _mm_set1_epi32((std::int32_t)columns);
+			__m128i result = _mm_setzero_si128();
+			for (; y + 3 <= bottom; y += 4) {
+				__m128i rows = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&maskBits[y]));
+				result = _mm_or_si128(result, _mm_and_si128(rows, columns4));
+			}
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(result, _mm_setzero_si128())) != 0xFFFF) {
+				return false;
+			}
+#elif defined(DEATH_TARGET_NEON)
+			uint32x4_t columns4 = vdupq_n_u32(columns);
+			uint32x4_t result = vdupq_n_u32(0);
+			for (; y + 3 <= bottom; y += 4) {
+				result = vorrq_u32(result, vandq_u32(vld1q_u32(&maskBits[y]), columns4));
+			}
+			uint32x2_t result2 = vorr_u32(vget_low_u32(result), vget_high_u32(result));
+			if ((vget_lane_u32(result2, 0) | vget_lane_u32(result2, 1)) != 0) {
+				return false;
+			}
+#endif
+			for (; y <= bottom; y++) {
+				if ((maskBits[y] & columns) != 0) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Visits all cells of a grid intersected by a segment in order (Amanatides & Woo), the callback returns true to stop the traversal
+		template<typename F>
+		bool TraverseGridCells(const Vector2f& from, const Vector2f& dir, std::int32_t cellSize, float tBegin, float tEnd, Vector2i minCell, Vector2i maxCell, F&& callback)
+		{
+			Vector2f start = from + dir * tBegin;
+			std::int32_t cx = std::clamp((std::int32_t)std::floor(start.X / cellSize), minCell.X, maxCell.X);
+			std::int32_t cy = std::clamp((std::int32_t)std::floor(start.Y / cellSize), minCell.Y, maxCell.Y);
+			std::int32_t stepX = (dir.X < 0.0f ? -1 : 1);
+			std::int32_t stepY = (dir.Y < 0.0f ? -1 : 1);
+			float tDeltaX = (dir.X != 0.0f ? cellSize / std::abs(dir.X) : FLT_MAX);
+			float tDeltaY = (dir.Y != 0.0f ? cellSize / std::abs(dir.Y) : FLT_MAX);
+			float tMaxX = (dir.X != 0.0f ? ((cx + (stepX > 0 ? 1 : 0)) * cellSize - from.X) / dir.X : FLT_MAX);
+			float tMaxY = (dir.Y != 0.0f ? ((cy + (stepY > 0 ? 1 : 0)) * cellSize - from.Y) / dir.Y : FLT_MAX);
+
+			float tEnter = tBegin;
+			while (true) {
+				float tExit = std::min(std::min(tMaxX, tMaxY), tEnd);
+				if (callback(cx, cy, tEnter, tExit)) {
+					return true;
+				}
+				if (tExit >= tEnd) {
+					return false;
+				}
+
+				tEnter = tExit;
+				if (tMaxX < tMaxY) {
+					cx += stepX;
+					tMaxX += tDeltaX;
+				} else {
+					cy += stepY;
+					tMaxY += tDeltaY;
+				}
+				if (cx < minCell.X || cx > maxCell.X || cy < minCell.Y || cy > maxCell.Y) {
+					return false;
+				}
+			}
+		}
+	}
+
 	TileMap::TileMap(const StringView tileSetPath, std::uint16_t captionTileId, bool applyPalette)
-		: _owner(nullptr), _sprLayerIndex(-1), _pitType(PitType::FallForever), _renderCommandsCount(0), _collapsingTimer(0.0f),
-			_triggerState(ValueInit, TriggerCount), _texturedBackgroundLayer(-1), _texturedBackgroundPass(this)
+		: _owner(nullptr), _sprLayerIndex(-1), _pitType(PitType::FallForever), _renderCommandsCount(0), _chunkRenderCommandsCount(0), _collapsingTimer(0.0f),
+			_triggerState(ValueInit, TriggerCount), _debris(this), _texturedBackgroundLayer(-1), _texturedBackgroundPass(this)
 	{
 		auto& tileSetPart = _tileSets.emplace_back();
 		tileSetPart.Data = ContentResolver::Get().RequestTileSet(tileSetPath, captionTileId, applyPalette);
@@ -157,7 +256,7 @@ namespace Jazz2::Tiles
 		}
 
 		AdvanceCollapsingTileTimers(timeMult);
-		UpdateDebris(timeMult);
+		_debris.OnUpdate(timeMult);
 	}
 
 	void TileMap::OnEndFrame()
@@ -165,6 +264,8 @@ namespace Jazz2::Tiles
 		// The command cache must be reset every frame,
 		// OnDraw() is called multiple times if multiple viewports are active
 		_renderCommandsCount = 0;
+		_chunkRenderCommandsCount = 0;
+		_debris.OnEndFrame();
 	}
 
 	bool TileMap::OnDraw(RenderQueue& renderQueue)
@@ -179,7 +280,7 @@ namespace Jazz2::Tiles
 			DrawLayer(renderQueue, layer, cullingRect, viewCenter);
 		}
 
-		DrawDebris(renderQueue);
+		_debris.OnDraw(renderQueue);
 
 		TracyPlot("TileMap Render Commands", static_cast<std::int64_t>(_renderCommandsCount));
 
@@ -215,6 +316,10 @@ namespace Jazz2::Tiles
 			return true;
 		}
 
+#if defined(WITH_PROFILER)
+		Profiler::AddCounter(ProfilerCounter::CollisionQueries);
+#endif
+
 		Vector2i layoutSize = _layers[_sprLayerIndex].LayoutSize;
 
 		std::int32_t limitRightPx = layoutSize.X * TileSet::DefaultTileSize;
@@ -245,11 +350,30 @@ namespace Jazz2::Tiles
 		std::int32_t hy2t = hy2 / TileSet::DefaultTileSize;
 
 		auto* sprLayerLayout = _layers[_sprLayerIndex].Layout.get();
+		bool ignoreSolidTiles = ((params.DestructType & TileDestructType::IgnoreSolidTiles) == TileDestructType::IgnoreSolidTiles);
 
 		for (std::int32_t y = hy1t; y <= hy2t; y++) {
 			for (std::int32_t x = hx1t; x <= hx2t; x++) {
+				std::int32_t layoutIndex = y * layoutSize.X + x;
+				const TileCollision& collision = _sprLayerCollisions[layoutIndex];
+				if (collision.Type != TileCollisionType::Complex) {
+					// Static tiles can be resolved only from collision data, they cannot be destroyed
+					if (!ignoreSolidTiles && collision.Type != TileCollisionType::Empty) {
+						if (collision.Type == TileCollisionType::Solid) {
+							return false;
+						}
+						std::int32_t tx = x * TileSet::DefaultTileSize;
+						std::int32_t ty = y * TileSet::DefaultTileSize;
+						if (!IsMaskRegionEmpty(_sprLayerCollisionMasks[layoutIndex], collision.Flags, std::max(hx1 - tx, 0), std::min(hx2 - tx, TileSet::DefaultTileSize - 1),
+							std::max(hy1 - ty, 0), std::min(hy2 - ty, TileSet::DefaultTileSize - 1))) {
+							return false;
+						}
+					}
+					continue;
+				}
+
 			RecheckTile:
-				LayerTile& tile = sprLayerLayout[y * layoutSize.X + x];
+				LayerTile& tile = sprLayerLayout[layoutIndex];
 
 				if (tile.DestructType == TileDestructType::Weapon && (params.DestructType & TileDestructType::Weapon) == TileDestructType::Weapon) {
 					if ((tile.TileParams & (1 << (std::uint16_t)params.UsedWeaponType)) != 0) {
@@ -294,8 +418,8 @@ namespace Jazz2::Tiles
 					}
 				}
 
-				if ((params.DestructType & TileDestructType::IgnoreSolidTiles) != TileDestructType::IgnoreSolidTiles &&
-					tile.HasSuspendType == SuspendType::None && ((tile.Flags & LayerTileFlags::OneWay) != LayerTileFlags::OneWay || params.Downwards)) {
+				if (!ignoreSolidTiles && tile.HasSuspendType == SuspendType::None &&
+					((tile.Flags & LayerTileFlags::OneWay) != LayerTileFlags::OneWay || params.Downwards)) {
 					std::int32_t tileId = ResolveTileID(tile);
 					TileSet* tileSet = ResolveTileSet(tileId);
 					if (tileSet == nullptr || tileSet->IsTileMaskEmpty(tileId)) {
@@ -304,33 +428,9 @@ namespace Jazz2::Tiles
 
 					std::int32_t tx = x * TileSet::DefaultTileSize;
 					std::int32_t ty = y * TileSet::DefaultTileSize;
-
-					std::int32_t left = std::max(hx1 - tx, 0);
-					std::int32_t right = std::min(hx2 - tx, TileSet::DefaultTileSize - 1);
-					std::int32_t top = std::max(hy1 - ty, 0);
-					std::int32_t bottom = std::min(hy2 - ty, TileSet::DefaultTileSize - 1);
-
-					if ((tile.Flags & LayerTileFlags::FlipX) == LayerTileFlags::FlipX) {
-						std::int32_t left2 = left;
-						left = (TileSet::DefaultTileSize - 1 - right);
-						right = (TileSet::DefaultTileSize - 1 - left2);
-					}
-					if ((tile.Flags & LayerTileFlags::FlipY) == LayerTileFlags::FlipY) {
-						std::int32_t top2 = top;
-						top = (TileSet::DefaultTileSize - 1 - bottom);
-						bottom = (TileSet::DefaultTileSize - 1 - top2);
-					}
-
-					top *= TileSet::DefaultTileSize;
-					bottom *= TileSet::DefaultTileSize;
-
-					std::uint8_t* mask = tileSet->GetTileMask(tileId);
-					for (std::int32_t ry = top; ry <= bottom; ry += TileSet::DefaultTileSize) {
-						for (std::int32_t rx = left; rx <= right; rx++) {
-							if (mask[ry | rx]) {
-								return false;
-							}
-						}
+					if (!IsMaskRegionEmpty(tileSet->GetTileMaskBits(tileId), tile.Flags, std::max(hx1 - tx, 0), std::min(hx2 - tx, TileSet::DefaultTileSize - 1),
+						std::max(hy1 - ty, 0), std::min(hy2 - ty, TileSet::DefaultTileSize - 1))) {
+						return false;
 					}
 				}
 			}
@@ -375,10 +475,29 @@ namespace Jazz2::Tiles
 		std::int32_t hy2t = hy2 / TileSet::DefaultTileSize;
 
 		auto* sprLayerLayout = _layers[_sprLayerIndex].Layout.get();
+		bool ignoreSolidTiles = ((params.DestructType & TileDestructType::IgnoreSolidTiles) == TileDestructType::IgnoreSolidTiles);
 
 		for (std::int32_t y = hy1t; y <= hy2t; y++) {
 			for (std::int32_t x = hx1t; x <= hx2t; x++) {
-				LayerTile& tile = sprLayerLayout[y * layoutSize.X + x];
+				std::int32_t layoutIndex = y * layoutSize.X + x;
+				const TileCollision& collision = _sprLayerCollisions[layoutIndex];
+				if (collision.Type != TileCollisionType::Complex) {
+					// Static tiles can be resolved only from collision data, they cannot be destroyed
+					if (!ignoreSolidTiles && collision.Type != TileCollisionType::Empty) {
+						if (collision.Type == TileCollisionType::Solid) {
+							return false;
+						}
+						std::int32_t tx = x * TileSet::DefaultTileSize;
+						std::int32_t ty = y * TileSet::DefaultTileSize;
+						if (!IsMaskRegionEmpty(_sprLayerCollisionMasks[layoutIndex], collision.Flags, std::max(hx1 - tx, 0), std::min(hx2 - tx, TileSet::DefaultTileSize - 1),
+							std::max(hy1 - ty, 0), std::min(hy2 - ty, TileSet::DefaultTileSize - 1))) {
+							return false;
+						}
+					}
+					continue;
+				}
+
+				LayerTile& tile = sprLayerLayout[layoutIndex];
 
 				if ((tile.DestructType & TileDestructType::Weapon) == TileDestructType::Weapon && (params.DestructType & TileDestructType::Weapon) == TileDestructType::Weapon) {
 					if (tile.DestructFrameIndex < (_animatedTiles[tile.DestructAnimation].Tiles.size() - 2) &&
@@ -407,8 +526,8 @@ namespace Jazz2::Tiles
 					}
 				}
 
-				if ((params.DestructType & TileDestructType::IgnoreSolidTiles) != TileDestructType::IgnoreSolidTiles &&
-					tile.HasSuspendType == SuspendType::None && ((tile.Flags & LayerTileFlags::OneWay) != LayerTileFlags::OneWay || params.Downwards)) {
+				if (!ignoreSolidTiles && tile.HasSuspendType == SuspendType::None &&
+					((tile.Flags & LayerTileFlags::OneWay) != LayerTileFlags::OneWay || params.Downwards)) {
 					std::int32_t tileId = ResolveTileID(tile);
 					TileSet* tileSet = ResolveTileSet(tileId);
 					if (tileSet == nullptr || tileSet->IsTileMaskEmpty(tileId)) {
@@ -417,33 +536,9 @@ namespace Jazz2::Tiles
 
 					std::int32_t tx = x * TileSet::DefaultTileSize;
 					std::int32_t ty = y * TileSet::DefaultTileSize;
-
-					std::int32_t left = std::max(hx1 - tx, 0);
-					std::int32_t right = std::min(hx2 - tx, TileSet::DefaultTileSize - 1);
-					std::int32_t top = std::max(hy1 - ty, 0);
-					std::int32_t bottom = std::min(hy2 - ty, TileSet::DefaultTileSize - 1);
-
-					if ((tile.Flags & LayerTileFlags::FlipX) == LayerTileFlags::FlipX) {
-						std::int32_t left2 = left;
-						left = (TileSet::DefaultTileSize - 1 - right);
-						right = (TileSet::DefaultTileSize - 1 - left2);
-					}
-					if ((tile.Flags & LayerTileFlags::FlipY) == LayerTileFlags::FlipY) {
-						std::int32_t top2 = top;
-						top = (TileSet::DefaultTileSize - 1 - bottom);
-						bottom = (TileSet::DefaultTileSize - 1 - top2);
-					}
-
-					top *= TileSet::DefaultTileSize;
-					bottom *= TileSet::DefaultTileSize;
-
-					std::uint8_t* mask = tileSet->GetTileMask(tileId);
-					for (std::int32_t ry = top; ry <= bottom; ry += TileSet::DefaultTileSize) {
-						for (std::int32_t rx = left; rx <= right; rx++) {
-							if (mask[ry | rx]) {
-								return false;
-							}
-						}
+					if (!IsMaskRegionEmpty(tileSet->GetTileMaskBits(tileId), tile.Flags, std::max(hx1 - tx, 0), std::min(hx2 - tx, TileSet::DefaultTileSize - 1),
+						std::max(hy1 - ty, 0), std::min(hy2 - ty, TileSet::DefaultTileSize - 1))) {
+						return false;
 					}
 				}
 			}
@@ -452,6 +547,24 @@ namespace Jazz2::Tiles
 		return false;
 	}
 
+	bool TileMap::CastRay(const Vector2f& from, const Vector2f& to, float& hitFraction)
+	{
+		if (_sprLayerIndex == -1) {
+			return false;
+		}
+
+#if defined(WITH_PROFILER)
+		Profiler::AddCounter(ProfilerCounter::CollisionQueries);
+#endif
+
+		// Only tiles intersected by the segment are visited, pixel masks are checked only for non-empty tiles
+		Vector2f dir = to - from;
+		return TraverseGridCells(from, dir, TileSet::DefaultTileSize, 0.0f, 1.0f, Vector2i(INT32_MIN, INT32_MIN), Vector2i(INT32_MAX, INT32_MAX),
+			[this, &from, &dir, &hitFraction](std::int32_t tx, std::int32_t ty, float tEnter, float tExit) {
+				return !IsTileRayEmpty(tx, ty, from, dir, tEnter, tExit, hitFraction);
+			});
+	}
+
 	bool TileMap::IsTileHurting(float x, float y)
 	{
 		// TODO: Implement all JJ2+ parameters (directional hurt events)
@@ -678,6 +791,12 @@ namespace Jazz2::Tiles
 					break;
 			}
 
+			if (layer.Description.RendererType == LayerRendererType::Default || layer.Description.RendererType == LayerRendererType::Tinted) {
+				// Tile with absolute index N is centered at (x1 - xt + N * TileSize), so whole chunks can be placed at once
+				DrawLayerChunks(renderQueue, layer, cullingRect, x1 - xt, y1 - yt);
+				return;
+			}
+
 			// Calculate the index (on the layer map) of the first tile that needs to be drawn to the position determined earlier
 			std::int32_t tileX, tileY, tileAbsX, tileAbsY;
 
@@ -795,6 +914,259 @@ namespace Jazz2::Tiles
 		}
 	}
 
+	void TileMap::DrawLayerChunks(RenderQueue& renderQueue, TileMapLayer& layer, const Rectf& cullingRect, float originX, float originY)
+	{
+		Vector2i tileCount = layer.LayoutSize;
+		if (tileCount.X <= 0 || tileCount.Y <= 0) {
+			return;
+		}
+
+		if (layer.Chunks.empty()) {
+			layer.ChunkCount = Vector2i((tileCount.X + ChunkSize - 1) / ChunkSize, (tileCount.Y + ChunkSize - 1) / ChunkSize);
+			layer.Chunks.resize(layer.ChunkCount.X * layer.ChunkCount.Y);
+		}
+
+		if (!PreferencesCache::UnalignedViewport) {
+			originX = std::floor(originX);
+			originY = std::floor(originY);
+		}
+
+		// Range of absolute tile indices (including repetitions) that intersect the view
+		constexpr float HalfTileSize = TileSet::DefaultTileSize * 0.5f;
+		std::int32_t firstX = (std::int32_t)std::floor((cullingRect.X - originX + HalfTileSize) / TileSet::DefaultTileSize);
+		std::int32_t lastX = (std::int32_t)std::floor((cullingRect.X + cullingRect.W - originX + HalfTileSize) / TileSet::DefaultTileSize);
+		std::int32_t firstY = (std::int32_t)std::floor((cullingRect.Y - originY + HalfTileSize) / TileSet::DefaultTileSize);
+		std::int32_t lastY = (std::int32_t)std::floor((cullingRect.Y + cullingRect.H - originY + HalfTileSize) / TileSet::DefaultTileSize);
+
+		if (!layer.Description.RepeatX) {
+			firstX = std::max(firstX, 0);
+			lastX = std::min(lastX, tileCount.X - 1);
+		}
+		if (!layer.Description.RepeatY) {
+			firstY = std::max(firstY, 0);
+			lastY = std::min(lastY, tileCount.Y - 1);
+		}
+
+		std::int32_t ay = firstY;
+		while (ay <= lastY) {
+			std::int32_t ty = ay % tileCount.Y;
+			if (ty < 0) {
+				ty += tileCount.Y;
+			}
+			std::int32_t cy = ty / ChunkSize;
+			std::int32_t chunkFirstY = ay - (ty - cy * ChunkSize);
+
+			std::int32_t ax = firstX;
+			while (ax <= lastX) {
+				std::int32_t tx = ax % tileCount.X;
+				if (tx < 0) {
+					tx += tileCount.X;
+				}
+				std::int32_t cx = tx / ChunkSize;
+				std::int32_t chunkFirstX = ax - (tx - cx * ChunkSize);
+
+				DrawLayerChunk(renderQueue, layer, cx, cy,
+					originX + chunkFirstX * TileSet::DefaultTileSize,
+					originY + chunkFirstY * TileSet::DefaultTileSize);
+
+				ax += std::min((cx + 1) * ChunkSize, tileCount.X) - tx;
+			}
+
+			ay += std::min((cy + 1) * ChunkSize, tileCount.Y) - ty;
+		}
+	}
+
+	void TileMap::DrawLayerChunk(RenderQueue& renderQueue, TileMapLayer& layer, std::int32_t cx, std::int32_t cy, float x, float y)
+	{
+		LayerChunk& chunk = layer.Chunks[cx + cy * layer.ChunkCount.X];
+		if (!chunk.IsBuilt || chunk.RendererType != layer.Description.RendererType) {
+			BuildLayerChunk(layer, chunk, cx, cy);
+		}
+		if (chunk.Meshes.empty()) {
+			return;
+		}
+
+		std::uint32_t frameCount = (std::uint32_t)theApplication().GetFrameCount();
+		if (chunk.Meshes[0].LastFrameDrawn != frameCount) {
+			// Dynamic tiles are checked only once per frame, before the chunk is drawn for the first time
+			if (!UpdateLayerChunk(layer, chunk)) {
+				BuildLayerChunk(layer, chunk, cx, cy);
+				if (chunk.Meshes.empty()) {
+					return;
+				}
+			}
+		}
+
+		Matrix4x4f transform = Matrix4x4f::Translation(x, y, 0.0f);
+
+		for (auto& mesh : chunk.Meshes) {
+			RenderCommand* command;
+			if (mesh.LastFrameDrawn != frameCount) {
+				// The baked command uploads modified vertices, so it must be the first one used in the frame
+				command = mesh.Command.get();
+				mesh.LastFrameDrawn = frameCount;
+			} else {
+				// The same chunk is visible multiple times (multiple viewports or repeating layer)
+				command = RentChunkRenderCommand();
+				SetupChunkRenderCommand(command, chunk.RendererType);
+				command->geometry().shareVbo(&mesh.Command->geometry());
+				command->geometry().setNumElementsPerVertex(sizeof(LayerChunkVertex) / sizeof(GLfloat));
+				command->geometry().setDrawParameters(GL_TRIANGLES, 0, (GLsizei)mesh.Vertices.size());
+				command->material().setTexture(*mesh.Source->TextureDiffuse);
+			}
+
+			auto* instanceBlock = command->material().uniformBlock(Material::InstanceBlockName);
+			instanceBlock->uniform(Material::ColorUniformName)->setFloatVector(layer.Description.Color.Data());
+
+			command->setTransformation(transform);
+			command->setLayer(layer.Description.Depth);
+
+			renderQueue.addCommand(command);
+		}
+	}
+
+	void TileMap::BuildLayerChunk(TileMapLayer& layer, LayerChunk& chunk, std::int32_t cx, std::int32_t cy)
+	{
+		ZoneScopedC(0xA09359);
+
+		chunk.Meshes.clear();
+		chunk.DynamicTiles.clear();
+
+		std::int32_t x1 = cx * ChunkSize;
+		std::int32_t y1 = cy * ChunkSize;
+		std::int32_t x2 = std::min(x1 + ChunkSize, layer.LayoutSize.X);
+		std::int32_t y2 = std::min(y1 + ChunkSize, layer.LayoutSize.Y);
+
+		for (std::int32_t y = y1; y < y2; y++) {
+			for (std::int32_t x = x1; x < x2; x++) {
+				std::int32_t layoutIndex = x + y * layer.LayoutSize.X;
+				LayerTile& tile = layer.Layout[layoutIndex];
+
+				bool isDynamic = ((tile.Flags & LayerTileFlags::Animated) == LayerTileFlags::Animated || tile.DestructType != TileDestructType::None);
+				std::int32_t tileId = ResolveTileID(tile);
+				std::int32_t resolvedTileId = tileId;
+				TileSet* tileSet = ResolveTileSet(resolvedTileId);
+				if (!isDynamic && (tileId == 0 || tile.Alpha == 0 || tileSet == nullptr)) {
+					continue;
+				}
+				if (tileSet == nullptr) {
+					// Dynamic tile is empty now, but it still needs some space reserved
+					tileSet = _tileSets[0].Data.get();
+				}
+
+				std::int32_t meshIndex = 0;
+				while (meshIndex < (std::int32_t)chunk.Meshes.size() && chunk.Meshes[meshIndex].Source != tileSet) {
+					meshIndex++;
+				}
+				if (meshIndex == (std::int32_t)chunk.Meshes.size()) {
+					auto& newMesh = chunk.Meshes.emplace_back();
+					newMesh.Source = tileSet;
+					newMesh.LastFrameDrawn = UINT32_MAX;
+				}
+
+				auto& mesh = chunk.Meshes[meshIndex];
+				std::int32_t vertexOffset = (std::int32_t)mesh.Vertices.size();
+				mesh.Vertices.resize_for_overwrite(vertexOffset + 6);
+				WriteChunkTileVertices(&mesh.Vertices[vertexOffset], tile, tileId, tileSet,
+					(float)((x - x1) * TileSet::DefaultTileSize), (float)((y - y1) * TileSet::DefaultTileSize));
+
+				if (isDynamic) {
+					auto& dynamicTile = chunk.DynamicTiles.emplace_back();
+					dynamicTile.LayoutIndex = layoutIndex;
+					dynamicTile.LastTileId = tileId;
+					dynamicTile.MeshIndex = meshIndex;
+					dynamicTile.VertexOffset = vertexOffset;
+				}
+			}
+		}
+
+		for (auto& mesh : chunk.Meshes) {
+			mesh.Command = std::make_unique<RenderCommand>();
+			SetupChunkRenderCommand(mesh.Command.get(), layer.Description.RendererType);
+
+			// Custom VBO must have exactly the same size as vertices in host memory
+			Geometry& geometry = mesh.Command->geometry();
+			geometry.createCustomVbo((std::uint32_t)(mesh.Vertices.size() * sizeof(LayerChunkVertex) / sizeof(GLfloat)), GL_STATIC_DRAW);
+			geometry.setNumElementsPerVertex(sizeof(LayerChunkVertex) / sizeof(GLfloat));
+			geometry.setDrawParameters(GL_TRIANGLES, 0, (GLsizei)mesh.Vertices.size());
+			geometry.setHostVertexPointer(reinterpret_cast<const float*>(mesh.Vertices.data()));
+			mesh.Command->material().setTexture(*mesh.Source->TextureDiffuse);
+		}
+
+		chunk.RendererType = layer.Description.RendererType;
+		chunk.IsBuilt = true;
+	}
+
+	bool TileMap::UpdateLayerChunk(TileMapLayer& layer, LayerChunk& chunk)
+	{
+		for (auto& dynamicTile : chunk.DynamicTiles) {
+			LayerTile& tile = layer.Layout[dynamicTile.LayoutIndex];
+			std::int32_t tileId = ResolveTileID(tile);
+			if (tileId == dynamicTile.LastTileId) {
+				continue;
+			}
+
+			auto& mesh = chunk.Meshes[dynamicTile.MeshIndex];
+			std::int32_t resolvedTileId = tileId;
+			TileSet* tileSet = ResolveTileSet(resolvedTileId);
+			if (tileSet != nullptr && tileSet != mesh.Source) {
+				// The tile switched to another tile set, so the whole chunk has to be rebuilt
+				return false;
+			}
+
+			std::int32_t x = (dynamicTile.LayoutIndex % layer.LayoutSize.X) % ChunkSize;
+			std::int32_t y = (dynamicTile.LayoutIndex / layer.LayoutSize.X) % ChunkSize;
+			WriteChunkTileVertices(&mesh.Vertices[dynamicTile.VertexOffset], tile, tileId, mesh.Source,
+				(float)(x * TileSet::DefaultTileSize), (float)(y * TileSet::DefaultTileSize));
+			// Setting the pointer again marks vertices as dirty, so they are uploaded before drawing
+			mesh.Command->geometry().setHostVertexPointer(reinterpret_cast<const float*>(mesh.Vertices.data()));
+			dynamicTile.LastTileId = tileId;
+		}
+
+		return true;
+	}
+
+	void TileMap::WriteChunkTileVertices(LayerChunkVertex* dest, const LayerTile& tile, std::int32_t tileId, TileSet* tileSet, float x, float y)
+	{
+		constexpr float HalfTileSize = TileSet::DefaultTileSize * 0.5f;
+
+		std::int32_t resolvedTileId = tileId;
+		if (tileId == 0 || tile.Alpha == 0 || ResolveTileSet(resolvedTileId) != tileSet) {
+			// Empty tile is collapsed to a degenerate quad
+			for (std::int32_t i = 0; i < 6; i++) {
+				dest[i] = { x, y, 0.0f, 0.0f, { 0, 0, 0, 0 } };
+			}
+			return;
+		}
+
+		Vector2i texSize = tileSet->TextureDiffuse->size();
+		float texScaleX = TileSet::DefaultTileSize / float(texSize.X);
+		float texBiasX = ((resolvedTileId % tileSet->TilesPerRow) * (TileSet::DefaultTileSize + 2.0f) + 1.0f) / float(texSize.X);
+		float texScaleY = TileSet::DefaultTileSize / float(texSize.Y);
+		float texBiasY = ((resolvedTileId / tileSet->TilesPerRow) * (TileSet::DefaultTileSize + 2.0f) + 1.0f) / float(texSize.Y);
+
+		if ((tile.Flags & LayerTileFlags::FlipX) == LayerTileFlags::FlipX) {
+			texBiasX += texScaleX;
+			texScaleX *= -1;
+		}
+		if ((tile.Flags & LayerTileFlags::FlipY) == LayerTileFlags::FlipY) {
+			texBiasY += texScaleY;
+			texScaleY *= -1;
+		}
+
+		float left = x - HalfTileSize, right = x + HalfTileSize;
+		float top = y - HalfTileSize, bottom = y + HalfTileSize;
+		float u1 = texBiasX, u2 = texBiasX + texScaleX;
+		float v1 = texBiasY, v2 = texBiasY + texScaleY;
+
+		dest[0] = { left, top, u1, v1, { 255, 255, 255, tile.Alpha } };
+		dest[1] = { left, bottom, u1, v2, { 255, 255, 255, tile.Alpha } };
+		dest[2] = { right, top, u2, v1, { 255, 255, 255, tile.Alpha } };
+		dest[3] = dest[2];
+		dest[4] = dest[1];
+		dest[5] = { right, bottom, u2, v2, { 255, 255, 255, tile.Alpha } };
+	}
+
 	float TileMap::TranslateCoordinate(float coordinate, float speed, float offset, std::int32_t viewSize, bool isY)
 	{
 		std::int32_t alignment = ((isY ? (viewSize - 200) : (viewSize - 320)) / 2) + HardcodedOffset;
@@ -833,6 +1205,49 @@ namespace Jazz2::Tiles
 		return command;
 	}
 
+	RenderCommand* TileMap::RentChunkRenderCommand()
+	{
+		if (_chunkRenderCommandsCount < _chunkRenderCommands.size()) {
+			return _chunkRenderCommands[_chunkRenderCommandsCount++].get();
+		}
+
+		_chunkRenderCommandsCount++;
+		return _chunkRenderCommands.emplace_back(std::make_unique<RenderCommand>()).get();
+	}
+
+	void TileMap::SetupChunkRenderCommand(RenderCommand* command, LayerRendererType type)
+	{
+		Shader* shader = ContentResolver::Get().GetShader(type == LayerRendererType::Tinted
+			? PrecompiledShader::TileMapChunkTinted
+			: PrecompiledShader::TileMapChunk);
+
+		command->setType(RenderCommand::Type::TileMap);
+		command->material().setBlendingEnabled(true);
+		command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		if (command->material().setShader(shader)) {
+			command->material().reserveUniformsDataMemory();
+
+			GLUniformCache* textureUniform = command->material().uniform(Material::TextureUniformName);
+			if (textureUniform && textureUniform->intValue(0) != 0) {
+				textureUniform->setIntValue(0); // GL_TEXTURE0
+			}
+
+			GLShaderProgram* program = shader->getHandle();
+			if (auto* positionAttribute = program->attribute(Material::PositionAttributeName)) {
+				positionAttribute->setVboParameters(sizeof(LayerChunkVertex), reinterpret_cast<void*>(offsetof(LayerChunkVertex, X)));
+			}
+			if (auto* texCoordsAttribute = program->attribute(Material::TexCoordsAttributeName)) {
+				texCoordsAttribute->setVboParameters(sizeof(LayerChunkVertex), reinterpret_cast<void*>(offsetof(LayerChunkVertex, U)));
+			}
+			if (auto* colorAttribute = program->attribute(Material::ColorAttributeName)) {
+				colorAttribute->setVboParameters(sizeof(LayerChunkVertex), reinterpret_cast<void*>(offsetof(LayerChunkVertex, Color)));
+				colorAttribute->setType(GL_UNSIGNED_BYTE);
+				colorAttribute->setNormalized(true);
+			}
+		}
+	}
+
 	void TileMap::AddTileSet(const StringView tileSetPath, std::uint16_t offset, std::uint16_t count, const std::uint8_t* paletteRemapping)
 	{
 		auto& tileSetPart = _tileSets.emplace_back();
@@ -935,6 +1350,15 @@ namespace Jazz2::Tiles
 				tile.Alpha = 255;
 			}
 		}
+
+		if (layerType == LayerType::Sprite) {
+			// Tile sets and animated tiles are already loaded at this point
+			_sprLayerCollisions = std::make_unique<TileCollision[]>(width * height);
+			_sprLayerCollisionMasks = std::make_unique<const std::uint32_t*[]>(width * height);
+			for (std::int32_t i = 0; i < (width * height); i++) {
+				UpdateTileCollision(i);
+			}
+		}
 	}
 
 	void TileMap::ReadAnimatedTiles(Stream& s)
@@ -1002,6 +1426,8 @@ namespace Jazz2::Tiles
 				SetTileDestructibleEventParams(tile, TileDestructType::Collapse, tileParams[0]);
 				break;
 		}
+
+		UpdateTileCollision(x + y * _layers[_sprLayerIndex].LayoutSize.X);
 	}
 
 	void TileMap::SetTileDestructibleEventParams(LayerTile& tile, TileDestructType type, std::uint16_t tileParams)
@@ -1018,6 +1444,135 @@ namespace Jazz2::Tiles
 		tile.DestructFrameIndex = 0;
 	}
 
+	void TileMap::UpdateTileCollision(std::int32_t layoutIndex)
+	{
+		LayerTile& tile = _layers[_sprLayerIndex].Layout[layoutIndex];
+		TileCollision& collision = _sprLayerCollisions[layoutIndex];
+		collision.Flags = tile.Flags;
+		_sprLayerCollisionMasks[layoutIndex] = nullptr;
+
+		// Tiles that can change during the level or that depend on collision parameters always take the slow path
+		if ((tile.Flags & (LayerTileFlags::Animated | LayerTileFlags::OneWay)) != LayerTileFlags::None ||
+			tile.HasSuspendType != SuspendType::None || tile.DestructType != TileDestructType::None) {
+			collision.Type = TileCollisionType::Complex;
+			return;
+		}
+
+		std::int32_t tileId = tile.TileID;
+		TileSet* tileSet = ResolveTileSet(tileId);
+		if (tileSet == nullptr || tileSet->IsTileMaskEmpty(tileId)) {
+			collision.Type = TileCollisionType::Empty;
+		} else if (tileSet->IsTileMaskFilled(tileId)) {
+			collision.Type = TileCollisionType::Solid;
+		} else {
+			collision.Type = TileCollisionType::Masked;
+			_sprLayerCollisionMasks[layoutIndex] = tileSet->GetTileMaskBits(tileId);
+		}
+	}
+
+	bool TileMap::IsTileCollisionEmpty(const AABBf& aabb) const
+	{
+		// Conservative check that uses only collision data of static tiles, it returns false if the full check is needed
+		if (_sprLayerIndex == -1) {
+			return true;
+		}
+
+		Vector2i layoutSize = _layers[_sprLayerIndex].LayoutSize;
+		std::int32_t hx2 = (std::int32_t)std::ceil(aabb.R);
+		std::int32_t hy2 = (std::int32_t)std::ceil(aabb.B);
+		if (aabb.L < 0 || aabb.T < 0 || hx2 >= layoutSize.X * TileSet::DefaultTileSize || hy2 >= layoutSize.Y * TileSet::DefaultTileSize) {
+			return false;
+		}
+
+		std::int32_t hx1t = (std::int32_t)aabb.L / TileSet::DefaultTileSize;
+		std::int32_t hx2t = hx2 / TileSet::DefaultTileSize;
+		std::int32_t hy1t = (std::int32_t)aabb.T / TileSet::DefaultTileSize;
+		std::int32_t hy2t = hy2 / TileSet::DefaultTileSize;
+
+		for (std::int32_t y = hy1t; y <= hy2t; y++) {
+			for (std::int32_t x = hx1t; x <= hx2t; x++) {
+				if (_sprLayerCollisions[y * layoutSize.X + x].Type != TileCollisionType::Empty) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool TileMap::IsTileRayEmpty(std::int32_t tx, std::int32_t ty, const Vector2f& from, const Vector2f& dir, float tEnter, float tExit, float& hitFraction)
+	{
+		// Consider out-of-level coordinates as solid walls, the same as in IsTileEmpty()
+		Vector2i layoutSize = _layers[_sprLayerIndex].LayoutSize;
+		if (tx < 0 || tx >= layoutSize.X || (ty >= layoutSize.Y && _pitType == PitType::StandOnPlatform)) {
+			hitFraction = tEnter;
+			return false;
+		}
+		if (ty >= layoutSize.Y) {
+			return true;
+		}
+		if (ty < 0) {
+			// Area above the level is extension of the first row, pixel masks cannot be used there
+			if (_sprLayerCollisions[tx].Type != TileCollisionType::Empty) {
+				hitFraction = tEnter;
+				return false;
+			}
+			return true;
+		}
+
+		std::int32_t layoutIndex = ty * layoutSize.X + tx;
+		const TileCollision& collision = _sprLayerCollisions[layoutIndex];
+		const std::uint32_t* maskBits;
+		LayerTileFlags flags;
+		switch (collision.Type) {
+			case TileCollisionType::Empty:
+				return true;
+			case TileCollisionType::Solid:
+				hitFraction = tEnter;
+				return false;
+			case TileCollisionType::Masked:
+				maskBits = _sprLayerCollisionMasks[layoutIndex];
+				flags = collision.Flags;
+				break;
+			default: {
+				LayerTile& tile = _layers[_sprLayerIndex].Layout[layoutIndex];
+				if (tile.HasSuspendType != SuspendType::None || (tile.Flags & LayerTileFlags::OneWay) == LayerTileFlags::OneWay) {
+					return true;
+				}
+				std::int32_t tileId = ResolveTileID(tile);
+				TileSet* tileSet = ResolveTileSet(tileId);
+				if (tileSet == nullptr || tileSet->IsTileMaskEmpty(tileId)) {
+					return true;
+				}
+				maskBits = tileSet->GetTileMaskBits(tileId);
+				flags = tile.Flags;
+				break;
+			}
+		}
+
+		std::int32_t px = tx * TileSet::DefaultTileSize;
+		std::int32_t py = ty * TileSet::DefaultTileSize;
+		bool flipX = ((flags & LayerTileFlags::FlipX) == LayerTileFlags::FlipX);
+		bool flipY = ((flags & LayerTileFlags::FlipY) == LayerTileFlags::FlipY);
+
+		return !TraverseGridCells(from, dir, 1, tEnter, tExit, Vector2i(px, py), Vector2i(px + TileSet::DefaultTileSize - 1, py + TileSet::DefaultTileSize - 1),
+			[maskBits, px, py, flipX, flipY, &hitFraction](std::int32_t x, std::int32_t y, float tPixelEnter, float) {
+				x -= px;
+				y -= py;
+				if (flipX) {
+					x = TileSet::DefaultTileSize - 1 - x;
+				}
+				if (flipY) {
+					y = TileSet::DefaultTileSize - 1 - y;
+				}
+				if ((maskBits[y] & (1u << x)) != 0) {
+					hitFraction = tPixelEnter;
+					return true;
+				}
+				return false;
+			});
+	}
+
 	void TileMap::CreateDebris(const DestructibleDebris& debris)
 	{
 		auto& spriteLayer = _layers[_sprLayerIndex];
@@ -1044,7 +1599,7 @@ namespace Jazz2::Tiles
 			}
 		}
 
-		_debrisList.push_back(debris);
+		_debris.Add(debris);
 	}
 
 	void TileMap::CreateTileDebris(std::int32_t tileId, std::int32_t x, std::int32_t y)
@@ -1081,7 +1636,7 @@ namespace Jazz2::Tiles
 		}*/
 
 		for (std::int32_t i = 0; i < 4; i++) {
-			DestructibleDebris& debris = _debrisList.emplace_back();
+			DestructibleDebris debris;
 			debris.Pos = Vector2f(x * TileSet::DefaultTileSize + (i % 2) * QuarterSize, y * TileSet::DefaultTileSize + (i / 2) * QuarterSize);
 			debris.Depth = z;
 			debris.Size = Vector2f(QuarterSize, QuarterSize);
@@ -1104,7 +1659,9 @@ namespace Jazz2::Tiles
 			debris.TexBiasY = texBiasY + ((i / 2) * QuarterSize / float(texSize.Y));
 
 			debris.DiffuseTexture = tileSet->TextureDiffuse.get();
+			debris.PaletteOffset = 0;
 			debris.Flags = DebrisFlags::None;
+			_debris.Add(debris);
 		}
 	}
 
@@ -1120,7 +1677,7 @@ namespace Jazz2::Tiles
 			for (std::int32_t fx = 0; fx < res->Base->FrameDimensions.X; fx += DebrisSize + 1) {
 				float currentSize = DebrisSize * Random().FastFloat(0.2f, 1.1f);
 
-				DestructibleDebris& debris = _debrisList.emplace_back();
+				DestructibleDebris debris;
 				debris.Pos = Vector2f(x + (isFacingLeft ? res->Base->FrameDimensions.X - fx : fx), y + fy);
 				debris.Depth = (std::uint16_t)pos.Z;
 				debris.Size = Vector2f(currentSize, currentSize);
@@ -1139,12 +1696,14 @@ namespace Jazz2::Tiles
 				debris.Time = 320.0f;
 
 				debris.TexScaleX = (currentSize / float(texSize.X));
-				debris.TexBiasX = (((float)(currentFrame % res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.X) + ((float)fx / float(texSize.X)));
+				debris.TexBiasX = (float(res->Base->TextureOffset.X + (currentFrame % res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.X + fx) / float(texSize.X));
 				debris.TexScaleY = (currentSize / float(texSize.Y));
-				debris.TexBiasY = (((float)(currentFrame / res->Base->FrameConfiguration.X) / res->Base->FrameConfiguration.Y) + ((float)fy / float(texSize.Y)));
+				debris.TexBiasY = (float(res->Base->TextureOffset.Y + (currentFrame / res->Base->FrameConfiguration.X) * res->Base->FrameDimensions.Y + fy) / float(texSize.Y));
 
 				debris.DiffuseTexture = res->Base->TextureDiffuse.get();
-				debris.Flags = DebrisFlags::Bounce;
+				debris.PaletteOffset = res->Base->PaletteOffset;
+				debris.Flags = (res->Base->IsIndexed() ? DebrisFlags::Bounce | DebrisFlags::Indexed : DebrisFlags::Bounce);
+				_debris.Add(debris);
 			}
 		}
 	}
@@ -1158,7 +1717,7 @@ namespace Jazz2::Tiles
 		for (std::int32_t i = 0; i < count; i++) {
 			float speedX = Random().FastFloat(-1.0f, 1.0f) * Random().FastFloat(0.2f, 0.8f) * count;
 
-			DestructibleDebris& debris = _debrisList.emplace_back();
+			DestructibleDebris debris;
 			debris.Pos = Vector2f(x, y);
 			debris.Depth = (std::uint16_t)pos.Z;
 			debris.Size = Vector2f((float)res->Base->FrameDimensions.X, (float)res->Base->FrameDimensions.Y);
@@ -1179,133 +1738,14 @@ namespace Jazz2::Tiles
 			std::int32_t col = curAnimFrame % res->Base->FrameConfiguration.X;
 			std::int32_t row = curAnimFrame / res->Base->FrameConfiguration.X;
 			debris.TexScaleX = (float(res->Base->FrameDimensions.X) / float(texSize.X));
-			debris.TexBiasX = (float(res->Base->FrameDimensions.X * col) / float(texSize.X));
+			debris.TexBiasX = (float(res->Base->TextureOffset.X + res->Base->FrameDimensions.X * col) / float(texSize.X));
 			debris.TexScaleY = (float(res->Base->FrameDimensions.Y) / float(texSize.Y));
-			debris.TexBiasY = (float(res->Base->FrameDimensions.Y * row) / float(texSize.Y));
+			debris.TexBiasY = (float(res->Base->TextureOffset.Y + res->Base->FrameDimensions.Y * row) / float(texSize.Y));
 
 			debris.DiffuseTexture = res->Base->TextureDiffuse.get();
-			debris.Flags = DebrisFlags::Bounce;
-		}
-	}
-
-	void TileMap::UpdateDebris(float timeMult)
-	{
-		ZoneScopedC(0xA09359);
-
-		std::int32_t size = (std::int32_t)_debrisList.size();
-		for (std::int32_t i = 0; i < size; i++) {
-			DestructibleDebris& debris = _debrisList[i];
-
-			if (debris.Scale <= 0.0f || debris.Alpha <= 0.0f) {
-				std::swap(debris, _debrisList[size - 1]);
-				_debrisList.pop_back();
-				i--;
-				size--;
-				continue;
-			}
-
-			debris.Time -= timeMult;
-			if (debris.Time <= 0.0f) {
-				debris.Alpha = -std::min(0.02f, debris.Alpha);
-			}
-
-			if ((debris.Flags & (DebrisFlags::Disappear | DebrisFlags::Bounce)) != DebrisFlags::None) {
-				// Debris should collide with tilemap
-				float nx = debris.Pos.X + debris.Speed.X * timeMult;
-				float ny = debris.Pos.Y + debris.Speed.Y * timeMult;
-				AABB aabb = AABBf(nx - 1, ny - 1, nx + 1, ny + 1);
-				TileCollisionParams params = { TileDestructType::None, true };
-				if (IsTileEmpty(aabb, params)) {
-					// Nothing...
-				} else if ((debris.Flags & DebrisFlags::Disappear) == DebrisFlags::Disappear) {
-					debris.ScaleSpeed = -0.02f;
-					debris.AlphaSpeed = -0.006f;
-					debris.Speed = Vector2f::Zero;
-					debris.Acceleration = Vector2f::Zero;
-				} else {
-					// Place us to the ground only if no horizontal movement was
-					// involved (this prevents speeds resetting if the actor
-					// collides with a wall from the side while in the air)
-					aabb.T = debris.Pos.Y - 1;
-					aabb.B = debris.Pos.Y + 1;
-
-					if (IsTileEmpty(aabb, params)) {
-						if (debris.Speed.Y > 0.0f) {
-							debris.Speed.Y = -(0.8f/*elasticity*/ * debris.Speed.Y);
-							//OnHitFloorHook();
-						} else {
-							debris.Speed.Y = 0;
-							//OnHitCeilingHook();
-						}
-					}
-
-					// If the actor didn't move all the way horizontally,
-					// it hit a wall (or was already touching it)
-					aabb = AABBf(debris.Pos.X - 1, ny - 1, debris.Pos.X + 1, ny + 1);
-					if (IsTileEmpty(aabb, params)) {
-						debris.Speed.X = -(0.8f/*elasticity*/ * debris.Speed.X);
-						debris.AngleSpeed = -(0.8f/*elasticity*/ * debris.AngleSpeed);
-						//OnHitWallHook();
-					}
-				}
-			}
-
-			debris.Pos.X += debris.Speed.X * timeMult + 0.5f * debris.Acceleration.X * timeMult * timeMult;
-			debris.Pos.Y += debris.Speed.Y * timeMult + 0.5f * debris.Acceleration.Y * timeMult * timeMult;
-
-			if (debris.Acceleration.X != 0.0f) {
-				debris.Speed.X = std::min(debris.Speed.X + debris.Acceleration.X * timeMult, 10.0f);
-			}
-			if (debris.Acceleration.Y != 0.0f) {
-				debris.Speed.Y = std::min(debris.Speed.Y + debris.Acceleration.Y * timeMult, 10.0f);
-			}
-
-			debris.Scale += debris.ScaleSpeed * timeMult;
-			debris.Angle += debris.AngleSpeed * timeMult;
-			debris.Alpha += debris.AlphaSpeed * timeMult;
-		}
-	}
-
-	void TileMap::DrawDebris(RenderQueue& renderQueue)
-	{
-		ZoneScopedNC("Debris", 0xA09359);
-
-		constexpr float MaxDebrisSize = 128.0f;
-
-		Rectf viewportRect = RenderResources::currentViewport()->cullingRect();
-		viewportRect.X -= MaxDebrisSize;
-		viewportRect.Y -= MaxDebrisSize;
-		viewportRect.W += MaxDebrisSize * 2.0f;
-		viewportRect.H += MaxDebrisSize * 2.0f;
-
-		for (const auto& debris : _debrisList) {
-			if (!viewportRect.Contains(debris.Pos)) {
-				continue;
-			}
-
-			auto command = RentRenderCommand(LayerRendererType::Default);
-			command->setType(RenderCommand::Type::Particle);
-
-			if ((debris.Flags & DebrisFlags::AdditiveBlending) == DebrisFlags::AdditiveBlending) {
-				command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE);
-			} else {
-				command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			}
-
-			auto instanceBlock = command->material().uniformBlock(Material::InstanceBlockName);
-			instanceBlock->uniform(Material::TexRectUniformName)->setFloatValue(debris.TexScaleX, debris.TexBiasX, debris.TexScaleY, debris.TexBiasY);
-			instanceBlock->uniform(Material::SpriteSizeUniformName)->setFloatValue(debris.Size.X, debris.Size.Y);
-			instanceBlock->uniform(Material::ColorUniformName)->setFloatVector(Colorf(1.0f, 1.0f, 1.0f, debris.Alpha).Data());
-
-			Matrix4x4f worldMatrix = Matrix4x4f::Translation(debris.Pos.X, debris.Pos.Y, 0.0f);
-			worldMatrix.RotateZ(debris.Angle);
-			worldMatrix.Scale(debris.Scale, debris.Scale, 1.0f);
-			worldMatrix.Translate(debris.Size.X  * -0.5f, debris.Size.Y * -0.5f, 0.0f);
-			command->setTransformation(worldMatrix);
-			command->setLayer(debris.Depth);
-			command->material().setTexture(*debris.DiffuseTexture);
-
-			renderQueue.addCommand(command);
+			debris.PaletteOffset = res->Base->PaletteOffset;
+			debris.Flags = (res->Base->IsIndexed() ? DebrisFlags::Bounce | DebrisFlags::Indexed : DebrisFlags::Bounce);
+			_debris.Add(debris);
 		}
 	}
 
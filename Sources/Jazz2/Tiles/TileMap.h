@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "DebrisSystem.h"
 #include "ITileMapOwner.h"
 #include "../ILevelHandler.h"
 #include "../PitType.h"
@@ -78,11 +79,45 @@ namespace Jazz2::Tiles
 											// Collapsible: Delay ("wait" parameter); Trigger: Trigger ID
 	};
 
+	struct LayerChunkVertex {
+		float X;
+		float Y;
+		float U;
+		float V;
+		std::uint8_t Color[4];
+	};
+
+	struct LayerChunkMesh {
+		TileSet* Source;
+		SmallVector<LayerChunkVertex, 0> Vertices;
+		std::unique_ptr<RenderCommand> Command;
+		std::uint32_t LastFrameDrawn;
+	};
+
+	struct LayerChunkDynamicTile {
+		std::int32_t LayoutIndex;
+		std::int32_t LastTileId;
+		std::int32_t MeshIndex;
+		std::int32_t VertexOffset;
+	};
+
+	// Pre-baked part of a layer, static tiles are uploaded to the GPU only once
+	struct LayerChunk {
+		SmallVector<LayerChunkMesh, 1> Meshes;
+		// Animated and destructible tiles have reserved vertices, so they can be patched in place
+		SmallVector<LayerChunkDynamicTile, 0> DynamicTiles;
+		LayerRendererType RendererType;
+		bool IsBuilt;
+	};
+
 	struct TileMapLayer {
 		std::unique_ptr<LayerTile[]> Layout;
 		Vector2i LayoutSize;
 		LayerDescription Description;
 		bool Visible;
+
+		SmallVector<LayerChunk, 0> Chunks;
+		Vector2i ChunkCount;
 	};
 
 	struct AnimatedTileFrame {
@@ -103,48 +138,16 @@ namespace Jazz2::Tiles
 
 	class TileMap : public SceneNode
 	{
+		friend class DebrisSystem;
+
 	public:
 		static constexpr std::int32_t TriggerCount = 32;
 		static constexpr std::int32_t AnimatedTileMask = 0x80000000;
 		static constexpr std::int32_t HardcodedOffset = 70;
+		static constexpr std::int32_t ChunkSize = 32;
 
-		enum class DebrisFlags {
-			None = 0x00,
-			Disappear = 0x01,
-			Bounce = 0x02,
-			AdditiveBlending = 0x04
-		};
-
-		DEFINE_PRIVATE_ENUM_OPERATORS(DebrisFlags);
-
-		struct DestructibleDebris {
-			Vector2f Pos;
-			std::uint16_t Depth;
-
-			Vector2f Size;
-			Vector2f Speed;
-			Vector2f Acceleration;
-
-			float Scale;
-			float ScaleSpeed;
-
-			float Angle;
-			float AngleSpeed;
-
-			float Alpha;
-			float AlphaSpeed;
-
-			float Time;
-
-			float TexScaleX;
-			float TexBiasX;
-			float TexScaleY;
-			float TexBiasY;
-
-			Texture* DiffuseTexture;
-
-			DebrisFlags Flags;
-		};
+		using DebrisFlags = Tiles::DebrisFlags;
+		using DestructibleDebris = Tiles::DestructibleDebris;
 
 		TileMap(const StringView tileSetPath, std::uint16_t captionTileId, bool applyPalette);
 		~TileMap();
@@ -167,6 +170,8 @@ namespace Jazz2::Tiles
 		bool IsTileHurting(float x, float y);
 		SuspendType GetTileSuspendState(float x, float y);
 		bool AdvanceDestructibleTileAnimation(std::int32_t tx, std::int32_t ty, std::int32_t amount);
+		// Returns true if the segment hits a solid pixel of the sprite layer, one-way and suspend tiles are ignored
+		bool CastRay(const Vector2f& from, const Vector2f& to, float& hitFraction);
 
 		void AddTileSet(const StringView tileSetPath, std::uint16_t offset, std::uint16_t count, const std::uint8_t* paletteRemapping = nullptr);
 		void ReadLayerConfiguration(Stream& s);
@@ -204,6 +209,19 @@ namespace Jazz2::Tiles
 			std::int32_t Count;
 		};
 
+		enum class TileCollisionType : std::uint8_t {
+			Empty,
+			Solid,
+			Masked,
+			// Destructible, animated, one-way or suspend tiles, they need to be resolved from the layout
+			Complex
+		};
+
+		struct TileCollision {
+			TileCollisionType Type;
+			LayerTileFlags Flags;
+		};
+
 		class TexturedBackgroundPass : public SceneNode
 		{
 			friend class TileMap;
@@ -233,28 +251,40 @@ namespace Jazz2::Tiles
 
 		SmallVector<TileSetPart, 2> _tileSets;
 		SmallVector<TileMapLayer, 0> _layers;
+		// Collision data of the sprite layer stored separately, so static tiles can be checked without touching the layout
+		std::unique_ptr<TileCollision[]> _sprLayerCollisions;
+		std::unique_ptr<const std::uint32_t*[]> _sprLayerCollisionMasks;
 		SmallVector<AnimatedTile, 0> _animatedTiles;
 		SmallVector<Vector2i, 0> _activeCollapsingTiles;
 		float _collapsingTimer;
 		BitArray _triggerState;
 
-		SmallVector<DestructibleDebris, 0> _debrisList;
+		DebrisSystem _debris;
 		SmallVector<std::unique_ptr<RenderCommand>, 0> _renderCommands;
 		std::int32_t _renderCommandsCount;
+		SmallVector<std::unique_ptr<RenderCommand>, 0> _chunkRenderCommands;
+		std::int32_t _chunkRenderCommandsCount;
 
 		std::int32_t _texturedBackgroundLayer;
 		TexturedBackgroundPass _texturedBackgroundPass;
 
 		void DrawLayer(RenderQueue& renderQueue, TileMapLayer& layer, const Rectf& cullingRect, const Vector2f& viewCenter);
+		void DrawLayerChunks(RenderQueue& renderQueue, TileMapLayer& layer, const Rectf& cullingRect, float originX, float originY);
+		void DrawLayerChunk(RenderQueue& renderQueue, TileMapLayer& layer, std::int32_t cx, std::int32_t cy, float x, float y);
+		void BuildLayerChunk(TileMapLayer& layer, LayerChunk& chunk, std::int32_t cx, std::int32_t cy);
+		bool UpdateLayerChunk(TileMapLayer& layer, LayerChunk& chunk);
+		void WriteChunkTileVertices(LayerChunkVertex* dest, const LayerTile& tile, std::int32_t tileId, TileSet* tileSet, float x, float y);
 		static float TranslateCoordinate(float coordinate, float speed, float offset, std::int32_t viewSize, bool isY);
 		RenderCommand* RentRenderCommand(LayerRendererType type);
+		RenderCommand* RentChunkRenderCommand();
+		static void SetupChunkRenderCommand(RenderCommand* command, LayerRendererType type);
 
 		bool AdvanceDestructibleTileAnimation(LayerTile& tile, std::int32_t tx, std::int32_t ty, std::int32_t& amount, const StringView soundName);
 		void AdvanceCollapsingTileTimers(float timeMult);
 		void SetTileDestructibleEventParams(LayerTile& tile, TileDestructType type, std::uint16_t tileParams);
-
-		void UpdateDebris(float timeMult);
-		void DrawDebris(RenderQueue& renderQueue);
+		void UpdateTileCollision(std::int32_t layoutIndex);
+		bool IsTileCollisionEmpty(const AABBf& aabb) const;
+		bool IsTileRayEmpty(std::int32_t tx, std::int32_t ty, const Vector2f& from, const Vector2f& dir, float tEnter, float tExit, float& hitFraction);
 
 		void RenderTexturedBackground(RenderQueue& renderQueue, const Rectf& cullingRect, const Vector2f& viewCenter, TileMapLayer& layer, float x, float y);
 
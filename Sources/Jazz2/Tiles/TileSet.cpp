@@ -19,6 +19,11 @@ namespace Jazz2::Tiles
 		_isMaskFilled.resize(ValueInit, TileCount);
 		_isTileFilled.resize(ValueInit, TileCount);
 
+		static_assert(DefaultTileSize == 32, "Bit-packed mask requires 32 pixels per row");
+
+		// Each tile occupies 128 bytes, so rows of all tiles stay 16-byte aligned for SIMD loads
+		_maskBits = std::make_unique<std::uint32_t[]>(TileCount * DefaultTileSize);
+
 		std::uint32_t maskMaxTiles = maskSize / (DefaultTileSize * DefaultTileSize);
 
 		for (std::uint32_t i = 0; i < tileCount; i++) {
@@ -27,10 +32,17 @@ namespace Jazz2::Tiles
 
 			if (i < maskMaxTiles) {
 				auto maskOffset = &_mask[i * DefaultTileSize * DefaultTileSize];
-				for (std::int32_t x = 0; x < DefaultTileSize * DefaultTileSize; x++) {
-					bool masked = (maskOffset[x] > 0);
-					maskEmpty &= !masked;
-					maskFilled &= masked;
+				auto maskBitsOffset = &_maskBits[i * DefaultTileSize];
+				for (std::int32_t y = 0; y < DefaultTileSize; y++) {
+					std::uint32_t row = 0;
+					for (std::int32_t x = 0; x < DefaultTileSize; x++) {
+						if (maskOffset[y * DefaultTileSize + x] > 0) {
+							row |= (1u << x);
+						}
+					}
+					maskBitsOffset[y] = row;
+					maskEmpty &= (row == 0);
+					maskFilled &= (row == 0xFFFFFFFFu);
 				}
 			}
 
@@ -25,6 +25,16 @@ namespace Jazz2::Tiles
 			return &_mask[tileId * DefaultTileSize * DefaultTileSize];
 		}
 
+		// Returns bit-packed mask of the tile, one 32-bit row per line, bit N corresponds to pixel column N
+		const std::uint32_t* GetTileMaskBits(std::int32_t tileId) const
+		{
+			if (tileId >= TileCount) {
+				return nullptr;
+			}
+
+			return &_maskBits[tileId * DefaultTileSize];
+		}
+
 		bool IsTileMaskEmpty(std::int32_t tileId) const
 		{
 			if (tileId >= TileCount) {
@@ -59,6 +69,7 @@ namespace Jazz2::Tiles
 
 	private:
 		std::unique_ptr<uint8_t[]> _mask;
+		std::unique_ptr<std::uint32_t[]> _maskBits;
 		std::unique_ptr<Color[]> _captionTile;
 		BitArray _isMaskEmpty;
 		BitArray _isMaskFilled;
@@ -1,6 +1,9 @@
 ﻿#include "Canvas.h"
+#include "../ContentResolver.h"
 
+#include "../../nCine/Graphics/Camera.h"
 #include "../../nCine/Graphics/RenderQueue.h"
+#include "../../nCine/Graphics/RenderResources.h"
 #include "../../nCine/Base/Random.h"
 
 namespace Jazz2::UI
@@ -24,12 +27,15 @@ namespace Jazz2::UI
 
 		_renderCommandsCount = 0;
 		_currentRenderQueue = &renderQueue;
+		_glyphRuns.clear();
 
 		return false;
 	}
 
 	void Canvas::DrawRenderCommand(RenderCommand* command)
 	{
+		// Glyphs drawn after this command must not be appended to earlier runs, otherwise they could end up underneath
+		_glyphRuns.clear();
 		_currentRenderQueue->addCommand(command);
 	}
 
@@ -48,6 +54,39 @@ namespace Jazz2::UI
 			}
 		}
 
+		SubmitTexture(command, texture, pos, z, size, texCoords, color, additiveBlending, angle);
+	}
+
+	void Canvas::DrawIndexedTexture(const Texture& texture, std::uint16_t paletteOffset, const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Vector4f& texCoords, const Colorf& color, bool additiveBlending, float angle)
+	{
+		Texture* paletteTexture = ContentResolver::Get().GetPaletteTexture();
+		if (paletteTexture == nullptr) {
+			return;
+		}
+
+		auto command = RentRenderCommand();
+		if (command->material().setShader(ContentResolver::Get().GetShader(PrecompiledShader::Palette))) {
+			command->material().reserveUniformsDataMemory();
+			command->geometry().setDrawParameters(GL_TRIANGLE_STRIP, 0, 4);
+
+			GLUniformCache* textureUniform = command->material().uniform(Material::TextureUniformName);
+			if (textureUniform && textureUniform->intValue(0) != 0) {
+				textureUniform->setIntValue(0); // GL_TEXTURE0
+			}
+			GLUniformCache* paletteUniform = command->material().uniform(Material::PaletteUniformName);
+			if (paletteUniform && paletteUniform->intValue(0) != 1) {
+				paletteUniform->setIntValue(1); // GL_TEXTURE1
+			}
+		}
+
+		command->material().setTexture(1, *paletteTexture);
+
+		// Palette offset is passed in red channel of the color, so red and blue channels of the tint are dropped
+		SubmitTexture(command, texture, pos, z, size, texCoords, Colorf((float)paletteOffset, color.G, 1.0f, color.A), additiveBlending, angle);
+	}
+
+	void Canvas::SubmitTexture(RenderCommand* command, const Texture& texture, const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Vector4f& texCoords, const Colorf& color, bool additiveBlending, float angle)
+	{
 		if (additiveBlending) {
 			command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE);
 		} else {
@@ -69,7 +108,7 @@ namespace Jazz2::UI
 		command->setLayer(z);
 		command->material().setTexture(texture);
 
-		_currentRenderQueue->addCommand(command);
+		DrawRenderCommand(command);
 	}
 
 	void Canvas::DrawSolid(const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Colorf& color, bool additiveBlending)
@@ -95,7 +134,35 @@ namespace Jazz2::UI
 		command->setTransformation(Matrix4x4f::Translation(pos.X, pos.Y, 0.0f));
 		command->setLayer(z);
 
-		_currentRenderQueue->addCommand(command);
+		DrawRenderCommand(command);
+	}
+
+	void Canvas::DrawGlyph(const Texture& texture, Shader* batchedShader, const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Vector4f& texCoords, const Colorf& color, bool additiveBlending)
+	{
+		GlyphRun* run = RentGlyphRun(texture, batchedShader, z, additiveBlending);
+
+		BatchedSpriteInstance instance;
+		instance.ModelMatrix = Matrix4x4f::Translation(pos.X, pos.Y, run->Depth);
+		instance.Color[0] = color.R;
+		instance.Color[1] = color.G;
+		instance.Color[2] = color.B;
+		instance.Color[3] = color.A;
+		instance.TexRect[0] = texCoords.X;
+		instance.TexRect[1] = texCoords.Y;
+		instance.TexRect[2] = texCoords.Z;
+		instance.TexRect[3] = texCoords.W;
+		instance.SpriteSize[0] = size.X;
+		instance.SpriteSize[1] = size.Y;
+		instance.Padding[0] = 0.0f;
+		instance.Padding[1] = 0.0f;
+
+		run->InstancesBlock->copyData(run->Count * sizeof(BatchedSpriteInstance), reinterpret_cast<const GLubyte*>(&instance), sizeof(BatchedSpriteInstance));
+		run->Count++;
+
+		// The command is already in the queue, but it's committed after all nodes are visited, so it can still grow
+		run->InstancesBlock->setUsedSize(run->Count * sizeof(BatchedSpriteInstance));
+		run->Command->setBatchSize(run->Count);
+		run->Command->geometry().setDrawParameters(GL_TRIANGLES, 0, 6 * run->Count);
 	}
 
 	Vector2f Canvas::ApplyAlignment(Alignment align, const Vector2f& vec, const Vector2f& size)
@@ -120,6 +187,9 @@ namespace Jazz2::UI
 		if (_renderCommandsCount < _renderCommands.size()) {
 			RenderCommand* command = _renderCommands[_renderCommandsCount].get();
 			command->setType(RenderCommand::Type::Sprite);
+			command->setBatchSize(0);
+			// Palette texture could be bound by previous owner
+			command->material().setTexture(1, nullptr);
 			_renderCommandsCount++;
 			return command;
 		} else {
@@ -129,4 +199,54 @@ namespace Jazz2::UI
 			return command.get();
 		}
 	}
+
+	Canvas::GlyphRun* Canvas::RentGlyphRun(const Texture& texture, Shader* batchedShader, std::uint16_t z, bool additiveBlending)
+	{
+		// Only a few runs are open at once (fonts × layers × shaders), so linear search is enough
+		for (std::size_t i = _glyphRuns.size(); i > 0; i--) {
+			GlyphRun& run = _glyphRuns[i - 1];
+			if (run.DiffuseTexture == &texture && run.BatchedShader == batchedShader && run.Layer == z &&
+				run.AdditiveBlending == additiveBlending && run.Count < run.Capacity) {
+				return &run;
+			}
+		}
+
+		auto command = RentRenderCommand();
+		command->setType(RenderCommand::Type::Text);
+		bool shaderChanged = (batchedShader != nullptr
+			? command->material().setShader(batchedShader)
+			: command->material().setShaderProgramType(Material::ShaderProgramType::BatchedSprites));
+		if (shaderChanged) {
+			command->material().reserveUniformsDataMemory();
+
+			GLUniformCache* textureUniform = command->material().uniform(Material::TextureUniformName);
+			if (textureUniform && textureUniform->intValue(0) != 0) {
+				textureUniform->setIntValue(0); // GL_TEXTURE0
+			}
+		}
+
+		if (additiveBlending) {
+			command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE);
+		} else {
+			command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
+
+		command->setLayer(z);
+		command->material().setTexture(texture);
+
+		GlyphRun& run = _glyphRuns.emplace_back();
+		run.Command = command;
+		run.InstancesBlock = command->material().uniformBlock(Material::InstancesBlockName);
+		run.DiffuseTexture = &texture;
+		run.BatchedShader = batchedShader;
+		run.Count = 0;
+		run.Capacity = (std::int32_t)(run.InstancesBlock->size() / sizeof(BatchedSpriteInstance));
+		const Camera::ProjectionValues& cameraValues = RenderResources::currentCamera()->projectionValues();
+		run.Depth = RenderCommand::calculateDepth(z, cameraValues.nearClip, cameraValues.farClip);
+		run.Layer = z;
+		run.AdditiveBlending = additiveBlending;
+
+		_currentRenderQueue->addCommand(command);
+		return &run;
+	}
 }
\ No newline at end of file
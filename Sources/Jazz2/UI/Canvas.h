@@ -4,6 +4,10 @@
 #include "../../nCine/Graphics/RenderCommand.h"
 #include "../../nCine/Graphics/SceneNode.h"
 
+#include <Containers/SmallVector.h>
+
+using namespace Death::Containers;
+
 using namespace nCine;
 
 namespace Jazz2::UI
@@ -22,15 +26,37 @@ namespace Jazz2::UI
 		bool OnDraw(RenderQueue& renderQueue) override;
 
 		void DrawTexture(const Texture& texture, const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Vector4f& texCoords, const Colorf& color, bool additiveBlending = false, float angle = 0.0f);
+		// Draws texture with palette indices, red channel of the color is replaced by palette offset, so tinting is not supported,
+		// only green channel is applied as brightness to all channels and alpha is applied as usual, blue channel is ignored
+		void DrawIndexedTexture(const Texture& texture, std::uint16_t paletteOffset, const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Vector4f& texCoords, const Colorf& color, bool additiveBlending = false, float angle = 0.0f);
 		void DrawSolid(const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Colorf& color, bool additiveBlending = false);
+		void DrawGlyph(const Texture& texture, Shader* batchedShader, const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Vector4f& texCoords, const Colorf& color, bool additiveBlending = false);
 		static Vector2f ApplyAlignment(Alignment align, const Vector2f& vec, const Vector2f& size);
 
 		RenderCommand* RentRenderCommand();
 		void DrawRenderCommand(RenderCommand* command);
 
 	private:
+		// Consecutive glyphs sharing the same texture, shader, layer and blending that are drawn using one instanced draw
+		struct GlyphRun
+		{
+			RenderCommand* Command;
+			GLUniformBlockCache* InstancesBlock;
+			const Texture* DiffuseTexture;
+			Shader* BatchedShader;
+			std::int32_t Count;
+			std::int32_t Capacity;
+			float Depth;
+			std::uint16_t Layer;
+			bool AdditiveBlending;
+		};
+
 		SmallVector<std::unique_ptr<RenderCommand>, 0> _renderCommands;
 		std::int32_t _renderCommandsCount;
 		RenderQueue* _currentRenderQueue;
+		SmallVector<GlyphRun, 0> _glyphRuns;
+
+		void SubmitTexture(RenderCommand* command, const Texture& texture, const Vector2f& pos, std::uint16_t z, const Vector2f& size, const Vector4f& texCoords, const Colorf& color, bool additiveBlending, float angle);
+		GlyphRun* RentGlyphRun(const Texture& texture, Shader* batchedShader, std::uint16_t z, bool additiveBlending);
 	};
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "../ContentResolver.h"
 
+#include "../../nCine/Application.h"
 #include "../../nCine/Graphics/ITextureLoader.h"
 #include "../../nCine/Graphics/RenderQueue.h"
 #include "../../nCine/Base/Random.h"
@@ -9,6 +10,8 @@
 #include <Containers/StringConcatenable.h>
 #include <Utf8.h>
 
+#include <cstring>
+
 using namespace Death;
 
 namespace Jazz2::UI
@@ -121,17 +124,7 @@ namespace Jazz2::UI
 
 	Vector2f Font::MeasureChar(char32_t c) const
 	{
-		Rectf uvRect;
-		if (c < 128) {
-			uvRect = _asciiChars[c];
-		} else {
-			auto it = _unicodeChars.find(c);
-			if (it != _unicodeChars.end()) {
-				uvRect = it->second;
-			} else {
-				uvRect = _asciiChars[0];
-			}
-		}
+		Rectf uvRect = GetCharRect(c);
 		return Vector2f(uvRect.W, uvRect.H);
 	}
 
@@ -234,25 +227,146 @@ namespace Jazz2::UI
 
 	void Font::DrawString(Canvas* canvas, StringView text, std::int32_t& charOffset, float x, float y, std::uint16_t z, Alignment align, Colorf color, float scale, float angleOffset, float varianceX, float varianceY, float speed, float charSpacing, float lineSpacing)
 	{
-		std::size_t textLength = text.size();
-		if (textLength == 0 || _charSize.Y <= 0) {
+		if (text.empty() || _charSize.Y <= 0) {
 			return;
 		}
 
+		// Layout is cached across frames, only color and animation are resolved here
+		const TextLayout& layout = GetLayout(text, align, scale, charSpacing, lineSpacing);
+
 		// TODO: Revise this
 		float phase = canvas->AnimTime * speed * 16.0f;
 
-		// Maximum number of lines - center and right alignment starts to glitch if text has more lines, but it should be enough in most cases
-		constexpr std::int32_t MaxLines = 16;
+		Shader* colorizeShader = ContentResolver::Get().GetShader(PrecompiledShader::BatchedColorized);
+		Shader* initialShader;
+		bool useRandomColor, isShadow;
+		float alpha;
+		if (color.R == DefaultColor.R && color.G == DefaultColor.G && color.B == DefaultColor.B) {
+			initialShader = nullptr;
+			useRandomColor = false;
+			isShadow = false;
+			alpha = color.A;
+			color = Colorf(1.0f, 1.0f, 1.0f, alpha);
+		} else {
+			initialShader = colorizeShader;
+			useRandomColor = (color.R == RandomColor.R && color.G == RandomColor.G && color.B == RandomColor.B);
+			isShadow = (color.R == 0.0f && color.G == 0.0f && color.B == 0.0f);
+			alpha = std::min(color.A * 2.0f, 1.0f);
+		}
+
+		for (const LayoutGlyph& glyph : layout.Glyphs) {
+			Shader* shader;
+			Colorf glyphColor;
+			if (useRandomColor) {
+				const Colorf& newColor = RandomColors[charOffset % static_cast<std::int32_t>(arraySize(RandomColors))];
+				glyphColor = Colorf(newColor.R, newColor.G, newColor.B, color.A);
+				shader = initialShader;
+			} else if (isShadow || glyph.ColorMode == GlyphColor::Default) {
+				glyphColor = color;
+				shader = initialShader;
+			} else if (glyph.ColorMode == GlyphColor::Custom) {
+				glyphColor = Color(glyph.CustomColor);
+				glyphColor.SetAlpha(0.5f * alpha);
+				shader = colorizeShader;
+			} else {
+				glyphColor = Colorf(1.0f, 1.0f, 1.0f, alpha);
+				shader = nullptr;
+			}
+
+			Vector2f pos = Vector2f(x + glyph.Position.X, y + glyph.Position.Y);
+
+			if (angleOffset > 0.0f) {
+				float currentPhase = (phase + charOffset) * angleOffset * fPi;
+				if (speed > 0.0f && (charOffset % 2) == 1) {
+					currentPhase = -currentPhase;
+				}
+
+				pos.X += cosf(currentPhase) * varianceX * scale;
+				pos.Y += sinf(currentPhase) * varianceY * scale;
+			}
+
+			pos.X = std::round(pos.X);
+			pos.Y = std::round(pos.Y);
+
+			canvas->DrawGlyph(*_texture.get(), shader, pos, z - (charOffset & 1), glyph.Size, glyph.TexCoords, glyphColor);
+
+			charOffset++;
+		}
+		charOffset++;
+	}
+
+	Rectf Font::GetCharRect(char32_t c) const
+	{
+		if (c < 128) {
+			return _asciiChars[c];
+		}
+
+		auto it = _unicodeChars.find(c);
+		return (it != _unicodeChars.end() ? it->second : _asciiChars[0]);
+	}
+
+	const Font::TextLayout& Font::GetLayout(StringView text, Alignment align, float scale, float charSpacing, float lineSpacing)
+	{
+		// 64-bit FNV-1a of the text and all parameters that affect the layout
+		std::uint64_t hash = 0xcbf29ce484222325ull;
+		for (char c : text) {
+			hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x100000001b3ull;
+		}
+		std::uint32_t params[4];
+		std::memcpy(&params[0], &scale, sizeof(float));
+		std::memcpy(&params[1], &charSpacing, sizeof(float));
+		std::memcpy(&params[2], &lineSpacing, sizeof(float));
+		params[3] = static_cast<std::uint32_t>(align);
+		for (std::uint32_t param : params) {
+			hash = (hash ^ param) * 0x100000001b3ull;
+		}
+
+		unsigned long int currentFrame = theApplication().GetFrameCount();
+
+		auto it = _cachedLayouts.find(hash);
+		if (it != _cachedLayouts.end()) {
+			TextLayout& layout = it->second;
+			if (layout.Text == text && layout.Scale == scale && layout.CharSpacing == charSpacing &&
+				layout.LineSpacing == lineSpacing && layout.Align == align) {
+				layout.LastUsedFrame = currentFrame;
+				return layout;
+			}
+			// Hash collision, the layout is rebuilt in place
+		} else {
+			if (_cachedLayouts.size() >= MaxCachedLayouts) {
+				TrimCachedLayouts(currentFrame);
+			}
+			it = _cachedLayouts.emplace(hash, TextLayout{}).first;
+		}
+
+		TextLayout& layout = it->second;
+		layout.Text = text;
+		layout.Scale = scale;
+		layout.CharSpacing = charSpacing;
+		layout.LineSpacing = lineSpacing;
+		layout.Align = align;
+		layout.LastUsedFrame = currentFrame;
+		BuildLayout(layout);
+		return layout;
+	}
+
+	void Font::BuildLayout(TextLayout& layout)
+	{
+		StringView text = layout.Text;
+		std::size_t textLength = text.size();
+		Alignment align = layout.Align;
+		float scale = layout.Scale;
+		float charSpacingPre = layout.CharSpacing;
+		float charSpacing = charSpacingPre;
+		float lineSpacing = layout.LineSpacing;
+
+		layout.Glyphs.clear();
 
 		// Preprocessing
 		float totalWidth = 0.0f, lastWidth = 0.0f, totalHeight = 0.0f;
-		float lineWidths[MaxLines];
-		float charSpacingPre = charSpacing;
-		float scalePre = scale;
+		SmallVector<float, 16> lineWidths;
 
 		std::int32_t idx = 0;
-		std::int32_t line = 0;
 		do {
 			std::pair<char32_t, std::size_t> cursor = Utf8::NextChar(text, idx);
 
@@ -261,8 +375,7 @@ namespace Jazz2::UI
 				if (totalWidth < lastWidth) {
 					totalWidth = lastWidth;
 				}
-				lineWidths[line & (MaxLines - 1)] = lastWidth;
-				line++;
+				lineWidths.push_back(lastWidth);
 				lastWidth = 0.0f;
 				totalHeight += (_charSize.Y * scale * lineSpacing);
 			} else if (cursor.first == '\f') {
@@ -313,20 +426,9 @@ namespace Jazz2::UI
 					}
 				}
 			} else {
-				Rectf uvRect;
-				if (cursor.first < 128) {
-					uvRect = _asciiChars[cursor.first];
-				} else {
-					auto it = _unicodeChars.find(cursor.first);
-					if (it != _unicodeChars.end()) {
-						uvRect = it->second;
-					} else {
-						uvRect = _asciiChars[0];
-					}
-				}
-
+				Rectf uvRect = GetCharRect(cursor.first);
 				if (uvRect.W > 0 && uvRect.H > 0) {
-					lastWidth += (uvRect.W + _baseSpacing) * charSpacing * scalePre;
+					lastWidth += (uvRect.W + _baseSpacing) * charSpacing * scale;
 				}
 			}
 
@@ -336,13 +438,13 @@ namespace Jazz2::UI
 		if (totalWidth < lastWidth) {
 			totalWidth = lastWidth;
 		}
-		lineWidths[line & (MaxLines - 1)] = lastWidth;
+		lineWidths.push_back(lastWidth);
 		totalHeight += (_charSize.Y * scale * lineSpacing);
 
 		charSpacing = charSpacingPre;
 
-		// Rendering
-		Vector2f originPos = Vector2f(x, y);
+		// Positions are relative to the origin, so the layout can be drawn anywhere
+		Vector2f originPos = Vector2f::Zero;
 		switch (align & Alignment::HorizontalMask) {
 			case Alignment::Center: originPos.X -= totalWidth * 0.5f; break;
 			case Alignment::Right: originPos.X -= totalWidth; break;
@@ -360,24 +462,11 @@ namespace Jazz2::UI
 		}
 
 		Vector2i texSize = _texture->size();
-		Shader* colorizeShader;
-		bool useRandomColor, isShadow;
-		float alpha;
-		if (color.R == DefaultColor.R && color.G == DefaultColor.G && color.B == DefaultColor.B) {
-			colorizeShader = nullptr;
-			useRandomColor = false;
-			isShadow = false;
-			alpha = color.A;
-			color = Colorf(1.0f, 1.0f, 1.0f, alpha);
-		} else {
-			colorizeShader = ContentResolver::Get().GetShader(PrecompiledShader::Colorized);
-			useRandomColor = (color.R == RandomColor.R && color.G == RandomColor.G && color.B == RandomColor.B);
-			isShadow = (color.R == 0.0f && color.G == 0.0f && color.B == 0.0f);
-			alpha = std::min(color.A * 2.0f, 1.0f);
-		}
+		GlyphColor colorMode = GlyphColor::Default;
+		std::uint32_t customColor = 0;
 
 		idx = 0;
-		line = 0;
+		std::int32_t line = 0;
 		do {
 			std::pair<char32_t, std::size_t> cursor = Utf8::NextChar(text, idx);
 
@@ -386,8 +475,8 @@ namespace Jazz2::UI
 				line++;
 				originPos.X = lineStart;
 				switch (align & Alignment::HorizontalMask) {
-					case Alignment::Center: originPos.X += (totalWidth - lineWidths[line & (MaxLines - 1)]) * 0.5f; break;
-					case Alignment::Right: originPos.X += (totalWidth - lineWidths[line & (MaxLines - 1)]); break;
+					case Alignment::Center: originPos.X += (totalWidth - lineWidths[line]) * 0.5f; break;
+					case Alignment::Right: originPos.X += (totalWidth - lineWidths[line]); break;
 				}
 				originPos.Y += (_charSize.Y * scale * lineSpacing);
 			} else if (cursor.first == '\f') {
@@ -400,7 +489,7 @@ namespace Jazz2::UI
 						idx = cursor.second;
 						cursor = Utf8::NextChar(text, idx);
 						if (cursor.first == ':') {
-							// Set custom color
+							// Set custom color, it's ignored later for random colors and shadows
 							idx = cursor.second;
 							cursor = Utf8::NextChar(text, idx);
 							if (cursor.first == '#') {
@@ -418,16 +507,13 @@ namespace Jazz2::UI
 									idx = cursor.second;
 								} while (idx < textLength);
 
-								if (paramLength > 0 && !useRandomColor && !isShadow) {
+								if (paramLength > 0) {
 									param[paramLength] = '\0';
 									char* end = &param[paramLength];
 									unsigned long paramValue = strtoul(param, &end, 16);
 									if (param != end) {
-										color = Color(paramValue);
-										color.SetAlpha(0.5f * alpha);
-										if (colorizeShader == nullptr) {
-											colorizeShader = ContentResolver::Get().GetShader(PrecompiledShader::Colorized);
-										}
+										colorMode = GlyphColor::Custom;
+										customColor = static_cast<std::uint32_t>(paramValue);
 									}
 								}
 							}
@@ -464,10 +550,7 @@ namespace Jazz2::UI
 						cursor = Utf8::NextChar(text, idx);
 						if (cursor.first == 'c') {
 							// Reset color
-							if (!useRandomColor && !isShadow) {
-								color = Colorf(1.0f, 1.0f, 1.0f, alpha);
-								colorizeShader = nullptr;
-							}
+							colorMode = GlyphColor::Reset;
 						} else if (cursor.first == 'w') {
 							// Reset char spacing
 							charSpacing = charSpacingPre;
@@ -479,88 +562,42 @@ namespace Jazz2::UI
 					cursor = Utf8::NextChar(text, cursor.second);
 				}
 			} else {
-				Rectf uvRect;
-				if (cursor.first < 128) {
-					uvRect = _asciiChars[cursor.first];
-				} else {
-					auto it = _unicodeChars.find(cursor.first);
-					if (it != _unicodeChars.end()) {
-						uvRect = it->second;
-					} else {
-						uvRect = _asciiChars[0];
-					}
-				}
-
+				Rectf uvRect = GetCharRect(cursor.first);
 				if (uvRect.W > 0 && uvRect.H > 0) {
-					if (useRandomColor) {
-						const Colorf& newColor = RandomColors[charOffset % static_cast<std::int32_t>(arraySize(RandomColors))];
-						color = Colorf(newColor.R, newColor.G, newColor.B, color.A);
-					}
-
-					Vector2f pos = Vector2f(originPos);
-
-					if (angleOffset > 0.0f) {
-						float currentPhase = (phase + charOffset) * angleOffset * fPi;
-						if (speed > 0.0f && (charOffset % 2) == 1) {
-							currentPhase = -currentPhase;
-						}
-
-						pos.X += cosf(currentPhase) * varianceX * scale;
-						pos.Y += sinf(currentPhase) * varianceY * scale;
-					}
-
-					pos.X = std::round(pos.X);
-					pos.Y = std::round(pos.Y);
-
 					std::int32_t charWidth = _charSize.X;
 					if (charWidth > uvRect.W) {
 						charWidth--;
 					}
 
-					Vector4f texCoords = Vector4f(
+					LayoutGlyph& glyph = layout.Glyphs.emplace_back();
+					glyph.Position = originPos;
+					glyph.Size = Vector2f(charWidth * scale, uvRect.H * scale);
+					glyph.TexCoords = Vector4f(
 						charWidth / float(texSize.X),
 						uvRect.X,
 						uvRect.H / float(texSize.Y),
 						uvRect.Y
 					);
-
-					auto command = canvas->RentRenderCommand();
-					command->setType(RenderCommand::Type::Text);
-					bool shaderChanged = (colorizeShader
-						? command->material().setShader(colorizeShader)
-						: command->material().setShaderProgramType(Material::ShaderProgramType::Sprite));
-					if (shaderChanged) {
-						command->material().reserveUniformsDataMemory();
-						command->geometry().setDrawParameters(GL_TRIANGLE_STRIP, 0, 4);
-						// Required to reset render command properly
-						//command->setTransformation(command->transformation());
-
-						GLUniformCache* textureUniform = command->material().uniform(Material::TextureUniformName);
-						if (textureUniform && textureUniform->intValue(0) != 0) {
-							textureUniform->setIntValue(0); // GL_TEXTURE0
-						}
-					}
-
-					command->material().setBlendingFactors(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-					auto instanceBlock = command->material().uniformBlock(Material::InstanceBlockName);
-					instanceBlock->uniform(Material::TexRectUniformName)->setFloatVector(texCoords.Data());
-					instanceBlock->uniform(Material::SpriteSizeUniformName)->setFloatValue(charWidth * scale, uvRect.H * scale);
-					instanceBlock->uniform(Material::ColorUniformName)->setFloatVector(color.Data());
-
-					command->setTransformation(Matrix4x4f::Translation(pos.X, pos.Y, 0.0f));
-					command->setLayer(z - (charOffset & 1));
-					command->material().setTexture(*_texture.get());
-
-					canvas->_currentRenderQueue->addCommand(command);
+					glyph.CustomColor = customColor;
+					glyph.ColorMode = colorMode;
 
 					originPos.X += ((uvRect.W + _baseSpacing) * scale * charSpacing);
-					charOffset++;
 				}
 			}
 
 			idx = cursor.second;
 		} while (idx < textLength);
-		charOffset++;
+	}
+
+	void Font::TrimCachedLayouts(unsigned long int currentFrame)
+	{
+		// Layouts that were used in this or the previous frame are probably static text, so they are kept
+		for (auto it = _cachedLayouts.begin(); it != _cachedLayouts.end(); ) {
+			if (it->second.LastUsedFrame + 1 < currentFrame) {
+				it = _cachedLayouts.erase(it);
+			} else {
+				++it;
+			}
+		}
 	}
 }
\ No newline at end of file
@@ -6,6 +6,9 @@
 #include "../../nCine/Base/HashMap.h"
 #include "../../nCine/Graphics/Texture.h"
 
+#include <Containers/SmallVector.h>
+#include <Containers/String.h>
+
 using namespace nCine;
 
 namespace Jazz2::UI
@@ -40,10 +43,47 @@ namespace Jazz2::UI
 			Colorf(0.56f, 0.50f, 0.42f, 0.5f),
 		};
 
+		// Max. number of cached text layouts, unused layouts are evicted when the limit is reached
+		static constexpr std::int32_t MaxCachedLayouts = 256;
+
+		enum class GlyphColor : std::uint8_t {
+			Default,
+			Custom,
+			Reset
+		};
+
+		struct LayoutGlyph
+		{
+			// Position relative to the origin of the text, including alignment
+			Vector2f Position;
+			Vector2f Size;
+			Vector4f TexCoords;
+			std::uint32_t CustomColor;
+			GlyphColor ColorMode;
+		};
+
+		// Layout of a string that doesn't depend on position, color or animation, so it can be reused in next frames
+		struct TextLayout
+		{
+			String Text;
+			float Scale;
+			float CharSpacing;
+			float LineSpacing;
+			Alignment Align;
+			unsigned long int LastUsedFrame;
+			SmallVector<LayoutGlyph, 0> Glyphs;
+		};
+
 		Rectf _asciiChars[128];
 		HashMap<std::uint32_t, Rectf> _unicodeChars;
 		Vector2i _charSize;
 		std::int32_t _baseSpacing;
 		std::unique_ptr<Texture> _texture;
+		HashMap<std::uint64_t, TextLayout> _cachedLayouts;
+
+		Rectf GetCharRect(char32_t c) const;
+		const TextLayout& GetLayout(StringView text, Alignment align, float scale, float charSpacing, float lineSpacing);
+		void BuildLayout(TextLayout& layout);
+		void TrimCachedLayouts(unsigned long int currentFrame);
 	};
 }
\ No newline at end of file
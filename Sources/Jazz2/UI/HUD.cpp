@@ -11,6 +11,7 @@
 #include "../../nCine/Graphics/RenderQueue.h"
 #include "../../nCine/Base/Random.h"
 #include "../../nCine/Application.h"
+#include "../../nCine/Base/Profiler.h"
 
 // Position of key in 22x6 grid
 static const std::uint8_t KeyLayout[] = {
@@ -259,6 +260,9 @@ namespace Jazz2::UI
 			i32tos((std::int32_t)std::round(theApplication().GetFrameTimer().GetAverageFps()), stringBuffer);
 			_smallFont->DrawString(this, stringBuffer, charOffset, view.W - 4.0f, view.Y + 1.0f, FontLayer,
 				Alignment::TopRight, Font::DefaultColor, 0.8f, 0.0f, 0.0f, 0.0f, 0.0f, 0.96f);
+#if defined(WITH_PROFILER)
+			DrawProfilerStats(view, charOffset);
+#endif
 		}
 
 		if (_transitionState == TransitionState::FadeIn || _transitionState == TransitionState::FadeOut) {
@@ -859,6 +863,48 @@ namespace Jazz2::UI
 		}
 	}
 
+#if defined(WITH_PROFILER)
+	void HUD::DrawProfilerStats(const Rectf& view, std::int32_t& charOffset)
+	{
+		constexpr std::int32_t AverageFrameCount = 60;
+		constexpr std::int32_t MaxZoneCount = 5;
+
+		if (!Profiler::IsEnabled()) {
+			return;
+		}
+
+		std::int32_t frameCount = std::min(Profiler::GetFrameCount(), AverageFrameCount);
+		if (frameCount <= 0) {
+			return;
+		}
+
+		float avgDuration = 0.0f;
+		float maxDuration = 0.0f;
+		for (std::int32_t i = 0; i < frameCount; i++) {
+			float duration = Profiler::GetFrameStats(i).Duration;
+			avgDuration += duration;
+			maxDuration = std::max(maxDuration, duration);
+		}
+		avgDuration /= frameCount;
+
+		char text[512];
+		std::int32_t length = formatString(text, sizeof(text), "%.2f ms (max. %.2f ms)", avgDuration, maxDuration);
+
+		const ProfilerFrameStats& lastFrame = Profiler::GetFrameStats(0);
+		for (std::int32_t i = 0; i < (std::int32_t)ProfilerCounter::Count && length < (std::int32_t)sizeof(text); i++) {
+			length += formatString(text + length, sizeof(text) - length, "\n%s: %i", Profiler::GetCounterName((ProfilerCounter)i), lastFrame.Counters[i]);
+		}
+
+		auto topZones = Profiler::GetTopZones();
+		for (std::size_t i = 0; i < topZones.size() && i < MaxZoneCount && length < (std::int32_t)sizeof(text); i++) {
+			length += formatString(text + length, sizeof(text) - length, "\n%s: %.2f ms", topZones[i].Name, topZones[i].Duration);
+		}
+
+		_smallFont->DrawString(this, text, charOffset, view.W - 4.0f, view.Y + 12.0f, FontLayer,
+			Alignment::TopRight, Font::DefaultColor, 0.7f, 0.0f, 0.0f, 0.0f, 0.0f, 0.96f);
+	}
+#endif
+
 	void HUD::DrawElement(AnimState state, std::int32_t frame, float x, float y, std::uint16_t z, Alignment align, const Colorf& color, float scaleX, float scaleY, bool additiveBlending, float angle)
 	{
 		auto* res = _metadata->FindAnimation(state);
@@ -879,12 +925,17 @@ namespace Jazz2::UI
 		std::int32_t row = frame / base->FrameConfiguration.X;
 		Vector4f texCoords = Vector4f(
 			float(base->FrameDimensions.X) / float(texSize.X),
-			float(base->FrameDimensions.X * col) / float(texSize.X),
+			float(base->TextureOffset.X + base->FrameDimensions.X * col) / float(texSize.X),
 			float(base->FrameDimensions.Y) / float(texSize.Y),
-			float(base->FrameDimensions.Y * row) / float(texSize.Y)
+			float(base->TextureOffset.Y + base->FrameDimensions.Y * row) / float(texSize.Y)
 		);
 
-		DrawTexture(*base->TextureDiffuse.get(), adjustedPos, z, size, texCoords, color, additiveBlending, angle);
+		if (base->IsIndexed()) {
+			// Indexed textures support only brightness (green channel) and alpha of the color
+			DrawIndexedTexture(*base->TextureDiffuse.get(), base->PaletteOffset, adjustedPos, z, size, texCoords, color, additiveBlending, angle);
+		} else {
+			DrawTexture(*base->TextureDiffuse.get(), adjustedPos, z, size, texCoords, color, additiveBlending, angle);
+		}
 	}
 
 	void HUD::DrawElementClipped(AnimState state, std::int32_t frame, float x, float y, std::uint16_t z, Alignment align, const Colorf& color, float clipX, float clipY)
@@ -907,9 +958,9 @@ namespace Jazz2::UI
 		std::int32_t row = frame / base->FrameConfiguration.X;
 		Vector4f texCoords = Vector4f(
 			std::floor(float(base->FrameDimensions.X) * clipX) / float(texSize.X),
-			float(base->FrameDimensions.X * col) / float(texSize.X),
+			float(base->TextureOffset.X + base->FrameDimensions.X * col) / float(texSize.X),
 			std::floor(float(base->FrameDimensions.Y) * clipY) / float(texSize.Y),
-			float(base->FrameDimensions.Y * row) / float(texSize.Y)
+			float(base->TextureOffset.Y + base->FrameDimensions.Y * row) / float(texSize.Y)
 		);
 
 		DrawTexture(*base->TextureDiffuse.get(), adjustedPos, z, size, texCoords, color);
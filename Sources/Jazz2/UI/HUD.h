@@ -131,6 +131,9 @@ namespace Jazz2::UI
 		void DrawLevelText(std::int32_t& charOffset);
 		void DrawCoins(const Rectf& view, std::int32_t& charOffset);
 		void DrawGems(const Rectf& view, std::int32_t& charOffset);
+#if defined(WITH_PROFILER)
+		void DrawProfilerStats(const Rectf& view, std::int32_t& charOffset);
+#endif
 
 		void DrawElement(AnimState state, std::int32_t frame, float x, float y, std::uint16_t z, Alignment align, const Colorf& color, float scaleX = 1.0f, float scaleY = 1.0f, bool additiveBlending = false, float angle = 0.0f);
 		void DrawElementClipped(AnimState state, std::int32_t frame, float x, float y, std::uint16_t z, Alignment align, const Colorf& color, float clipX, float clipY);
@@ -83,9 +83,9 @@ namespace Jazz2::UI
 			std::int32_t row = frame / base->FrameConfiguration.X;
 			Vector4f texCoords = Vector4f(
 				float(base->FrameDimensions.X) / float(texSize.X),
-				float(base->FrameDimensions.X * col) / float(texSize.X),
+				float(base->TextureOffset.X + base->FrameDimensions.X * col) / float(texSize.X),
 				float(base->FrameDimensions.Y) / float(texSize.Y),
-				float(base->FrameDimensions.Y * row) / float(texSize.Y)
+				float(base->TextureOffset.Y + base->FrameDimensions.Y * row) / float(texSize.Y)
 			);
 
 			DrawTexture(*base->TextureDiffuse.get(), pos, 960, size, texCoords, Colorf::White, false);
@@ -373,9 +373,9 @@ namespace Jazz2::UI::Menu
 		std::int32_t row = frame / base->FrameConfiguration.X;
 		Vector4f texCoords = Vector4f(
 			float(base->FrameDimensions.X) / float(texSize.X),
-			float(base->FrameDimensions.X * col) / float(texSize.X),
+			float(base->TextureOffset.X + base->FrameDimensions.X * col) / float(texSize.X),
 			float(base->FrameDimensions.Y) / float(texSize.Y),
-			float(base->FrameDimensions.Y * row) / float(texSize.Y)
+			float(base->TextureOffset.Y + base->FrameDimensions.Y * row) / float(texSize.Y)
 		);
 
 		currentCanvas->DrawTexture(*base->TextureDiffuse.get(), adjustedPos, z, size, texCoords, color, additiveBlending);
@@ -453,9 +453,9 @@ namespace Jazz2::UI::Menu
 		std::int32_t row = frame / base->FrameConfiguration.X;
 		Vector4f texCoords = Vector4f(
 			float(base->FrameDimensions.X) / float(texSize.X),
-			float(base->FrameDimensions.X * col) / float(texSize.X),
+			float(base->TextureOffset.X + base->FrameDimensions.X * col) / float(texSize.X),
 			float(base->FrameDimensions.Y) / float(texSize.Y),
-			float(base->FrameDimensions.Y * row) / float(texSize.Y)
+			float(base->TextureOffset.Y + base->FrameDimensions.Y * row) / float(texSize.Y)
 		);
 		
 		currentCanvas->DrawTexture(*base->TextureDiffuse.get(), adjustedPos, z, size, texCoords, color, additiveBlending);
@@ -658,9 +658,9 @@ namespace Jazz2::UI::Menu
 					std::int32_t col = curAnimFrame % resBase->FrameConfiguration.X;
 					std::int32_t row = curAnimFrame / resBase->FrameConfiguration.X;
 					debris.TexScaleX = (float(resBase->FrameDimensions.X) / float(texSize.X));
-					debris.TexBiasX = (float(resBase->FrameDimensions.X * col) / float(texSize.X));
+					debris.TexBiasX = (float(resBase->TextureOffset.X + resBase->FrameDimensions.X * col) / float(texSize.X));
 					debris.TexScaleY = (float(resBase->FrameDimensions.Y) / float(texSize.Y));
-					debris.TexBiasY = (float(resBase->FrameDimensions.Y * row) / float(texSize.Y));
+					debris.TexBiasY = (float(resBase->TextureOffset.Y + resBase->FrameDimensions.Y * row) / float(texSize.Y));
 
 					debris.DiffuseTexture = resBase->TextureDiffuse.get();
 
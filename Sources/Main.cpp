@@ -24,6 +24,7 @@
 #include "Jazz2/ContentResolver.h"
 #include "Jazz2/LevelHandler.h"
 #include "Jazz2/PreferencesCache.h"
+#include "Jazz2/SimulationBenchmark.h"
 #include "Jazz2/UI/Cinematics.h"
 #include "Jazz2/UI/ControlScheme.h"
 #include "Jazz2/UI/LoadingHandler.h"
@@ -37,6 +38,8 @@
 #include "Jazz2/Compatibility/JJ2Level.h"
 #include "Jazz2/Compatibility/JJ2Strings.h"
 #include "Jazz2/Compatibility/JJ2Tileset.h"
+#include "Jazz2/Compatibility/ConversionManifest.h"
+#include "Jazz2/Compatibility/ConversionPipeline.h"
 #include "Jazz2/Compatibility/EventConverter.h"
 
 #if defined(WITH_MULTIPLAYER)
@@ -59,6 +62,7 @@ using namespace Jazz2::Multiplayer;
 #	include <cstdlib> // for `__argc` and `__argv`
 #endif
 
+#include <Containers/DateTime.h>
 #include <Containers/StringConcatenable.h>
 #include <Cpu.h>
 #include <Environment.h>
@@ -143,6 +147,9 @@ private:
 #if defined(WITH_MULTIPLAYER)
 	std::unique_ptr<NetworkManager> _networkManager;
 #endif
+#if defined(WITH_BENCHMARK)
+	std::unique_ptr<SimulationBenchmark> _benchmark;
+#endif
 
 	void OnBeforeInitialize();
 	void OnAfterInitialize();
@@ -209,9 +216,28 @@ void GameEventHandler::OnPreInitialize(AppConfiguration& config)
 	config.shaderCachePath = fs::CombinePath(resolver.GetCachePath(), "Shaders"_s);
 #endif
 
+#if defined(WITH_THREADS)
+	// Thread pool is used for loading of resources in background
+	config.withThreads = true;
+#endif
 #if defined(WITH_IMGUI)
 	config.withDebugOverlay = true;
 #endif
+
+#if defined(WITH_BENCHMARK)
+	SimulationBenchmark::Configuration benchmarkConfig;
+	if (SimulationBenchmark::TryParseArguments(config, benchmarkConfig)) {
+#	if defined(DEATH_TRACE) && defined(DEATH_TARGET_WINDOWS)
+		// Always attach to console in this case
+		theApplication().AttachTraceTarget(MainApplication::ConsoleTarget);
+#	endif
+		// Nothing is rendered and audio is not needed, the simulation runs in a single call anyway
+		_benchmark = std::make_unique<SimulationBenchmark>(std::move(benchmarkConfig));
+		config.withAudio = false;
+		config.withVSync = false;
+		config.frameLimit = 0;
+	}
+#endif
 }
 
 void GameEventHandler::OnInitialize()
@@ -220,6 +246,21 @@ void GameEventHandler::OnInitialize()
 
 	OnBeforeInitialize();
 
+#if defined(WITH_BENCHMARK)
+	if (_benchmark != nullptr) {
+		// Benchmark runs synchronously instead of the game and the application quits right after it
+		OnAfterInitialize();
+		if ((_flags & Flags::IsPlayable) == Flags::IsPlayable) {
+			_benchmark->Run();
+		} else {
+			LOGE("Cannot run benchmark, because game files are not available");
+		}
+		_benchmark = nullptr;
+		theApplication().Quit();
+		return;
+	}
+#endif
+
 #if !defined(SHAREWARE_DEMO_ONLY)
 	if (PreferencesCache::ResumeOnStart) {
 		LOGI("Resuming last state due to suspended termination");
@@ -344,6 +385,10 @@ void GameEventHandler::OnInitialize()
 
 void GameEventHandler::OnBeginFrame()
 {
+#if defined(WITH_PROFILER)
+	Profiler::SetEnabled(PreferencesCache::ShowPerformanceMetrics);
+#endif
+
 	if (!_pendingCallbacks.empty()) {
 		ZoneScopedNC("Pending callbacks", 0x888888);
 
@@ -354,6 +399,8 @@ void GameEventHandler::OnBeginFrame()
 		_pendingCallbacks.clear();
 	}
 
+	ContentResolver::Get().ProcessPendingLoads();
+
 	_currentHandler->OnBeginFrame();
 }
 
@@ -448,6 +495,21 @@ void GameEventHandler::OnKeyPressed(const KeyboardEvent& event)
 		return;
 	}
 #endif
+#if defined(WITH_PROFILER)
+	// Allow F9 to save recorded profiler zones when performance metrics are shown
+	if (event.sym == KeySym::F9 && PreferencesCache::ShowPerformanceMetrics) {
+		auto now = DateTime::Now().Partitioned();
+		char fileName[64];
+		formatString(fileName, sizeof(fileName), "Trace-%04i%02i%02i-%02i%02i%02i.json", now.Year, now.Month + 1, now.Day, now.Hour, now.Minute, now.Second);
+		String tracePath = fs::CombinePath(PreferencesCache::GetDirectory(), fileName);
+		if (Profiler::SaveTrace(tracePath)) {
+			LOGI("Profiler trace saved to \"%s\"", tracePath.data());
+		} else {
+			LOGE("Failed to save profiler trace to \"%s\"", tracePath.data());
+		}
+		return;
+	}
+#endif
 
 	_currentHandler->OnKeyPressed(event);
 }
@@ -963,11 +1025,8 @@ void GameEventHandler::RefreshCache()
 			goto RecreateCache;
 		}
 
-		// If some events were added, recreate cache
+		// If some events were added, only levels have to be converted again
 		std::uint16_t eventTypeCount = s->ReadValue<std::uint16_t>();
-		if (eventTypeCount != (std::uint16_t)EventType::Count) {
-			goto RecreateCache;
-		}
 
 		// Cache is up-to-date
 		std::uint64_t lastVersion = s->ReadValue<std::uint64_t>();
@@ -975,7 +1034,12 @@ void GameEventHandler::RefreshCache()
 		// Close the file, so it can be writable for possible update
 		s = nullptr;
 
-		if (currentVersion != lastVersion) {
+		if (eventTypeCount != (std::uint16_t)EventType::Count) {
+			LOGI("Cache is already up-to-date, but event types were changed");
+
+			RefreshCacheLevels();
+			WriteCacheDescriptor(cachePath, currentVersion, animsModified);
+		} else if (currentVersion != lastVersion) {
 			if ((lastVersion & 0xFFFFFFFFULL) == 0x0FFFFFFFULL) {
 				LOGI("Cache is already up-to-date, but created in experimental build v%i.%i.0", (lastVersion >> 48) & 0xFFFFULL, (lastVersion >> 32) & 0xFFFFULL);
 			} else {
@@ -1206,61 +1270,80 @@ void GameEventHandler::RefreshCacheLevels()
 		}
 	};
 
-	String episodesPath = fs::CombinePath(resolver.GetCachePath(), "Episodes"_s);
-	fs::RemoveDirectoryRecursive(episodesPath);
+	struct ConversionItem {
+		String SourcePath;
+		String TargetName;
+		Compatibility::ConversionManifest::Entry Result;
+		// Files are converted to temporary paths first and moved to their target paths in the original order,
+		// so the result is the same as with sequential conversion, even if multiple source files have the same target
+		SmallVector<Pair<String, String>, 2> PendingMoves;
+	};
+
+	const String& cachePath = resolver.GetCachePath();
+	String episodesPath = fs::CombinePath(cachePath, "Episodes"_s);
+	String tilesetsPath = fs::CombinePath(cachePath, "Tilesets"_s);
+	String tempPath = fs::CombinePath(cachePath, "Temp"_s);
+	String manifestPath = fs::CombinePath(cachePath, "Source.manifest"_s);
+
+	// Only added or changed source files are converted, everything is converted again if converters were changed
+	std::uint32_t converterVersion = ((std::uint32_t)Compatibility::JJ2Anims::CacheVersion << 16) | (std::uint32_t)EventType::Count;
+	Compatibility::ConversionManifest lastManifest;
+	if (!lastManifest.Load(manifestPath, converterVersion)) {
+		fs::RemoveDirectoryRecursive(episodesPath);
+		fs::RemoveDirectoryRecursive(tilesetsPath);
+	}
 	fs::CreateDirectories(episodesPath);
+	fs::CreateDirectories(tilesetsPath);
+	fs::RemoveDirectoryRecursive(tempPath);
+	fs::CreateDirectories(tempPath);
 
+	Compatibility::ConversionManifest manifest;
+	manifest.SetConverterVersion(converterVersion);
 	HashMap<String, bool> usedTilesets;
+	std::int32_t convertedCount = 0;
 
-	for (auto item : fs::Directory(fs::FindPathCaseInsensitive(resolver.GetSourcePath()), fs::EnumerationOptions::SkipDirectories)) {
-		auto extension = fs::GetExtension(item);
-		if (extension == "j2e"_s || extension == "j2pe"_s) {
-			// Episode
-			Compatibility::JJ2Episode episode;
-			if (episode.Open(item)) {
-				if (episode.Name == "home"_s || (hasChristmasChronicles && episode.Name == "xmas98"_s)) {
-					continue;
-				}
+	auto GetTempPath = [&tempPath](std::int32_t index, std::int32_t n) -> String {
+		char tempName[32];
+		formatString(tempName, sizeof(tempName), "%i_%i.tmp", index, n);
+		return fs::CombinePath(tempPath, tempName);
+	};
 
-				String fullPath = fs::CombinePath(episodesPath, String((episode.Name == "xmas98"_s ? "xmas99"_s : StringView(episode.Name)) + ".j2e"_s));
-				episode.Convert(fullPath, LevelTokenConversion, EpisodeNameConversion, EpisodePrevNext);
+	auto TryReusePreviousResult = [&lastManifest, &cachePath](ConversionItem& item) -> bool {
+		auto* lastEntry = lastManifest.Find(fs::GetFileName(item.SourcePath), item.Result.Hash);
+		if (lastEntry == nullptr) {
+			return false;
+		}
+		for (auto& output : lastEntry->Outputs) {
+			if (!fs::IsReadableFile(fs::CombinePath(cachePath, output))) {
+				return false;
 			}
-		} else if (extension == "j2l"_s) {
-			// Level
-			String levelName = fs::GetFileName(item);
-			if (levelName.find("-MLLE-Data-"_s) == nullptr) {
-				Compatibility::JJ2Level level;
-				if (level.Open(item, false)) {
-					String fullPath;
-					auto it = knownLevels.find(level.LevelName);
-					if (it != knownLevels.end()) {
-						if (it->second.second().empty()) {
-							fullPath = fs::CombinePath({ episodesPath, it->second.first(), String(level.LevelName + ".j2l"_s) });
-						} else {
-							fullPath = fs::CombinePath({ episodesPath, it->second.first(), String(it->second.second() + '_' + level.LevelName + ".j2l"_s) });
-						}
-					} else {
-						fullPath = fs::CombinePath({ episodesPath, "unknown"_s, String(level.LevelName + ".j2l"_s) });
-					}
-
-					fs::CreateDirectories(fs::GetDirectoryName(fullPath));
-					level.Convert(fullPath, eventConverter, LevelTokenConversion);
+		}
+		item.Result.Outputs = lastEntry->Outputs;
+		item.Result.Dependencies = lastEntry->Dependencies;
+		return true;
+	};
 
-					usedTilesets.emplace(level.Tileset, true);
-					for (auto& extraTileset : level.ExtraTilesets) {
-						usedTilesets.emplace(extraTileset.Name, true);
-					}
+	auto CommitItem = [&](ConversionItem& item) {
+		for (auto& move : item.PendingMoves) {
+			String targetPath = fs::CombinePath(cachePath, move.second());
+			fs::CreateDirectories(fs::GetDirectoryName(targetPath));
+			fs::Move(move.first(), targetPath);
+		}
+		if (!item.PendingMoves.empty()) {
+			convertedCount++;
+		}
+		for (auto& dependency : item.Result.Dependencies) {
+			usedTilesets.emplace(dependency, true);
+		}
+		manifest.Set(fs::GetFileName(item.SourcePath), std::move(item.Result));
+		item = {};
+	};
 
-					// Also copy level script file if exists
-					StringView foundDot = item.findLastOr('.', item.end());
-					String scriptPath = item.prefix(foundDot.begin()) + ".j2as"_s;
-					auto adjustedPath = fs::FindPathCaseInsensitive(scriptPath);
-					if (fs::IsReadableFile(adjustedPath)) {
-						foundDot = fullPath.findLastOr('.', fullPath.end());
-						fs::Copy(adjustedPath, String(fullPath.prefix(foundDot.begin()) + ".j2as"_s));
-					}
-				}
-			}
+	SmallVector<ConversionItem, 0> items;
+	for (auto item : fs::Directory(fs::FindPathCaseInsensitive(resolver.GetSourcePath()), fs::EnumerationOptions::SkipDirectories)) {
+		auto extension = fs::GetExtension(item);
+		if (extension == "j2e"_s || extension == "j2pe"_s || (extension == "j2l"_s && fs::GetFileName(item).find("-MLLE-Data-"_s) == nullptr)) {
+			items.emplace_back().SourcePath = item;
 		}
 #if defined(DEATH_DEBUG)
 		/*else if (extension == "j2s"_s) {
@@ -1275,22 +1358,135 @@ void GameEventHandler::RefreshCacheLevels()
 #endif
 	}
 
+	// Episodes and levels are independent, so they are converted in parallel
+	Compatibility::ConversionPipeline::Run((std::int32_t)items.size(), [&](std::int32_t i) {
+		auto& item = items[i];
+		StringView sourcePath = item.SourcePath;
+		StringView foundDot = sourcePath.findLastOr('.', sourcePath.end());
+		bool isLevel = (fs::GetExtension(sourcePath) == "j2l"_s);
+
+		if (isLevel) {
+			// Level script and additional layers are converted together with the level, so they must be included in the hash too
+			String scriptPath = fs::FindPathCaseInsensitive(String(sourcePath.prefix(foundDot.begin()) + ".j2as"_s));
+			item.Result.Hash = Compatibility::ConversionManifest::HashFile(sourcePath);
+			item.Result.Hash = Compatibility::ConversionManifest::HashFile(scriptPath, item.Result.Hash);
+			for (std::int32_t j = 1; ; j++) {
+				char numberBuffer[16];
+				i32tos(j, numberBuffer);
+				String extraLayersPath = fs::FindPathCaseInsensitive(String(sourcePath.prefix(foundDot.begin()) + "-MLLE-Data-"_s + numberBuffer + ".j2l"_s));
+				if (!fs::IsReadableFile(extraLayersPath)) {
+					break;
+				}
+				item.Result.Hash = Compatibility::ConversionManifest::HashFile(extraLayersPath, item.Result.Hash);
+			}
+
+			if (TryReusePreviousResult(item)) {
+				return;
+			}
+
+			Compatibility::JJ2Level level;
+			if (!level.Open(sourcePath, false)) {
+				return;
+			}
+
+			String targetPath;
+			auto it = knownLevels.find(level.LevelName);
+			if (it != knownLevels.end()) {
+				if (it->second.second().empty()) {
+					targetPath = fs::CombinePath({ "Episodes"_s, it->second.first(), String(level.LevelName + ".j2l"_s) });
+				} else {
+					targetPath = fs::CombinePath({ "Episodes"_s, it->second.first(), String(it->second.second() + '_' + level.LevelName + ".j2l"_s) });
+				}
+			} else {
+				targetPath = fs::CombinePath({ "Episodes"_s, "unknown"_s, String(level.LevelName + ".j2l"_s) });
+			}
+
+			String levelTempPath = GetTempPath(i, 0);
+			level.Convert(levelTempPath, eventConverter, LevelTokenConversion);
+			item.PendingMoves.emplace_back(levelTempPath, targetPath);
+			item.Result.Outputs.push_back(targetPath);
+
+			item.Result.Dependencies.push_back(level.Tileset);
+			for (auto& extraTileset : level.ExtraTilesets) {
+				item.Result.Dependencies.push_back(extraTileset.Name);
+			}
+
+			// Also copy level script file if exists
+			if (fs::IsReadableFile(scriptPath)) {
+				StringView targetDot = targetPath.findLastOr('.', targetPath.end());
+				String scriptTargetPath = String(targetPath.prefix(targetDot.begin()) + ".j2as"_s);
+				String scriptTempPath = GetTempPath(i, 1);
+				fs::Copy(scriptPath, scriptTempPath);
+				item.PendingMoves.emplace_back(scriptTempPath, scriptTargetPath);
+				item.Result.Outputs.push_back(scriptTargetPath);
+			}
+		} else {
+			// Presence of "The Christmas Chronicles" changes how "Holiday Hare '98" is converted
+			item.Result.Hash = Compatibility::ConversionManifest::HashFile(sourcePath, hasChristmasChronicles
+				? ~Compatibility::ConversionManifest::InitialHash : Compatibility::ConversionManifest::InitialHash);
+
+			if (TryReusePreviousResult(item)) {
+				return;
+			}
+
+			Compatibility::JJ2Episode episode;
+			if (!episode.Open(sourcePath) || episode.Name == "home"_s || (hasChristmasChronicles && episode.Name == "xmas98"_s)) {
+				return;
+			}
+
+			String targetPath = fs::CombinePath("Episodes"_s, String((episode.Name == "xmas98"_s ? "xmas99"_s : StringView(episode.Name)) + ".j2e"_s));
+			String episodeTempPath = GetTempPath(i, 0);
+			episode.Convert(episodeTempPath, LevelTokenConversion, EpisodeNameConversion, EpisodePrevNext);
+			item.PendingMoves.emplace_back(episodeTempPath, targetPath);
+			item.Result.Outputs.push_back(targetPath);
+		}
+	}, [&](std::int32_t i) {
+		CommitItem(items[i]);
+	});
+
 	// Convert only used tilesets
 	LOGI("Converting used tilesets...");
-	String tilesetsPath = fs::CombinePath(resolver.GetCachePath(), "Tilesets"_s);
-	fs::RemoveDirectoryRecursive(tilesetsPath);
-	fs::CreateDirectories(tilesetsPath);
-
+	items.clear();
 	for (auto& pair : usedTilesets) {
 		String tilesetPath = fs::CombinePath(resolver.GetSourcePath(), String(pair.first + ".j2t"_s));
 		auto adjustedPath = fs::FindPathCaseInsensitive(tilesetPath);
 		if (fs::IsReadableFile(adjustedPath)) {
-			Compatibility::JJ2Tileset tileset;
-			if (tileset.Open(adjustedPath, false)) {
-				tileset.Convert(fs::CombinePath({ tilesetsPath, String(pair.first + ".j2t"_s) }));
-			}
+			auto& item = items.emplace_back();
+			item.SourcePath = std::move(adjustedPath);
+			item.TargetName = pair.first;
+		}
+	}
+	usedTilesets.clear();
+
+	Compatibility::ConversionPipeline::Run((std::int32_t)items.size(), [&](std::int32_t i) {
+		auto& item = items[i];
+		item.Result.Hash = Compatibility::ConversionManifest::HashFile(item.SourcePath);
+		if (TryReusePreviousResult(item)) {
+			return;
 		}
+
+		Compatibility::JJ2Tileset tileset;
+		if (tileset.Open(item.SourcePath, false)) {
+			String targetPath = fs::CombinePath("Tilesets"_s, String(item.TargetName + ".j2t"_s));
+			String tilesetTempPath = GetTempPath(i, 0);
+			tileset.Convert(tilesetTempPath);
+			item.PendingMoves.emplace_back(tilesetTempPath, targetPath);
+			item.Result.Outputs.push_back(targetPath);
+		}
+	}, [&](std::int32_t i) {
+		CommitItem(items[i]);
+	});
+
+	// Remove converted files of source files that were removed or that are not used anymore
+	auto staleOutputs = lastManifest.GetStaleOutputs(manifest);
+	for (auto& output : staleOutputs) {
+		fs::RemoveFile(fs::CombinePath(cachePath, output));
 	}
+
+	fs::RemoveDirectoryRecursive(tempPath);
+	manifest.Save(manifestPath);
+
+	LOGI("Converted %i files, removed %i files", convertedCount, (std::int32_t)staleOutputs.size());
 }
 
 void GameEventHandler::CheckUpdates()
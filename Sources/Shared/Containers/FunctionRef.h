@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../Common.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace Death { namespace Containers {
+//###==##====#=====--==~--~=~- --- -- -  -  -   -
+
+	template<class> class FunctionRef;
+
+	/**
+		@brief Lightweight non-owning reference to a callable
+
+		Unlike @ref std::function, it never allocates and it's trivially copyable, it only stores a pointer to the callable
+		object and a pointer to a function that invokes it. It's intended to be used as a function parameter for callbacks
+		that are called only during the function call. The referenced callable must outlive the @ref FunctionRef instance,
+		so it should never be stored.
+	*/
+	template<class R, class ...Args> class FunctionRef<R(Args...)>
+	{
+	public:
+		/** @brief Construct a reference to a function pointer */
+		/*implicit*/ FunctionRef(R(*function)(Args...)) noexcept
+			: _object{reinterpret_cast<void*>(function)}, _invoker{[](void* object, Args... args) -> R {
+				return reinterpret_cast<R(*)(Args...)>(object)(std::forward<Args>(args)...);
+			}} {}
+
+		/** @brief Construct a reference to a callable object */
+		template<class F, class = typename std::enable_if<!std::is_same<typename std::decay<F>::type, FunctionRef>::value &&
+			!std::is_pointer<typename std::decay<F>::type>::value>::type>
+		/*implicit*/ FunctionRef(F&& function) noexcept
+			: _object{const_cast<void*>(static_cast<const void*>(&function))}, _invoker{[](void* object, Args... args) -> R {
+				return (*static_cast<typename std::remove_reference<F>::type*>(object))(std::forward<Args>(args)...);
+			}} {}
+
+		/** @brief Call the referenced function */
+		R operator()(Args... args) const {
+			return _invoker(_object, std::forward<Args>(args)...);
+		}
+
+	private:
+		void* _object;
+		R(*_invoker)(void*, Args...);
+	};
+
+}}
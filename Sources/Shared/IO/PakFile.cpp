@@ -1,16 +1,99 @@
 #include "PakFile.h"
 #include "DeflateStream.h"
 #include "FileSystem.h"
+#include "MemoryStream.h"
 #include "../Containers/GrowableArray.h"
 #include "../Containers/StringConcatenable.h"
+#include "../Threading/Interlocked.h"
 
 #include <algorithm>
+#include <thread>
 
 using namespace Death::Containers;
+using namespace Death::Containers::Literals;
+using namespace Death::Threading;
 
 namespace Death { namespace IO {
 //###==##====#=====--==~--~=~- --- -- -  -  -   -
 
+	namespace
+	{
+		// Critical sections guarded by this lock are very short, so spinning is cheaper than a mutex
+		class SpinLockGuard
+		{
+		public:
+			explicit SpinLockGuard(std::int32_t volatile& lock) : _lock(lock) {
+				std::int32_t spinCount = 0;
+				while (Interlocked::CompareExchange(&_lock, 1, 0) != 0) {
+					// Spin for a while first, then yield, so the owner can release the lock even if it was preempted
+					if (++spinCount >= MaxSpinCount) {
+						std::this_thread::yield();
+					}
+				}
+			}
+
+			~SpinLockGuard() {
+				Interlocked::Exchange(&_lock, 0);
+			}
+
+			SpinLockGuard(const SpinLockGuard&) = delete;
+			SpinLockGuard& operator=(const SpinLockGuard&) = delete;
+
+		private:
+			static constexpr std::int32_t MaxSpinCount = 64;
+
+			std::int32_t volatile& _lock;
+		};
+
+		std::uint32_t HashPath(StringView path)
+		{
+			// FNV-1a
+			std::uint32_t hash = 0x811C9DC5u;
+			for (char c : path) {
+				hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x01000193u;
+			}
+			return hash;
+		}
+
+		// Removes leading, trailing and consecutive separators and converts them to '/'
+		std::size_t NormalizePath(StringView path, char* buffer, std::size_t bufferSize)
+		{
+			std::size_t length = 0;
+			bool pendingSeparator = false;
+			for (char c : path) {
+				if (c == '/' || c == '\\') {
+					pendingSeparator = (length > 0);
+					continue;
+				}
+				if (pendingSeparator) {
+					if (length >= bufferSize) {
+						return 0;
+					}
+					buffer[length++] = '/';
+					pendingSeparator = false;
+				}
+				if (length >= bufferSize) {
+					return 0;
+				}
+				buffer[length++] = c;
+			}
+			return length;
+		}
+	}
+
+	/** @brief Read-only stream over decompressed data shared with the cache */
+	class CachedBlobStream : public MemoryStream
+	{
+	public:
+		explicit CachedBlobStream(std::shared_ptr<Array<std::uint8_t>> blob)
+			: MemoryStream(static_cast<const void*>(blob->data()), static_cast<std::int64_t>(blob->size())), _blob(std::move(blob))
+		{
+		}
+
+	private:
+		std::shared_ptr<Array<std::uint8_t>> _blob;
+	};
+
 	class BoundedStream : public Stream
 	{
 	public:
@@ -190,8 +273,20 @@ namespace Death { namespace IO {
 #endif
 
 	PakFile::PakFile(const StringView path)
-	{
-		std::unique_ptr<Stream> s = std::make_unique<FileStream>(path, FileAccess::Read);
+		: _cacheSize(0), _cacheCounter(0), _cacheLock(0)
+	{
+		std::unique_ptr<Stream> s;
+#if defined(DEATH_PAKFILE_MEMORY_MAPPED)
+		auto mappedFile = FileSystem::OpenAsMemoryMapped(path, FileAccess::Read);
+		if (mappedFile && !mappedFile->empty()) {
+			// Even the index is read directly from the mapped memory
+			_mappedFile = std::move(*mappedFile);
+			s = std::make_unique<MemoryStream>(static_cast<const void*>(_mappedFile.data()), static_cast<std::int64_t>(_mappedFile.size()));
+		} else
+#endif
+		{
+			s = std::make_unique<FileStream>(path, FileAccess::Read);
+		}
 		DEATH_ASSERT(s->GetSize() > 24, "Invalid .pak file", );
 
 		// Header size is 18 bytes
@@ -222,6 +317,7 @@ namespace Death { namespace IO {
 		}
 
 		ReadIndex(s, nullptr);
+		BuildIndex();
 		_path = path;
 	}
 
@@ -240,6 +336,15 @@ namespace Death { namespace IO {
 		return !_path.empty();
 	}
 
+	bool PakFile::IsMemoryMapped() const
+	{
+#if defined(DEATH_PAKFILE_MEMORY_MAPPED)
+		return !_mappedFile.empty();
+#else
+		return false;
+#endif
+	}
+
 	void PakFile::ReadIndex(std::unique_ptr<Stream>& s, Item* parentItem)
 	{
 		std::uint32_t itemCount = s->ReadVariableUint32();
@@ -308,6 +413,15 @@ namespace Death { namespace IO {
 
 		if ((foundItem->Flags & ItemFlags::ZlibCompressed) == ItemFlags::ZlibCompressed) {
 #if defined(WITH_ZLIB)
+#	if defined(DEATH_PAKFILE_MEMORY_MAPPED)
+			if (!_mappedFile.empty()) {
+				auto blob = GetDecompressedBlob(foundItem);
+				if (blob == nullptr) {
+					return nullptr;
+				}
+				return std::make_unique<CachedBlobStream>(std::move(blob));
+			}
+#	endif
 			return std::make_unique<ZlibCompressedBoundedStream>(_path, foundItem->Offset, foundItem->UncompressedSize, foundItem->Size);
 #else
 			LOGE("File \"%s\" was compressed using an unsupported compression method", String::nullTerminatedView(path).data());
@@ -315,43 +429,145 @@ namespace Death { namespace IO {
 #endif
 		}
 
+#if defined(DEATH_PAKFILE_MEMORY_MAPPED)
+		if (!_mappedFile.empty()) {
+			// Uncompressed files are accessed directly in the mapped memory without any copies
+			DEATH_ASSERT(foundItem->Offset + foundItem->UncompressedSize <= _mappedFile.size(), "Malformed .pak file", nullptr);
+			return std::make_unique<MemoryStream>(static_cast<const void*>(&_mappedFile[foundItem->Offset]), static_cast<std::int64_t>(foundItem->UncompressedSize));
+		}
+#endif
+
 		return std::make_unique<BoundedStream>(_path, foundItem->Offset, foundItem->UncompressedSize);
 	}
 
-	PakFile::Item* PakFile::FindItem(StringView path)
+#if defined(DEATH_PAKFILE_MEMORY_MAPPED) && defined(WITH_ZLIB)
+	std::shared_ptr<Array<std::uint8_t>> PakFile::GetDecompressedBlob(Item* item)
 	{
-		path = path.trimmedPrefix("/\\");
+		bool isCacheable = (item->UncompressedSize <= MaxCachedItemSize);
+		if (isCacheable) {
+			SpinLockGuard lock(_cacheLock);
+			for (CachedBlob& entry : _cache) {
+				if (entry.Key == item) {
+					entry.LastUsed = ++_cacheCounter;
+					return entry.Data;
+				}
+			}
+		}
 
-		Array<Item>* items = &_rootItems;
-		while (true) {
-			auto separator = path.findAnyOr("/\\", path.end());
-			auto name = path.prefix(separator.begin());
+		DEATH_ASSERT(item->Offset + item->Size <= _mappedFile.size(), "Malformed .pak file", nullptr);
+
+		// Decompress outside of the lock, so other threads are not blocked
+		MemoryStream compressedStream(static_cast<const void*>(&_mappedFile[item->Offset]), static_cast<std::int64_t>(item->Size));
+		DeflateStream deflateStream(compressedStream, static_cast<std::int32_t>(item->Size));
+		auto data = std::make_shared<Array<std::uint8_t>>(NoInit, item->UncompressedSize);
+		std::int32_t bytesRead = deflateStream.Read(data->data(), static_cast<std::int32_t>(item->UncompressedSize));
+		if (bytesRead != static_cast<std::int32_t>(item->UncompressedSize)) {
+			LOGE("File \"%s\" is truncated or corrupted", item->Name.data());
+			return nullptr;
+		}
+
+		if (!isCacheable) {
+			return data;
+		}
 
-			if (name.empty()) {
-				// Skip all consecutive slashes
-				path = path.suffix(separator.end());
-				continue;
+		SpinLockGuard lock(_cacheLock);
+		for (CachedBlob& entry : _cache) {
+			if (entry.Key == item) {
+				// The same file was decompressed by another thread in the meantime
+				entry.LastUsed = ++_cacheCounter;
+				return entry.Data;
 			}
+		}
 
-			// Items are always sorted by PakWriter
-			Item* foundItem = std::lower_bound(items->begin(), items->end(), name, [](const PakFile::Item& a, const StringView& b) {
-				return a.Name < b;
-			});
+		// Evict least recently used files, they are still alive if any stream uses them
+		while (!_cache.empty() && _cacheSize + item->UncompressedSize > MaxCacheSize) {
+			std::size_t oldest = 0;
+			for (std::size_t i = 1; i < _cache.size(); i++) {
+				if (_cache[i].LastUsed < _cache[oldest].LastUsed) {
+					oldest = i;
+				}
+			}
+			_cacheSize -= static_cast<std::uint32_t>(_cache[oldest].Data->size());
+			arrayRemoveUnordered(_cache, oldest);
+		}
 
-			if (foundItem == items->end() || foundItem->Name != name) {
-				return nullptr;
+		arrayAppend(_cache, CachedBlob { item, data, ++_cacheCounter });
+		_cacheSize += item->UncompressedSize;
+		return data;
+	}
+#endif
+
+	void PakFile::BuildIndex()
+	{
+		std::size_t count = 0;
+		Array<Item*> queue;
+		for (Item& item : _rootItems) {
+			arrayAppend(queue, &item);
+		}
+		for (std::size_t i = 0; i < queue.size(); i++) {
+			count++;
+			for (Item& child : queue[i]->ChildItems) {
+				arrayAppend(queue, &child);
 			}
+		}
 
-			if (separator == path.end()) {
-				// If there is no separator left
-				return foundItem;
+		// Keep load factor below 0.5, so probe sequences are short
+		std::size_t capacity = 16;
+		while (capacity < count * 2) {
+			capacity <<= 1;
+		}
+		_index = Array<IndexEntry>(capacity);
+
+		AddItemsToIndex(_rootItems, {});
+	}
+
+	void PakFile::AddItemsToIndex(Array<Item>& items, StringView parentPath)
+	{
+		std::size_t mask = _index.size() - 1;
+
+		for (Item& item : items) {
+			String path = (parentPath.empty() ? String(item.Name) : String(parentPath + "/"_s + item.Name));
+			std::uint32_t hash = HashPath(path);
+
+			std::size_t i = hash & mask;
+			while (_index[i].Target != nullptr) {
+				i = (i + 1) & mask;
 			}
 
-			path = path.suffix(separator.end());
-			items = &foundItem->ChildItems;
+			IndexEntry& entry = _index[i];
+			entry.Path = std::move(path);
+			entry.Hash = hash;
+			entry.Target = &item;
+
+			if ((item.Flags & ItemFlags::Directory) == ItemFlags::Directory) {
+				AddItemsToIndex(item.ChildItems, entry.Path);
+			}
 		}
 	}
 
+	PakFile::Item* PakFile::FindItem(StringView path)
+	{
+		char buffer[FileSystem::MaxPathLength];
+		std::size_t length = NormalizePath(path, buffer, sizeof(buffer));
+		if (length == 0 || _index.empty()) {
+			return nullptr;
+		}
+
+		StringView normalizedPath(buffer, length);
+		std::uint32_t hash = HashPath(normalizedPath);
+		std::size_t mask = _index.size() - 1;
+
+		std::size_t i = hash & mask;
+		while (_index[i].Target != nullptr) {
+			if (_index[i].Hash == hash && _index[i].Path == normalizedPath) {
+				return _index[i].Target;
+			}
+			i = (i + 1) & mask;
+		}
+
+		return nullptr;
+	}
+
 	class PakFile::Directory::Impl
 	{
 		friend class Directory;
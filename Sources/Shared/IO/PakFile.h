@@ -9,9 +9,20 @@
 #include <cstdio>		// for FILE
 #include <memory>
 
+#if defined(DEATH_TARGET_UNIX) || (defined(DEATH_TARGET_WINDOWS) && !defined(DEATH_TARGET_WINDOWS_RT))
+#	define DEATH_PAKFILE_MEMORY_MAPPED
+#endif
+
 namespace Death { namespace IO {
 //###==##====#=====--==~--~=~- --- -- -  -  -   -
 
+	/**
+		@brief Read-only access to `.pak` files
+
+		If supported by the platform, the whole file is memory-mapped, so uncompressed files are accessed directly
+		without any copies, and recently used compressed files are kept decompressed in a small cache. Streams returned
+		from @ref OpenFile() must not outlive the @ref PakFile instance in this case.
+	*/
 	class PakFile
 	{
 		friend class PakWriter;
@@ -25,6 +36,8 @@ namespace Death { namespace IO {
 		Containers::StringView GetMountPoint() const;
 		Containers::StringView GetPath() const;
 		bool IsValid() const;
+		/** @brief Returns `true` if the file is memory-mapped */
+		bool IsMemoryMapped() const;
 
 		bool FileExists(const Containers::StringView path);
 		bool DirectoryExists(const Containers::StringView path);
@@ -107,16 +120,47 @@ namespace Death { namespace IO {
 			Containers::Array<Item> ChildItems;
 		};
 
+		struct IndexEntry {
+			Containers::String Path;
+			std::uint32_t Hash;
+			Item* Target;
+		};
+
+		struct CachedBlob {
+			Item* Key;
+			std::shared_ptr<Containers::Array<std::uint8_t>> Data;
+			std::uint64_t LastUsed;
+		};
+
 		static constexpr std::uint64_t Signature = 0x208FA69FF0BFBBEF;
 		static constexpr std::uint16_t Version = 1;
 
+		/** @brief Max. total size of decompressed files kept in the cache */
+		static constexpr std::uint32_t MaxCacheSize = 16 * 1024 * 1024;
+		/** @brief Max. size of a decompressed file to be cached */
+		static constexpr std::uint32_t MaxCachedItemSize = 2 * 1024 * 1024;
+
 		Containers::String _path;
 		Containers::String _mountPoint;
 		Containers::Array<Item> _rootItems;
+		// Open-addressing hash table of all items with full paths, size is always power of two
+		Containers::Array<IndexEntry> _index;
+#if defined(DEATH_PAKFILE_MEMORY_MAPPED)
+		Containers::Array<char, FileSystem::MapDeleter> _mappedFile;
+#endif
+		Containers::Array<CachedBlob> _cache;
+		std::uint32_t _cacheSize;
+		std::uint64_t _cacheCounter;
+		std::int32_t volatile _cacheLock;
 
 		void ReadIndex(std::unique_ptr<Stream>& s, Item* parentItem);
+		void BuildIndex();
+		void AddItemsToIndex(Containers::Array<Item>& items, Containers::StringView parentPath);
 
 		Item* FindItem(Containers::StringView path);
+#if defined(DEATH_PAKFILE_MEMORY_MAPPED) && defined(WITH_ZLIB)
+		std::shared_ptr<Containers::Array<std::uint8_t>> GetDecompressedBlob(Item* item);
+#endif
 	};
 
 	class PakWriter
@@ -2,6 +2,7 @@
 #include "AudioBufferPlayer.h"
 #include "AudioStreamPlayer.h"
 #include "../ServiceLocator.h"
+#include "../Base/Profiler.h"
 
 #if defined(DEATH_TARGET_WINDOWS) && !defined(DEATH_TARGET_WINDOWS_RT)
 #	include <Environment.h>
@@ -226,6 +227,10 @@ namespace nCine
 		for (auto& player : players_) {
 			player->updateState();
 		}
+
+#if defined(WITH_PROFILER)
+		Profiler::SetCounter(ProfilerCounter::AudioVoices, (std::int32_t)players_.size());
+#endif
 	}
 
 	const Vector3f& ALAudioDevice::getListenerPosition() const
@@ -0,0 +1,433 @@
+#if defined(WITH_PROFILER)
+
+#include "Profiler.h"
+#include "Algorithms.h"
+#include "Clock.h"
+#include "../Threading/Atomic.h"
+#include "../../Common.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <IO/FileSystem.h>
+
+using namespace Death::IO;
+
+namespace nCine
+{
+	namespace
+	{
+		enum class EventType : std::uint32_t
+		{
+			Begin,
+			End
+		};
+
+		struct Event
+		{
+			const char* Name;
+			std::uint64_t Time;
+			std::uint32_t Color;
+			EventType Type;
+		};
+
+		struct ThreadData
+		{
+			std::unique_ptr<Event[]> Events;
+			/// Total number of events written by the owning thread, published with release semantics
+			Atomic64 WriteIndex;
+			/// Set when `Events` is allocated and the slot can be read by other threads
+			Atomic32 Ready;
+			/// One of `ThreadSlot*` values
+			Atomic32 State;
+			Atomic32 Counters[(std::int32_t)ProfilerCounter::Count];
+		};
+
+		struct OpenZone
+		{
+			const char* Name;
+			std::uint64_t Time;
+		};
+
+		constexpr std::int32_t ThreadSlotUnused = 0;
+		constexpr std::int32_t ThreadSlotOwned = 1;
+		constexpr std::int32_t ThreadSlotReleased = 2;
+
+		constexpr std::int32_t MaxOpenZones = 64;
+		constexpr std::int32_t MaxFrameZones = 64;
+
+		ThreadData Threads[Profiler::MaxThreads];
+		Atomic32 ThreadCount;
+		DEATH_THREAD_LOCAL ThreadData* CurrentThread = nullptr;
+		DEATH_THREAD_LOCAL bool CurrentThreadRejected = false;
+
+		ThreadData* MainThread = nullptr;
+		std::uint64_t BaseTime = 0;
+		std::uint64_t LastFrameTime = 0;
+
+		ProfilerFrameStats FrameHistory[Profiler::MaxFrameHistory];
+		std::int32_t FrameIndex = 0;
+		std::int32_t FrameCount = 0;
+
+		// Zones of the main thread are aggregated incrementally in `MarkFrame()`
+		std::int64_t MainThreadReadIndex = 0;
+		OpenZone MainThreadOpenZones[MaxOpenZones];
+		std::int32_t MainThreadDepth = 0;
+		ProfilerZoneStats FrameZones[MaxFrameZones];
+		std::int32_t FrameZoneCount = 0;
+		std::int32_t TopZoneCount = 0;
+
+		const char* CounterNames[(std::int32_t)ProfilerCounter::Count] = {
+			"Actors updated", "Collision queries", "Render commands", "Render batches", "Texture uploads", "Audio voices"
+		};
+
+		ThreadData* GetCurrentThread()
+		{
+			if DEATH_LIKELY(CurrentThread != nullptr) {
+				return CurrentThread;
+			}
+			if (CurrentThreadRejected) {
+				return nullptr;
+			}
+
+			// Slots released by exited threads are reused first, the ring buffer is kept
+			ThreadData* thread = nullptr;
+			std::int32_t threadCount = std::min(ThreadCount.load(), Profiler::MaxThreads);
+			for (std::int32_t i = 0; i < threadCount; i++) {
+				if (Threads[i].State.cmpExchange(ThreadSlotOwned, ThreadSlotReleased, Atomic32::MemoryModel::ACQUIRE)) {
+					thread = &Threads[i];
+					break;
+				}
+			}
+
+			if (thread == nullptr) {
+				std::int32_t index = ThreadCount.fetchAdd(1);
+				if (index >= Profiler::MaxThreads) {
+					ThreadCount.fetchSub(1);
+					CurrentThreadRejected = true;
+					LOGW("Too many threads for profiler, zones of the current thread will not be recorded");
+					return nullptr;
+				}
+
+				thread = &Threads[index];
+				thread->State.store(ThreadSlotOwned, Atomic32::MemoryModel::RELAXED);
+				thread->Events = std::make_unique<Event[]>(Profiler::MaxEvents);
+				thread->Ready.store(1, Atomic32::MemoryModel::RELEASE);
+			}
+
+			CurrentThread = thread;
+			return thread;
+		}
+
+		inline void PushEvent(ThreadData* thread, const char* name, std::uint32_t color, EventType type)
+		{
+			std::int64_t index = thread->WriteIndex.load(Atomic64::MemoryModel::RELAXED);
+			Event& e = thread->Events[index & (Profiler::MaxEvents - 1)];
+			e.Name = name;
+			e.Time = clock().now();
+			e.Color = color;
+			e.Type = type;
+			thread->WriteIndex.store(index + 1, Atomic64::MemoryModel::RELEASE);
+		}
+
+		void AddFrameZone(const char* name, std::uint64_t duration)
+		{
+			float durationMs = (float)((double)duration * 1000.0 / clock().frequency());
+			for (std::int32_t i = 0; i < FrameZoneCount; i++) {
+				// Names are string literals, so pointers can be compared directly
+				if (FrameZones[i].Name == name) {
+					FrameZones[i].Duration += durationMs;
+					FrameZones[i].Calls++;
+					return;
+				}
+			}
+			if (FrameZoneCount < MaxFrameZones) {
+				FrameZones[FrameZoneCount++] = { name, durationMs, 1 };
+			}
+		}
+
+		void CollectMainThreadZones()
+		{
+			FrameZoneCount = 0;
+			if (MainThread == nullptr) {
+				TopZoneCount = 0;
+				return;
+			}
+
+			std::int64_t end = MainThread->WriteIndex.load(Atomic64::MemoryModel::ACQUIRE);
+			if (end - MainThreadReadIndex > Profiler::MaxEvents) {
+				// Ring buffer was overwritten, nesting of zones is unknown now
+				MainThreadReadIndex = end - Profiler::MaxEvents;
+				MainThreadDepth = 0;
+			}
+
+			for (std::int64_t i = MainThreadReadIndex; i < end; i++) {
+				const Event& e = MainThread->Events[i & (Profiler::MaxEvents - 1)];
+				if (e.Type == EventType::Begin) {
+					if (MainThreadDepth < MaxOpenZones) {
+						MainThreadOpenZones[MainThreadDepth] = { e.Name, e.Time };
+					}
+					MainThreadDepth++;
+				} else if (MainThreadDepth > 0) {
+					MainThreadDepth--;
+					if (MainThreadDepth < MaxOpenZones) {
+						const OpenZone& zone = MainThreadOpenZones[MainThreadDepth];
+						AddFrameZone(zone.Name, e.Time - zone.Time);
+					}
+				}
+			}
+			MainThreadReadIndex = end;
+
+			TopZoneCount = std::min(FrameZoneCount, Profiler::MaxTopZones);
+			std::partial_sort(FrameZones, FrameZones + TopZoneCount, FrameZones + FrameZoneCount, [](const ProfilerZoneStats& a, const ProfilerZoneStats& b) {
+				return a.Duration > b.Duration;
+			});
+		}
+
+		void WriteEscapedString(Stream& s, const char* str)
+		{
+			char buffer[256];
+			std::int32_t length = 0;
+			for (; *str != '\0' && length < (std::int32_t)sizeof(buffer) - 2; str++) {
+				char c = *str;
+				if (c == '"' || c == '\\') {
+					buffer[length++] = '\\';
+				} else if ((unsigned char)c < 0x20) {
+					c = ' ';
+				}
+				buffer[length++] = c;
+			}
+			s.Write(buffer, length);
+		}
+
+		inline double TicksToMicroseconds(std::uint64_t time)
+		{
+			return (double)(time - BaseTime) * 1000000.0 / clock().frequency();
+		}
+	}
+
+	std::atomic<bool> Profiler::enabled_{false};
+
+	void Profiler::SetEnabled(bool value)
+	{
+		if (IsEnabled() == value) {
+			return;
+		}
+
+		if (value) {
+			if (BaseTime == 0) {
+				BaseTime = clock().now();
+			}
+			LastFrameTime = clock().now();
+			MainThread = GetCurrentThread();
+			if (MainThread != nullptr) {
+				MainThreadReadIndex = MainThread->WriteIndex.load(Atomic64::MemoryModel::RELAXED);
+			}
+			MainThreadDepth = 0;
+			FrameZoneCount = 0;
+			TopZoneCount = 0;
+		}
+		enabled_.store(value, std::memory_order_release);
+	}
+
+	void Profiler::BeginZone(const char* name, std::uint32_t color)
+	{
+		ThreadData* thread = GetCurrentThread();
+		if (thread != nullptr) {
+			PushEvent(thread, name, color, EventType::Begin);
+		}
+	}
+
+	void Profiler::EndZone()
+	{
+		ThreadData* thread = GetCurrentThread();
+		if (thread != nullptr) {
+			PushEvent(thread, nullptr, 0, EventType::End);
+		}
+	}
+
+	void Profiler::ReleaseCurrentThread()
+	{
+		ThreadData* thread = CurrentThread;
+		CurrentThread = nullptr;
+		CurrentThreadRejected = false;
+
+		if (thread != nullptr && thread != MainThread) {
+			thread->State.store(ThreadSlotReleased, Atomic32::MemoryModel::RELEASE);
+		}
+	}
+
+	void Profiler::AddCounter(ProfilerCounter counter, std::int32_t value)
+	{
+		if (!IsEnabled()) {
+			return;
+		}
+		ThreadData* thread = GetCurrentThread();
+		if (thread != nullptr) {
+			thread->Counters[(std::int32_t)counter].fetchAdd(value, Atomic32::MemoryModel::RELAXED);
+		}
+	}
+
+	void Profiler::SetCounter(ProfilerCounter counter, std::int32_t value)
+	{
+		if (!IsEnabled()) {
+			return;
+		}
+		ThreadData* thread = GetCurrentThread();
+		if (thread != nullptr) {
+			thread->Counters[(std::int32_t)counter].store(value, Atomic32::MemoryModel::RELAXED);
+		}
+	}
+
+	void Profiler::MarkFrame()
+	{
+		if (!IsEnabled()) {
+			return;
+		}
+
+		std::uint64_t now = clock().now();
+		FrameIndex = (FrameIndex + 1) % MaxFrameHistory;
+		if (FrameCount < MaxFrameHistory) {
+			FrameCount++;
+		}
+
+		ProfilerFrameStats& stats = FrameHistory[FrameIndex];
+		stats.EndTime = now;
+		stats.Duration = (float)((double)(now - LastFrameTime) * 1000.0 / clock().frequency());
+		LastFrameTime = now;
+
+		for (std::int32_t i = 0; i < (std::int32_t)ProfilerCounter::Count; i++) {
+			stats.Counters[i] = 0;
+		}
+
+		std::int32_t threadCount = std::min(ThreadCount.load(), MaxThreads);
+		for (std::int32_t i = 0; i < threadCount; i++) {
+			ThreadData& thread = Threads[i];
+			if (thread.Ready.load(Atomic32::MemoryModel::ACQUIRE) == 0) {
+				continue;
+			}
+			for (std::int32_t j = 0; j < (std::int32_t)ProfilerCounter::Count; j++) {
+				// Subtract only the collected value, so increments from other threads in the meantime are not lost
+				std::int32_t value = thread.Counters[j].load(Atomic32::MemoryModel::RELAXED);
+				if (value != 0) {
+					thread.Counters[j].fetchSub(value, Atomic32::MemoryModel::RELAXED);
+					stats.Counters[j] += value;
+				}
+			}
+		}
+
+		CollectMainThreadZones();
+	}
+
+	std::int32_t Profiler::GetFrameCount()
+	{
+		return FrameCount;
+	}
+
+	const ProfilerFrameStats& Profiler::GetFrameStats(std::int32_t framesAgo)
+	{
+		ASSERT(framesAgo >= 0 && framesAgo < MaxFrameHistory);
+		return FrameHistory[(FrameIndex - framesAgo + MaxFrameHistory) % MaxFrameHistory];
+	}
+
+	ArrayView<const ProfilerZoneStats> Profiler::GetTopZones()
+	{
+		return { FrameZones, (std::size_t)TopZoneCount };
+	}
+
+	const char* Profiler::GetCounterName(ProfilerCounter counter)
+	{
+		return CounterNames[(std::int32_t)counter];
+	}
+
+	bool Profiler::SaveTrace(StringView path)
+	{
+		auto s = fs::Open(path, FileAccess::Write);
+		if (!s->IsValid()) {
+			return false;
+		}
+
+		// Recording is paused, so ring buffers of other threads are not overwritten while they are exported
+		bool wasEnabled = IsEnabled();
+		SetEnabled(false);
+
+		char buffer[256];
+		std::int32_t length;
+		bool first = true;
+
+		auto writeSeparator = [&s, &first]() {
+			if (first) {
+				s->Write("\n", 1);
+				first = false;
+			} else {
+				s->Write(",\n", 2);
+			}
+		};
+
+		s->Write("{\"traceEvents\":[", 16);
+
+		std::int32_t threadCount = std::min(ThreadCount.load(), MaxThreads);
+		for (std::int32_t i = 0; i < threadCount; i++) {
+			ThreadData& thread = Threads[i];
+			if (thread.Ready.load(Atomic32::MemoryModel::ACQUIRE) == 0) {
+				continue;
+			}
+
+			writeSeparator();
+			if (&thread == MainThread) {
+				length = formatString(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"Main thread\"}}", i);
+			} else {
+				length = formatString(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"Thread %i\"}}", i, i);
+			}
+			s->Write(buffer, length);
+
+			// Zones that were open when recording was paused are still closed by their threads,
+			// so only already published events are exported and the oldest ones are skipped
+			std::int64_t end = thread.WriteIndex.load(Atomic64::MemoryModel::ACQUIRE);
+			std::int64_t start = std::max(end - (std::int64_t)MaxEvents + MaxOpenZones, (std::int64_t)0);
+			std::int32_t depth = 0;
+			for (std::int64_t j = start; j < end; j++) {
+				const Event& e = thread.Events[j & (MaxEvents - 1)];
+				if (e.Time < BaseTime) {
+					continue;
+				}
+				if (e.Type == EventType::Begin) {
+					writeSeparator();
+					s->Write("{\"name\":\"", 9);
+					WriteEscapedString(*s, e.Name != nullptr ? e.Name : "Unknown");
+					length = formatString(buffer, sizeof(buffer), "\",\"ph\":\"B\",\"pid\":1,\"tid\":%i,\"ts\":%.3f}", i, TicksToMicroseconds(e.Time));
+					s->Write(buffer, length);
+					depth++;
+				} else if (depth > 0) {
+					// Skip zones that were opened before the oldest recorded event
+					writeSeparator();
+					length = formatString(buffer, sizeof(buffer), "{\"ph\":\"E\",\"pid\":1,\"tid\":%i,\"ts\":%.3f}", i, TicksToMicroseconds(e.Time));
+					s->Write(buffer, length);
+					depth--;
+				}
+			}
+		}
+
+		for (std::int32_t i = FrameCount - 1; i >= 0; i--) {
+			const ProfilerFrameStats& stats = GetFrameStats(i);
+			double ts = TicksToMicroseconds(stats.EndTime);
+
+			writeSeparator();
+			length = formatString(buffer, sizeof(buffer), "{\"name\":\"Frame time (ms)\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%.3f}}", ts, stats.Duration);
+			s->Write(buffer, length);
+
+			for (std::int32_t j = 0; j < (std::int32_t)ProfilerCounter::Count; j++) {
+				writeSeparator();
+				length = formatString(buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%i}}", CounterNames[j], ts, stats.Counters[j]);
+				s->Write(buffer, length);
+			}
+		}
+
+		s->Write("\n],\"displayTimeUnit\":\"ms\"}\n", 27);
+
+		SetEnabled(wasEnabled);
+		return true;
+	}
+}
+
+#endif
@@ -0,0 +1,134 @@
+#pragma once
+
+#if defined(WITH_PROFILER)
+
+#include <Common.h>
+#include <Containers/ArrayView.h>
+#include <Containers/StringView.h>
+
+#include <atomic>
+
+using namespace Death::Containers;
+
+namespace nCine
+{
+	/// Counters aggregated by the built-in profiler for every frame
+	enum class ProfilerCounter
+	{
+		ActorsUpdated,
+		CollisionQueries,
+		RenderCommands,
+		RenderBatches,
+		TextureUploads,
+		AudioVoices,
+
+		Count
+	};
+
+	/// Statistics of a single frame gathered by the built-in profiler
+	struct ProfilerFrameStats
+	{
+		/// Timestamp of the end of the frame in clock ticks
+		std::uint64_t EndTime;
+		/// Duration of the frame in milliseconds
+		float Duration;
+		/// Values of all counters accumulated during the frame
+		std::int32_t Counters[(std::int32_t)ProfilerCounter::Count];
+	};
+
+	/// Total duration of all instances of a zone during a frame
+	struct ProfilerZoneStats
+	{
+		const char* Name;
+		/// Total inclusive duration in milliseconds
+		float Duration;
+		std::int32_t Calls;
+	};
+
+	/// Lightweight built-in profiler used when Tracy integration is not available
+	/*! Zones are recorded to per-thread lock-free ring buffers, so recording doesn't need any synchronization.
+	 *  Counters are accumulated per thread and collected once per frame by `MarkFrame()` on the main thread.
+	 *  Recorded zones can be exported in Chrome trace format (`chrome://tracing`, Perfetto). */
+	class Profiler
+	{
+	public:
+		/// Max. number of threads that can record zones
+		static constexpr std::int32_t MaxThreads = 32;
+		/// Number of zone events kept per thread, it must be power of two
+		static constexpr std::int32_t MaxEvents = 16384;
+		/// Number of frames kept in history
+		static constexpr std::int32_t MaxFrameHistory = 256;
+		/// Max. number of zones reported by `GetTopZones()`
+		static constexpr std::int32_t MaxTopZones = 8;
+
+		/// Returns `true` if the profiler is currently recording
+		static inline bool IsEnabled() {
+			return enabled_.load(std::memory_order_relaxed);
+		}
+		/// Enables or disables recording, it should be called only from the main thread between frames
+		static void SetEnabled(bool value);
+
+		/// Opens a new zone on the calling thread, the name must be a string literal
+		static void BeginZone(const char* name, std::uint32_t color);
+		/// Closes the last opened zone on the calling thread
+		static void EndZone();
+		/// Releases the slot of the calling thread, so it can be reused by another thread, it should be called before the thread exits
+		static void ReleaseCurrentThread();
+
+		/// Adds a value to a counter of the current frame
+		static void AddCounter(ProfilerCounter counter, std::int32_t value = 1);
+		/// Replaces the value of a counter accumulated by the calling thread in the current frame
+		static void SetCounter(ProfilerCounter counter, std::int32_t value);
+
+		/// Finishes the current frame and collects all counters, it must be called from the main thread
+		static void MarkFrame();
+
+		/// Returns the number of frames available in history
+		static std::int32_t GetFrameCount();
+		/// Returns statistics of a frame from history, `0` is the last finished frame
+		static const ProfilerFrameStats& GetFrameStats(std::int32_t framesAgo);
+		/// Returns zones of the main thread with the longest total duration in the last finished frame
+		static ArrayView<const ProfilerZoneStats> GetTopZones();
+		/// Returns a human-readable name of a counter
+		static const char* GetCounterName(ProfilerCounter counter);
+
+		/// Saves all recorded zones and counters to a file in Chrome trace format, recording is paused in the meantime
+		static bool SaveTrace(StringView path);
+
+	private:
+		static std::atomic<bool> enabled_;
+
+		/// Static class, no instances allowed
+		Profiler() = delete;
+		~Profiler() = delete;
+	};
+
+	/// Scoped zone of the built-in profiler
+	class ProfilerZone
+	{
+	public:
+		inline ProfilerZone(const char* name, std::uint32_t color)
+			: active_(Profiler::IsEnabled())
+		{
+			if (active_) {
+				Profiler::BeginZone(name, color);
+			}
+		}
+
+		inline ~ProfilerZone()
+		{
+			// Zone is closed only if it was opened, even if the profiler was toggled in the meantime
+			if (active_) {
+				Profiler::EndZone();
+			}
+		}
+
+		ProfilerZone(const ProfilerZone&) = delete;
+		ProfilerZone& operator=(const ProfilerZone&) = delete;
+
+	private:
+		bool active_;
+	};
+}
+
+#endif
@@ -16,12 +16,15 @@ namespace nCine
 
 	Material::Material(GLShaderProgram* program, GLTexture* texture)
 		: isBlendingEnabled_(false), srcBlendingFactor_(GL_SRC_ALPHA), destBlendingFactor_(GL_ONE_MINUS_SRC_ALPHA),
-			shaderProgramType_(ShaderProgramType::Custom), shaderProgram_(program), uniformsHostBufferSize_(0)
+			shaderProgramType_(ShaderProgramType::Custom), shaderProgram_(program), uniformsHostBufferSize_(0),
+			sortKey_(0), sortKeyDirty_(true)
 	{
 		for (unsigned int i = 0; i < GLTexture::MaxTextureUnits; i++) {
 			textures_[i] = nullptr;
+			textureHandles_[i] = 0;
 		}
 		textures_[0] = texture;
+		textureHandles_[0] = (texture != nullptr ? texture->glHandle() : 0);
 
 		if (program != nullptr) {
 			setShaderProgram(program);
@@ -30,8 +33,11 @@ namespace nCine
 
 	void Material::setBlendingFactors(GLenum srcBlendingFactor, GLenum destBlendingFactor)
 	{
-		srcBlendingFactor_ = srcBlendingFactor;
-		destBlendingFactor_ = destBlendingFactor;
+		if (srcBlendingFactor_ != srcBlendingFactor || destBlendingFactor_ != destBlendingFactor) {
+			srcBlendingFactor_ = srcBlendingFactor;
+			destBlendingFactor_ = destBlendingFactor;
+			sortKeyDirty_ = true;
+		}
 	}
 
 	bool Material::setShaderProgramType(ShaderProgramType shaderProgramType)
@@ -54,6 +60,7 @@ namespace nCine
 
 		shaderProgramType_ = ShaderProgramType::Custom;
 		shaderProgram_ = program;
+		sortKeyDirty_ = true;
 		// The camera uniforms are handled separately as they have a different update frequency
 		shaderUniforms_.setProgram(shaderProgram_, nullptr, ProjectionViewMatrixExcludeString);
 		shaderUniformBlocks_.setProgram(shaderProgram_);
@@ -116,7 +123,13 @@ namespace nCine
 	{
 		bool result = false;
 		if (unit < GLTexture::MaxTextureUnits) {
-			textures_[unit] = texture;
+			// A texture can be recreated at the same address, so its handle is checked when it is set again
+			const GLuint handle = (texture != nullptr ? texture->glHandle() : 0);
+			if (textures_[unit] != texture || textureHandles_[unit] != handle) {
+				textures_[unit] = texture;
+				textureHandles_[unit] = handle;
+				sortKeyDirty_ = true;
+			}
 			result = true;
 		}
 		return result;
@@ -183,17 +196,24 @@ namespace nCine
 
 	uint32_t Material::sortKey()
 	{
+		// Most materials don't change between frames, so the hash is recalculated only after a setter invalidated it
+		if (!sortKeyDirty_) {
+			return sortKey_;
+		}
+
 		constexpr uint32_t Seed = 1697381921;
 		// Align to 64 bits for `fasthash64()` to properly work on Emscripten without alignment faults
 		static SortHashData hashData alignas(8);
 
 		for (unsigned int i = 0; i < GLTexture::MaxTextureUnits; i++) {
-			hashData.textures[i] = (textures_[i] != nullptr) ? textures_[i]->glHandle() : 0;
+			hashData.textures[i] = textureHandles_[i];
 		}
 		hashData.shaderProgram = shaderProgram_->glHandle();
 		hashData.srcBlendingFactor = glBlendingFactorToInt(srcBlendingFactor_);
 		hashData.destBlendingFactor = glBlendingFactorToInt(destBlendingFactor_);
 
-		return fasthash32(reinterpret_cast<const void*>(&hashData), sizeof(SortHashData), Seed);
+		sortKey_ = fasthash32(reinterpret_cast<const void*>(&hashData), sizeof(SortHashData), Seed);
+		sortKeyDirty_ = false;
+		return sortKey_;
 	}
 }
@@ -4,6 +4,7 @@
 #include "GL/GLShaderUniformBlocks.h"
 #include "GL/GLTexture.h"
 #include "Shader.h"
+#include "../Primitives/Matrix4x4.h"
 
 namespace nCine
 {
@@ -13,6 +14,19 @@ namespace nCine
 	class GLUniformCache;
 	class GLAttribute;
 
+	/// Layout of one instance in `InstancesBlock` of batched sprite shaders (std140)
+	/*! Instances are not transformed by the render command, so the depth of the layer has to be stored in the model matrix. */
+	struct BatchedSpriteInstance
+	{
+		Matrix4x4f ModelMatrix;
+		float Color[4];
+		float TexRect[4];
+		float SpriteSize[2];
+		float Padding[2];
+	};
+
+	static_assert(sizeof(BatchedSpriteInstance) == 112, "BatchedSpriteInstance must match layout of batched shaders");
+
 	/// The class containing material data for a drawable node
 	class Material
 	{
@@ -73,6 +87,7 @@ namespace nCine
 		static constexpr char ColorUniformName[] = "color";
 		static constexpr char SpriteSizeUniformName[] = "spriteSize";
 		static constexpr char TexRectUniformName[] = "texRect";
+		static constexpr char PaletteUniformName[] = "uPalette";
 		static constexpr char PositionAttributeName[] = "aPosition";
 		static constexpr char TexCoordsAttributeName[] = "aTexCoords";
 		static constexpr char MeshIndexAttributeName[] = "aMeshIndex";
@@ -162,12 +177,19 @@ namespace nCine
 		GLShaderUniforms shaderUniforms_;
 		GLShaderUniformBlocks shaderUniformBlocks_;
 		const GLTexture* textures_[GLTexture::MaxTextureUnits];
+		/// OpenGL handles of the textures when they were set, a texture can be recreated at the same address
+		GLuint textureHandles_[GLTexture::MaxTextureUnits];
 
 		/// The size of the memory buffer containing uniform values
 		unsigned int uniformsHostBufferSize_;
 		/// Memory buffer with uniform values to be sent to the GPU
 		std::unique_ptr<GLubyte[]> uniformsHostBuffer_;
 
+		/// Cached hash of shader program, textures and blending factors
+		uint32_t sortKey_;
+		/// Set when the shader program, a texture or blending factors change and the sort key has to be recalculated
+		bool sortKeyDirty_;
+
 		void bind();
 		/// Wrapper around `GLShaderUniforms::commitUniforms()`
 		inline void commitUniforms() {
@@ -179,6 +201,7 @@ namespace nCine
 		}
 		/// Wrapper around `GLShaderProgram::defineVertexFormat()`
 		void defineVertexFormat(const GLBufferObject* vbo, const GLBufferObject* ibo, unsigned int vboOffset);
+		/// Returns the material sort key, it's recalculated only if the material changed
 		uint32_t sortKey();
 
 		friend class RenderCommand;
@@ -56,7 +56,11 @@ namespace nCine
 		}
 		/// Sets the drawing layer for this command
 		inline void setLayer(uint16_t layer) {
-			layer_ = layer;
+			if (layer_ != layer) {
+				layer_ = layer;
+				// The depth of the model matrix is derived from the layer
+				transformationCommitted_ = false;
+			}
 		}
 		/// Returns the visit order index for this command
 		inline uint16_t visitOrder() const {
@@ -143,6 +147,7 @@ namespace nCine
 		static constexpr float LayerStep = 1.0f / static_cast<float>(0xFFFF);
 
 		/// The material sort key minimizes state changes when rendering commands
+		/*! It's packed as layer (16 bits), visit order (16 bits) and hash of shader program, textures and blending (32 bits). */
 		uint64_t materialSortKey_;
 		/// The id based secondary sort key stabilizes render commands sorting
 		uint32_t idSortKey_;
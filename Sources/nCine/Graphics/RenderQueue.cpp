@@ -2,6 +2,7 @@
 #include "RenderBatcher.h"
 #include "RenderResources.h"
 #include "RenderStatistics.h"
+#include "../Base/Profiler.h"
 #include "GL/GLDebug.h"
 #include "../Application.h"
 #include "GL/GLScissorTest.h"
@@ -10,6 +11,8 @@
 #include "../Base/Algorithms.h"
 #include "../tracy_opengl.h"
 
+#include <cstring>
+
 namespace nCine
 {
 #if defined(DEATH_DEBUG)
@@ -47,18 +50,57 @@ namespace nCine
 
 	namespace
 	{
-		bool descendingOrder(const RenderCommand* a, const RenderCommand* b)
+		/// Number of commands below which a comparison sort is faster than the radix sort
+		constexpr unsigned int RadixSortThreshold = 128;
+		/// Number of 8-bit digits of the id sort key and of the material sort key
+		constexpr unsigned int IdDigitCount = 4;
+		constexpr unsigned int DigitCount = IdDigitCount + 8;
+
+		template<class T>
+		inline uint32_t sortDigit(const T& entry, unsigned int digit)
 		{
-			return (a->materialSortKey() != b->materialSortKey())
-				? a->materialSortKey() > b->materialSortKey()
-				: a->idSortKey() > b->idSortKey();
+			return (digit < IdDigitCount
+				? (entry.idSortKey >> (digit * 8)) & 0xFF
+				: static_cast<uint32_t>(entry.materialSortKey >> ((digit - IdDigitCount) * 8)) & 0xFF);
 		}
 
-		bool ascendingOrder(const RenderCommand* a, const RenderCommand* b)
+		/// Stable LSD radix sort in ascending order, the id sort key is the least significant part
+		template<class T>
+		void radixSort(T* entries, T* buffer, unsigned int count)
 		{
-			return (a->materialSortKey() != b->materialSortKey())
-				? a->materialSortKey() < b->materialSortKey()
-				: a->idSortKey() < b->idSortKey();
+			// Histograms of all digits are built in a single pass
+			uint32_t histograms[DigitCount][256] = {};
+			for (unsigned int i = 0; i < count; i++) {
+				for (unsigned int digit = 0; digit < DigitCount; digit++) {
+					histograms[digit][sortDigit(entries[i], digit)]++;
+				}
+			}
+
+			T* src = entries;
+			T* dest = buffer;
+			for (unsigned int digit = 0; digit < DigitCount; digit++) {
+				uint32_t* histogram = histograms[digit];
+				// Skip the pass if all entries have the same digit, usually the case for upper bytes of layers and visit orders
+				if (histogram[sortDigit(src[0], digit)] == count) {
+					continue;
+				}
+
+				uint32_t offset = 0;
+				for (unsigned int i = 0; i < 256; i++) {
+					const uint32_t bucketSize = histogram[i];
+					histogram[i] = offset;
+					offset += bucketSize;
+				}
+				for (unsigned int i = 0; i < count; i++) {
+					dest[histogram[sortDigit(src[i], digit)]++] = src[i];
+				}
+
+				std::swap(src, dest);
+			}
+
+			if (src != entries) {
+				std::memcpy(entries, src, count * sizeof(T));
+			}
 		}
 
 #if defined(DEATH_DEBUG) && defined(NCINE_PROFILING)
@@ -86,8 +128,11 @@ namespace nCine
 		const bool batchingEnabled = theApplication().GetRenderingSettings().batchingEnabled;
 
 		// Sorting the queues with the relevant orders
-		sort(opaqueQueue_.begin(), opaqueQueue_.end(), descendingOrder);
-		sort(transparentQueue_.begin(), transparentQueue_.end(), ascendingOrder);
+		{
+			ZoneScopedNC("Sorting", 0x81A861);
+			sortQueue(opaqueQueue_, true);
+			sortQueue(transparentQueue_, false);
+		}
 
 		SmallVectorImpl<RenderCommand*>* opaques = batchingEnabled ? &opaqueBatchedQueue_ : &opaqueQueue_;
 		SmallVectorImpl<RenderCommand*>* transparents = batchingEnabled ? &transparentBatchedQueue_ : &transparentQueue_;
@@ -129,6 +174,11 @@ namespace nCine
 		SmallVectorImpl<RenderCommand*>* opaques = batchingEnabled ? &opaqueBatchedQueue_ : &opaqueQueue_;
 		SmallVectorImpl<RenderCommand*>* transparents = batchingEnabled ? &transparentBatchedQueue_ : &transparentQueue_;
 
+#if defined(WITH_PROFILER)
+		// Commands are counted before batching, batches are actual draw calls
+		Profiler::AddCounter(ProfilerCounter::RenderCommands, (std::int32_t)(opaqueQueue_.size() + transparentQueue_.size()));
+		Profiler::AddCounter(ProfilerCounter::RenderBatches, (std::int32_t)(opaques->size() + transparents->size()));
+#endif
 #if defined(DEATH_DEBUG) && defined(NCINE_PROFILING)
 		unsigned int commandIndex = 0;
 #endif
@@ -202,6 +252,42 @@ namespace nCine
 		GLScissorTest::disable();
 	}
 
+	void RenderQueue::sortQueue(SmallVectorImpl<RenderCommand*>& queue, bool descending)
+	{
+		const unsigned int count = (unsigned int)queue.size();
+		if (count < 2) {
+			return;
+		}
+
+		// Keys are inverted for descending order, so both orders can use the same ascending sort
+		const uint64_t keyMask = (descending ? ~uint64_t(0) : uint64_t(0));
+		const uint32_t idMask = (descending ? ~uint32_t(0) : uint32_t(0));
+
+		sortEntries_.resize_for_overwrite(count);
+		for (unsigned int i = 0; i < count; i++) {
+			RenderCommand* command = queue[i];
+			SortEntry& entry = sortEntries_[i];
+			entry.materialSortKey = command->materialSortKey() ^ keyMask;
+			entry.idSortKey = command->idSortKey() ^ idMask;
+			entry.command = command;
+		}
+
+		if (count < RadixSortThreshold) {
+			sort(sortEntries_.begin(), sortEntries_.end(), [](const SortEntry& a, const SortEntry& b) {
+				return (a.materialSortKey != b.materialSortKey
+					? a.materialSortKey < b.materialSortKey
+					: a.idSortKey < b.idSortKey);
+			});
+		} else {
+			sortBuffer_.resize_for_overwrite(count);
+			radixSort(sortEntries_.data(), sortBuffer_.data(), count);
+		}
+
+		for (unsigned int i = 0; i < count; i++) {
+			queue[i] = sortEntries_[i].command;
+		}
+	}
+
 	void RenderQueue::clear()
 	{
 		opaqueQueue_.clear();
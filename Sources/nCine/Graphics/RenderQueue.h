@@ -30,6 +30,14 @@ namespace nCine
 		void clear();
 
 	private:
+		/// Sort keys of a render command copied to a flat array, so sorting doesn't need to dereference commands
+		struct SortEntry
+		{
+			uint64_t materialSortKey;
+			uint32_t idSortKey;
+			RenderCommand* command;
+		};
+
 		/// Array of opaque render command pointers
 		SmallVector<RenderCommand*, 0> opaqueQueue_;
 		/// Array of opaque batched render command pointers
@@ -38,6 +46,13 @@ namespace nCine
 		SmallVector<RenderCommand*, 0> transparentQueue_;
 		/// Array of transparent batched render command pointers
 		SmallVector<RenderCommand*, 0> transparentBatchedQueue_;
+		/// Array of sort entries for the queue being sorted
+		SmallVector<SortEntry, 0> sortEntries_;
+		/// Temporary array used by the radix sort
+		SmallVector<SortEntry, 0> sortBuffer_;
+
+		/// Sorts a queue by the material sort key and then by the id sort key
+		void sortQueue(SmallVectorImpl<RenderCommand*>& queue, bool descending);
 	};
 
 }
@@ -240,6 +240,9 @@ namespace nCine
 		glGetError();
 		glTexture_->texSubImage2D(level, x, y, width, height, format, GL_UNSIGNED_BYTE, data);
 		const GLenum error = glGetError();
+#if defined(WITH_PROFILER)
+		Profiler::AddCounter(ProfilerCounter::TextureUploads);
+#endif
 
 		return (error == GL_NO_ERROR);
 	}
@@ -464,5 +467,9 @@ namespace nCine
 			levelWidth /= 2;
 			levelHeight /= 2;
 		}
+
+#if defined(WITH_PROFILER)
+		Profiler::AddCounter(ProfilerCounter::TextureUploads);
+#endif
 	}
 }
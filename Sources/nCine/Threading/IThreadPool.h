@@ -1,8 +1,13 @@
 #pragma once
 
 #include "IThreadCommand.h"
+#include "Job.h"
 
 #include <memory>
+#include <Containers/SmallVector.h>
+
+using namespace Death::Containers;
+#include <utility>
 
 namespace nCine
 {
@@ -14,14 +19,108 @@ namespace nCine
 
 		/// Enqueues a command request for a worker thread
 		virtual void EnqueueCommand(std::unique_ptr<IThreadCommand>&& threadCommand) = 0;
+
+		/// Creates a new job, it's not executed until `Run()` is called
+		virtual Job* CreateJob(JobFunction function) = 0;
+		/// Creates a new job as a child of the specified job, the parent is not completed until all its children are completed
+		virtual Job* CreateChildJob(Job* parent, JobFunction function) = 0;
+		/// Schedules a job for execution
+		virtual void Run(Job* job) = 0;
+		/// Waits until a job is completed, the calling thread executes other jobs in the meantime
+		virtual void Wait(const Job* job) = 0;
+
+		/// Creates a new job from a closure, the closure is stored inline in the job
+		template<typename F>
+		Job* CreateJob(F&& function) {
+			return CreateChildJob(nullptr, std::forward<F>(function));
+		}
+
+		/// Creates a new job from a closure as a child of the specified job
+		template<typename F, class = std::enable_if_t<!std::is_convertible<F, JobFunction>::value>>
+		Job* CreateChildJob(Job* parent, F&& function) {
+			using T = std::decay_t<F>;
+			static_assert(std::is_trivially_destructible<T>::value, "Job closure must be trivially destructible");
+
+			Job* job = CreateChildJob(parent, &Implementation::InvokeJobClosure<T>);
+			new(job->GetData<T>()) T(std::forward<F>(function));
+			return job;
+		}
+
+		/// Calls `function(start, end)` for all batches of the range `[0, count)` in parallel and waits until all of them are completed
+		template<typename F>
+		void ParallelFor(std::int32_t count, std::int32_t batchSize, const F& function) {
+			if (count <= 0) {
+				return;
+			}
+			if (batchSize <= 0) {
+				batchSize = 1;
+			}
+			if (count <= batchSize) {
+				// Only one batch, don't bother with jobs
+				function(0, count);
+				return;
+			}
+
+			Job* root = CreateJob(static_cast<JobFunction>(nullptr));
+			for (std::int32_t start = 0; start < count; start += batchSize) {
+				Job* job = CreateChildJob(root, &Implementation::InvokeParallelForJob<F>);
+				auto* data = job->GetData<Implementation::ParallelForJobData<F>>();
+				data->Function = &function;
+				data->Start = start;
+				data->End = (count - start > batchSize ? start + batchSize : count);
+				Run(job);
+			}
+			Run(root);
+			Wait(root);
+		}
 	};
 
 	inline IThreadPool::~IThreadPool() { }
 
-	/// A fake thread pool which doesn't execute any commands
+	/// A fake thread pool which doesn't execute any commands and executes jobs immediately on the calling thread
 	class NullThreadPool : public IThreadPool
 	{
 	public:
+		using IThreadPool::CreateJob;
+		using IThreadPool::CreateChildJob;
+
+		NullThreadPool() : nextJob_(0) { }
+
 		void EnqueueCommand(std::unique_ptr<IThreadCommand>&& threadCommand) override { }
+
+		Job* CreateJob(JobFunction function) override {
+			return CreateChildJob(nullptr, function);
+		}
+		Job* CreateChildJob(Job* parent, JobFunction function) override {
+			// Jobs are executed immediately, only parents of not yet executed jobs can be still in use
+			Job* job = nullptr;
+			std::uint32_t jobCount = std::uint32_t(jobChunks_.size()) * JobChunkSize;
+			for (std::uint32_t n = 0; n < jobCount; n++) {
+				std::uint32_t index = nextJob_++ % jobCount;
+				Job* candidate = &jobChunks_[index / JobChunkSize][index % JobChunkSize];
+				if (candidate->IsCompleted()) {
+					job = candidate;
+					break;
+				}
+			}
+			if (job == nullptr) {
+				// All jobs are still in flight, allocate a new chunk, existing jobs must not be moved
+				jobChunks_.push_back(std::make_unique<Job[]>(JobChunkSize));
+				job = &jobChunks_.back()[0];
+				nextJob_ = jobCount + 1;
+			}
+			job->Initialize(function, parent);
+			return job;
+		}
+		void Run(Job* job) override {
+			job->Execute();
+		}
+		void Wait(const Job*) override { }
+
+	private:
+		static constexpr std::uint32_t JobChunkSize = 256;
+
+		SmallVector<std::unique_ptr<Job[]>, 0> jobChunks_;
+		std::uint32_t nextJob_;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Atomic.h"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace nCine
+{
+	class Job;
+
+	/// Job function delegate
+	using JobFunction = void(*)(Job* job);
+
+	/// A small unit of work executed by a thread pool
+	/*! Jobs are allocated from a preallocated pool, so no heap allocation is needed. Closures are stored inline
+	 *  in the job, so they should capture only a few pointers or values. */
+	class alignas(64) Job
+	{
+		friend class ThreadPool;
+		friend class NullThreadPool;
+
+	public:
+		/// Size of inline storage for job data
+		static constexpr std::size_t DataSize = 96;
+
+		/// Returns pointer to inline storage for job data
+		inline void* GetData() {
+			return data_;
+		}
+		/// Returns inline storage for job data as the specified type
+		template<typename T>
+		inline T* GetData() {
+			static_assert(sizeof(T) <= DataSize, "Job data don't fit into inline storage");
+			return reinterpret_cast<T*>(data_);
+		}
+
+		/// Returns true if the job and all its children are completed
+		inline bool IsCompleted() const {
+			return const_cast<Atomic32&>(unfinishedJobs_).load(Atomic32::MemoryModel::ACQUIRE) <= 0;
+		}
+
+	private:
+		alignas(std::max_align_t) unsigned char data_[DataSize];
+		JobFunction function_;
+		Job* parent_;
+		Atomic32 unfinishedJobs_;
+
+		/// Initializes the job, it's called before the job is returned from a pool
+		void Initialize(JobFunction function, Job* parent)
+		{
+			function_ = function;
+			parent_ = parent;
+			unfinishedJobs_.store(1, Atomic32::MemoryModel::RELAXED);
+			if (parent != nullptr) {
+				parent->unfinishedJobs_.fetchAdd(1);
+			}
+		}
+
+		/// Executes the job function and marks the job as finished
+		void Execute()
+		{
+			if (function_ != nullptr) {
+				function_(this);
+			}
+			Finish();
+		}
+
+		void Finish()
+		{
+			// Parent must be read before decrementing, the job can be reused by another thread as soon as it's completed
+			Job* parent = parent_;
+			if (unfinishedJobs_.fetchSub(1) == 1 && parent != nullptr) {
+				parent->Finish();
+			}
+		}
+	};
+
+	static_assert(sizeof(Job) == 128, "Job should occupy exactly two cache lines");
+
+	namespace Implementation
+	{
+		template<typename F>
+		void InvokeJobClosure(Job* job)
+		{
+			(*job->GetData<F>())();
+		}
+
+		template<typename F>
+		struct ParallelForJobData
+		{
+			const F* Function;
+			std::int32_t Start;
+			std::int32_t End;
+		};
+
+		template<typename F>
+		void InvokeParallelForJob(Job* job)
+		{
+			auto* data = job->GetData<ParallelForJobData<F>>();
+			(*data->Function)(data->Start, data->End);
+		}
+	}
+}
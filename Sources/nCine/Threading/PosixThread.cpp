@@ -28,6 +28,10 @@
 #	include "common/TracySystem.hpp"
 #endif
 
+#if defined(WITH_PROFILER)
+#	include "../Base/Profiler.h"
+#endif
+
 namespace nCine
 {
 	namespace
@@ -310,6 +314,9 @@ namespace nCine
 		t.Detach();
 
 		threadFunc(threadArg);
+#if defined(WITH_PROFILER)
+		Profiler::ReleaseCurrentThread();
+#endif
 		return nullptr;
 	}
 }
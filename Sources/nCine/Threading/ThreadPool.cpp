@@ -5,74 +5,201 @@
 
 namespace nCine
 {
+	namespace
+	{
+		// Every thread can be associated with only one pool
+		DEATH_THREAD_LOCAL void* CurrentWorker = nullptr;
+
+		// Number of unsuccessful attempts to get a job before the worker thread goes to sleep
+		constexpr std::int32_t SpinCountBeforeSleep = 64;
+	}
+
 	ThreadPool::ThreadPool()
-		: ThreadPool(Thread::GetProcessorCount())
+		: ThreadPool(Thread::GetProcessorCount() > 1 ? Thread::GetProcessorCount() - 1 : 1)
 	{
 	}
 
 	ThreadPool::ThreadPool(std::size_t numThreads)
-		: threads_(numThreads), numThreads_(numThreads)
+		: numThreads_(numThreads), shouldQuit_(false)
 	{
-		threadStruct_.queue = &queue_;
-		threadStruct_.queueMutex = &queueMutex_;
-		threadStruct_.queueCV = &queueCV_;
-		threadStruct_.shouldQuit = false;
+		threads_.reserve(numThreads_);
+		workers_.reserve(numThreads_ + 1);
+
+		// The first slot belongs to the calling thread
+		for (std::size_t i = 0; i <= numThreads_; i++) {
+			auto& worker = workers_.emplace_back(std::make_unique<WorkerData>());
+			worker->owner = this;
+			worker->index = (std::int32_t)i;
+			worker->jobs = std::make_unique<Job[]>(MaxJobCount);
+			worker->nextJob = 0;
+		}
 
-		quitMutex_.Lock();
+		CurrentWorker = workers_[0].get();
 
 		for (std::size_t i = 0; i < numThreads_; i++) {
-			threads_.emplace_back(WorkerFunction, &threadStruct_);
+			threads_.emplace_back(WorkerFunction, workers_[i + 1].get());
 		}
 	}
 
 	ThreadPool::~ThreadPool()
 	{
-		threadStruct_.shouldQuit = true;
-		queueCV_.Broadcast();
+		sleepMutex_.Lock();
+		shouldQuit_ = true;
+		sleepCV_.Broadcast();
+		sleepMutex_.Unlock();
 
 		for (std::size_t i = 0; i < numThreads_; i++) {
 			threads_[i].Join();
 		}
+
+		if (CurrentWorker == workers_[0].get()) {
+			CurrentWorker = nullptr;
+		}
 	}
 
 	void ThreadPool::EnqueueCommand(std::unique_ptr<IThreadCommand>&& threadCommand)
 	{
 		ASSERT(threadCommand);
 
-		queueMutex_.Lock();
-		queue_.push_back(std::move(threadCommand));
-		queueCV_.Broadcast();
-		queueMutex_.Unlock();
+		commandQueue_.enqueue(std::move(threadCommand));
+		pendingCount_.fetchAdd(1);
+		WakeUpWorker();
+	}
+
+	Job* ThreadPool::CreateJob(JobFunction function)
+	{
+		return CreateChildJob(nullptr, function);
+	}
+
+	Job* ThreadPool::CreateChildJob(Job* parent, JobFunction function)
+	{
+		WorkerData* worker = GetCurrentWorker();
+		FATAL_ASSERT_MSG(worker != nullptr, "Jobs can be created only from the main thread or from worker threads");
+
+		// Jobs are allocated from a ring buffer, skip jobs that are still in flight (mostly parents waiting for children)
+		Job* job;
+		std::uint32_t n = 0;
+		do {
+			job = &worker->jobs[worker->nextJob++ & (MaxJobCount - 1)];
+			FATAL_ASSERT_MSG(++n <= MaxJobCount, "Too many jobs in flight");
+		} while (!job->IsCompleted());
+
+		job->Initialize(function, parent);
+		return job;
+	}
+
+	void ThreadPool::Run(Job* job)
+	{
+		WorkerData* worker = GetCurrentWorker();
+		if (worker == nullptr) {
+			// Unknown thread, use queue of the main thread instead, it's thread-safe anyway
+			worker = workers_[0].get();
+		}
+
+		worker->queue.enqueue(job);
+		pendingCount_.fetchAdd(1);
+		WakeUpWorker();
+	}
+
+	void ThreadPool::Wait(const Job* job)
+	{
+		WorkerData* worker = GetCurrentWorker();
+
+		while (!job->IsCompleted()) {
+			Job* nextJob = (worker != nullptr ? TryGetJob(worker) : nullptr);
+			if (nextJob != nullptr) {
+				nextJob->Execute();
+			} else {
+				Thread::YieldExecution();
+			}
+		}
 	}
 
 	void ThreadPool::WorkerFunction(void* arg)
 	{
-		ThreadStruct* threadStruct = static_cast<ThreadStruct*>(arg);
+		WorkerData* worker = static_cast<WorkerData*>(arg);
+		ThreadPool* owner = worker->owner;
+		CurrentWorker = worker;
 
 		LOGD("Worker thread %llu is starting", Thread::GetCurrentId());
 
+		std::int32_t spinCount = 0;
 		while (true) {
-			threadStruct->queueMutex->Lock();
-			while (threadStruct->queue->empty() && !threadStruct->shouldQuit) {
-				threadStruct->queueCV->Wait(*(threadStruct->queueMutex));
+			Job* job = owner->TryGetJob(worker);
+			if (job != nullptr) {
+				job->Execute();
+				spinCount = 0;
+				continue;
 			}
 
-			if (threadStruct->shouldQuit) {
-				threadStruct->queueMutex->Unlock();
-				break;
+			std::unique_ptr<IThreadCommand> threadCommand;
+			if (owner->commandQueue_.try_dequeue(threadCommand)) {
+				owner->pendingCount_.fetchSub(1);
+				threadCommand->Execute();
+				spinCount = 0;
+				continue;
+			}
+
+			if (++spinCount < SpinCountBeforeSleep) {
+				Thread::YieldExecution();
+				continue;
 			}
 
-			std::unique_ptr<IThreadCommand> threadCommand = std::move(threadStruct->queue->front());
-			threadStruct->queue->pop_front();
-			threadStruct->queueMutex->Unlock();
+			// Nothing to do, go to sleep until something is enqueued
+			owner->sleepMutex_.Lock();
+			owner->sleepingCount_.fetchAdd(1);
+			while (owner->pendingCount_.load() <= 0 && !owner->shouldQuit_) {
+				owner->sleepCV_.Wait(owner->sleepMutex_);
+			}
+			owner->sleepingCount_.fetchSub(1);
+			bool shouldQuit = owner->shouldQuit_;
+			owner->sleepMutex_.Unlock();
 
-			LOGD("Worker thread %llu is executing its command", Thread::GetCurrentId());
-			threadCommand->Execute();
+			if (shouldQuit) {
+				break;
+			}
+			spinCount = 0;
 		}
 
 		LOGD("Worker thread %llu is exiting", Thread::GetCurrentId());
 	}
 
+	ThreadPool::WorkerData* ThreadPool::GetCurrentWorker()
+	{
+		WorkerData* worker = static_cast<WorkerData*>(CurrentWorker);
+		return (worker != nullptr && worker->owner == this ? worker : nullptr);
+	}
+
+	Job* ThreadPool::TryGetJob(WorkerData* worker)
+	{
+		Job* job;
+		if (worker->queue.try_dequeue(job)) {
+			pendingCount_.fetchSub(1);
+			return job;
+		}
+
+		// Own queue is empty, try to steal a job from other threads
+		std::size_t count = workers_.size();
+		for (std::size_t i = 1; i < count; i++) {
+			WorkerData* victim = workers_[(worker->index + i) % count].get();
+			if (victim->queue.try_dequeue(job)) {
+				pendingCount_.fetchSub(1);
+				return job;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void ThreadPool::WakeUpWorker()
+	{
+		// Signal only one sleeping worker, and only if there is any
+		if (sleepingCount_.load() > 0) {
+			sleepMutex_.Lock();
+			sleepCV_.Signal();
+			sleepMutex_.Unlock();
+		}
+	}
 }
 
-#endif
\ No newline at end of file
+#endif
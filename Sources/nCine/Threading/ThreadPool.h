@@ -3,8 +3,7 @@
 #include "IThreadPool.h"
 #include "ThreadSync.h"
 #include "Thread.h"
-
-#include <list>
+#include "../Base/ConcurentQueue/concurrentqueue.h"
 
 #include <Containers/SmallVector.h>
 
@@ -13,10 +12,15 @@ using namespace Death::Containers;
 namespace nCine
 {
 	/// Thread pool class
+	/*! Every thread (including the thread that created the pool) has its own lock-free job queue and job allocator.
+	 *  Idle threads steal jobs from queues of other threads. Commands are executed only by worker threads. */
 	class ThreadPool : public IThreadPool
 	{
 	public:
-		/// Creates a thread pool with as many threads as available processors
+		using IThreadPool::CreateJob;
+		using IThreadPool::CreateChildJob;
+
+		/// Creates a thread pool with as many threads as available processors (excluding the calling thread)
 		ThreadPool();
 		/// Creates a thread pool with a specified number of threads
 		explicit ThreadPool(std::size_t numThreads);
@@ -25,28 +29,47 @@ namespace nCine
 		/// Enqueues a command request for a worker thread
 		void EnqueueCommand(std::unique_ptr<IThreadCommand>&& threadCommand) override;
 
+		/// Creates a new job, it can be called only from the thread that created the pool or from worker threads
+		Job* CreateJob(JobFunction function) override;
+		/// Creates a new job as a child of the specified job
+		Job* CreateChildJob(Job* parent, JobFunction function) override;
+		/// Schedules a job for execution
+		void Run(Job* job) override;
+		/// Waits until a job is completed, the calling thread executes other jobs in the meantime
+		void Wait(const Job* job) override;
+
 	private:
-		struct ThreadStruct
+		/// Max. number of jobs in flight per thread, it must be power of two
+		static constexpr std::uint32_t MaxJobCount = 4096;
+
+		struct WorkerData
 		{
-			std::list<std::unique_ptr<IThreadCommand>>* queue;
-			Mutex* queueMutex;
-			CondVariable* queueCV;
-			bool shouldQuit;
+			ThreadPool* owner;
+			std::int32_t index;
+			moodycamel::ConcurrentQueue<Job*> queue;
+			std::unique_ptr<Job[]> jobs;
+			std::uint32_t nextJob;
 		};
 
-		std::list<std::unique_ptr<IThreadCommand>> queue_;
 		SmallVector<Thread, 0> threads_;
-		Mutex queueMutex_;
-		CondVariable queueCV_;
-		Mutex quitMutex_;
+		SmallVector<std::unique_ptr<WorkerData>, 0> workers_;
+		moodycamel::ConcurrentQueue<std::unique_ptr<IThreadCommand>> commandQueue_;
+		Atomic32 pendingCount_;
+		Atomic32 sleepingCount_;
+		Mutex sleepMutex_;
+		CondVariable sleepCV_;
 		std::size_t numThreads_;
+		bool shouldQuit_;
 
-		ThreadStruct threadStruct_;
 		static void WorkerFunction(void* arg);
 
+		WorkerData* GetCurrentWorker();
+		Job* TryGetJob(WorkerData* worker);
+		void WakeUpWorker();
+
 		/// Deleted copy constructor
 		ThreadPool(const ThreadPool&) = delete;
 		/// Deleted assignment operator
 		ThreadPool& operator=(const ThreadPool&) = delete;
 	};
-}
\ No newline at end of file
+}
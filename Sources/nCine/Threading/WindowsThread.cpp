@@ -235,6 +235,9 @@ namespace nCine
 		t.Detach();
 
 		threadFunc(threadArg);
+#if defined(WITH_PROFILER)
+		Profiler::ReleaseCurrentThread();
+#endif
 		_endthreadex(0);
 		return 0;
 	}
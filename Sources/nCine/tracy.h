@@ -3,20 +3,42 @@
 #	include "tracy/TracyC.h"
 #else
 
+#if defined(WITH_PROFILER)
+#	include "Base/Profiler.h"
+
+// Zones are recorded by the built-in profiler instead
+#	define NCINE_PROFILER_CONCAT_(x, y) x##y
+#	define NCINE_PROFILER_CONCAT(x, y) NCINE_PROFILER_CONCAT_(x, y)
+
+#	define ZoneNamed(x, y) nCine::ProfilerZone x(__FUNCTION__, 0)
+#	define ZoneNamedN(x, y, z) nCine::ProfilerZone x(y, 0)
+#	define ZoneNamedC(x, y, z) nCine::ProfilerZone x(__FUNCTION__, y)
+#	define ZoneNamedNC(x, y, z, w) nCine::ProfilerZone x(y, z)
+
+#	define ZoneScoped nCine::ProfilerZone NCINE_PROFILER_CONCAT(profilerZone, __LINE__)(__FUNCTION__, 0)
+#	define ZoneScopedN(x) nCine::ProfilerZone NCINE_PROFILER_CONCAT(profilerZone, __LINE__)(x, 0)
+#	define ZoneScopedC(x) nCine::ProfilerZone NCINE_PROFILER_CONCAT(profilerZone, __LINE__)(__FUNCTION__, x)
+#	define ZoneScopedNC(x, y) nCine::ProfilerZone NCINE_PROFILER_CONCAT(profilerZone, __LINE__)(x, y)
+
+#	define FrameMark nCine::Profiler::MarkFrame()
+#else
 // From Tracy.hpp
 #	define ZoneNamed(x, y)
 #	define ZoneNamedN(x, y, z)
 #	define ZoneNamedC(x, y, z)
 #	define ZoneNamedNC(x, y, z, w)
 
-#	define ZoneTransient(x, y)
-#	define ZoneTransientN(x, y, z)
-
 #	define ZoneScoped
 #	define ZoneScopedN(x)
 #	define ZoneScopedC(x)
 #	define ZoneScopedNC(x, y)
 
+#	define FrameMark
+#endif
+
+#	define ZoneTransient(x, y)
+#	define ZoneTransientN(x, y, z)
+
 #	define ZoneText(x, y)
 #	define ZoneTextV(x, y, z)
 #	define ZoneName(x, y)
@@ -28,7 +50,6 @@
 #	define ZoneIsActive false
 #	define ZoneIsActiveV(x) false
 
-#	define FrameMark
 #	define FrameMarkNamed(x)
 #	define FrameMarkStart(x)
 #	define FrameMarkEnd(x)
@@ -464,6 +464,13 @@ if(NCINE_WITH_TRACY)
 		PUBLIC $<INSTALL_INTERFACE:include/tracy>)
 endif()
 
+if(NCINE_WITH_PROFILER)
+	target_compile_definitions(${NCINE_APP} PRIVATE "WITH_PROFILER")
+
+	list(APPEND HEADERS ${NCINE_SOURCE_DIR}/nCine/Base/Profiler.h)
+	list(APPEND SOURCES ${NCINE_SOURCE_DIR}/nCine/Base/Profiler.cpp)
+endif()
+
 #if(NCINE_WITH_RENDERDOC AND NOT APPLE)
 #	find_file(RENDERDOC_API_H
 #		NAMES renderdoc.h renderdoc_app.h
@@ -691,6 +698,11 @@ if(DISABLE_RESCALE_SHADERS)
 	target_compile_definitions(${NCINE_APP} PUBLIC "DISABLE_RESCALE_SHADERS")
 endif()
 
+if(WITH_BENCHMARK)
+	message(STATUS "Building the game with simulation benchmark")
+	target_compile_definitions(${NCINE_APP} PUBLIC "WITH_BENCHMARK")
+endif()
+
 if(WITH_MULTIPLAYER)
 	message(STATUS "Building the game with multiplayer support")
 	target_compile_definitions(${NCINE_APP} PUBLIC "WITH_MULTIPLAYER")
@@ -18,6 +18,7 @@ set(HEADERS
 	${NCINE_SOURCE_DIR}/Shared/Containers/Array.h
 	${NCINE_SOURCE_DIR}/Shared/Containers/ArrayView.h
 	${NCINE_SOURCE_DIR}/Shared/Containers/DateTime.h
+	${NCINE_SOURCE_DIR}/Shared/Containers/FunctionRef.h
 	${NCINE_SOURCE_DIR}/Shared/Containers/GrowableArray.h
 	${NCINE_SOURCE_DIR}/Shared/Containers/Pair.h
 	${NCINE_SOURCE_DIR}/Shared/Containers/Reference.h
@@ -157,6 +158,7 @@ list(APPEND HEADERS
 	${NCINE_SOURCE_DIR}/nCine/Threading/Atomic.h
 	${NCINE_SOURCE_DIR}/nCine/Threading/IThreadCommand.h
 	${NCINE_SOURCE_DIR}/nCine/Threading/IThreadPool.h
+	${NCINE_SOURCE_DIR}/nCine/Threading/Job.h
 )
 
 list(APPEND HEADERS
@@ -190,11 +192,15 @@ list(APPEND HEADERS
 	${NCINE_SOURCE_DIR}/Jazz2/RumbleDescription.h
 	${NCINE_SOURCE_DIR}/Jazz2/RumbleProcessor.h
 	${NCINE_SOURCE_DIR}/Jazz2/ShieldType.h
+	${NCINE_SOURCE_DIR}/Jazz2/SimulationBenchmark.h
+	${NCINE_SOURCE_DIR}/Jazz2/SoundVoiceManager.h
+	${NCINE_SOURCE_DIR}/Jazz2/SpriteAtlas.h
 	${NCINE_SOURCE_DIR}/Jazz2/SuspendType.h
 	${NCINE_SOURCE_DIR}/Jazz2/WarpFlags.h
 	${NCINE_SOURCE_DIR}/Jazz2/WeaponType.h
 	${NCINE_SOURCE_DIR}/Jazz2/WeatherType.h
 	${NCINE_SOURCE_DIR}/Jazz2/Actors/ActorBase.h
+	${NCINE_SOURCE_DIR}/Jazz2/Actors/ActorPool.h
 	${NCINE_SOURCE_DIR}/Jazz2/Actors/Player.h
 	${NCINE_SOURCE_DIR}/Jazz2/Actors/PlayerCorpse.h
 	${NCINE_SOURCE_DIR}/Jazz2/Actors/SolidObjectBase.h
@@ -306,6 +312,8 @@ list(APPEND HEADERS
 	${NCINE_SOURCE_DIR}/Jazz2/Collisions/DynamicTree.h
 	${NCINE_SOURCE_DIR}/Jazz2/Collisions/DynamicTreeBroadPhase.h
 	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/AnimSetMapping.h
+	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/ConversionManifest.h
+	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/ConversionPipeline.h
 	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/EventConverter.h
 	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/JJ2Anims.h
 	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/JJ2Anims.Palettes.h
@@ -330,6 +338,7 @@ list(APPEND HEADERS
 	${NCINE_SOURCE_DIR}/Jazz2/Scripting/ScriptActorWrapper.h
 	${NCINE_SOURCE_DIR}/Jazz2/Scripting/ScriptLoader.h
 	${NCINE_SOURCE_DIR}/Jazz2/Scripting/ScriptPlayerWrapper.h
+	${NCINE_SOURCE_DIR}/Jazz2/Tiles/DebrisSystem.h
 	${NCINE_SOURCE_DIR}/Jazz2/Tiles/ITileMapOwner.h
 	${NCINE_SOURCE_DIR}/Jazz2/Tiles/TileCollisionParams.h
 	${NCINE_SOURCE_DIR}/Jazz2/Tiles/TileDestructType.h
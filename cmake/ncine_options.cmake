@@ -67,6 +67,7 @@ cmake_dependent_option(NCINE_WITH_OPENMPT "Enable module (libopenmpt) audio file
 option(NCINE_WITH_ANGELSCRIPT "Enable AngelScript scripting support" OFF)
 option(NCINE_WITH_IMGUI "Enable integration with Dear ImGui" OFF)
 option(NCINE_WITH_TRACY "Enable integration with Tracy frame profiler" OFF)
+cmake_dependent_option(NCINE_WITH_PROFILER "Enable built-in frame profiler with performance overlay and trace export" ON "NOT NCINE_WITH_TRACY" OFF)
 option(NCINE_WITH_RENDERDOC "Enable integration with RenderDoc" OFF)
 
 cmake_dependent_option(NCINE_COMPILE_OPENMPT "Compile libopenmpt from sources instead of using library" OFF "NCINE_WITH_OPENMPT" OFF)
@@ -157,6 +158,7 @@ option(DEATH_CPU_USE_RUNTIME_DISPATCH "Build with runtime dispatch for CPU-depen
 # Jazz² Resurrection options
 option(SHAREWARE_DEMO_ONLY "Show only Shareware Demo episode" OFF)
 option(DISABLE_RESCALE_SHADERS "Disable all rescaling options" OFF)
+option(WITH_BENCHMARK "Enable headless simulation benchmark (/benchmark:<episode>/<level>)" OFF)
 
 # Multiplayer is not supported on Emscripten yet and requires multithreading
 cmake_dependent_option(WITH_MULTIPLAYER "Enable multiplayer support" OFF "NCINE_WITH_THREADS;NOT EMSCRIPTEN" OFF)
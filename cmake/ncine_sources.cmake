@@ -110,7 +110,11 @@ list(APPEND SOURCES
 	${NCINE_SOURCE_DIR}/Jazz2/PreferencesCache.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Resources.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/RumbleProcessor.cpp
+	${NCINE_SOURCE_DIR}/Jazz2/SimulationBenchmark.cpp
+	${NCINE_SOURCE_DIR}/Jazz2/SoundVoiceManager.cpp
+	${NCINE_SOURCE_DIR}/Jazz2/SpriteAtlas.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Actors/ActorBase.cpp
+	${NCINE_SOURCE_DIR}/Jazz2/Actors/ActorPool.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Actors/Player.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Actors/PlayerCorpse.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Actors/SolidObjectBase.cpp
@@ -222,6 +226,8 @@ list(APPEND SOURCES
 	${NCINE_SOURCE_DIR}/Jazz2/Collisions/DynamicTree.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Collisions/DynamicTreeBroadPhase.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/AnimSetMapping.cpp
+	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/ConversionManifest.cpp
+	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/ConversionPipeline.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/EventConverter.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/JJ2Anims.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Compatibility/JJ2Block.cpp
@@ -243,6 +249,7 @@ list(APPEND SOURCES
 	${NCINE_SOURCE_DIR}/Jazz2/Scripting/ScriptActorWrapper.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Scripting/ScriptLoader.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Scripting/ScriptPlayerWrapper.cpp
+	${NCINE_SOURCE_DIR}/Jazz2/Tiles/DebrisSystem.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Tiles/TileMap.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/Tiles/TileSet.cpp
 	${NCINE_SOURCE_DIR}/Jazz2/UI/Canvas.cpp